@@ -29,6 +29,7 @@ $OUTPUT_DIR/Endian_UT
 $OUTPUT_DIR/Bitv_UT
 $OUTPUT_DIR/ConfigLoader_UT
 $OUTPUT_DIR/PkCont_UT
+$OUTPUT_DIR/PkReceiver_UT
 $OUTPUT_DIR/ObjSupplier_UT
 $OUTPUT_DIR/FlowControl_UT
 
@@ -57,6 +58,7 @@ $OUTPUT_DIR/TimedFileName_UT
 $OUTPUT_DIR/InnFile_UT
 $OUTPUT_DIR/InnDbf_UT
 $OUTPUT_DIR/InnApf_UT
+$OUTPUT_DIR/TsPkLog_UT
 ./t_FileRevRead.sh  t_FileRevRead.sh
 
 rm -rf ./logs
@@ -77,6 +79,7 @@ $OUTPUT_DIR/AuthMgr_UT
 
 # unit tests: fmkt / fix
 $OUTPUT_DIR/Symb_UT
+$OUTPUT_DIR/SymbBS_UT
 $OUTPUT_DIR/FixParser_UT
 $OUTPUT_DIR/FixRecorder_UT
 $OUTPUT_DIR/FixFeeder_UT
@@ -9,6 +9,7 @@
 #include "fon9/TestTools.hpp"
 #include "fon9/RevPrint.hpp"
 #include "fon9/buffer/DcQueue.hpp"
+#include "fon9/PkReceiver.hpp"
 
 namespace f9extests {
 
@@ -52,6 +53,45 @@ double ExgMktFeedAll(const MktDataFile& mdf, PkReceiverT& pkReceiver) {
    return tmFull;
 }
 
+/// 使用各種 fon9::XorSumKernel 及 SkipCheckSum, 重播 mdf, 顯示各種方式的吞吐量.
+/// 結果(ReceivedCount_, ChkSumErrCount_, DroppedBytes_)必須與 orig 相同(SkipCheckSum 除外).
+template <class PkReceiverT>
+void ExgMktBenchCheckSum(const PkReceiverT& orig, const MktDataFile& mdf) {
+   static const fon9::XorSumKernel kKernels[] = {
+      fon9::XorSumKernel::Scalar,
+      fon9::XorSumKernel::Sse41,
+      fon9::XorSumKernel::Avx2,
+   };
+   static const char* const kKernelNames[] = {"Scalar", "SSE4.1", "AVX2"};
+   const fon9::XorSumKernel kernelOrig = fon9::GetXorSumKernel();
+   for (unsigned L = 0; L <= fon9::numofele(kKernels); ++L) {
+      const bool isSkip = (L == fon9::numofele(kKernels));
+      if (!isSkip && !fon9::SetXorSumKernel(kKernels[L]))
+         continue;
+      std::unique_ptr<PkReceiverT> pkReceiver{new PkReceiverT};
+      pkReceiver->SetSkipCheckSum(isSkip);
+      fon9::DcQueueFixedMem   dcq{mdf.Buffer_, mdf.Size_};
+      fon9::StopWatch         stopWatch;
+      pkReceiver->FeedBuffer(dcq);
+      const double secs = stopWatch.StopTimer();
+      std::string  msg = "Replay:";
+      msg.append(isSkip ? "SkipCheckSum" : kKernelNames[L]);
+      msg.resize(20, ' ');
+      stopWatch.PrintResultNoEOL(secs, msg.c_str(), pkReceiver->ReceivedCount_)
+         << "|" << static_cast<double>(mdf.Size_) / secs / (1024 * 1024) << " MB/s" << std::endl;
+      if (isSkip ? (pkReceiver->ReceivedCount_ != orig.ReceivedCount_ + orig.ChkSumErrCount_)
+                 : (pkReceiver->ReceivedCount_ != orig.ReceivedCount_
+                    || pkReceiver->ChkSumErrCount_ != orig.ChkSumErrCount_
+                    || pkReceiver->DroppedBytes_ != orig.DroppedBytes_)) {
+         std::cout << "[ERROR] " << msg << "|ReceivedCount=" << pkReceiver->ReceivedCount_
+            << "|ChkSumErrCount=" << pkReceiver->ChkSumErrCount_
+            << "|DroppedBytes=" << pkReceiver->DroppedBytes_ << std::endl;
+         abort();
+      }
+   }
+   fon9::SetXorSumKernel(kernelOrig);
+}
+
 /// step = 每次餵食的資料量, 用來測試「串流式」的資料來源.
 template <class PkReceiverT>
 void CheckExgMktFeederStep(const PkReceiverT& orig, const char* buf, size_t bufsz, size_t step) {
@@ -177,12 +217,12 @@ void ExgMktTestParser(const char* msgHead, const MktDataFile& mdf, int argc, cha
                   symi->BS_.Data_.DerivedSell_.Pri_, fmtPri, " / ", symi->BS_.Data_.DerivedSell_.Qty_, fmtQty, '\n',
                   symi->BS_.Data_.DerivedBuy_.Pri_, fmtPri, " / ", symi->BS_.Data_.DerivedBuy_.Qty_, fmtQty, '\n');
       }
-      for (int L = fon9::fmkt::SymbBSData::kBSCount; L > 0;) {
+      for (int L = symi->BS_.Data_.kBSCount; L > 0;) {
          --L;
          RevPrint(rbuf, symi->BS_.Data_.Buys_[L].Pri_, fmtPri, " / ", symi->BS_.Data_.Buys_[L].Qty_, fmtQty, '\n');
       }
       RevPrint(rbuf, "---\n");
-      for (int L = 0; L < fon9::fmkt::SymbBSData::kBSCount; ++L) {
+      for (int L = 0; L < symi->BS_.Data_.kBSCount; ++L) {
          RevPrint(rbuf, symi->BS_.Data_.Sells_[L].Pri_, fmtPri, " / ", symi->BS_.Data_.Sells_[L].Qty_, fmtQty, '\n');
       }
       fon9::RevPrint(rbuf,
@@ -0,0 +1,141 @@
+﻿// \file f9twf/ExgMcArbitrator.cpp
+// \author fonwinz@gmail.com
+#include "f9twf/ExgMcArbitrator.hpp"
+#include "fon9/Log.hpp"
+
+namespace f9twf {
+using namespace fon9;
+
+ExgMcArbitrator::~ExgMcArbitrator() {
+   this->Timer_.DisposeAndWait();
+}
+void ExgMcArbitrator::ResetSeq() {
+   std::lock_guard<std::mutex> locker{this->Mutex_};
+   for (Slot& slot : this->Window_)
+      slot.Seq_ = 0;
+}
+void ExgMcArbitrator::ClearSt() {
+   std::lock_guard<std::mutex> locker{this->Mutex_};
+   for (Line& line : this->Lines_) {
+      line.PkCount_ = 0;
+      line.WinCount_ = 0;
+      line.LoseCount_ = 0;
+      line.StallCount_ = 0;
+      line.LagNS_.Clear();
+   }
+}
+void ExgMcArbitrator::SetLineDevice(unsigned lineIdx, io::Device* dev) {
+   assert(lineIdx < kExgMcArbLineCount);
+   std::lock_guard<std::mutex> locker{this->Mutex_};
+   this->Lines_[lineIdx].Device_.reset(dev);
+}
+void ExgMcArbitrator::StartStallTimer() {
+   this->Timer_.RunAfter(TimeInterval_Microsecond(static_cast<TimeInterval::OrigType>(this->StallIntervalNS_ / 2000)));
+}
+void ExgMcArbitrator::EmitOnTimer(TimerEntry* timer, TimeStamp now) {
+   (void)now;
+   ExgMcArbitrator& rthis = ContainerOf(*static_cast<decltype(ExgMcArbitrator::Timer_)*>(timer), &ExgMcArbitrator::Timer_);
+   if (rthis.StallIntervalNS_ == 0) { // Stall=0: 不檢查停滯.
+      std::lock_guard<std::mutex> locker{rthis.Mutex_};
+      rthis.IsTimerStarted_ = false;
+      return;
+   }
+   rthis.CheckStalled(LatencyHistogram::NowNS());
+   rthis.StartStallTimer();
+}
+void ExgMcArbitrator::CheckStalled(uint64_t now) {
+   io::DeviceSP   reopens[kExgMcArbLineCount];
+   {
+      std::lock_guard<std::mutex> locker{this->Mutex_};
+      bool isAnyAlive = false;
+      for (const Line& line : this->Lines_) {
+         if (line.LastRecvNS_ != 0 && now - line.LastRecvNS_ < this->StallIntervalNS_)
+            isAnyAlive = true;
+      }
+      if (!isAnyAlive)
+         return;
+      for (unsigned L = 0; L < kExgMcArbLineCount; ++L) {
+         Line& line = this->Lines_[L];
+         // 從沒收過封包的線路(例: 尚未啟用), 不判斷是否停滯.
+         if (line.IsStalled_ || line.LastRecvNS_ == 0 || now - line.LastRecvNS_ < this->StallIntervalNS_)
+            continue;
+         line.IsStalled_ = true;
+         ++line.StallCount_;
+         fon9_LOG_WARN(this->Name_, ".McArb.Stalled"
+                       "|line=", ExgMcArbLineName(L),
+                       "|idleMS=", (now - line.LastRecvNS_) / 1000000,
+                       "|dev=", ToPtr(line.Device_.get()));
+         reopens[L] = line.Device_;
+      }
+   }
+   // 停滯期間由其他線路提供全部的封包; 並嘗試重新開啟停滯線路的 Device.
+   // Device 的操作可能會回頭呼叫 SetLineDevice(), 所以必須在解鎖後處理.
+   for (io::DeviceSP& dev : reopens) {
+      if (dev) {
+         dev->AsyncClose("McArb.Stalled");
+         dev->AsyncOpen(std::string{});
+      }
+   }
+}
+void ExgMcArbitrator::OnLineReceived(unsigned lineIdx, uint64_t now) {
+   Line& line = this->Lines_[lineIdx];
+   ++line.PkCount_;
+   line.LastRecvNS_ = now;
+   if (fon9_UNLIKELY(line.IsStalled_)) {
+      line.IsStalled_ = false;
+      fon9_LOG_INFO(this->Name_, ".McArb.Recovered|line=", ExgMcArbLineName(lineIdx));
+   }
+   if (fon9_UNLIKELY(!this->IsTimerStarted_ && this->StallIntervalNS_ != 0)) {
+      this->IsTimerStarted_ = true;
+      this->StartStallTimer();
+   }
+}
+void ExgMcArbitrator::OnLineAlive(unsigned lineIdx) {
+   assert(lineIdx < kExgMcArbLineCount);
+   const uint64_t now = LatencyHistogram::NowNS();
+   std::lock_guard<std::mutex> locker{this->Mutex_};
+   this->OnLineReceived(lineIdx, now);
+}
+bool ExgMcArbitrator::OnSeqReceived(unsigned lineIdx, uint64_t seq) {
+   assert(lineIdx < kExgMcArbLineCount);
+   const uint64_t now = LatencyHistogram::NowNS();
+   std::lock_guard<std::mutex> locker{this->Mutex_};
+   this->OnLineReceived(lineIdx, now);
+   if (fon9_UNLIKELY(this->Window_.empty()))
+      this->Window_.resize(kWindowSize, Slot{0, 0});
+   Slot& slot = this->Window_[seq % kWindowSize];
+   Line& line = this->Lines_[lineIdx];
+   if (slot.Seq_ == seq) {
+      ++line.LoseCount_;
+      line.LagNS_.Add(now - slot.FirstNS_);
+      return false;
+   }
+   // 超過 kWindowSize 的舊序號, 也會來到這裡, 由 PkContFeeder 判斷是否重複.
+   slot.Seq_ = seq;
+   slot.FirstNS_ = now;
+   ++line.WinCount_;
+   return true;
+}
+bool ExgMcArbitrator::GetLineSt(unsigned lineIdx, ExgMcArbLineSt& st) const {
+   assert(lineIdx < kExgMcArbLineCount);
+   const uint64_t now = LatencyHistogram::NowNS();
+   std::lock_guard<std::mutex> locker{this->Mutex_};
+   const Line& line = this->Lines_[lineIdx];
+   if (line.LastRecvNS_ == 0)
+      return false;
+   st.PkCount_ = line.PkCount_;
+   st.WinCount_ = line.WinCount_;
+   st.LoseCount_ = line.LoseCount_;
+   const uint64_t total = line.WinCount_ + line.LoseCount_;
+   st.WinRate_ = Decimal<uint32_t, 2>::Make<2>(total ? static_cast<uint32_t>(line.WinCount_ * 10000 / total) : 0u);
+   st.LagAvgNS_ = line.LagNS_.GetAvgNS();
+   st.LagP50NS_ = line.LagNS_.GetPercentileNS(500);
+   st.LagP99NS_ = line.LagNS_.GetPercentileNS(990);
+   st.LagMaxNS_ = line.LagNS_.GetMaxNS();
+   st.IdleTime_ = TimeInterval_Microsecond(static_cast<TimeInterval::OrigType>((now - line.LastRecvNS_) / 1000));
+   st.StallCount_ = line.StallCount_;
+   st.Stalled_ = (line.IsStalled_ ? EnabledYN::Yes : EnabledYN{});
+   return true;
+}
+
+} // namespaces
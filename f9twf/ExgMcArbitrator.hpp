@@ -0,0 +1,128 @@
+﻿// \file f9twf/ExgMcArbitrator.hpp
+// \author fonwinz@gmail.com
+#ifndef __f9twf_ExgMcArbitrator_hpp__
+#define __f9twf_ExgMcArbitrator_hpp__
+#include "f9twf/Config.h"
+#include "fon9/io/Device.hpp"
+#include "fon9/LatencyHistogram.hpp"
+#include "fon9/ConfigUtils.hpp"
+#include "fon9/TimeInterval.hpp"
+#include "fon9/Timer.hpp"
+fon9_BEFORE_INCLUDE_STD;
+#include <mutex>
+#include <vector>
+fon9_AFTER_INCLUDE_STD;
+
+namespace f9twf {
+
+/// 同一個 Channel 同時訂閱期交所的 A/B 兩條線路.
+enum : unsigned {
+   kExgMcArbLineCount = 2,
+   /// 沒有指定線路, 不經過 ExgMcArbitrator.
+   kExgMcArbLineNone = kExgMcArbLineCount,
+};
+inline char ExgMcArbLineName(unsigned lineIdx) {
+   return static_cast<char>('A' + lineIdx);
+}
+
+/// 一條線路的統計快照, 提供給 seed tree 顯示.
+struct ExgMcArbLineSt {
+   /// 此線路收到的封包數量(含重複、Hb).
+   uint64_t          PkCount_;
+   /// 此線路搶先收到的序號數量.
+   uint64_t          WinCount_;
+   /// 此線路落後(其他線路已先收到)的序號數量.
+   uint64_t          LoseCount_;
+   /// WinCount_ / (WinCount_ + LoseCount_);
+   fon9::Decimal<uint32_t, 2> WinRate_;
+   /// 此線路落後時, 與搶先線路的時間差.
+   uint64_t          LagAvgNS_;
+   uint64_t          LagP50NS_;
+   uint64_t          LagP99NS_;
+   uint64_t          LagMaxNS_;
+   /// 距離最後一次收到封包的時間.
+   fon9::TimeInterval IdleTime_;
+   uint32_t          StallCount_;
+   fon9::EnabledYN   Stalled_;
+   char              Padding____[3];
+};
+
+/// 台灣期交所逐筆行情: 單一 Channel 的 A/B 線路仲裁.
+/// - 每個序號, 只採用最先到達的封包, 其餘線路的相同序號直接拋棄:
+///   - 只記錄 [序號, 到達時間, 線路], 不複製封包內容.
+///   - 超過 kWindowSize 的舊序號, 無法判斷是否重複, 交給 PkContFeeder 處理(視為重複拋棄).
+/// - 統計: 每條線路的勝率, 落後時與搶先線路的時間差.
+/// - 線路停滯: 收到第一個封包後, 啟動 timer 每 StallInterval/2 檢查一次:
+///   若某條線路已超過 StallInterval 沒有封包, 但其他線路仍持續收到封包,
+///   則將該線路視為停滯(Stalled): 記錄 log, 並(在解鎖後)重新開啟該線路的 Device.
+///   該線路恢復收到封包後, 解除停滯.
+///   全部線路都沒有封包時(例: 尚未開盤), 不視為停滯.
+class f9twf_API ExgMcArbitrator {
+   fon9_NON_COPY_NON_MOVE(ExgMcArbitrator);
+public:
+   enum : size_t {
+      kWindowSize = 4096,
+   };
+
+   ExgMcArbitrator() = default;
+   ~ExgMcArbitrator();
+
+   /// 重設序號(例: 換日, I002.SeqReset), 保留統計資料.
+   void ResetSeq();
+   /// 清除統計資料.
+   void ClearSt();
+
+   /// lineIdx 收到序號為 seq 的封包.
+   /// \retval true  第一次收到此序號, 呼叫端應繼續處理此封包.
+   /// \retval false 其他線路已先收到此序號, 呼叫端應拋棄此封包.
+   bool OnSeqReceived(unsigned lineIdx, uint64_t seq);
+   /// lineIdx 收到與序號無關的封包(例: Hb, 快照更新): 僅用於判斷線路是否停滯.
+   void OnLineAlive(unsigned lineIdx);
+
+   /// 線路連線成功時設定 dev, 斷線時設定 nullptr; 線路停滯時, 透過 dev 重新開啟.
+   void SetLineDevice(unsigned lineIdx, fon9::io::Device* dev);
+   /// ti == 0: 不檢查線路停滯.
+   void SetStallInterval(fon9::TimeInterval ti) {
+      this->StallIntervalNS_ = static_cast<uint64_t>(ti.ShiftUnit<9>());
+   }
+   /// 若此線路沒有收過封包, 則傳回 false;
+   bool GetLineSt(unsigned lineIdx, ExgMcArbLineSt& st) const;
+   /// 檢查線路是否停滯, 由 timer 定時呼叫.
+   void CheckStalled(uint64_t now);
+
+   /// 記錄 log 時使用的名稱, 例: "TwfMd_MdDay.01";
+   std::string Name_;
+
+private:
+   struct Slot {
+      uint64_t Seq_;
+      uint64_t FirstNS_;
+   };
+   struct Line {
+      uint64_t                PkCount_{0};
+      uint64_t                WinCount_{0};
+      uint64_t                LoseCount_{0};
+      uint64_t                LastRecvNS_{0};
+      uint32_t                StallCount_{0};
+      bool                    IsStalled_{false};
+      char                    Padding____[3];
+      fon9::io::DeviceSP      Device_;
+      fon9::LatencyHistogram  LagNS_;
+   };
+   mutable std::mutex   Mutex_;
+   /// 第一次使用時才配置.
+   std::vector<Slot>    Window_;
+   uint64_t             StallIntervalNS_{3000000000};
+   Line                 Lines_[kExgMcArbLineCount];
+   bool                 IsTimerStarted_{false};
+   char                 Padding____[7];
+
+   /// 呼叫前必須已鎖定 Mutex_;
+   void OnLineReceived(unsigned lineIdx, uint64_t now);
+   void StartStallTimer();
+   static void EmitOnTimer(fon9::TimerEntry* timer, fon9::TimeStamp now);
+   fon9::DataMemberEmitOnTimer<&ExgMcArbitrator::EmitOnTimer> Timer_;
+};
+
+} // namespaces
+#endif//__f9twf_ExgMcArbitrator_hpp__
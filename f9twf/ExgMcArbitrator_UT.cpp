@@ -0,0 +1,115 @@
+﻿// \file f9twf/ExgMcArbitrator_UT.cpp
+// \author fonwinz@gmail.com
+#include "f9twf/ExgMcArbitrator.hpp"
+#include "fon9/TestTools.hpp"
+fon9_BEFORE_INCLUDE_STD;
+#include <thread>
+fon9_AFTER_INCLUDE_STD;
+
+using namespace f9twf;
+static const unsigned kLineA = 0;
+static const unsigned kLineB = 1;
+
+static void CheckResult(const char* msg, bool isOK) {
+   if (isOK)
+      return;
+   std::cout << "|err=" << msg << "\r[ERROR]" << std::endl;
+   abort();
+}
+static ExgMcArbLineSt GetLineSt(const ExgMcArbitrator& arb, unsigned lineIdx) {
+   ExgMcArbLineSt st;
+   CheckResult("GetLineSt", arb.GetLineSt(lineIdx, st));
+   return st;
+}
+
+void TestDedup() {
+   std::cout << "[TEST ] Dedup";
+   ExgMcArbitrator arb;
+   CheckResult("A.1 first", arb.OnSeqReceived(kLineA, 1));
+   CheckResult("B.1 dup", !arb.OnSeqReceived(kLineB, 1));
+   CheckResult("B.2 first", arb.OnSeqReceived(kLineB, 2));
+   CheckResult("A.2 dup", !arb.OnSeqReceived(kLineA, 2));
+   CheckResult("A.2 dup again", !arb.OnSeqReceived(kLineA, 2));
+   const ExgMcArbLineSt stA = GetLineSt(arb, kLineA);
+   const ExgMcArbLineSt stB = GetLineSt(arb, kLineB);
+   CheckResult("A.PkCount", stA.PkCount_ == 3);
+   CheckResult("A.Win/Lose", stA.WinCount_ == 1 && stA.LoseCount_ == 2);
+   CheckResult("B.Win/Lose", stB.WinCount_ == 1 && stB.LoseCount_ == 1);
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+void TestWindowWrap() {
+   std::cout << "[TEST ] Window wrap";
+   ExgMcArbitrator arb;
+   const uint64_t kSeq = 3;
+   CheckResult("A.seq first", arb.OnSeqReceived(kLineA, kSeq));
+   // 相同 slot 的新序號: 取代舊序號.
+   CheckResult("B.seq+window first", arb.OnSeqReceived(kLineB, kSeq + ExgMcArbitrator::kWindowSize));
+   CheckResult("A.seq+window dup", !arb.OnSeqReceived(kLineA, kSeq + ExgMcArbitrator::kWindowSize));
+   // 超過 kWindowSize 的舊序號, 無法判斷是否重複, 交給 PkContFeeder 處理.
+   CheckResult("B.seq out of window", arb.OnSeqReceived(kLineB, kSeq));
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+void TestResetSeq() {
+   std::cout << "[TEST ] ResetSeq";
+   ExgMcArbitrator arb;
+   CheckResult("A.10 first", arb.OnSeqReceived(kLineA, 10));
+   CheckResult("B.10 dup", !arb.OnSeqReceived(kLineB, 10));
+   arb.ResetSeq();
+   CheckResult("B.10 after ResetSeq", arb.OnSeqReceived(kLineB, 10));
+   CheckResult("A.10 dup after ResetSeq", !arb.OnSeqReceived(kLineA, 10));
+   // ResetSeq() 保留統計資料.
+   CheckResult("A.Win after ResetSeq", GetLineSt(arb, kLineA).WinCount_ == 1);
+   arb.ClearSt();
+   CheckResult("A.Win after ClearSt", GetLineSt(arb, kLineA).WinCount_ == 0);
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+/// 只有 lineIdx 持續收到封包 dur 時間.
+static uint64_t FeedLine(ExgMcArbitrator& arb, unsigned lineIdx, uint64_t seq, std::chrono::milliseconds dur) {
+   const auto endTime = std::chrono::steady_clock::now() + dur;
+   while (std::chrono::steady_clock::now() < endTime) {
+      CheckResult("failover: seq accepted", arb.OnSeqReceived(lineIdx, ++seq));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+   return seq;
+}
+void TestStall() {
+   std::cout << "[TEST ] Stall and failover";
+   ExgMcArbitrator arb;
+   arb.Name_ = "UT";
+   arb.SetStallInterval(fon9::TimeInterval_Millisecond(50));
+   uint64_t seq = 0;
+   for (unsigned L = 0; L < 20; ++L) {
+      ++seq;
+      CheckResult("A first", arb.OnSeqReceived(kLineA, seq));
+      CheckResult("B dup", !arb.OnSeqReceived(kLineB, seq));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+   }
+   CheckResult("B not stalled", GetLineSt(arb, kLineB).Stalled_ != fon9::EnabledYN::Yes);
+   // B 停滯: 只有 A 收到封包, 由 timer 判斷 B 停滯(B 不會再收到任何封包).
+   seq = FeedLine(arb, kLineA, seq, std::chrono::milliseconds(200));
+   ExgMcArbLineSt stB = GetLineSt(arb, kLineB);
+   CheckResult("B stalled", stB.Stalled_ == fon9::EnabledYN::Yes && stB.StallCount_ == 1);
+   CheckResult("A not stalled", GetLineSt(arb, kLineA).Stalled_ != fon9::EnabledYN::Yes);
+   // B 恢復.
+   CheckResult("B recovered: first", arb.OnSeqReceived(kLineB, ++seq));
+   CheckResult("B recovered", GetLineSt(arb, kLineB).Stalled_ != fon9::EnabledYN::Yes);
+   // 全部線路都沒有封包: 不視為停滯.
+   std::this_thread::sleep_for(std::chrono::milliseconds(200));
+   CheckResult("All idle: A not stalled", GetLineSt(arb, kLineA).Stalled_ != fon9::EnabledYN::Yes);
+   stB = GetLineSt(arb, kLineB);
+   CheckResult("All idle: B not stalled", stB.Stalled_ != fon9::EnabledYN::Yes && stB.StallCount_ == 1);
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+   (void)argc; (void)argv;
+   fon9::AutoPrintTestInfo utinfo{"ExgMcArbitrator"};
+   fon9::GetDefaultTimerThread();
+   TestDedup();
+   TestWindowWrap();
+   TestResetSeq();
+   TestStall();
+}
@@ -27,6 +27,8 @@ void ExgMcChannel::StartupChannel(std::string logPath) {
    this->Pk1stSeq_ = 0;
    this->ReceivedCountInHb_ = 0;
    this->Clear();
+   this->Arbitrator_.ResetSeq();
+   this->Arbitrator_.ClearSt();
    this->PkLog_.reset();
    if (IsEnumContainsAny(this->Style_, ExgMcChannelStyle::PkLog | ExgMcChannelStyle::Reload)) {
       fon9::NumOutBuf nbuf;
@@ -185,18 +187,9 @@ void ExgMcChannel::OnRecoverErr(SeqT beginSeqNo, unsigned recoverNum, ExgMrStatu
       this->ResetBiggerNextSeq(endSeq);
       return;
    }
-   auto i = pks->begin();
-   while(i->Seq_ <= endSeq) {
-      this->LostCount_ += (i->Seq_ - this->NextSeq_);
-      do {
-         this->CallOnReceived(i->data(), static_cast<unsigned>(i->size()), i->Seq_);
-         if (++i == pks->end()) {
-            pks->clear();
-            return;
-         }
-      } while (this->NextSeq_ == i->Seq_);
-   }
-   pks->erase(pks->begin(), i);
+   this->PopPendings(*pks, endSeq);
+   if (pks->empty())
+      return;
    this->ResetBiggerNextSeq(endSeq);
    pks.unlock();
    this->StartPkContTimer();
@@ -213,6 +206,7 @@ void ExgMcChannel::OnRecoverEnd(ExgMrRecoverSession* svr) {
       this->StartPkContTimer();
 }
 void ExgMcChannel::PkContOnTimer(PkPendings::Locker&& pks) {
+   pks->DropBefore(this->NextSeq_);
    const auto keeps = pks->size();
    if (keeps == 0)
       return;
@@ -222,8 +216,10 @@ void ExgMcChannel::PkContOnTimer(PkPendings::Locker&& pks) {
    // 必須等上次要求完成, 才能送出下一個要求.
    constexpr uint32_t kMaxRequestCount = std::numeric_limits<uint32_t>::max();//1000;
 
-   const bool  isKeepsNoGap = (keeps == 1 || (pks->back().Seq_ - pks->begin()->Seq_ + 1 == keeps));
-   const SeqT  lostCount = (isKeepsNoGap ? pks->begin()->Seq_ : pks->back().Seq_) - this->NextSeq_;
+   const SeqT  frontSeq = pks->FrontSeq();
+   const SeqT  backSeq = pks->BackSeq();
+   const bool  isKeepsNoGap = (keeps == 1 || (backSeq - frontSeq + 1 == keeps));
+   const SeqT  lostCount = (isKeepsNoGap ? frontSeq : backSeq) - this->NextSeq_;
    const ExgMrRecoverNum_t recoverNum = (lostCount > kMaxRecoverNum
                                          ? kMaxRecoverNum
                                          : static_cast<ExgMrRecoverNum_t>(lostCount));
@@ -263,9 +259,9 @@ void ExgMcChannel::PkContOnTimer(PkPendings::Locker&& pks) {
       fon9::RevBufferList rbuf_{fon9::kLogBlockNodeSize};
       fon9::RevPrint(rbuf_, "|keeps=", keeps, '\n');
       if (!isKeepsNoGap)
-         fon9::RevPrint(rbuf_, "|back=", pks->back().Seq_);
+         fon9::RevPrint(rbuf_, "|back=", backSeq);
       fon9::RevPrint(rbuf_, "|channelId=", this->ChannelId_,
-                     "|from=", this->NextSeq_, "|to=", pks->begin()->Seq_ - 1,
+                     "|from=", this->NextSeq_, "|to=", frontSeq - 1,
                      "|lostCount=", lostCount);
       if (svr) {
          fon9::RevPrint(rbuf_, "|dev=", fon9::ToPtr(svr->GetDevice()),
@@ -333,6 +329,7 @@ ExgMcChannelState ExgMcChannel::OnPkSeqReset(const ExgMcHead& pk, unsigned pksz)
    auto pks = this->PkPendings_.Lock();
    pks->clear();
    this->NextSeq_ = 0;
+   this->Arbitrator_.ResetSeq();
    if (!this->IsSetupReloading_) {
       // SeqReset 需要自行觸發 DispatchMcMessage(裡面會觸發 NotifyConsumers).
       ExgMcMessage e(pk, pksz, *this, seq);
@@ -340,6 +337,17 @@ ExgMcChannelState ExgMcChannel::OnPkSeqReset(const ExgMcHead& pk, unsigned pksz)
    }
    return this->State_;
 }
+ExgMcChannelState ExgMcChannel::OnLinePkReceived(unsigned lineIdx, const ExgMcHead& pk, unsigned pksz) {
+   assert(lineIdx < kExgMcArbLineCount);
+   // Hb, SeqReset 的 CHANNEL-SEQ 與一般訊息重疊; 快照更新每輪重新編號:
+   // 這些訊息不進行仲裁, 僅用來判斷線路是否停滯.
+   if ((pk.TransmissionCode_ == '0' && (pk.MessageKind_ == '1' || pk.MessageKind_ == '2'))
+       || this->IsSnapshot())
+      this->Arbitrator_.OnLineAlive(lineIdx);
+   else if (!this->Arbitrator_.OnSeqReceived(lineIdx, pk.GetChannelSeq()))
+      return this->State_;
+   return this->OnPkReceived(pk, pksz);
+}
 // 收到完整封包後, 會執行到此, 尚未確定是否重複或有遺漏.
 ExgMcChannelState ExgMcChannel::OnPkReceived(const ExgMcHead& pk, unsigned pksz) {
    assert(pk.GetChannelId() == this->ChannelId_);
@@ -400,11 +408,15 @@ void ExgMcChannel::PkContOnReceived(const void* pk, unsigned pksz, SeqT seq) {
 void ExgMcChannel::DispatchMcMessage(ExgMcMessage& e) {
    assert(this->PkPendings_.IsLocked());
    assert(e.Pk_.GetChannelId() == this->ChannelId_);
+   // 解析及通知 Consumers, 交給 FanOut_ 的 worker 處理, 請參考 ExgMcFanOut 的說明.
+   if (this->FanOut_ && !this->IsSetupReloading_) {
+      this->FanOut_->Dispatch(*this, e.Pk_, e.PkSize_, e.SeqNo_);
+      return;
+   }
    this->ChannelMgr_->DispatchMcMessage(e);
-   this->NotifyConsumersLocked(e);
+   this->NotifyConsumers(e);
 }
-void ExgMcChannel::NotifyConsumersLocked(ExgMcMessage& e) {
-   assert(this->PkPendings_.IsLocked());
+void ExgMcChannel::NotifyConsumers(ExgMcMessage& e) {
    if (this->IsSetupReloading_)
       return;
    struct Combiner {
@@ -413,7 +425,7 @@ void ExgMcChannel::NotifyConsumersLocked(ExgMcMessage& e) {
          return true;
       }
    } combiner;
-   this->UnsafeConsumers_.Combine(combiner, e);
+   this->Consumers_.Lock()->Combine(combiner, e);
 }
 bool ExgMcChannel::OnPkContSnapshot(const ExgMcHead& pk) {
    assert(this->IsSnapshot());
@@ -534,8 +546,35 @@ ExgMcChannelMgr::ExgMcChannelMgr(ExgMdSymbsSP symbs, fon9::StrView sysName, fon9
    // 快照更新.
    this->Channels_[13].Ctor(this, 13, ExgMcChannelStyle::Snapshot);
    this->Channels_[14].Ctor(this, 14, ExgMcChannelStyle::Snapshot);
+   // A/B 線路仲裁記錄 log 時使用的名稱.
+   for (ExgMrChannelId_t L = 1; L < kChannelCount; ++L) {
+      fon9::NumOutBuf nbuf;
+      std::string&    name = this->Channels_[L].Arbitrator_.Name_;
+      name = this->Name_ + '.';
+      name.append(fon9::ToStrRev(nbuf.end(), L, fon9::FmtDef{2, fon9::FmtFlag::IntPad0}), nbuf.end());
+   }
 }
 ExgMcChannelMgr::~ExgMcChannelMgr() {
+   // FanOut_ 解構時會等候 worker 處理完剩餘的訊息, 此時 Channels_ 仍然有效.
+}
+void ExgMcChannelMgr::StartFanOut(const ExgMcFanOutConfig& cfg) {
+   std::lock_guard<std::mutex> locker{this->FanOutMutex_};
+   if (this->FanOut_ ? (this->FanOut_->GetConfig() == cfg) : (cfg.WorkerCount_ == 0))
+      return;
+   std::unique_ptr<ExgMcFanOut> fanOut{cfg.WorkerCount_ ? new ExgMcFanOut{cfg, &this->Name_} : nullptr};
+   fon9_LOG_INFO(this->Name_, ".StartFanOut|workers=", cfg.WorkerCount_, "|cpus=", cfg.CpuAffinity_.size());
+   for (ExgMcChannel& channel : this->Channels_) {
+      if (!channel.IsRealtime())
+         continue;
+      auto pks = channel.PkPendings_.Lock();
+      // 切換前, 必須等原本的 worker 處理完(包含通知 Consumers), 才能確保訊息順序.
+      // worker 通知 Consumers 時不會用到 PkPendings_, 所以可以在 PkPendings_ locked 狀態下等候.
+      if (channel.FanOut_)
+         channel.FanOut_->WaitDrain();
+      channel.FanOut_ = fanOut.get();
+   }
+   this->FanOut_.swap(fanOut);
+   // 離開時, fanOut(原本的 ExgMcFanOut) 解構: 等候 worker 結束.
 }
 void ExgMcChannelMgr::StartupChannelMgr(std::string logPath) {
    fon9_LOG_INFO(this->Name_, ".StartupChannelMgr|path=", logPath);
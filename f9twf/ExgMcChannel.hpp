@@ -6,6 +6,8 @@
 #include "f9twf/ExgMrRecover.hpp"
 #include "f9twf/ExgMdSymbs.hpp"
 #include "f9twf/ExgMdContracts.hpp"
+#include "f9twf/ExgMcFanOut.hpp"
+#include "f9twf/ExgMcArbitrator.hpp"
 #include "fon9/TsAppend.hpp"
 #include "fon9/Subr.hpp"
 #include "fon9/PkCont.hpp"
@@ -39,6 +41,7 @@ struct ExgMcMessage {
 
 /// 處理 Channel 收到的訊息, 每個 Channel 可以有多個 Consumers;
 /// - 在 ExgMcChannelMgr::DispatchMcMessage() 執行完畢後之後才會呼叫 Consumers.
+///   - 啟用 ExgMcFanOut 時, 由 worker 在解析完畢後呼叫, 但仍依序號順序, 且不會同時進入.
 /// - 不通知 SetupReload 的訊息.
 struct f9twf_API ExgMcMessageConsumer {
    fon9_NON_COPY_NON_MOVE(ExgMcMessageConsumer);
@@ -122,7 +125,13 @@ class f9twf_API ExgMcChannel : private fon9::PkContFeeder {
 
    /// 封包消費者, 例: McToMiConv.
    /// 在通知 Consumer 之前, 應先進行 DispatchMcMessage();
-   fon9::UnsafeSubject<ExgMcMessageConsumer*> UnsafeConsumers_{8};
+   /// 啟用 ExgMcFanOut 時, 由 worker 通知 Consumers, 所以不能使用 PkPendings_ 保護.
+   using Consumers = fon9::MustLock<fon9::UnsafeSubject<ExgMcMessageConsumer*>>;
+   Consumers                                  Consumers_{8};
+   /// 由 ExgMcChannelMgr::StartFanOut() 在 PkPendings_ locked 狀態下設定.
+   ExgMcFanOut*                               FanOut_{nullptr};
+   /// 從 A/B 線路收到的封包, 先經過此處過濾重複.
+   ExgMcArbitrator                            Arbitrator_;
 
    using RecoversImpl = std::deque<ExgMrRecoverSessionSP>;
    using Recovers = fon9::MustLock<RecoversImpl>;
@@ -163,7 +172,6 @@ class f9twf_API ExgMcChannel : private fon9::PkContFeeder {
    fon9::DataMemberEmitOnTimer<&ExgMcChannel::EmitHbTimer> HbTimer_;
 
    void DispatchMcMessage(ExgMcMessage& e);
-   void NotifyConsumersLocked(ExgMcMessage& e);
    void PkContOnReceived(const void* pk, unsigned pksz, SeqT seq) override;
    void PkContOnTimer(PkPendings::Locker&& pks) override;
    void PkLogAppend(const void* pk, unsigned pksz, SeqT seq) {
@@ -197,6 +205,8 @@ public:
 
    /// 若 ExgMcReceiver 連線到 McTunnel, 應該將 Channel.WaitInterval 設為 0;
    using base::SetWaitInterval;
+   /// 預期每秒的封包數量, 用來預先配置「等候中封包」的 Ring; 應在 SetWaitInterval() 之後設定.
+   using base::SetPkPendingsRing;
 
    ExgMcChannelMgr* GetChannelMgr() const {
       return this->ChannelMgr_;
@@ -210,6 +220,9 @@ public:
    bool IsSnapshot() const {
       return this->ChannelId_ == 13 || this->ChannelId_ == 14;
    }
+   ExgMcArbitrator& GetArbitrator() {
+      return this->Arbitrator_;
+   }
    bool IsRealtime() const {
       return this->ChannelId_ == 1 || this->ChannelId_ == 2;
    }
@@ -230,31 +243,26 @@ public:
       return this->State_;
    }
    ExgMcChannelState OnPkReceived(const ExgMcHead& pk, unsigned pksz);
+   /// 從 lineIdx 線路收到封包: 先經過 Arbitrator_ 過濾重複, 第一次收到的序號才進入 OnPkReceived();
+   ExgMcChannelState OnLinePkReceived(unsigned lineIdx, const ExgMcHead& pk, unsigned pksz);
 
    bool IsNeedsNotifyConsumer() const {
-      return (!this->IsSetupReloading_ && !this->UnsafeConsumers_.IsEmpty());
+      return (!this->IsSetupReloading_ && !this->Consumers_.ConstLock()->IsEmpty());
    }
    /// - 在 this->ChannelMgr_->DispatchMcMessage(e); 之後, 將收到的封包轉發給訂閱者(例: McToMiConv).
    /// - 可對於部分手動建立的訊息(例: 收到 I084._O_ 轉成 I083), 透過此處轉發給訂閱者.
-   void NotifyConsumers(ExgMcMessage& e) {
-      auto locker = this->PkPendings_.Lock();
-      this->NotifyConsumersLocked(e);
-   }
+   void NotifyConsumers(ExgMcMessage& e);
    void SubscribeConsumer(fon9::SubConn* conn, ExgMcMessageConsumer& h) {
-      auto locker = this->PkPendings_.Lock();
-      this->UnsafeConsumers_.Subscribe(conn, &h);
+      this->Consumers_.Lock()->Subscribe(conn, &h);
    }
    void SubscribeConsumer(ExgMcMessageConsumer& h) {
-      auto locker = this->PkPendings_.Lock();
-      this->UnsafeConsumers_.Subscribe(&h);
+      this->Consumers_.Lock()->Subscribe(&h);
    }
    void UnsubscribeConsumer(fon9::SubConn* h) {
-      auto locker = this->PkPendings_.Lock();
-      this->UnsafeConsumers_.Unsubscribe(h);
+      this->Consumers_.Lock()->Unsubscribe(h);
    }
    void UnsubscribeConsumer(ExgMcMessageConsumer& h) {
-      auto locker = this->PkPendings_.Lock();
-      this->UnsafeConsumers_.UnsubscribeAll(&h);
+      this->Consumers_.Lock()->UnsubscribeAll(&h);
    }
 
    void AddRecover(ExgMrRecoverSessionSP);
@@ -290,6 +298,17 @@ public:
    /// 在系統啟動時, 換日時... 會重新啟動 ChannelMgr;
    void StartupChannelMgr(std::string logPath);
 
+   /// 即時行情(Channel 1,2)使用 cfg.WorkerCount_ 個 threads 解析, 請參考 ExgMcFanOut 的說明.
+   /// - 由 ExgMcReceiverFactory 依照設定(FanOut=N|FanOutCpus=c1,c2...)呼叫.
+   /// - cfg.WorkerCount_ == 0: 停止使用 ExgMcFanOut, 回到在接收端直接處理.
+   /// - 若 cfg 與目前相同, 則不做任何事.
+   /// - 若已有 ExgMcFanOut, 則會等候原本的 worker 處理完畢後, 再切換.
+   /// - 切換後, 原本 GetFanOut() 取得的指標就失效了, 所以 GetFanOut() 的使用者不可保留該指標.
+   void StartFanOut(const ExgMcFanOutConfig& cfg);
+   ExgMcFanOut* GetFanOut() const {
+      return this->FanOut_.get();
+   }
+
    enum {
       kChannelCount = 20
    };
@@ -323,6 +342,12 @@ public:
          return channel->OnPkReceived(pk, pksz);
       return ExgMcChannelState::Running;
    }
+   /// 從 A/B 線路收到的封包, 請參考 ExgMcArbitrator;
+   ExgMcChannelState OnLinePkReceived(unsigned lineIdx, const ExgMcHead& pk, unsigned pksz) {
+      if (auto* channel = this->GetChannel(pk.GetChannelId()))
+         return channel->OnLinePkReceived(lineIdx, pk, pksz);
+      return ExgMcChannelState::Running;
+   }
 
    /// channel 已收完一次輪播, 檢查是否允許進入下一階段, 例:
    /// - 基本資料.
@@ -339,6 +364,9 @@ private:
    using McDispatcher = ExgMdMessageDispatcher<FnMcMessageParser>;
    McDispatcher   McDispatcher_;
    ExgMcChannel   Channels_[kChannelCount];
+   /// 避免多個 ExgMcReceiver 同時呼叫 StartFanOut();
+   std::mutex                    FanOutMutex_;
+   std::unique_ptr<ExgMcFanOut>  FanOut_;
 };
 
 } // namespaces
@@ -0,0 +1,109 @@
+﻿// \file f9twf/ExgMcChannelTree.cpp
+// \author fonwinz@gmail.com
+#include "f9twf/ExgMcChannelTree.hpp"
+#include "fon9/seed/FieldMaker.hpp"
+#include "fon9/seed/TreeOp.hpp"
+#include "fon9/seed/PodOp.hpp"
+
+namespace f9twf {
+using namespace fon9;
+using namespace fon9::seed;
+
+static const size_t kRowCount = ExgMcChannelMgr::kChannelCount * kExgMcArbLineCount;
+
+static void RevPrintRowKey(RevBuffer& rbuf, size_t idx) {
+   RevPrint(rbuf, ExgMcArbLineName(static_cast<unsigned>(idx % kExgMcArbLineCount)));
+   RevPrint(rbuf, idx / kExgMcArbLineCount, FmtDef{2, FmtFlag::IntPad0});
+}
+/// "01A" => 1 * kExgMcArbLineCount + 0;
+/// \retval false key 格式有誤.
+static bool ParseRowKey(StrView key, size_t& idx) {
+   if (IsTextBegin(key)) {
+      idx = 0;
+      return true;
+   }
+   if (IsTextEnd(key)) {
+      idx = kRowCount;
+      return true;
+   }
+   if (key.size() != 3)
+      return false;
+   const unsigned lineIdx = static_cast<unsigned>(key.end()[-1] - 'A');
+   const size_t   channelId = StrTo(StrView{key.begin(), 2}, 0u);
+   if (lineIdx >= kExgMcArbLineCount || channelId >= ExgMcChannelMgr::kChannelCount)
+      return false;
+   idx = channelId * kExgMcArbLineCount + lineIdx;
+   return true;
+}
+
+struct ExgMcChannelTree::TreeOp : public seed::TreeOp {
+   fon9_NON_COPY_NON_MOVE(TreeOp);
+   using base = seed::TreeOp;
+   TreeOp(ExgMcChannelTree& tree) : base(tree) {
+   }
+   static bool GetLineSt(ExgMcChannelMgr& mgr, size_t idx, ExgMcArbLineSt& st) {
+      ExgMcChannel* channel = mgr.GetChannel(static_cast<ExgMrChannelId_t>(idx / kExgMcArbLineCount));
+      return channel && channel->GetArbitrator().GetLineSt(static_cast<unsigned>(idx % kExgMcArbLineCount), st);
+   }
+   void GridView(const GridViewRequest& req, FnGridViewOp fnCallback) override {
+      GridViewResult res{this->Tree_, req.Tab_};
+      size_t         istart;
+      if (ParseRowKey(req.OrigKey_, istart)) {
+         ExgMcChannelMgr& mgr = *static_cast<ExgMcChannelTree*>(&this->Tree_)->ChannelMgr_;
+         MakeGridViewArrayRange(istart, kRowCount, req, res,
+                                [&mgr](size_t idx, Tab* tab, RevBuffer& rbuf) {
+            ExgMcArbLineSt st;
+            if (!GetLineSt(mgr, idx, st))
+               return false;
+            if (tab)
+               FieldsCellRevPrint(tab->Fields_, SimpleRawRd{st}, rbuf, GridViewResult::kCellSplitter);
+            RevPrintRowKey(rbuf, idx);
+            return true;
+         });
+      }
+      else
+         res.OpResult_ = OpResult::key_format_error;
+      fnCallback(res);
+   }
+   void Get(StrView strKeyText, FnPodOp fnCallback) override {
+      size_t         idx;
+      ExgMcArbLineSt st;
+      if (!ParseRowKey(strKeyText, idx) || idx >= kRowCount)
+         fnCallback(PodOpResult{this->Tree_, OpResult::key_format_error, strKeyText}, nullptr);
+      else if (!GetLineSt(*static_cast<ExgMcChannelTree*>(&this->Tree_)->ChannelMgr_, idx, st))
+         fnCallback(PodOpResult{this->Tree_, OpResult::not_found_key, strKeyText}, nullptr);
+      else {
+         PodOpReadonly<ExgMcArbLineSt> op{st, this->Tree_, strKeyText};
+         fnCallback(op, &op);
+      }
+   }
+};
+//--------------------------------------------------------------------------//
+LayoutSP ExgMcChannelTree::MakeLayout() {
+   Fields flds;
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, PkCount));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, WinCount));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, LoseCount));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, WinRate));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, LagAvgNS));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, LagP50NS));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, LagP99NS));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, LagMaxNS));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, IdleTime));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, StallCount));
+   flds.Add(fon9_MakeField2_const(ExgMcArbLineSt, Stalled));
+   return new Layout1(MakeField(Named{"Line"}, 0, *static_cast<const CharAry<3>*>(nullptr)),
+                      new Tab{Named{"McArb"}, std::move(flds), TabFlag::NoSapling});
+}
+ExgMcChannelTree::ExgMcChannelTree(ExgMcChannelMgrSP channelMgr)
+   : base{MakeLayout()}
+   , ChannelMgr_{std::move(channelMgr)} {
+}
+ExgMcChannelTree::~ExgMcChannelTree() {
+}
+void ExgMcChannelTree::OnTreeOp(FnTreeOp fnCallback) {
+   TreeOp op{*this};
+   fnCallback(TreeOpResult{this, OpResult::no_error}, &op);
+}
+
+} // namespaces
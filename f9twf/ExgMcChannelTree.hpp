@@ -0,0 +1,30 @@
+﻿// \file f9twf/ExgMcChannelTree.hpp
+// \author fonwinz@gmail.com
+#ifndef __f9twf_ExgMcChannelTree_hpp__
+#define __f9twf_ExgMcChannelTree_hpp__
+#include "f9twf/ExgMcChannel.hpp"
+#include "fon9/seed/Tree.hpp"
+
+namespace f9twf {
+
+/// 透過 seed 機制, 查看 ExgMcChannelMgr 各 Channel 的 A/B 線路仲裁狀態(ExgMcArbitrator).
+/// - Key = ChannelId(2碼) + 線路(A or B), 例: "01A", "02B";
+/// - 只列出有收到封包的線路.
+/// - 唯讀: 不支援 Add/Remove/Write;
+class f9twf_API ExgMcChannelTree : public fon9::seed::Tree {
+   fon9_NON_COPY_NON_MOVE(ExgMcChannelTree);
+   using base = fon9::seed::Tree;
+   struct TreeOp;
+   static fon9::seed::LayoutSP MakeLayout();
+
+public:
+   const ExgMcChannelMgrSP ChannelMgr_;
+
+   ExgMcChannelTree(ExgMcChannelMgrSP channelMgr);
+   ~ExgMcChannelTree();
+
+   void OnTreeOp(fon9::seed::FnTreeOp fnCallback) override;
+};
+
+} // namespaces
+#endif//__f9twf_ExgMcChannelTree_hpp__
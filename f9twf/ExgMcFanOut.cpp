@@ -0,0 +1,260 @@
+﻿// \file f9twf/ExgMcFanOut.cpp
+// \author fonwinz@gmail.com
+#include "f9twf/ExgMcFanOut.hpp"
+#include "f9twf/ExgMcChannel.hpp"
+#include "f9twf/ExgMdFmtBS.hpp"
+#include "f9twf/ExgMdFmtMatch.hpp"
+#include "f9twf/ExgMdFmtHL.hpp"
+#include "fon9/MessageQueue.hpp"
+#include "fon9/CountDownLatch.hpp"
+#include "fon9/Tools.hpp"
+#include "fon9/Log.hpp"
+
+namespace f9twf {
+using namespace fon9;
+
+/// 與商品無關的訊息, 必須等全部 worker 都處理到此處, 才能處理.
+/// - 最後到達的 worker: 處理訊息(若有), 然後喚醒其他 worker.
+/// - 每個 worker(及 WaitDrain() 的等候者) 用完後 Release(), 最後一個負責刪除.
+struct ExgMcFanOutFence {
+   fon9_NON_COPY_NON_MOVE(ExgMcFanOutFence);
+   std::atomic<unsigned>   Arriving_;
+   std::atomic<unsigned>   RefCount_;
+   CountDownLatch          Done_{1};
+
+   ExgMcFanOutFence(unsigned workerCount, unsigned refCount)
+      : Arriving_{workerCount}
+      , RefCount_{refCount} {
+   }
+   void Release() {
+      if (--this->RefCount_ == 0)
+         delete this;
+   }
+};
+
+/// 放入 worker 佇列的訊息.
+/// - Fence_ != nullptr: 表示與商品無關的訊息, 或 WaitDrain(); 請參考 ExgMcFanOutFence;
+/// - Channel_ == nullptr: 沒有需要處理的封包(WaitDrain());
+/// - 封包內容放在 ExgMcFanOutBatch::Pks_[PkPos_ .. PkPos_ + PkSize_);
+struct ExgMcFanOutItem {
+   ExgMcChannel*     Channel_;
+   ExgMcFanOutFence* Fence_;
+   uint64_t          Ticket_;
+   uint64_t          SeqNo_;
+   uint64_t          EnqueueNS_;
+   size_t            PkPos_;
+   unsigned          PkSize_;
+   char              Padding____[4];
+};
+/// 為了避免每個封包都要配置一次記憶體, 封包內容集中放在 Pks_;
+/// worker 取出時使用 swap(), 處理完後 clear(), 所以穩定之後就不會再配置記憶體.
+struct ExgMcFanOutBatch {
+   std::vector<ExgMcFanOutItem>  Items_;
+   std::string                   Pks_;
+
+   bool empty() const {
+      return this->Items_.empty();
+   }
+   /// MessageQueue 判斷 OnMessage() 的種類時需要, ExgMcFanOutHandler 不會用到.
+   ExgMcFanOutItem& front() {
+      return this->Items_.front();
+   }
+   void clear() {
+      this->Items_.clear();
+      this->Pks_.clear();
+   }
+   void swap(ExgMcFanOutBatch& rhs) {
+      this->Items_.swap(rhs.Items_);
+      this->Pks_.swap(rhs.Pks_);
+   }
+   void emplace_back(ExgMcChannel* channel, ExgMcFanOutFence* fence, uint64_t ticket,
+                     const ExgMcHead* pk, unsigned pksz, uint64_t seq) {
+      const size_t pos = this->Pks_.size();
+      if (pk)
+         this->Pks_.append(reinterpret_cast<const char*>(pk), pksz);
+      this->Items_.push_back(ExgMcFanOutItem{channel, fence, ticket, seq, LatencyHistogram::NowNS(), pos, pksz, {}});
+   }
+};
+
+/// 解析 pk, 然後等候輪到 ticket 時通知 Consumers.
+static void DispatchFanOutPk(ExgMcFanOut& owner, ExgMcChannel& channel, uint64_t ticket,
+                             const ExgMcHead& pk, unsigned pksz, uint64_t seq) {
+   const uint64_t beginNS = LatencyHistogram::NowNS();
+   ExgMcMessage   e(pk, pksz, channel, seq);
+   channel.GetChannelMgr()->DispatchMcMessage(e);
+   owner.ParseLatency_.AddSince(beginNS);
+   owner.WaitTurn(ticket);
+   channel.NotifyConsumers(e);
+   owner.EndTurn(ticket);
+}
+/// 抵達 fence: 最後到達者處理 pk(若有), 其餘等候最後到達者處理完畢.
+static void ArriveFence(ExgMcFanOut& owner, ExgMcFanOutFence& fence, uint64_t ticket,
+                        ExgMcChannel* channel, const ExgMcHead* pk, unsigned pksz, uint64_t seq) {
+   if (--fence.Arriving_ == 0) {
+      if (channel)
+         DispatchFanOutPk(owner, *channel, ticket, *pk, pksz, seq);
+      else {
+         owner.WaitTurn(ticket);
+         owner.EndTurn(ticket);
+      }
+      fence.Done_.CountDown();
+   }
+   else {
+      const uint64_t beginNS = LatencyHistogram::NowNS();
+      fence.Done_.Wait();
+      owner.FenceLatency_.AddSince(beginNS);
+   }
+   fence.Release();
+}
+
+struct ExgMcFanOutHandler;
+using ExgMcFanOutQueue = MessageQueue<ExgMcFanOutHandler, ExgMcFanOutItem, ExgMcFanOutBatch>;
+
+struct ExgMcFanOut::Worker : public ExgMcFanOutQueue {
+   fon9_NON_COPY_NON_MOVE(Worker);
+   ExgMcFanOut&   Owner_;
+   const unsigned Index_;
+   Worker(ExgMcFanOut& owner, unsigned index) : Owner_(owner), Index_{index} {
+   }
+};
+
+struct ExgMcFanOutHandler {
+   fon9_NON_COPY_NON_MOVE(ExgMcFanOutHandler);
+   using MessageType = ExgMcFanOutItem;
+   ExgMcFanOut&      Owner_;
+   ExgMcFanOutBatch  Consuming_;
+
+   ExgMcFanOutHandler(ExgMcFanOutQueue& queue);
+   void OnMessage(ExgMcFanOutQueue::Locker& queue) {
+      assert(this->Consuming_.empty());
+      this->Consuming_.swap(*queue);
+      queue.unlock();
+      for (const ExgMcFanOutItem& item : this->Consuming_.Items_) {
+         const uint64_t beginNS = LatencyHistogram::NowNS();
+         this->Owner_.QueueLatency_.Add(beginNS > item.EnqueueNS_ ? beginNS - item.EnqueueNS_ : 0);
+         const ExgMcHead* pk = reinterpret_cast<const ExgMcHead*>(this->Consuming_.Pks_.data() + item.PkPos_);
+         if (item.Fence_)
+            ArriveFence(this->Owner_, *item.Fence_, item.Ticket_, item.Channel_, pk, item.PkSize_, item.SeqNo_);
+         else
+            DispatchFanOutPk(this->Owner_, *item.Channel_, item.Ticket_, *pk, item.PkSize_, item.SeqNo_);
+      }
+      this->Consuming_.clear();
+   }
+   void OnThreadEnd(const std::string& thrName) {
+      (void)thrName;
+   }
+};
+ExgMcFanOutHandler::ExgMcFanOutHandler(ExgMcFanOutQueue& queue)
+   : Owner_(static_cast<ExgMcFanOut::Worker&>(queue).Owner_) {
+   // 在 worker thread 建構, 所以可在此設定 cpu affinity.
+   const unsigned index = static_cast<ExgMcFanOut::Worker&>(queue).Index_;
+   const int      cpuAffinity = this->Owner_.Config_.GetCpuAffinity(index);
+   if (cpuAffinity >= 0) {
+      Result3 res = SetCpuAffinity(cpuAffinity);
+      fon9_LOG_INFO("ExgMcFanOut.Worker|index=", index, "|Cpu=", cpuAffinity, ':', res);
+   }
+}
+//--------------------------------------------------------------------------//
+ExgMcFanOut::ExgMcFanOut(const ExgMcFanOutConfig& cfg, StrView thrName) : Config_(cfg) {
+   assert(cfg.WorkerCount_ > 0);
+   this->Workers_.reserve(cfg.WorkerCount_);
+   std::string name = thrName.ToString() + ".FanOut";
+   for (unsigned L = 0; L < cfg.WorkerCount_; ++L) {
+      this->Workers_.emplace_back(new Worker{*this, L});
+      this->Workers_.back()->StartThread(1, &name);
+   }
+}
+ExgMcFanOut::~ExgMcFanOut() {
+   for (WorkerSP& w : this->Workers_)
+      w->WaitForEndAfterWorkDone();
+}
+StrView ExgMcFanOut::GetSymbId(const ExgMcHead& pk) {
+   switch (pk.TransmissionCode_) {
+   case '2': // Fut.
+   case '5': // Opt.
+      switch (pk.MessageKind_) {
+      case 'A': // I081: 委託簿揭示訊息.
+         return StrView_eos_or_all(static_cast<const ExgMcI081*>(&pk)->ProdId_.Chars_, ' ');
+      case 'B': // I083: 委託簿快照訊息.
+         return StrView_eos_or_all(static_cast<const ExgMcI083*>(&pk)->ProdId_.Chars_, ' ');
+      case 'D': // I024: 成交價量揭示訊息.
+         return StrView_eos_or_all(static_cast<const ExgMcI024Head*>(&pk)->ProdId_.Chars_, ' ');
+      case 'E': // I025: 最高價、最低價.
+         return StrView_eos_or_all(static_cast<const ExgMcI025Head*>(&pk)->ProdId_.Chars_, ' ');
+      }
+      break;
+   }
+   return StrView{};
+}
+void ExgMcFanOut::Dispatch(ExgMcChannel& channel, const ExgMcHead& pk, unsigned pksz, uint64_t seq) {
+   const uint64_t beginNS = LatencyHistogram::NowNS();
+   const StrView  symbid = GetSymbId(pk);
+   std::unique_lock<std::mutex> locker{this->DispatchMutex_};
+   const uint64_t ticket = this->NextTicket_++;
+   if (fon9_LIKELY(!symbid.empty())) {
+      const size_t hash = std::hash<StrView>{}(symbid);
+      // worker 已結束(不應發生), 則由接收端代為處理, 避免後續的 ticket 無法通知.
+      if (this->Workers_[hash % this->Workers_.size()]->EmplaceMessage(&channel, nullptr, ticket, &pk, pksz, seq)
+          > ThreadState::ExecutingOrWaiting) {
+         locker.unlock();
+         DispatchFanOutPk(*this, channel, ticket, pk, pksz, seq);
+      }
+   }
+   else {
+      const unsigned    count = static_cast<unsigned>(this->Workers_.size());
+      ExgMcFanOutFence* fence = new ExgMcFanOutFence{count, count};
+      unsigned          endedCount = 0;
+      for (WorkerSP& w : this->Workers_) {
+         if (w->EmplaceMessage(&channel, fence, ticket, &pk, pksz, seq) > ThreadState::ExecutingOrWaiting)
+            ++endedCount;
+      }
+      locker.unlock();
+      // worker 已結束(不應發生), 則由接收端代為抵達 fence.
+      while (endedCount-- > 0)
+         ArriveFence(*this, *fence, ticket, &channel, &pk, pksz, seq);
+   }
+   this->EnqueueLatency_.AddSince(beginNS);
+}
+void ExgMcFanOut::WaitDrain() {
+   const unsigned    count = static_cast<unsigned>(this->Workers_.size());
+   ExgMcFanOutFence* fence = new ExgMcFanOutFence{count, count + 1};
+   unsigned          endedCount = 0;
+   {
+      std::unique_lock<std::mutex> locker{this->DispatchMutex_};
+      const uint64_t ticket = this->NextTicket_++;
+      for (WorkerSP& w : this->Workers_) {
+         if (w->EmplaceMessage(nullptr, fence, ticket, nullptr, 0u, 0u) > ThreadState::ExecutingOrWaiting)
+            ++endedCount;
+      }
+      locker.unlock();
+      while (endedCount-- > 0)
+         ArriveFence(*this, *fence, ticket, nullptr, nullptr, 0, 0);
+   }
+   fence->Done_.Wait();
+   fence->Release();
+}
+void ExgMcFanOut::WaitTurn(uint64_t ticket) {
+   if (fon9_LIKELY(this->NotifyTurn_.load(std::memory_order_acquire) == ticket))
+      return;
+   const uint64_t beginNS = LatencyHistogram::NowNS();
+   while (this->NotifyTurn_.load(std::memory_order_acquire) != ticket)
+      std::this_thread::yield();
+   this->TurnLatency_.AddSince(beginNS);
+}
+void ExgMcFanOut::ClearLatency() {
+   this->EnqueueLatency_.Clear();
+   this->QueueLatency_.Clear();
+   this->ParseLatency_.Clear();
+   this->FenceLatency_.Clear();
+   this->TurnLatency_.Clear();
+}
+void ExgMcFanOut::RevPrintInfo(RevBuffer& rbuf) const {
+   RevPrint(rbuf, "Turn:",    this->TurnLatency_,    '\n');
+   RevPrint(rbuf, "Fence:",   this->FenceLatency_,   '\n');
+   RevPrint(rbuf, "Parse:",   this->ParseLatency_,   '\n');
+   RevPrint(rbuf, "Queue:",   this->QueueLatency_,   '\n');
+   RevPrint(rbuf, "Enqueue:", this->EnqueueLatency_, '\n');
+   RevPrint(rbuf, "workers=", this->Workers_.size(),  '\n');
+}
+
+} // namespaces
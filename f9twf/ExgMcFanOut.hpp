@@ -0,0 +1,115 @@
+﻿// \file f9twf/ExgMcFanOut.hpp
+// \author fonwinz@gmail.com
+#ifndef __f9twf_ExgMcFanOut_hpp__
+#define __f9twf_ExgMcFanOut_hpp__
+#include "f9twf/ExgMdFmt.hpp"
+#include "fon9/LatencyHistogram.hpp"
+fon9_BEFORE_INCLUDE_STD;
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+fon9_AFTER_INCLUDE_STD;
+
+namespace f9twf {
+
+class f9twf_API ExgMcChannel;
+struct ExgMcFanOutHandler;
+
+/// ExgMcChannelMgr::StartFanOut() 的設定.
+struct ExgMcFanOutConfig {
+   /// worker thread 的數量, 0 表示不使用 ExgMcFanOut.
+   unsigned WorkerCount_{0};
+   /// 第 i 個 worker 綁定 CpuAffinity_[i % CpuAffinity_.size()]; empty() 表示不綁定.
+   std::vector<uint32_t> CpuAffinity_;
+
+   int GetCpuAffinity(unsigned workerIndex) const {
+      if (this->CpuAffinity_.empty())
+         return -1;
+      return static_cast<int>(this->CpuAffinity_[workerIndex % this->CpuAffinity_.size()]);
+   }
+   bool operator==(const ExgMcFanOutConfig& rhs) const {
+      return this->WorkerCount_ == rhs.WorkerCount_ && this->CpuAffinity_ == rhs.CpuAffinity_;
+   }
+   bool operator!=(const ExgMcFanOutConfig& rhs) const {
+      return !(*this == rhs);
+   }
+};
+
+/// 台灣期交所逐筆行情: 使用多個 worker thread 處理 Channel 訊息的解析.
+/// - 序號連續、過濾重複、回補: 仍由 ExgMcChannel 在接收端(單一 thread)依序號處理.
+/// - 確定連續後, 放入 worker 佇列時依序取得一個 ticket(同一個 ExgMcFanOut 的全部 Channel 共用).
+/// - 與單一商品有關的訊息(I081, I083, I024, I025):
+///   複製一份, 依商品代號的 hash 放入 worker 的佇列, 由 worker 執行 ExgMcChannelMgr::DispatchMcMessage();
+///   - 同一商品必定由同一個 worker 處理, 所以同一商品的訊息順序不變.
+///   - 不同商品的訊息, 可能同時解析.
+/// - 與商品無關的訊息(例: Hb, SeqReset): 放入全部 worker 的佇列(fence), 接收端不用等候;
+///   每個 worker 處理到 fence 時暫停, 由最後到達的 worker 執行 DispatchMcMessage(), 然後全部 worker 繼續.
+///   所以與商品無關的訊息, 與前後的商品訊息之間, 仍維持序號順序.
+/// - 解析完畢後, 等候輪到該 ticket, 才通知 Channel 的 Consumers(此時 e.Symb_ 已由 Parser 設定),
+///   所以 Consumers 仍依序號順序收到訊息, 且收到時商品狀態就是解析完該訊息的狀態.
+///   - 每個 worker 的佇列都依 ticket 排序, 所以最小的 ticket 必定在某個 worker 的佇列前端, 不會互相等候.
+/// - Parser 仍會使用 ExgMdSymbs 的 SymbMap_.Lock(), 所以能並行的部分是: 解析以外的排隊、複製...
+///   若 Parser 使用更細的鎖, 則可得到更好的擴展性.
+class f9twf_API ExgMcFanOut {
+   fon9_NON_COPY_NON_MOVE(ExgMcFanOut);
+   friend struct ExgMcFanOutHandler;
+   struct Worker;
+   using WorkerSP = std::unique_ptr<Worker>;
+   std::vector<WorkerSP>   Workers_;
+   const ExgMcFanOutConfig Config_;
+   /// 取得 ticket 並放入 worker 佇列時鎖定, 確保每個 worker 佇列裡的 ticket 都是遞增的.
+   std::mutex              DispatchMutex_;
+   uint64_t                NextTicket_{0};
+   /// 輪到哪個 ticket 可以通知 Consumers.
+   std::atomic<uint64_t>   NotifyTurn_{0};
+
+public:
+   /// 建構時立即啟動 cfg.WorkerCount_ 個 threads, cfg.WorkerCount_ 必須 > 0;
+   ExgMcFanOut(const ExgMcFanOutConfig& cfg, fon9::StrView thrName);
+   /// 等候 worker 處理完剩餘的訊息後結束.
+   ~ExgMcFanOut();
+
+   unsigned GetWorkerCount() const {
+      return static_cast<unsigned>(this->Workers_.size());
+   }
+   const ExgMcFanOutConfig& GetConfig() const {
+      return this->Config_;
+   }
+
+   /// 取得與 pk 有關的商品代號, 若與單一商品無關, 則傳回 empty();
+   static fon9::StrView GetSymbId(const ExgMcHead& pk);
+
+   /// 由 ExgMcChannel 在 PkPendings_ locked 狀態下呼叫, 所以同一個 Channel 不會同時進入.
+   /// 複製 pk 放入 worker 的佇列後立即返回, 不會等候 worker.
+   /// worker 解析後, 會透過 channel.NotifyConsumers() 通知 Consumers.
+   void Dispatch(ExgMcChannel& channel, const ExgMcHead& pk, unsigned pksz, uint64_t seq);
+   /// 等候全部 worker 處理完目前佇列裡的訊息(包含通知 Consumers).
+   /// 僅在切換 ExgMcFanOut 時使用, 不在每個封包的處理流程之中.
+   void WaitDrain();
+
+   /// worker: 解析完畢後, 等候輪到 ticket; 返回後才可通知 Consumers.
+   void WaitTurn(uint64_t ticket);
+   /// worker: 通知 Consumers 之後呼叫, 讓下一個 ticket 可以通知.
+   void EndTurn(uint64_t ticket) {
+      this->NotifyTurn_.store(ticket + 1, std::memory_order_release);
+   }
+
+   /// 接收端: 複製 pk 並放入佇列的時間.
+   fon9::LatencyHistogram  EnqueueLatency_;
+   /// 放入佇列 => worker 開始處理.
+   fon9::LatencyHistogram  QueueLatency_;
+   /// worker: DispatchMcMessage() 的時間: 解析、更新商品、MdRtStream::Publish()...
+   fon9::LatencyHistogram  ParseLatency_;
+   /// worker: 在 fence(與商品無關的訊息) 等候其他 worker 的時間.
+   fon9::LatencyHistogram  FenceLatency_;
+   /// worker: 解析完畢 => 輪到此 ticket 通知 Consumers 的等候時間.
+   fon9::LatencyHistogram  TurnLatency_;
+
+   void ClearLatency();
+   /// 輸出各階段的延遲統計, 每個階段一行.
+   void RevPrintInfo(fon9::RevBuffer& rbuf) const;
+};
+
+} // namespaces
+#endif//__f9twf_ExgMcFanOut_hpp__
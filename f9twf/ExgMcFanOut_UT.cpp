@@ -0,0 +1,150 @@
+﻿// \file f9twf/ExgMcFanOut_UT.cpp
+// \author fonwinz@gmail.com
+#include "f9twf/ExgMcChannel.hpp"
+#include "f9twf/ExgMdFmtBS.hpp"
+#include "fon9/TestTools.hpp"
+#include "fon9/LatencyHistogram.hpp"
+fon9_BEFORE_INCLUDE_STD;
+#include <thread>
+fon9_AFTER_INCLUDE_STD;
+
+using namespace f9twf;
+
+static const unsigned kSymbCount = 16;
+static const uint64_t kPkCount = 20000;
+static const uint64_t kHbInterval = 100;
+/// 每個商品最後解析的序號, 用來確認: Consumer 收到時, 商品狀態就是解析完該訊息的狀態.
+static std::atomic<uint64_t> ParsedSeq_[3][kSymbCount];
+
+static unsigned GetSymbIndex(const ExgMcI081& pk) {
+   return static_cast<unsigned>((pk.ProdId_.Chars_[2] - '0') * 10 + (pk.ProdId_.Chars_[3] - '0'));
+}
+/// 模擬 I081 的解析: 設定 e.Symb_; 第 0 個商品解析較慢, 讓其他 worker 可以超前.
+static void TestI081Parser(ExgMcMessage& e) {
+   const ExgMcI081& pk = *static_cast<const ExgMcI081*>(&e.Pk_);
+   const unsigned   idx = GetSymbIndex(pk);
+   if (idx == 0) {
+      const uint64_t beginNS = fon9::LatencyHistogram::NowNS();
+      while (fon9::LatencyHistogram::NowNS() - beginNS < 20000) {
+      }
+   }
+   auto symbs = e.Channel_.GetChannelMgr()->Symbs_;
+   e.Symb_ = static_cast<ExgMdSymb*>(symbs->FetchSymb(fon9::StrView_eos_or_all(pk.ProdId_.Chars_, ' ')).get());
+   ParsedSeq_[e.Channel_.GetChannelId()][idx] = e.SeqNo_;
+}
+
+struct TestConsumer : public ExgMcMessageConsumer {
+   fon9_NON_COPY_NON_MOVE(TestConsumer);
+   TestConsumer() = default;
+   /// (MessageKind_, SeqNo_)
+   std::vector<std::pair<char, uint64_t>> Received_;
+   unsigned ErrCount_{0};
+
+   void OnExgMcMessage(const ExgMcMessage& e) override {
+      this->Received_.emplace_back(e.Pk_.MessageKind_, e.SeqNo_);
+      if (e.Pk_.MessageKind_ != 'A')
+         return;
+      if (e.Symb_ == nullptr
+          || ParsedSeq_[e.Channel_.GetChannelId()][GetSymbIndex(*static_cast<const ExgMcI081*>(&e.Pk_))] != e.SeqNo_)
+         ++this->ErrCount_;
+   }
+   void Check(const char* msg) {
+      std::cout << "[TEST ] " << msg;
+      if (this->ErrCount_ != 0) {
+         std::cout << "|err=Symb not parsed|count=" << this->ErrCount_ << "\r[ERROR]" << std::endl;
+         abort();
+      }
+      size_t idx = 0;
+      for (uint64_t seq = 1; seq <= kPkCount; ++seq) {
+         if (idx >= this->Received_.size() || this->Received_[idx] != std::make_pair('A', seq))
+            goto __ERROR;
+         ++idx;
+         if (seq % kHbInterval == 0) {
+            if (idx >= this->Received_.size() || this->Received_[idx] != std::make_pair('1', seq))
+               goto __ERROR;
+            ++idx;
+         }
+      }
+      if (idx != this->Received_.size()) {
+      __ERROR:;
+         std::cout << "|err=Unexpected order|index=" << idx;
+         if (idx < this->Received_.size())
+            std::cout << "|kind=" << this->Received_[idx].first << "|seq=" << this->Received_[idx].second;
+         std::cout << "\r[ERROR]" << std::endl;
+         abort();
+      }
+      std::cout << "|count=" << this->Received_.size() << "\r[OK   ]" << std::endl;
+      this->Received_.clear();
+   }
+};
+
+/// 依序送出 I081(seq=1..kPkCount), 每 kHbInterval 筆之後送出一筆 Hb;
+/// 若 fanOutWorkers != 0, 則在送到一半時切換成使用 fanOutWorkers 個 worker.
+static void FeedChannel(ExgMcChannelMgr& mgr, uint16_t channelId, unsigned fanOutWorkers) {
+   char           pkbuf[sizeof(ExgMcI081) + sizeof(ExgMdTail)];
+   ExgMcI081&     pk = *reinterpret_cast<ExgMcI081*>(pkbuf);
+   ExgMcNoBody    hb;
+   memset(pkbuf, 0, sizeof(pkbuf));
+   memset(&hb, 0, sizeof(hb));
+   pk.TransmissionCode_ = '2';
+   pk.MessageKind_ = 'A';
+   fon9::ToPackBcd(pk.VersionNo_, 1u);
+   fon9::ToPackBcd(pk.ChannelId_, channelId);
+   memset(pk.ProdId_.Chars_, ' ', sizeof(pk.ProdId_.Chars_));
+   pk.ProdId_.Chars_[0] = 'T';
+   pk.ProdId_.Chars_[1] = 'X';
+   hb.TransmissionCode_ = '0';
+   hb.MessageKind_ = '1';
+   fon9::ToPackBcd(hb.VersionNo_, 1u);
+   fon9::ToPackBcd(hb.ChannelId_, channelId);
+   for (uint64_t seq = 1; seq <= kPkCount; ++seq) {
+      if (fanOutWorkers && seq == kPkCount / 2) {
+         ExgMcFanOutConfig cfg;
+         cfg.WorkerCount_ = fanOutWorkers;
+         mgr.StartFanOut(cfg);
+      }
+      const unsigned idx = static_cast<unsigned>(seq % kSymbCount);
+      pk.ProdId_.Chars_[2] = static_cast<char>('0' + idx / 10);
+      pk.ProdId_.Chars_[3] = static_cast<char>('0' + idx % 10);
+      fon9::ToPackBcd(pk.ChannelSeq_, seq);
+      mgr.OnPkReceived(pk, sizeof(pkbuf));
+      if (seq % kHbInterval == 0) {
+         fon9::ToPackBcd(hb.ChannelSeq_, seq);
+         mgr.OnPkReceived(hb, sizeof(hb));
+      }
+   }
+}
+
+void TestFanOut(unsigned workers, unsigned switchTo) {
+   std::cout << "[INFO ] FanOut|workers=" << workers << "|switchTo=" << switchTo << std::endl;
+   ExgMdSymbsSP      symbs{new ExgMdSymbs{std::string{}}};
+   fon9::intrusive_ptr<ExgMcChannelMgr> mgr{new ExgMcChannelMgr(symbs, "UT", "FanOut", f9fmkt_TradingSessionId_Normal)};
+   mgr->RegMcMessageParser('2', 'A', 1, &TestI081Parser);
+   TestConsumer consumer1, consumer2;
+   mgr->GetChannel(1)->SubscribeConsumer(consumer1);
+   mgr->GetChannel(2)->SubscribeConsumer(consumer2);
+   if (workers) {
+      ExgMcFanOutConfig cfg;
+      cfg.WorkerCount_ = workers;
+      mgr->StartFanOut(cfg);
+   }
+   // Channel 1, 2 共用同一個 ExgMcFanOut: 同時送入, 確認不會互相等候.
+   std::thread thr2{&FeedChannel, std::ref(*mgr), uint16_t{2}, switchTo};
+   FeedChannel(*mgr, 1, 0);
+   thr2.join();
+   // 停止 FanOut: 等候 worker 處理完剩餘的訊息.
+   mgr->StartFanOut(ExgMcFanOutConfig{});
+   consumer1.Check("Channel 1: consumers notified in ChannelSeq order");
+   consumer2.Check("Channel 2: consumers notified in ChannelSeq order");
+   mgr->GetChannel(1)->UnsubscribeConsumer(consumer1);
+   mgr->GetChannel(2)->UnsubscribeConsumer(consumer2);
+}
+
+int main(int argc, char* argv[]) {
+   (void)argc; (void)argv;
+   fon9::AutoPrintTestInfo utinfo{"ExgMcFanOut"};
+   TestFanOut(0, 0);
+   TestFanOut(4, 0);
+   TestFanOut(0, 3);
+   TestFanOut(4, 2);
+}
@@ -1,6 +1,7 @@
 ﻿// \file f9twf/ExgMcGroup.cpp
 // \author fonwinz@gmail.com
 #include "f9twf/ExgMcGroup.hpp"
+#include "f9twf/ExgMcChannelTree.hpp"
 #include "fon9/seed/SysEnv.hpp"
 
 namespace f9twf {
@@ -45,6 +46,7 @@ void ExgMcSystem::OnMdSystemStartup(const unsigned tdayYYYYMMDD, const std::stri
 ExgMcGroup::ExgMcGroup(ExgMcSystem* mdsys, std::string name, f9fmkt_TradingSessionId tsesId)
    : base(std::move(name))
    , ChannelMgr_{new ExgMcChannelMgr(mdsys->Symbs_, &mdsys->Name_, &Name_, tsesId)} {
+   this->Sapling_->AddNamedSapling(new ExgMcChannelTree{this->ChannelMgr_}, "ChannelMgr");
 }
 ExgMcGroup::~ExgMcGroup() {
 }
@@ -31,8 +31,9 @@ public:
 using ExgMcSystemSP = fon9::intrusive_ptr<ExgMcSystem>;
 
 //--------------------------------------------------------------------------//
-/// - 建構後 Sapling 為空, 但可視情況, 自行加入底下物件.
-///   - "ChannelMgr" = ExgMcChannelMgr
+/// - 建構時自動加入:
+///   - "ChannelMgr" = ExgMcChannelTree: 查看 ExgMcChannelMgr 的 A/B 線路仲裁狀態.
+/// - 可視情況, 自行加入底下物件.
 ///   - "IoMgr"      = ExgMcGroupIoMgr
 ///   - "ToMiConvF"  = ExgMcToMiConv
 ///   - "ToMiConvO"  = ExgMcToMiConv
@@ -14,15 +14,36 @@ std::string ExgMcReceiver::SessionCommand(fon9::io::Device& dev, fon9::StrView c
       return RevPrintTo<std::string>(
          UtcNow(),
          "|channelId=", this->ChannelId_,
+         "|line=", this->LineIdx_ < kExgMcArbLineCount ? ExgMcArbLineName(this->LineIdx_) : '-',
          "|pkCount=", this->ReceivedCount_,
          "|chkSumErr=", this->ChkSumErrCount_,
-         "|dropped=", this->DroppedBytes_);
+         "|dropped=", this->DroppedBytes_,
+         "|chkSum=", this->IsSkipCheckSum() ? "Skip" : "Y");
+   }
+   if (cmdln == "fanout" || cmdln == "fanout clear") {
+      ExgMcFanOut* fanOut = this->ChannelMgr_->GetFanOut();
+      if (fanOut == nullptr)
+         return "FanOut not enabled.";
+      if (cmdln != "fanout")
+         fanOut->ClearLatency();
+      RevBufferList rbuf{256};
+      fanOut->RevPrintInfo(rbuf);
+      return BufferTo<std::string>(rbuf.MoveOut());
    }
    return "unknown ExgMcReceiver command";
 }
 void ExgMcReceiver::OnDevice_Initialized(fon9::io::Device& dev) {
    this->Device_ = &dev;
 }
+void ExgMcReceiver::OnDevice_StateChanged(fon9::io::Device& dev, const fon9::io::StateChangedArgs& e) {
+   if (this->LineIdx_ >= kExgMcArbLineCount)
+      return;
+   // 連線成功時, 將 dev 提供給 ExgMcArbitrator, 在線路停滯時重新開啟.
+   // 使用 A/B 線路時, 必定有指定 ChannelId(由 ExgMcReceiverFactory 檢查).
+   io::Device* arbdev = (e.After_.State_ == io::State::LinkReady ? &dev : nullptr);
+   if (auto* channel = this->ChannelMgr_->GetChannel(this->ChannelId_))
+      channel->GetArbitrator().SetLineDevice(this->LineIdx_, arbdev);
+}
 bool ExgMcReceiver::OnDevice_BeforeOpen(fon9::io::Device& dev, std::string& cfgstr) {
    (void)cfgstr;
    if (auto* channel = this->ChannelMgr_->GetChannel(this->ChannelId_)) {
@@ -42,7 +63,10 @@ io::RecvBufferSize ExgMcReceiver::OnDevice_Recv(io::Device& dev, DcQueueList& rx
    return io::RecvBufferSize::Default;
 }
 bool ExgMcReceiver::OnPkReceived(const void* pkptr, unsigned pksz) {
-   if (this->ChannelMgr_->OnPkReceived(*static_cast<const ExgMcHead*>(pkptr), pksz) == ExgMcChannelState::CanBeClosed)
+   const ExgMcHead&  pk = *static_cast<const ExgMcHead*>(pkptr);
+   if ((this->LineIdx_ < kExgMcArbLineCount
+        ? this->ChannelMgr_->OnLinePkReceived(this->LineIdx_, pk, pksz)
+        : this->ChannelMgr_->OnPkReceived(pk, pksz)) == ExgMcChannelState::CanBeClosed)
       this->Device_->AsyncClose("Channel can be closed.");
    return true;
 }
@@ -21,17 +21,23 @@ class ExgMcReceiver : public fon9::io::Session, private ExgMcPkReceiver {
 public:
    const ExgMcChannelMgrSP ChannelMgr_;
    const ExgMrChannelId_t  ChannelId_;
-   char                    Padding___[6];
+   char                    Padding___[2];
+   /// A/B 線路: 0=A, 1=B; kExgMcArbLineNone 表示不經過 ExgMcArbitrator;
+   const unsigned          LineIdx_;
 
    /// 如果有指定 channelId, 則在 OnDevice_BeforeOpen() 會檢查是否需要開啟 Receiver.
-   ExgMcReceiver(ExgMcChannelMgrSP channelMgr, ExgMrChannelId_t channelId)
+   ExgMcReceiver(ExgMcChannelMgrSP channelMgr, ExgMrChannelId_t channelId, unsigned lineIdx = kExgMcArbLineNone)
       : ChannelMgr_{std::move(channelMgr)}
-      , ChannelId_{channelId} {
+      , ChannelId_{channelId}
+      , LineIdx_{lineIdx} {
    }
    ~ExgMcReceiver();
 
+   using ExgMcPkReceiver::SetSkipCheckSum;
+
    bool OnDevice_BeforeOpen(fon9::io::Device& dev, std::string& cfgstr) override;
    void OnDevice_Initialized(fon9::io::Device& dev) override;
+   void OnDevice_StateChanged(fon9::io::Device& dev, const fon9::io::StateChangedArgs& e) override;
    std::string SessionCommand(fon9::io::Device& dev, fon9::StrView cmdln) override;
    fon9::io::RecvBufferSize OnDevice_Recv(fon9::io::Device& dev, fon9::DcQueueList& rxbuf) override;
 };
@@ -12,6 +12,12 @@ io::SessionSP ExgMcReceiverFactory::CreateSession(IoManager& ioMgr, const IoConf
       StrView           tag, value, args = ToStrView(cfg.SessionArgs_);
       ExgMrChannelId_t  channelId = 0;
       TimeInterval      waitInterval{TimeInterval::Null()};
+      bool              isSkipCheckSum = false;
+      uint32_t          pkRate = 0;
+      unsigned          lineIdx = kExgMcArbLineNone;
+      TimeInterval      stallInterval{TimeInterval::Null()};
+      bool              hasFanOut = false;
+      ExgMcFanOutConfig fanOutCfg;
       while (fon9::StrFetchTagValue(args, tag, value)) {
          if (tag == "ChannelId") {
             channelId = StrTo(value, channelId);
@@ -22,11 +28,47 @@ io::SessionSP ExgMcReceiverFactory::CreateSession(IoManager& ioMgr, const IoConf
          }
          else if (tag == "WaitInterval")
             waitInterval = StrTo(value, waitInterval);
+         else if (tag == "ChkSum") // ChkSum=N: 不檢查 CheckSum.
+            isSkipCheckSum = (fon9::toupper(value.Get1st()) == 'N');
+         else if (tag == "PkRate") // PkRate=每秒預期的封包數量: 用來預先配置「等候中封包」的 Ring.
+            pkRate = StrTo(value, pkRate);
+         else if (tag == "Line") { // Line=A 或 Line=B: 同時訂閱 A/B 線路, 由 ExgMcArbitrator 仲裁.
+            lineIdx = static_cast<unsigned>(fon9::toupper(value.Get1st()) - 'A');
+            if (lineIdx >= kExgMcArbLineCount) {
+               errReason = "f9twf.ExgMcReceiverFactory.CreateSession: Unknown Line.";
+               return nullptr;
+            }
+         }
+         else if (tag == "Stall") // Stall=線路停滯的判斷時間, 預設 3 秒.
+            stallInterval = StrTo(value, stallInterval);
+         else if (tag == "FanOut") { // FanOut=N: 即時行情使用 N 個 threads 解析, 0 表示不使用.
+            fanOutCfg.WorkerCount_ = StrTo(value, 0u);
+            hasFanOut = true;
+         }
+         else if (tag == "FanOutCpus") { // FanOutCpus=c1,c2...: FanOut worker 綁定的 CPU.
+            fanOutCfg.CpuAffinity_.clear();
+            while (!value.empty())
+               fanOutCfg.CpuAffinity_.push_back(StrTo(StrFetchTrim(value, ','), 0u));
+         }
+      }
+      // A/B 線路仲裁是針對單一 Channel, 所以必須指定 ChannelId.
+      if (lineIdx != kExgMcArbLineNone && channelId == 0) {
+         errReason = "f9twf.ExgMcReceiverFactory.CreateSession: Line requires ChannelId.";
+         return nullptr;
       }
+      // 同一個 ExgMcGroup 的全部 Channel(1,2) 共用一個 ExgMcFanOut, 所以只要在其中一個 Receiver 設定即可.
+      if (hasFanOut)
+         mgr->McGroup_->ChannelMgr_->StartFanOut(fanOutCfg);
       if (auto ch = mgr->McGroup_->ChannelMgr_->GetChannel(channelId)) {
          if (!waitInterval.IsNull())
             ch->SetWaitInterval(waitInterval);
-         return new ExgMcReceiver(mgr->McGroup_->ChannelMgr_, channelId);
+         if (pkRate > 0)
+            ch->SetPkPendingsRing(pkRate);
+         if (!stallInterval.IsNull())
+            ch->GetArbitrator().SetStallInterval(stallInterval);
+         ExgMcReceiver* ses = new ExgMcReceiver(mgr->McGroup_->ChannelMgr_, channelId, lineIdx);
+         ses->SetSkipCheckSum(isSkipCheckSum);
+         return ses;
       }
       errReason = "f9twf.ExgMcReceiverFactory.CreateSession: Unknown ChannelId.";
       return nullptr;
@@ -79,8 +79,7 @@ struct ExgMcToMiConv::HandlerFns {
       fon9::ToPackBcd(miPk->BodyLength_, miPkSz - sizeof(ExgMiNoBody));
       miPk->ProdId_ = static_cast<const ExgMcI081*>(&e.Pk_)->ProdId_;
       //-----
-      static_assert(fon9::fmkt::SymbBSData::kBSCount == sizeof(miPk->BuyOrderBook_) / sizeof(miPk->BuyOrderBook_[0]),
-                    "BSCount not equal.");
+      static_assert(ExgMdBS::Data::kBSCount >= kMiBSCount, "ExgMdBS::kBSCount must >= ExgMiI080 BSCount.");
       AssignBS(miPk->BuyOrderBook_, e.Symb_->BS_.Data_.Buys_, e.Symb_->PriceOrigDiv_);
       AssignBS(miPk->SellOrderBook_, e.Symb_->BS_.Data_.Sells_, e.Symb_->PriceOrigDiv_);
       if (!hasDerived)
@@ -95,8 +94,10 @@ struct ExgMcToMiConv::HandlerFns {
       //-----
       conv.FinalMiMessageSeq(*miPk, miPkSz, buf.MoveOut());
    }
+   /// 間隔行情 I080 的委託簿檔數.
+   static constexpr unsigned kMiBSCount = sizeof(ExgMiI080::BuyOrderBook_) / sizeof(ExgMiI080::BuyOrderBook_[0]);
    static void AssignBS(f9twf::ExgMdOrderPQ* dst, const fon9::fmkt::PriQty* src, uint32_t origDiv) {
-      for (unsigned L = 0; L < fon9::fmkt::SymbBSData::kBSCount; ++L) {
+      for (unsigned L = 0; L < kMiBSCount; ++L) {
          dst->Price_.AssignFrom(src->Pri_, origDiv);
          fon9::ToPackBcd(dst->Qty_, src->Qty_);
          ++src;
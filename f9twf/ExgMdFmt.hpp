@@ -21,7 +21,7 @@ using ExgMcProdMsgSeq = fon9::PackBcd<10>;
 
 using ExgMdPrice = fon9::PackBcd<9>;
 inline void ExgMdPriceTo(fon9::fmkt::Pri& dst, const ExgMdPrice& src, uint32_t origDiv) {
-   dst.SetOrigValue(fon9::signed_cast(fon9::PackBcdTo<uint64_t>(src)));
+   dst.SetOrigValue(fon9::signed_cast(fon9::PackBcdBytesTo<uint64_t>(src)));
    if (origDiv)
       dst *= origDiv;
 }
@@ -97,7 +97,7 @@ struct ExgMcHeadChannelSeq {
       return fon9::PackBcdTo<uint16_t>(this->ChannelId_);
    }
    uint64_t GetChannelSeq() const {
-      return fon9::PackBcdTo<uint64_t>(this->ChannelSeq_);
+      return fon9::PackBcdBytesTo<uint64_t>(this->ChannelSeq_);
    }
 };
 struct ExgMdHeadVerLen {
@@ -29,8 +29,8 @@ f9twf_API void I081BSParserToRts(ExgMcMessage& e) {
    // 分配一個前端保留一小塊(sizeReserved)記憶體的 FwdBufferNode.
    // 前方保留的小塊記憶體: 可以將 node 轉成 RevBufferNode 之後使用.
    RevBufferFixedSize<sizeof(PriQty) + 8> xbuf;
-   // 分配的記憶體量必須足夠: 最多 mdCount * (PQ 使用 Bitv 儲存所需的最大可能資料量 + sizeof(BSType)).
-   FwdBufferNode* fnode = FwdBufferNode::AllocReserveFront(mdCount * (sizeof(PriQty) + 5) + 64, 64);
+   // 分配的記憶體量必須足夠: 最多 mdCount * (PQ 使用 Bitv 儲存所需的最大可能資料量 + BSType 及 Level(最多 2 bytes)).
+   FwdBufferNode* fnode = FwdBufferNode::AllocReserveFront(mdCount * (sizeof(PriQty) + 6) + 64, 64);
    RevBufferList  rbuf{16};
    auto*          fnodeEnd = fnode->GetDataEnd();
    rbuf.PushFront(fnode);
@@ -69,27 +69,23 @@ f9twf_API void I081BSParserToRts(ExgMcMessage& e) {
       }
       if (lv >= dstCount)
          continue;
-      assert(lv <= 0x0f);
-      bsType = static_cast<uint8_t>(bsType | lv);
-      dst += lv;
       xbuf.Rewind();
       switch (mdEntry->UpdateAction_) {
       case '2': // Delete.
          bsType = static_cast<uint8_t>(bsType | cast_to_underlying(RtBSAction::Delete));
-         if (auto mvc = dstCount - lv - 1)
-            memmove(dst, dst + 1, mvc * sizeof(*dst));
-         memset(dst + dstCount - lv - 1, 0, sizeof(*dst));
+         SymbBS_DeleteLevel(dst, dstCount, lv);
          break;
       case '0': // New.
          bsType = static_cast<uint8_t>(bsType | cast_to_underlying(RtBSAction::New));
-         if (auto mvc = dstCount - lv - 1)
-            memmove(dst + 1, dst, mvc * sizeof(*dst));
+         SymbBS_InsertLevel(dst, dstCount, lv);
+         dst += lv;
          ToBitv(xbuf, dst->Qty_ = PackBcdTo<uint32_t>(mdEntry->Qty_));
          mdEntry->Price_.AssignTo(dst->Pri_, e.Symb_->PriceOrigDiv_);
          ToBitv(xbuf, dst->Pri_);
          break;
       case '1': // Change.
       case '5': // Overlay.
+         dst += lv;
          ToBitv(xbuf, dst->Qty_ = PackBcdTo<uint32_t>(mdEntry->Qty_));
          mdEntry->Price_.AssignTo(mdPri, e.Symb_->PriceOrigDiv_);
          if (mdPri == dst->Pri_)
@@ -104,9 +100,9 @@ f9twf_API void I081BSParserToRts(ExgMcMessage& e) {
       }
       ++uCount;
       const auto sz = xbuf.GetUsedSize();
-      *fnodeEnd = bsType;
-      memcpy(fnodeEnd + 1, xbuf.GetCurrent(), sz);
-      fnodeEnd += sz + 1;
+      fnodeEnd += MdRtsPutUpdateBSType(fnodeEnd, bsType, lv);
+      memcpy(fnodeEnd, xbuf.GetCurrent(), sz);
+      fnodeEnd += sz;
    }
    fnode->SetDataEnd(fnodeEnd);
    // MSB 1 bit = Calculated?
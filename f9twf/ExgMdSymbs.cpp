@@ -30,7 +30,7 @@ fon9::seed::LayoutSP ExgMdSymb::MakeLayout() {
       fon9_MakeField(Symb, SymbId_, "Id"), TreeFlag::AddableRemovable | TreeFlag::Unordered,
       TabSP{new Tab{Named{fon9_kCSTR_TabName_Base}, MakeFields(),            kTabFlag}},
       TabSP{new Tab{Named{fon9_kCSTR_TabName_Ref},  TwfSymbRef_MakeFields(), kTabFlag}},
-      TabSP{new Tab{Named{fon9_kCSTR_TabName_BS},   SymbTwfBS_MakeFields(),  kTabFlag}},
+      TabSP{new Tab{Named{fon9_kCSTR_TabName_BS},   SymbTwfBST_MakeFields<ExgMdBS::Data::kBSCount>(), kTabFlag}},
       TabSP{new Tab{Named{fon9_kCSTR_TabName_Deal}, SymbTwfDeal_MakeFields(),kTabFlag}},
       f9fmkt_MAKE_TABS_OpenHighLow(),
       TabSP{new Tab{Named{fon9_kCSTR_TabName_BreakSt}, SymbBreakSt_MakeFieldsTwf(),kTabFlag}},
@@ -136,7 +136,7 @@ void ExgMdSymbs::MdTreeOp::Get(fon9::StrView strKeyText, fon9::seed::FnPodOp fnC
 }
 //--------------------------------------------------------------------------//
 f9twf_API const void* ExgMdToSnapshotBS(fon9::DayTime mdTime, unsigned mdCount, const ExgMdEntry* mdEntry,
-                                        fon9::fmkt::SymbTwfBS& symbBS, uint32_t priceOrigDiv) {
+                                        ExgMdBS& symbBS, uint32_t priceOrigDiv) {
    symbBS.Data_.Clear(mdTime);
    for (unsigned mdL = 0; mdL < mdCount; ++mdL, ++mdEntry) {
       unsigned lv = fon9::PackBcdTo<unsigned>(mdEntry->Level_) - 1;
@@ -171,7 +171,7 @@ f9twf_API const void* ExgMdToSnapshotBS(fon9::DayTime mdTime, unsigned mdCount,
    return mdEntry;
 }
 f9twf_API void ExgMdToUpdateBS(fon9::DayTime mdTime, unsigned mdCount, const ExgMcI081Entry* mdEntry,
-                               fon9::fmkt::SymbTwfBS& symbBS, uint32_t priceOrigDiv) {
+                               ExgMdBS& symbBS, uint32_t priceOrigDiv) {
    symbBS.Data_.InfoTime_ = mdTime;
    symbBS.Data_.Flags_ = f9sv_BSFlag{};
    for (unsigned mdL = 0; mdL < mdCount; ++mdL, ++mdEntry) {
@@ -204,18 +204,16 @@ f9twf_API void ExgMdToUpdateBS(fon9::DayTime mdTime, unsigned mdCount, const Exg
       }
       if (lv >= dstCount)
          continue;
-      dst += lv;
       switch (mdEntry->UpdateAction_) {
       case '2': // Delete.
-         if (auto mvc = dstCount - lv - 1)
-            memmove(dst, dst + 1, mvc * sizeof(*dst));
-         memset(dst + dstCount - lv - 1, 0, sizeof(*dst));
+         fon9::fmkt::SymbBS_DeleteLevel(dst, dstCount, lv);
          break;
       case '0': // New.
-         if (auto mvc = dstCount - lv - 1)
-            memmove(dst + 1, dst, mvc * sizeof(*dst));
+         fon9::fmkt::SymbBS_InsertLevel(dst, dstCount, lv);
+         // 不用 break; 填入 dst[lv];
       case '1': // Change.
       case '5': // Overlay.
+         dst += lv;
          mdEntry->Price_.AssignTo(dst->Pri_, priceOrigDiv);
          dst->Qty_ = fon9::PackBcdTo<uint32_t>(mdEntry->Qty_);
          break;
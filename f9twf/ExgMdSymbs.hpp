@@ -17,6 +17,14 @@
 
 namespace f9twf {
 
+/// 委託簿檔數: 期交所逐筆行情(I081/I083)目前提供 5 檔;
+/// 若資訊來源提供更多檔(例: 全委託簿), 可在編譯時定義 f9twf_ExgMdBSCount 調整;
+/// 轉成間隔行情(ExgMcToMiConv)時, 只會使用前 5 檔.
+#ifndef f9twf_ExgMdBSCount
+#define f9twf_ExgMdBSCount    5
+#endif
+using ExgMdBS = fon9::fmkt::SymbTwfBST<f9twf_ExgMdBSCount>;
+
 /// 檢查並設定 symb 的 TradingSessionId.
 /// \retval true 應繼續處理 rxTradingSessionId 的其他資料.
 ///   - 現在的 symb.TradingSession_ 正確: symb.TradingSessionId_ == rxTradingSessionId;
@@ -47,7 +55,7 @@ class f9twf_API ExgMdSymb : public fon9::fmkt::SymbTwf, public fon9::fmkt::SymbD
    using base = fon9::fmkt::SymbTwf;
 public:
    TwfSymbRef                 Ref_;
-   fon9::fmkt::SymbTwfBS      BS_;
+   ExgMdBS                    BS_;
    fon9::fmkt::SymbDeal       Deal_;
    fon9::fmkt::SymbBreakSt    BreakSt_;
    fon9::fmkt::SymbFuoClosing FuoClosing_;
@@ -110,7 +118,7 @@ struct ExgMdEntry;
 
 /// 返回 mdEntry + mdCount;
 f9twf_API const void* ExgMdToSnapshotBS(fon9::DayTime mdTime, unsigned mdCount, const ExgMdEntry* mdEntry,
-                                        fon9::fmkt::SymbTwfBS& symbBS, uint32_t priceOrigDiv);
+                                        ExgMdBS& symbBS, uint32_t priceOrigDiv);
 template <class SymbT>
 inline const void* ExgMdToSnapshotBS(fon9::DayTime mdTime, unsigned mdCount, const ExgMdEntry* mdEntry, SymbT& symb) {
    return ExgMdToSnapshotBS(mdTime, mdCount, mdEntry, symb.BS_, symb.PriceOrigDiv_);
@@ -119,7 +127,7 @@ inline const void* ExgMdToSnapshotBS(fon9::DayTime mdTime, unsigned mdCount, con
 struct ExgMcI081Entry;
 
 f9twf_API void ExgMdToUpdateBS(fon9::DayTime mdTime, unsigned mdCount, const ExgMcI081Entry* mdEntry,
-                               fon9::fmkt::SymbTwfBS& symbBS, uint32_t priceOrigDiv);
+                               ExgMdBS& symbBS, uint32_t priceOrigDiv);
 template <class SymbT>
 inline void ExgMdToUpdateBS(fon9::DayTime mdTime, unsigned mdCount, const ExgMcI081Entry* mdEntry, SymbT& symb) {
    ExgMdToUpdateBS(mdTime, mdCount, mdEntry, symb.BS_, symb.PriceOrigDiv_);
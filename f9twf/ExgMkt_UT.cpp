@@ -388,6 +388,7 @@ int main(int argc, char* argv[]) {
    // ---
    TwfPkReceiver  pkReceiver;
    double         tmFull = f9extests::ExgMktFeedAll(mdf, pkReceiver);
+   f9extests::ExgMktBenchCheckSum(pkReceiver, mdf);
    for (unsigned txL = 0; txL < 0x100; ++txL) {
       for (unsigned mgL = 0; mgL < 0x100; ++mgL) {
          if (pkReceiver.FmtCount_[txL][mgL]) {
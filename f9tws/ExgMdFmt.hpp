@@ -46,7 +46,7 @@ struct ExgMdHeader {
    unsigned GetLength() const { return fon9::PackBcdTo<unsigned>(this->Length_); }
    uint8_t  GetFmtNo() const { return fon9::PackBcdTo<uint8_t>(this->FmtNo_); }
    uint8_t  GetVerNo() const { return fon9::PackBcdTo<uint8_t>(this->VerNo_); }
-   uint32_t GetSeqNo() const { return fon9::PackBcdTo<uint32_t>(this->SeqNo_); }
+   uint32_t GetSeqNo() const { return fon9::PackBcdBytesTo<uint32_t>(this->SeqNo_); }
 };
 static_assert(sizeof(ExgMdHeader) == 10, "ExgMdHeader 沒有 pack?");
 enum : size_t {
@@ -60,8 +60,8 @@ struct ExgMdPriQty {
    fon9::PackBcd<8>  Qty_;
 
    void AssignTo(fon9::fmkt::PriQty& dst) const {
-      dst.Pri_.Assign<4>(fon9::PackBcdTo<uint64_t>(this->PriV4_));
-      dst.Qty_ = fon9::PackBcdTo<fon9::fmkt::Qty>(this->Qty_);
+      dst.Pri_.Assign<4>(fon9::PackBcdBytesTo<uint64_t>(this->PriV4_));
+      dst.Qty_ = fon9::PackBcdBytesTo<fon9::fmkt::Qty>(this->Qty_);
    }
 };
 static_assert(sizeof(ExgMdPriQty) == 9, "ExgMdPriQty 沒有 pack?");
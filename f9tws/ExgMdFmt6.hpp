@@ -84,6 +84,22 @@ inline const ExgMdPQ* AssignBS(DstPQ (&adst)[kBSCount], const ExgMdPQ* pqs, unsi
       memset(pdst, 0, sizeof(*pdst) * (kBSCount - count));
    return pqs;
 }
+/// 證交所的 ExgMdPriQty: 使用 PackBcdRunTo() 一次解碼全部檔位的價格、數量.
+template <class DstPQ, unsigned kBSCount>
+inline const ExgMdPriQty* AssignBS(DstPQ (&adst)[kBSCount], const ExgMdPriQty* pqs, unsigned count) {
+   if (count > kBSCount)
+      count = kBSCount;
+   uint64_t pris[kBSCount], qtys[kBSCount];
+   fon9::PackBcdRunTo(pris, pqs->PriV4_, sizeof(pqs->PriV4_), sizeof(*pqs), count);
+   fon9::PackBcdRunTo(qtys, pqs->Qty_, sizeof(pqs->Qty_), sizeof(*pqs), count);
+   for (unsigned L = 0; L < count; ++L) {
+      adst[L].Pri_.template Assign<4>(pris[L]);
+      adst[L].Qty_ = static_cast<fon9::fmkt::Qty>(qtys[L]);
+   }
+   if (count < kBSCount)
+      memset(adst + count, 0, sizeof(adst[0]) * (kBSCount - count));
+   return pqs + count;
+}
 
 } // namespaces
 #endif//__f9tws_ExgMdFmt6_hpp__
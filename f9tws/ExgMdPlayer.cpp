@@ -7,6 +7,7 @@
 #include "fon9/framework/IoFactory.hpp"
 #include "fon9/DefaultThreadPool.hpp"
 #include "fon9/File.hpp"
+#include "fon9/TsPkLog.hpp"
 
 namespace f9tws {
 
@@ -16,7 +17,83 @@ struct ExgMdPlayerArgs {
    uint64_t             RdBytes_{0};
    fon9::TimeInterval   RdInterval_{fon9::TimeInterval_Millisecond(1)};
    fon9::TimeInterval   AtEnd_;
+   /// 依照 TsAppend() 記錄的封包時間播放, 速度倍數:
+   /// - 0 = 不使用封包時間: 依照 Rd、Interval 讀檔播放, 記錄檔可以是原始封包.
+   /// - kSpeedMax = 盡快播放.
+   unsigned             Speed_{0};
+   char                 Padding____[4];
+   /// 開始播放的時間: "HH:MM:SS[.uuuuuu]" 或 "YYYYMMDD-HH:MM:SS[.uuuuuu]"; 台灣時間.
+   std::string          SeekTime_;
+   /// 開始播放的序號: "Market.FmtNo.SeqNo"; 例: "1.6.12345" = 上市 Fmt6 序號 12345;
+   std::string          SeekSeq_;
+
+   enum : unsigned {
+      kSpeedMax = ~0u,
+   };
+   bool IsTsMode() const {
+      return this->Speed_ != 0;
+   }
 };
+
+/// 建立序號索引用: channel = Market * 100 + FmtNo;
+static bool ExgMdPkSeq(const void* pk, unsigned pksz, uint32_t& channel, uint64_t& seq) {
+   if (pksz < sizeof(ExgMdHeader))
+      return false;
+   const ExgMdHeader& hdr = *static_cast<const ExgMdHeader*>(pk);
+   if (hdr.Esc_ != 27)
+      return false;
+   channel = fon9::PackBcdTo<uint32_t>(hdr.Market_) * 100u + hdr.GetFmtNo();
+   seq = hdr.GetSeqNo();
+   return true;
+}
+/// \retval TimeStamp::Null() 格式錯誤.
+static fon9::TimeStamp StrToSeekTime(fon9::StrView str, fon9::TimeStamp firstPkTime) {
+   const fon9::TimeZoneOffset tz = fon9::GetTimeZoneOffsetByName("TW");
+   const char* pdig = str.begin();
+   while (pdig != str.end() && fon9::isdigit(static_cast<unsigned char>(*pdig)))
+      ++pdig;
+   if (pdig - str.begin() >= 8) { // 開頭至少 8 碼數字: 包含日期.
+      fon9::TimeStamp tm = fon9::StrTo(str, fon9::TimeStamp::Null());
+      return tm.IsNull() ? tm : (tm - tz);
+   }
+   fon9::TimeInterval ti = fon9::StrTo(str, fon9::TimeInterval::Null());
+   if (ti.IsNull())
+      return fon9::TimeStamp::Null();
+   // 使用第一個封包的日期.
+   return fon9::TimeStampResetHHMMSS(firstPkTime + tz) + ti - tz;
+}
+/// \retval false 格式錯誤.
+static bool StrToSeekSeq(fon9::StrView str, uint32_t& channel, uint64_t& seq) {
+   fon9::StrView mkt = fon9::StrFetchTrim(str, '.');
+   fon9::StrView fmt = fon9::StrFetchTrim(str, '.');
+   if (mkt.empty() || fmt.empty() || str.empty())
+      return false;
+   channel = fon9::StrTo(mkt, 0u) * 100u + fon9::StrTo(fmt, 0u);
+   seq = fon9::StrTo(str, uint64_t{0});
+   return true;
+}
+/// 使用 TsPkLogReader 的索引, 找到開始播放的位置.
+/// \retval !empty() 錯誤訊息.
+static std::string SeekTsLog(const fon9::TsPkLogReader& log, fon9::StrView how, fon9::StrView value,
+                             fon9::File::PosType& pos) {
+   if (how == "time") {
+      fon9::File::PosType  pos0 = 0;
+      fon9::TsPkLogPk      pk0;
+      if (!log.FetchPk(pos0, pk0))
+         return "Empty log.";
+      fon9::TimeStamp tm = StrToSeekTime(value, pk0.Time_);
+      if (tm.IsNull())
+         return fon9::RevPrintTo<std::string>("Bad SeekTime=", value);
+      pos = log.SeekTime(tm);
+      return std::string{};
+   }
+   uint32_t channel;
+   uint64_t seq;
+   if (!StrToSeekSeq(value, channel, seq))
+      return fon9::RevPrintTo<std::string>("Bad SeekSeq=", value);
+   pos = log.SeekSeq(channel, seq);
+   return std::string{};
+}
 class ExgMdPlayer : public ExgMdPkReceiver, public fon9::io::Session {
    fon9_NON_COPY_NON_MOVE(ExgMdPlayer);
    fon9::io::Device*    Device_{nullptr};
@@ -25,6 +102,12 @@ class ExgMdPlayer : public ExgMdPkReceiver, public fon9::io::Session {
    ExgMdPlayerArgs      Args_;
    fon9::TimeStamp      LastStTime_;
    uint64_t             SentPkCount_{0};
+   /// Args_.IsTsMode() 時使用.
+   std::unique_ptr<fon9::TsPkLogReader>   TsLog_;
+   /// 依照封包時間播放: 送出 PlayPkTime_ 封包的時間為 PlayTime_;
+   /// 之後的封包送出時間 = PlayTime_ + (封包時間 - PlayPkTime_) / Speed_;
+   fon9::TimeStamp      PlayTime_;
+   fon9::TimeStamp      PlayPkTime_;
 
    struct NodeSend : public fon9::BufferNodeVirtual {
       fon9_NON_COPY_NON_MOVE(NodeSend);
@@ -73,6 +156,10 @@ class ExgMdPlayer : public ExgMdPkReceiver, public fon9::io::Session {
    void ReadMktFile(fon9::TimeStamp now) {
       if (this->Device_->OpImpl_GetState() != fon9::io::State::LinkReady)
          return;
+      if (this->TsLog_) {
+         this->ReadTsLog(now);
+         return;
+      }
       if (this->Args_.RdTo_ != 0 && this->Args_.RdTo_ <= this->Args_.RdFrom_) {
          this->Device_->Manager_->OnSession_StateUpdated(*this->Device_,
                                                          fon9::ToStrView(this->RdInfoStr("|End=", this->Args_.RdTo_)),
@@ -121,6 +208,113 @@ class ExgMdPlayer : public ExgMdPkReceiver, public fon9::io::Session {
          this->Device_->Manager_->OnSession_StateUpdated(*this->Device_, &stmsg, stlv);
    }
 
+   void ReadTsLog(fon9::TimeStamp now) {
+      enum : size_t {
+         kDefaultRdBytes = 64 * 1024,
+      };
+      const size_t   rdmax = this->Args_.RdBytes_ ? this->Args_.RdBytes_ : kDefaultRdBytes;
+      size_t         rdsz = 0;
+      std::string    stmsg;
+      fon9::LogLevel stlv = fon9::LogLevel::Trace;
+      fon9::TsPkLogPk pk;
+      for (;;) {
+         if (this->Args_.RdTo_ != 0 && this->Args_.RdTo_ <= this->Args_.RdFrom_) {
+            stmsg = this->RdInfoStr("|End=", this->Args_.RdTo_);
+            stlv = fon9::LogLevel::Info;
+            break;
+         }
+         fon9::File::PosType pos = this->Args_.RdFrom_;
+         if (!this->TsLog_->FetchPk(pos, pk)) {
+            if (this->Args_.AtEnd_.GetOrigValue() > 0) {
+               this->TsLog_->Reload();
+               stmsg = this->RdInfoStr("|WaitNew");
+               this->Device_->CommonTimerRunAfter(this->Args_.AtEnd_);
+            }
+            else {
+               stmsg = this->RdInfoStr("|AtEnd");
+               stlv = fon9::LogLevel::Info;
+            }
+            break;
+         }
+         if (this->Args_.Speed_ != ExgMdPlayerArgs::kSpeedMax) {
+            if (this->PlayPkTime_.IsNull()) {
+               this->PlayPkTime_ = pk.Time_;
+               this->PlayTime_ = now;
+            }
+            const fon9::TimeStamp due = this->PlayTime_ + (pk.Time_ - this->PlayPkTime_) / this->Args_.Speed_;
+            if (due > now) {
+               this->Device_->CommonTimerRunAfter(due - now);
+               break;
+            }
+         }
+         if (rdsz >= rdmax) { // 等送出後, 再繼續.
+            NodeSend::Wait(*this);
+            break;
+         }
+         rdsz += pk.Size_;
+         this->Args_.RdFrom_ = pos;
+         this->OnPkReceived(pk.Pk_, pk.Size_);
+      }
+      if (stmsg.empty() && now - this->LastStTime_ >= fon9::TimeInterval_Second(1)) {
+         this->LastStTime_ = now;
+         stmsg = this->RdInfoStr("|PkTime=", pk.Time_);
+      }
+      if (!stmsg.empty())
+         this->Device_->Manager_->OnSession_StateUpdated(*this->Device_, &stmsg, stlv);
+   }
+   std::string SessionCommand(fon9::io::Device& dev, fon9::StrView cmdln) override {
+      fon9::StrView cmd = fon9::StrFetchTrim(cmdln, &fon9::isspace);
+      cmdln = fon9::StrTrim(&cmdln);
+      if (cmd == "?") {
+         return "seek"  fon9_kCSTR_CELLSPL "Seek by time or seq" fon9_kCSTR_CELLSPL "time HH:MM:SS[.uuuuuu] or time YYYYMMDD-HH:MM:SS; seq Market.FmtNo.SeqNo" fon9_kCSTR_ROWSPL
+                "speed" fon9_kCSTR_CELLSPL "Playback speed" fon9_kCSTR_CELLSPL "1..N or Max" fon9_kCSTR_ROWSPL
+                "info"  fon9_kCSTR_CELLSPL "Playback info";
+      }
+      if (!this->TsLog_)
+         return "Requires TsAppend log mode(Speed=).";
+      std::string res;
+      if (cmd == "seek") {
+         fon9::StrView how = fon9::StrFetchTrim(cmdln, &fon9::isspace);
+         if (how != "time" && how != "seq")
+            return "seek: time or seq?";
+         // 在 Device 的 OpQueue_ 執行, 避免與 OnDevice_CommonTimer() 同時操作.
+         dev.OpQueue_.InplaceOrWait(fon9::AQueueTaskKind::Get, fon9::io::DeviceAsyncOp{[&](fon9::io::Device&) {
+            fon9::File::PosType pos;
+            res = SeekTsLog(*this->TsLog_, how, fon9::StrTrim(&cmdln), pos);
+            if (!res.empty())
+               return;
+            this->Args_.RdFrom_ = pos;
+            this->PlayPkTime_.AssignNull();
+            res = this->RdInfoStr();
+            this->Device_->CommonTimerRunAfter(fon9::TimeInterval{});
+         }});
+         return res;
+      }
+      if (cmd == "speed") {
+         const unsigned speed = (fon9::toupper(cmdln.Get1st()) == 'M'
+                                 ? static_cast<unsigned>(ExgMdPlayerArgs::kSpeedMax)
+                                 : fon9::StrTo(cmdln, 0u));
+         if (speed == 0)
+            return "speed: 1..N or Max";
+         dev.OpQueue_.InplaceOrWait(fon9::AQueueTaskKind::Get, fon9::io::DeviceAsyncOp{[&](fon9::io::Device&) {
+            this->Args_.Speed_ = speed;
+            this->PlayPkTime_.AssignNull();
+            res = this->RdInfoStr("|Speed=", speed);
+            this->Device_->CommonTimerRunAfter(fon9::TimeInterval{});
+         }});
+         return res;
+      }
+      if (cmd == "info") {
+         dev.OpQueue_.InplaceOrWait(fon9::AQueueTaskKind::Get, fon9::io::DeviceAsyncOp{[&](fon9::io::Device&) {
+            res = this->RdInfoStr("|Speed=", this->Args_.Speed_,
+                                  "|LogSize=", this->TsLog_->GetLogSize(),
+                                  "|IdxCount=", this->TsLog_->GetIdx().size());
+         }});
+         return res;
+      }
+      return "unknown ExgMdPlayer command";
+   }
+
    bool OnPkReceived(const void* pk, unsigned pksz) override {
       ++this->SentPkCount_;
       NodeSend::Send(*this, pk, pksz);
@@ -131,6 +325,11 @@ public:
       : MktFile_{std::move(fd)}
       , Args_(args) {
    }
+   ExgMdPlayer(std::unique_ptr<fon9::TsPkLogReader> tslog, const ExgMdPlayerArgs& args)
+      : Args_(args)
+      , TsLog_{std::move(tslog)} {
+      this->PlayPkTime_.AssignNull();
+   }
    ~ExgMdPlayer() {
    }
 };
@@ -143,9 +342,9 @@ public:
 
    static fon9::io::SessionSP CreateSession(fon9::StrView cfg, std::string& errReason) {
       // cfg.SessionArgs_: fileName|From=pos|To=pos|Rd=BlockSize|Interval=ti|
-      // TODO: std::string ExgMdPlayer::SessionCommand(Device& dev, StrView cmdln);
-      //    - pause
-      //    - restart [from to speed]
+      //                   Speed=1..N or Max|SeekTime=HH:MM:SS|SeekSeq=Market.FmtNo.SeqNo
+      // - 有設定 Speed, SeekTime, SeekSeq 其中之一: 表示 fileName 為 TsAppend() 的記錄檔,
+      //   使用 TsPkLogReader(mmap + 索引檔 fileName.idx) 依照封包時間播放.
       fon9::StrView     fn = fon9::StrFetchTrim(cfg, '|');
       ExgMdPlayerArgs   args;
       fon9::StrView     tag, value;
@@ -160,11 +359,38 @@ public:
             args.RdInterval_ = fon9::StrTo(value, args.RdInterval_);
          else if (tag == "AtEnd")
             args.AtEnd_ = fon9::StrTo(value, args.AtEnd_);
+         else if (tag == "Speed")
+            args.Speed_ = (fon9::toupper(value.Get1st()) == 'M'
+                           ? static_cast<unsigned>(ExgMdPlayerArgs::kSpeedMax)
+                           : fon9::StrTo(value, 0u));
+         else if (tag == "SeekTime")
+            args.SeekTime_ = value.ToString();
+         else if (tag == "SeekSeq")
+            args.SeekSeq_ = value.ToString();
          else {
             errReason = fon9::RevPrintTo<std::string>("Create:TwsExgMdPlayer|err=Unknown tag: ", tag);
             return fon9::io::SessionSP{};
          }
       }
+      if (args.Speed_ == 0 && (!args.SeekTime_.empty() || !args.SeekSeq_.empty()))
+         args.Speed_ = 1;
+      if (args.IsTsMode()) {
+         std::unique_ptr<fon9::TsPkLogReader> tslog{new fon9::TsPkLogReader};
+         auto res = tslog->Open(fn.ToString(), &ExgMdPkSeq);
+         if (!res) {
+            errReason = fon9::RevPrintTo<std::string>("Create:TwsExgMdPlayer|fname=", tslog->GetOpenName(), '|', res);
+            return fon9::io::SessionSP{};
+         }
+         if (!args.SeekTime_.empty())
+            errReason = SeekTsLog(*tslog, "time", &args.SeekTime_, args.RdFrom_);
+         else if (!args.SeekSeq_.empty())
+            errReason = SeekTsLog(*tslog, "seq", &args.SeekSeq_, args.RdFrom_);
+         if (!errReason.empty()) {
+            errReason.insert(0, "Create:TwsExgMdPlayer|err=");
+            return fon9::io::SessionSP{};
+         }
+         return fon9::io::SessionSP{new ExgMdPlayer{std::move(tslog), args}};
+      }
       fon9::File fd;
       auto       res = fd.Open(fn.ToString(), fon9::FileMode::Read);
       if (!res) {
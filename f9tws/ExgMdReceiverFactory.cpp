@@ -10,15 +10,20 @@ io::SessionSP ExgMdReceiverFactory::CreateSession(IoManager& ioMgr, const IoConf
    (void)ioMgr;
    StrView  tag, value, args = ToStrView(cfg.SessionArgs_);
    StrView  pkLogName;
+   bool     isSkipCheckSum = false;
    while (fon9::StrFetchTagValue(args, tag, value)) {
       if (tag == "PkLog")
          pkLogName = value;
+      else if (tag == "ChkSum") // ChkSum=N: 不檢查 CheckSum.
+         isSkipCheckSum = (fon9::toupper(value.Get1st()) == 'N');
       else {
          errReason = "f9tws.ExgMdReceiverFactory.CreateSession: Unknown Tag:" + tag.ToString();
          return nullptr;
       }
    }
-   return new ExgMdReceiverSession(this->MdDispatcher_, pkLogName);
+   ExgMdReceiverSession* ses = new ExgMdReceiverSession(this->MdDispatcher_, pkLogName);
+   ses->SetSkipCheckSum(isSkipCheckSum);
+   return ses;
 }
 io::SessionServerSP ExgMdReceiverFactory::CreateSessionServer(IoManager& ioMgr, const IoConfigItem& cfg, std::string& errReason) {
    (void)ioMgr; (void)cfg;
@@ -17,7 +17,8 @@ std::string ExgMdReceiverSession::SessionCommand(io::Device& dev, StrView cmdln)
          UtcNow(),
          "|pkCount=", this->ReceivedCount_,
          "|chkSumErr=", this->ChkSumErrCount_,
-         "|dropped=", this->DroppedBytes_);
+         "|dropped=", this->DroppedBytes_,
+         "|chkSum=", this->IsSkipCheckSum() ? "Skip" : "Y");
    }
    return "unknown ExgMdReceiverSession command";
 }
@@ -37,6 +37,8 @@ public:
    }
 
    ~ExgMdReceiverSession();
+
+   using ExgMdPkReceiver::SetSkipCheckSum;
 };
 
 } // namespaces
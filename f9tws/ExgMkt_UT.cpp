@@ -116,6 +116,7 @@ int main(int argc, char* argv[]) {
 
    TwsPkReceiver pkReceiver;
    double        tmFull = f9extests::ExgMktFeedAll(mdf, pkReceiver);
+   f9extests::ExgMktBenchCheckSum(pkReceiver, mdf);
    for (unsigned L = 0; L < f9tws::kExgMdMaxFmtNoSize; ++L) {
       if (pkReceiver.FmtCount_[L]) {
          std::cout << "FmtNo=" << L
@@ -35,7 +35,8 @@ static f9fix::CompIDs MakeCompIDs(const ExgTradingLineFixArgs& args) {
             args.Market_ == f9fmkt_TradingMarket_TwSEC ? fon9::StrView{"XTAI"} : fon9::StrView{"ROCO"}, nullptr);
 }
 
-f9tws_API std::string MakeExgTradingLineFixSender(const ExgTradingLineFixArgs& args, fon9::StrView recPath, f9fix::IoFixSenderSP& out) {
+f9tws_API std::string MakeExgTradingLineFixSender(const ExgTradingLineFixArgs& args, fon9::StrView recPath, f9fix::IoFixSenderSP& out,
+                                                  const f9fix::FixConfig* fixcfg) {
    /// - 上市 retval->Initialize(recPath + "FIX44_XTAI_BrkId_SocketId.log");
    /// - 上櫃 retval->Initialize(recPath + "FIX44_ROCO_BrkId_SocketId.log");
    f9fix::IoFixSenderSP fixSender{new f9fix::IoFixSender{f9fix_BEGIN_HEADER_V44, MakeCompIDs(args)}};
@@ -45,6 +46,8 @@ f9tws_API std::string MakeExgTradingLineFixSender(const ExgTradingLineFixArgs& a
    fileName.push_back('_');
    fixSender->CompIDs_.Sender_.CompID_.AppendTo(fileName); // ('T' or 'O') + BrkId + SocketId
    fileName.append(".log");
+   if (fixcfg)
+      fixSender->GetFixRecorder().SetGroupCommit(fixcfg->RecorderGroupCommitDelay_, fixcfg->RecorderGroupCommitBytes_);
    auto res = fixSender->GetFixRecorder().Initialize(fileName);
    if (res.IsError())
       return fon9::RevPrintTo<std::string>("MakeExgTradingLineFixSender|fn=", fileName, '|', res);
@@ -35,8 +35,10 @@ f9tws_API std::string ExgTradingLineFixArgsParser(ExgTradingLineFixArgs& args, f
 /// 建立適合 TSE/OTC 使用的 fixSender.
 /// - 上市 retval->Initialize(recPath + "FIX44_XTAI_BrkId_SocketId.log");
 /// - 上櫃 retval->Initialize(recPath + "FIX44_ROCO_BrkId_SocketId.log");
+/// - 若有提供 fixcfg, 則在 Initialize() 之前, 套用 fixcfg->RecorderGroupCommitDelay_, RecorderGroupCommitBytes_;
 /// retval.empty() 成功, retval = 失敗訊息.
-f9tws_API std::string MakeExgTradingLineFixSender(const ExgTradingLineFixArgs& args, fon9::StrView recPath, f9fix::IoFixSenderSP& out);
+f9tws_API std::string MakeExgTradingLineFixSender(const ExgTradingLineFixArgs& args, fon9::StrView recPath, f9fix::IoFixSenderSP& out,
+                                                  const f9fix::FixConfig* fixcfg = nullptr);
 
 //--------------------------------------------------------------------------//
 
@@ -26,7 +26,7 @@ fon9::io::SessionSP ExgTradingLineFixFactory::CreateTradingLine(ExgTradingLineMg
       return fon9::io::SessionSP{};
 
    fon9::fix::IoFixSenderSP fixSender;
-   errReason = MakeExgTradingLineFixSender(args, &fixLogPath, fixSender);
+   errReason = MakeExgTradingLineFixSender(args, &fixLogPath, fixSender, &this->FixConfig_);
    if (!errReason.empty())
       return fon9::io::SessionSP{};
 
@@ -8,6 +8,8 @@ namespace fon9 {
 
 Appender::~Appender() {
 }
+void Appender::PrepareAppendBuffer(BufferList&) {
+}
 void Appender::MakeCallForWork(WorkContentLocker&& lk) {
    if (lk->SetToRinging())
       this->MakeCallNow(std::move(lk));
@@ -53,11 +55,16 @@ bool Appender::WaitConsumed(WorkContentLocker&& locker) {
 
 WorkerState Appender::WorkContentController::TakeCall(Locker&& lk) {
    DcQueueList& workingBuffer = lk->UnsafeWorkingBuffer_;
-   workingBuffer.push_back(std::move(lk->QueuingBuffer_));
-   lk->WorkingNodeCount_ = workingBuffer.GetNodeCount();
+   BufferList   takenBuffer{std::move(lk->QueuingBuffer_)};
+   lk->WorkingNodeCount_ = workingBuffer.GetNodeCount() + takenBuffer.size();
    lk.unlock();
 
-   Appender::StaticCast(*this).ConsumeAppendBuffer(workingBuffer);
+   Appender& appender = Appender::StaticCast(*this);
+   if (!takenBuffer.empty()) {
+      appender.PrepareAppendBuffer(takenBuffer);
+      workingBuffer.push_back(std::move(takenBuffer));
+   }
+   appender.ConsumeAppendBuffer(workingBuffer);
 
    lk.lock();
    lk->WorkingNodeCount_ = workingBuffer.GetNodeCount();
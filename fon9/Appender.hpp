@@ -97,6 +97,12 @@ protected:
    /// 由衍生者實現 Append(buffer);
    virtual void ConsumeAppendBuffer(DcQueueList& buffer) = 0;
 
+   /// 在 ConsumeAppendBuffer() 之前, 於 unlock 狀態, 處理剛從 queue 取出的 buffer.
+   /// - 例: LogFileAppender 在此將 LogBinNode 轉成文字.
+   /// - 因為放入 DcQueueList 時, 前端的控制節點(BufferNodeVirtual)會立即被消費, 所以必須在此處理.
+   /// - 預設: do nothing.
+   virtual void PrepareAppendBuffer(BufferList& buffer);
+
    /// \retval true  必定已將資料寫完, 且 locker 仍在 lock() 狀態.
    /// \retval false 無法執行: 可能正在解構? this thread in Working thread?
    bool WaitFlushed(WorkContentLocker&& locker);
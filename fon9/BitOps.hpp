@@ -0,0 +1,52 @@
+﻿/// \file fon9/BitOps.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_BitOps_hpp__
+#define __fon9_BitOps_hpp__
+#include "fon9/sys/Config.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#pragma intrinsic(_BitScanForward, _BitScanForward64, _BitScanReverse64)
+#endif
+fon9_AFTER_INCLUDE_STD;
+
+namespace fon9 {
+
+/// \ingroup Misc
+/// v != 0: 最低的 1 位元的位置.
+inline unsigned LowestBitIndex(uint32_t v) {
+#ifdef _MSC_VER
+   unsigned long res;
+   _BitScanForward(&res, v);
+   return static_cast<unsigned>(res);
+#else
+   return static_cast<unsigned>(__builtin_ctz(v));
+#endif
+}
+/// \ingroup Misc
+/// v != 0: 最低的 1 位元的位置.
+inline unsigned LowestBitIndex(uint64_t v) {
+#ifdef _MSC_VER
+   unsigned long res;
+   _BitScanForward64(&res, v);
+   return static_cast<unsigned>(res);
+#else
+   return static_cast<unsigned>(__builtin_ctzll(v));
+#endif
+}
+/// \ingroup Misc
+/// v != 0: 最高的 1 位元的位置.
+inline unsigned HighestBitIndex(uint64_t v) {
+#ifdef _MSC_VER
+   unsigned long res;
+   _BitScanReverse64(&res, v);
+   return static_cast<unsigned>(res);
+#else
+   return static_cast<unsigned>(63 - __builtin_clzll(v));
+#endif
+}
+
+} // namespace
+#endif//__fon9_BitOps_hpp__
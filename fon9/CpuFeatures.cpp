@@ -0,0 +1,68 @@
+﻿// \file fon9/CpuFeatures.cpp
+// \author fonwinz@gmail.com
+#include "fon9/CpuFeatures.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <stdint.h>
+#if fon9_HAS_X86_SIMD
+#ifdef _MSC_VER
+   #include <intrin.h>
+   #include <immintrin.h>
+#else
+   #include <cpuid.h>
+#endif
+#endif
+fon9_AFTER_INCLUDE_STD;
+
+namespace fon9 {
+
+#if fon9_HAS_X86_SIMD
+static void CpuId(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#ifdef _MSC_VER
+   int r[4];
+   __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+   for (unsigned L = 0; L < 4; ++L)
+      regs[L] = static_cast<unsigned>(r[L]);
+#else
+   __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+static uint64_t GetXcr0() {
+#ifdef _MSC_VER
+   return _xgetbv(0);
+#else
+   unsigned eax, edx;
+   __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+   return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+static CpuFeatures DetectCpuFeatures() {
+   CpuFeatures res;
+   unsigned    regs[4];
+   CpuId(0, 0, regs);
+   const unsigned maxLeaf = regs[0];
+   if (maxLeaf < 1)
+      return res;
+   CpuId(1, 0, regs);
+   res.Sse41_ = ((regs[2] & (1u << 19)) != 0);
+   const bool isOsXsave = ((regs[2] & (1u << 27)) != 0);
+   const bool isAvx = ((regs[2] & (1u << 28)) != 0);
+   // XCR0: bit 1 = SSE state(xmm), bit 2 = AVX state(ymm).
+   if (maxLeaf >= 7 && isOsXsave && isAvx && (GetXcr0() & 0x06) == 0x06) {
+      CpuId(7, 0, regs);
+      res.Avx2_ = ((regs[1] & (1u << 5)) != 0);
+   }
+   return res;
+}
+#else
+static CpuFeatures DetectCpuFeatures() {
+   return CpuFeatures{};
+}
+#endif
+
+fon9_API const CpuFeatures& GetCpuFeatures() {
+   static const CpuFeatures features = DetectCpuFeatures();
+   return features;
+}
+
+} // namespace
@@ -0,0 +1,100 @@
+﻿/// \file fon9/CpuFeatures.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_CpuFeatures_hpp__
+#define __fon9_CpuFeatures_hpp__
+#include "fon9/sys/Config.hpp"
+
+/// \ingroup Misc
+/// 在 x86/x64 平台, 可以使用 SSE/AVX 指令.
+/// - 編譯時不需要額外的參數(例: -mavx2), 使用 fon9_TARGET_SSE41, fon9_TARGET_AVX2 標示函式,
+///   執行時再根據 GetCpuFeatures() 選擇要呼叫哪個版本.
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+   #define fon9_HAS_X86_SIMD  1
+   #define fon9_TARGET_SSE41
+   #define fon9_TARGET_AVX2
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+   #define fon9_HAS_X86_SIMD  1
+   #define fon9_TARGET_SSE41  __attribute__((target("sse4.1")))
+   #define fon9_TARGET_AVX2   __attribute__((target("avx2")))
+#else
+   #define fon9_HAS_X86_SIMD  0
+#endif
+
+/// x64 必定支援 SSE2, 可以直接使用(不需要 fon9_TARGET_*, 也可以 inline);
+/// i386 則需要在編譯時啟用 SSE2(例: -msse2, /arch:SSE2).
+#if fon9_HAS_X86_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+   #define fon9_HAS_SSE2   1
+#else
+   #define fon9_HAS_SSE2   0
+#endif
+
+namespace fon9 {
+
+/// \ingroup Misc
+/// 執行時的 CPU 支援的指令集.
+/// 除了 CPU 本身的支援, AVX2 還需要 OS 支援(儲存 ymm 暫存器), 這裡已一併檢查.
+struct CpuFeatures {
+   bool  Sse41_{false};
+   bool  Avx2_{false};
+};
+
+/// \ingroup Misc
+/// 第一次呼叫時偵測, 之後傳回相同的結果.
+fon9_API const CpuFeatures& GetCpuFeatures();
+
+/// \ingroup Misc
+/// 根據 CPU 支援的指令集, 選擇實作方式(kernel)的共用機制.
+/// Traits 必須提供:
+/// - `using Kernel = ...;` enum class: 數值越大越快, 數值 0(Scalar) 必定可用.
+/// - `using Fn = ...;` kernel 對應的函式(或函式表).
+/// - `static constexpr Kernel kDefaultMax = ...;` 預設 kernel 的上限.
+/// - `static bool IsSupported(Kernel kernel);` CPU(及編譯環境) 是否支援 kernel.
+/// - `static Fn GetFn(Kernel kernel);`
+///
+/// 在第一次使用時(function-local static)才選擇預設的 kernel,
+/// 所以在其他 static 物件的建構期間使用也是安全的.
+template <class Traits>
+class CpuKernelSelector {
+public:
+   using Kernel = typename Traits::Kernel;
+   using Fn = typename Traits::Fn;
+
+   static Kernel GetKernel() {
+      return Selected().Kernel_;
+   }
+   static Fn GetFn() {
+      return Selected().Fn_;
+   }
+   /// 通常用於測試、效能評估.
+   /// \retval false CPU 不支援, 維持原本的設定.
+   static bool SetKernel(Kernel kernel) {
+      if (!Traits::IsSupported(kernel))
+         return false;
+      Selection& sel = Selected();
+      sel.Kernel_ = kernel;
+      sel.Fn_ = Traits::GetFn(kernel);
+      return true;
+   }
+
+private:
+   struct Selection {
+      Kernel   Kernel_;
+      Fn       Fn_;
+   };
+   static Selection& Selected() {
+      static Selection sel = MakeDefault();
+      return sel;
+   }
+   /// 從 Traits::kDefaultMax 往下, 選擇第一個支援的 kernel.
+   static Selection MakeDefault() {
+      using Underlying = typename std::underlying_type<Kernel>::type;
+      Underlying k = static_cast<Underlying>(Traits::kDefaultMax);
+      while (k > 0 && !Traits::IsSupported(static_cast<Kernel>(k)))
+         --k;
+      const Kernel kernel = static_cast<Kernel>(k);
+      return Selection{kernel, Traits::GetFn(kernel)};
+   }
+};
+
+} // namespace
+#endif//__fon9_CpuFeatures_hpp__
@@ -100,8 +100,8 @@ File File::Duplicate() const {
    return fdup;
 }
 
-void File::Sync() {
-   FlushFileBuffers(this->Fdr_.GetFD());
+File::Result File::Sync() {
+   return SyncFile(this->Fdr_.GetFD());
 }
 
 File::Result File::GetFileSize() const {
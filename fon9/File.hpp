@@ -169,7 +169,8 @@ public:
    /// 可參閱:
    /// - Linux: fdatasync
    /// - Windows: FlushFileBuffers
-   void Sync();
+   /// \retval 成功 Result{0}.
+   Result Sync();
 
    /// 讀取一個區塊.
    /// 只要不在其他 thread 執行 Open(), Close(), 則可確保正確讀取.
@@ -2,6 +2,7 @@
 /// \author fonwinz@gmail.com
 #include "fon9/FileAppender.hpp"
 #include "fon9/DefaultThreadPool.hpp"
+#include "fon9/Timer.hpp"
 
 namespace fon9 {
 
@@ -84,13 +85,122 @@ public:
    static void AddNode(FileAppender& owner, TimeStamp tm) {
       owner.Append(base::Alloc<NodeCheckRotateTime>(0, &owner, tm));
    }
+   static void AddNode(FileAppender& owner, TimeStamp tm, BufferList& outbuf) {
+      outbuf.push_back(base::Alloc<NodeCheckRotateTime>(0, &owner, tm));
+   }
+};
+
+//--------------------------------------------------------------------------//
+
+/// 持久化通知失敗: 每個通知節點都觸發 OnBufferConsumedErr();
+/// 不能使用 BufferListConsumeErr(): 因為 DcQueueList 建構時, 會對前端的控制節點觸發 OnBufferConsumed();
+static void DurableNotifyErr(BufferList&& notify, const ErrC& errc) {
+   while (BufferNode* node = notify.pop_front()) {
+      if (BufferNodeVirtual* vnode = BufferNodeVirtual::CastFrom(node))
+         vnode->OnBufferConsumedErr(errc);
+      FreeNode(node);
+   }
+}
+
+/// 在此節點之前的資料都寫入後, 將 Notify_ 移到 FileAppender::PendingDurable_, 等 Sync() 之後再通知.
+struct FileAppender::NodeDurable : public BufferNodeVirtual {
+   fon9_NON_COPY_NON_MOVE(NodeDurable);
+   using base = BufferNodeVirtual;
+   friend class BufferNode;// for BufferNode::Alloc();
+   using base::base;
+   FileAppender*        FileAppender_;
+   BufferNodeVirtual*   Notify_;
+protected:
+   NodeDurable(BufferNodeSize blockSize, FileAppender* owner, BufferNodeVirtual* notify)
+      : base(blockSize, StyleFlag{})
+      , FileAppender_(owner)
+      , Notify_{notify} {
+   }
+   ~NodeDurable() {
+      if (this->Notify_) // 沒有經過 OnBufferConsumed() 就被釋放了?
+         this->NotifyErr(std::errc::operation_canceled);
+   }
+   virtual void OnBufferConsumed() override {
+      this->FileAppender_->PendingDurable_.push_back(this->Notify_);
+      this->Notify_ = nullptr;
+   }
+   virtual void OnBufferConsumedErr(const ErrC& errc) override {
+      this->NotifyErr(errc);
+   }
+   void NotifyErr(const ErrC& errc) {
+      BufferList notify;
+      notify.push_back(this->Notify_);
+      this->Notify_ = nullptr;
+      DurableNotifyErr(std::move(notify), errc);
+   }
+public:
+   static NodeDurable* Alloc(FileAppender& owner, BufferNodeVirtual* notify) {
+      assert(notify != nullptr);
+      return base::Alloc<NodeDurable>(0, &owner, notify);
+   }
+};
+
+/// 由 GroupCommit::Timer_ 加入, 只是為了觸發 ConsumeAppendBuffer(), 在 Worker 裡面檢查是否需要 Sync();
+struct FileAppender::NodeGroupCommit : public BufferNodeVirtual {
+   fon9_NON_COPY_NON_MOVE(NodeGroupCommit);
+   using base = BufferNodeVirtual;
+   friend class BufferNode;// for BufferNode::Alloc();
+   using base::base;
+protected:
+   NodeGroupCommit(BufferNodeSize blockSize)
+      : base(blockSize, StyleFlag::AllowCrossing) {
+   }
+   virtual void OnBufferConsumed() override {
+   }
+   virtual void OnBufferConsumedErr(const ErrC&) override {
+   }
+public:
+   static void AddNode(FileAppender& owner) {
+      owner.Append(base::Alloc<NodeGroupCommit>(0));
+   }
+};
+
+struct FileAppender::GroupCommit {
+   fon9_NON_COPY_NON_MOVE(GroupCommit);
+   FileAppender&  Owner_;
+   TimeInterval   MaxDelay_;
+   size_t         MaxBytes_;
+   /// 尚未 Sync() 的資料量, 及這些資料中第一次寫入的時間.
+   size_t         UnsyncedSize_{0};
+   TimeStamp      UnsyncedTime_;
+   /// 計時器已設定的到期時間, 避免每次寫入都重新設定計時器.
+   TimeStamp      TimerAt_;
+
+   static void EmitOnTimer(TimerEntry* timer, TimeStamp now) {
+      (void)now;
+      GroupCommit& rthis = ContainerOf(*static_cast<decltype(GroupCommit::Timer_)*>(timer), &GroupCommit::Timer_);
+      NodeGroupCommit::AddNode(rthis.Owner_);
+   }
+   DataMemberEmitOnTimer<&GroupCommit::EmitOnTimer> Timer_;
+
+   GroupCommit(FileAppender& owner, TimeInterval maxDelay, size_t maxBytes)
+      : Owner_(owner)
+      , MaxDelay_{maxDelay}
+      , MaxBytes_{maxBytes} {
+   }
+   ~GroupCommit() {
+      this->Timer_.DisposeAndWait();
+   }
 };
 fon9_WARN_POP;
 
 //--------------------------------------------------------------------------//
 
+FileAppender::FileAppender() {
+}
+FileAppender::FileAppender(FileMode fm) : File_{fm | FileMode::Append} {
+}
 FileAppender::~FileAppender() {
+   this->DisposeGroupCommit();
    this->Worker_.TakeCall();
+   // 解構前, 確保已寫入的資料都 Sync(), 並通知尚未完成的持久化要求.
+   if (!this->PendingDurable_.empty() || (this->GroupCommit_ && this->GroupCommit_->UnsyncedSize_ > 0))
+      this->SyncPendingDurable();
 }
 FileAppender::OpenResult FileAppender::OpenAsync(std::string fname, FileMode fmode) {
    return NodeReopen::AddNode(*this, std::move(fname), fmode);
@@ -106,13 +216,82 @@ void FileAppender::CheckRotateTime(TimeStamp tm) {
    if (this->RotateTimeChecker_.CheckTime(tm))
       NodeCheckRotateTime::AddNode(*this, tm);
 }
+void FileAppender::CheckRotateTime(TimeStamp tm, BufferList& outbuf) {
+   if (this->RotateTimeChecker_.CheckTime(tm))
+      NodeCheckRotateTime::AddNode(*this, tm, outbuf);
+}
+
+void FileAppender::SetGroupCommit(TimeInterval maxDelay, size_t maxBytes) {
+   if (maxDelay.GetOrigValue() <= 0)
+      this->GroupCommit_.reset();
+   else
+      this->GroupCommit_.reset(new GroupCommit{*this, maxDelay, maxBytes});
+}
+void FileAppender::DisposeGroupCommit() {
+   if (this->GroupCommit_)
+      this->GroupCommit_->Timer_.DisposeAndWait();
+}
+void FileAppender::AddDurableNotify(BufferNodeVirtual* notify) {
+   this->Append(NodeDurable::Alloc(*this, notify));
+}
+void FileAppender::AddDurableNotify(BufferNodeVirtual* notify, BufferList& outbuf) {
+   outbuf.push_back(NodeDurable::Alloc(*this, notify));
+}
+void FileAppender::SyncPendingDurable() {
+   const Result res = this->File_.Sync();
+   if (this->GroupCommit_)
+      this->GroupCommit_->UnsyncedSize_ = 0;
+   if (this->PendingDurable_.empty())
+      return;
+   if (res) // DcQueueList 建構時, 會觸發前端控制節點的 OnBufferConsumed();
+      DcQueueList{std::move(this->PendingDurable_)};
+   else // Sync() 失敗, 無法確定資料已持久化.
+      DurableNotifyErr(std::move(this->PendingDurable_), res.GetError());
+}
+void FileAppender::CheckGroupCommit(size_t wrsz) {
+   GroupCommit* gc = this->GroupCommit_.get();
+   if (gc == nullptr) {
+      // 沒有啟用 group commit: 有持久化要求時, 立即 Sync();
+      if (!this->PendingDurable_.empty())
+         this->SyncPendingDurable();
+      return;
+   }
+   if (wrsz > 0) {
+      if (gc->UnsyncedSize_ == 0)
+         gc->UnsyncedTime_ = UtcNow();
+      gc->UnsyncedSize_ += wrsz;
+   }
+   if (gc->UnsyncedSize_ == 0) {
+      // 之前寫入的資料都已 Sync(), 可直接通知.
+      if (!this->PendingDurable_.empty())
+         DcQueueList{std::move(this->PendingDurable_)};
+      return;
+   }
+   const TimeStamp syncAt = gc->UnsyncedTime_ + gc->MaxDelay_;
+   if ((gc->MaxBytes_ > 0 && gc->UnsyncedSize_ >= gc->MaxBytes_) || UtcNow() >= syncAt) {
+      this->SyncPendingDurable();
+      return;
+   }
+   if (gc->TimerAt_ != syncAt) {
+      gc->TimerAt_ = syncAt;
+      gc->Timer_.RunAt(syncAt);
+   }
+}
 
 bool FileAppender::MakeCallNow(WorkContentLocker&& lk) {
    this->Worker_.TakeCallLocked(std::move(lk));
    return true;
 }
 void FileAppender::ConsumeAppendBuffer(DcQueueList& buffer) {
-   this->File_.Append(buffer);
+   if (fon9_LIKELY(!this->GroupCommit_)) {
+      this->File_.Append(buffer);
+      this->CheckGroupCommit(0);
+   }
+   else {
+      const size_t bufsz = buffer.CalcSize();
+      this->File_.Append(buffer);
+      this->CheckGroupCommit(bufsz - buffer.CalcSize());
+   }
    if (this->FileRotate_ && this->FileRotate_->IsCheckFileSizeRequired()) {
       if (Result fsz = this->File_.GetFileSize())
          if (const std::string* newfn = FileRotate_->CheckFileSize(fsz.GetResult()))
@@ -122,6 +301,9 @@ void FileAppender::ConsumeAppendBuffer(DcQueueList& buffer) {
 File::Result FileAppender::CheckRotateReopen(std::string newfn, FileMode fmode) {
    if (this->File_.IsOpened() && this->File_.GetOpenName() == newfn)
       return File::Result{0};
+   // 換檔前, 舊檔已寫入的資料必須先 Sync(), 才能通知持久化要求.
+   if (this->File_.IsOpened() && (this->GroupCommit_ || !this->PendingDurable_.empty()))
+      this->SyncPendingDurable();
    File  newfd;
    for (;;) {
       Result openResult = newfd.Open(newfn, fmode);
@@ -149,6 +331,7 @@ AsyncFileAppender::~AsyncFileAppender() {
    this->DisposeAsync();
 }
 void AsyncFileAppender::DisposeAsync() {
+   this->DisposeGroupCommit();
    this->Worker_.Dispose();
 }
 bool AsyncFileAppender::MakeCallNow(WorkContentLocker&& lk) {
@@ -50,15 +50,28 @@ using FileRotateSP = std::unique_ptr<FileRotate>;
 /// \ingroup Misc
 /// - 當收到 Append() 要求時, 立即寫檔.
 /// - 如果同時有多個 thread 呼叫 Append(); 則可能會集中在第一個呼叫 Append() 的 thread 寫檔.
+/// - 持久化(Sync)通知: AddDurableNotify(); 在之前的資料寫入且 Sync() 之後, 才通知呼叫端.
+///   - 預設: 每次 ConsumeAppendBuffer() 有持久化要求時, 寫完就立即 Sync().
+///   - SetGroupCommit(): 集中 Sync(), 在資料寫入後最多 maxDelay 或累積 maxBytes, 才執行一次 Sync().
 class fon9_API FileAppender : public Appender {
    fon9_NON_COPY_NON_MOVE(FileAppender);
    FileRotateSP   FileRotate_;
    TimeChecker    RotateTimeChecker_;
    File           File_;
+   /// 資料已寫入, 但尚未 Sync() 的持久化通知節點.
+   BufferList     PendingDurable_;
 
    struct NodeReopen;
    struct NodeCheckRotateTime;
+   struct NodeDurable;
+   struct NodeGroupCommit;
+   struct GroupCommit;
+   std::unique_ptr<GroupCommit>  GroupCommit_;
+
    File::Result CheckRotateReopen(std::string newfn, FileMode fmode);
+   /// 在 ConsumeAppendBuffer() 寫入 wrsz 之後, 檢查是否需要 Sync();
+   void CheckGroupCommit(size_t wrsz);
+   void SyncPendingDurable();
 protected:
    /// fd 不一定開檔成功, 若失敗, 則可從 openResult 取得原因.
    /// 預設: 不論 fd 是否有開檔成功, 一律 std::swap(this->File_, fd); 並返回 &this->File_;
@@ -66,6 +79,8 @@ protected:
    /// 預設為同步模式: 立即呼叫 TakeCall(); 並返回 true.
    virtual bool MakeCallNow(WorkContentLocker&& lk) override;
    virtual void ConsumeAppendBuffer(DcQueueList& buffer) override;
+   /// 停止 group commit 的計時器, 解構前(或停止 Async 時)必須呼叫.
+   void DisposeGroupCommit();
 
    const TimeChecker& GetRotateTimeChecker() const {
       return this->RotateTimeChecker_;
@@ -82,9 +97,8 @@ public:
    using SizeType = File::SizeType;
    using PosType = File::PosType;
 
-   FileAppender() = default;
-   FileAppender(FileMode fm) : File_{fm | FileMode::Append} {
-   }
+   FileAppender();
+   FileAppender(FileMode fm);
 
    /// 解構時, 如果 Worker_ 的狀態不是 WorkerState::Disposed 則:
    /// 寫入剩餘的資料, 避免資料遺失.
@@ -102,6 +116,24 @@ public:
    }
 
    void CheckRotateTime(TimeStamp tm);
+   /// 與 CheckRotateTime(tm) 相同, 但換檔檢查節點放到 outbuf 尾端(不會 Append()),
+   /// 由呼叫端與其他資料一起 Append(), 讓換檔的時機與資料的順序一致.
+   void CheckRotateTime(TimeStamp tm, BufferList& outbuf);
+
+   /// 啟用 group commit: 資料寫入後, 最多經過 maxDelay, 或尚未 Sync() 的資料量 >= maxBytes, 就執行一次 Sync();
+   /// - maxDelay <= 0: 取消 group commit, 回到預設: 有持久化要求時, 寫完就立即 Sync().
+   /// - maxBytes == 0: 不檢查資料量, 僅使用 maxDelay.
+   /// - 啟用後, 所有寫入的資料(不論是否有持久化要求)都會在 maxDelay 之內 Sync().
+   /// - 應在開始寫入前設定, 之後不可再改變.
+   void SetGroupCommit(TimeInterval maxDelay, size_t maxBytes);
+   /// 在之前 Append() 的資料都寫入檔案, 並且 Sync() 之後, 觸發 notify->OnBufferConsumed();
+   /// - 若寫檔失敗、Sync() 失敗(或 this 解構時仍未寫入), 則觸發 notify->OnBufferConsumedErr();
+   /// - notify 必須使用 BufferNode::Alloc<>() 建立, 通知後由 this 負責釋放.
+   /// - 例: FixSender 送出訊息後, 等訊息確實寫入磁碟, 才回覆 ack.
+   void AddDurableNotify(BufferNodeVirtual* notify);
+   /// 與 AddDurableNotify(notify) 相同, 但通知節點放到 outbuf 尾端(不會 Append()),
+   /// 由呼叫端與其他資料一起 Append();
+   void AddDurableNotify(BufferNodeVirtual* notify, BufferList& outbuf);
 
    void Close() {
       this->WaitFlushed();
@@ -141,7 +173,7 @@ protected:
    using base::base;
    AsyncFileAppender() = default;
 
-   /// 停止 Async: 把狀態設為 WorkerState::Disposing;
+   /// 停止 Async: 停止 group commit 計時器, 並把狀態設為 WorkerState::Disposing;
    virtual void DisposeAsync();
 
    /// 返回前 lk 可能已經 unlock().
@@ -0,0 +1,123 @@
+﻿/// \file fon9/LatencyHistogram.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_LatencyHistogram_hpp__
+#define __fon9_LatencyHistogram_hpp__
+#include "fon9/RevPrint.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <atomic>
+#include <chrono>
+fon9_AFTER_INCLUDE_STD;
+
+namespace fon9 {
+
+/// \ingroup Misc
+/// 以 2 的次方分組的延遲統計(單位: ns).
+/// - Buckets_[0] = 小於 2ns; Buckets_[i] = [2^i .. 2^(i+1)) ns; 最後一組包含全部更大的值.
+/// - Add() 可在任意 thread 呼叫(relaxed atomic), 不會有 lock, 適合放在 thread 迴圈內.
+/// - 讀取(RevPrint, GetPercentile)時不保證各欄位為同一瞬間的值, 僅供觀察調校使用.
+class LatencyHistogram {
+   fon9_NON_COPY_NON_MOVE(LatencyHistogram);
+public:
+   enum : unsigned { kBucketCount = 40 };
+   using Counter = std::atomic<uint64_t>;
+
+   LatencyHistogram() {
+      this->Clear();
+   }
+
+   static uint64_t NowNS() {
+      using namespace std::chrono;
+      return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+   }
+   static unsigned ToBucketIndex(uint64_t ns) {
+      unsigned idx = 0;
+      while ((ns >>= 1) != 0)
+         ++idx;
+      return idx < kBucketCount ? idx : (kBucketCount - 1);
+   }
+   /// Buckets_[idx] 的上限(不含).
+   static uint64_t BucketUpperNS(unsigned idx) {
+      return static_cast<uint64_t>(1) << (idx + 1);
+   }
+
+   void Add(uint64_t ns) {
+      this->Buckets_[ToBucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+      this->Count_.fetch_add(1, std::memory_order_relaxed);
+      this->SumNS_.fetch_add(ns, std::memory_order_relaxed);
+      uint64_t maxns = this->MaxNS_.load(std::memory_order_relaxed);
+      while (maxns < ns && !this->MaxNS_.compare_exchange_weak(maxns, ns, std::memory_order_relaxed)) {
+      }
+   }
+   /// 加入 (NowNS() - startNS) 的延遲.
+   void AddSince(uint64_t startNS) {
+      const uint64_t now = NowNS();
+      this->Add(now > startNS ? (now - startNS) : 0);
+   }
+   void Clear() {
+      for (Counter& c : this->Buckets_)
+         c.store(0, std::memory_order_relaxed);
+      this->Count_.store(0, std::memory_order_relaxed);
+      this->SumNS_.store(0, std::memory_order_relaxed);
+      this->MaxNS_.store(0, std::memory_order_relaxed);
+   }
+
+   uint64_t GetCount() const {
+      return this->Count_.load(std::memory_order_relaxed);
+   }
+   uint64_t GetMaxNS() const {
+      return this->MaxNS_.load(std::memory_order_relaxed);
+   }
+   uint64_t GetAvgNS() const {
+      const uint64_t count = this->GetCount();
+      return count ? (this->SumNS_.load(std::memory_order_relaxed) / count) : 0;
+   }
+   uint64_t GetBucket(unsigned idx) const {
+      return this->Buckets_[idx].load(std::memory_order_relaxed);
+   }
+   /// 傳回 permille(千分比, 例: 500=p50, 990=p99, 999=p99.9) 所在分組的上限(ns).
+   /// 若沒有任何資料, 則傳回 0.
+   uint64_t GetPercentileNS(unsigned permille) const {
+      const uint64_t count = this->GetCount();
+      if (count == 0)
+         return 0;
+      const uint64_t target = (count * permille + 999) / 1000;
+      uint64_t sum = 0;
+      for (unsigned L = 0; L < kBucketCount; ++L) {
+         if ((sum += this->GetBucket(L)) >= target)
+            return BucketUpperNS(L);
+      }
+      return BucketUpperNS(kBucketCount - 1);
+   }
+
+   /// 輸出格式: "Count=n|AvgNS=n|MaxNS=n|p50NS=n|p99NS=n|p999NS=n|Buckets=upper:count,upper:count..."
+   /// Buckets 只輸出 count != 0 的分組.
+   friend inline void RevPrint(RevBuffer& rbuf, const LatencyHistogram& h) {
+      bool isFirst = true;
+      for (unsigned L = kBucketCount; L > 0;) {
+         const uint64_t c = h.GetBucket(--L);
+         if (c == 0)
+            continue;
+         if (!isFirst)
+            RevPrint(rbuf, ',');
+         isFirst = false;
+         RevPrint(rbuf, BucketUpperNS(L), ':', c);
+      }
+      RevPrint(rbuf, "Count=", h.GetCount(),
+               "|AvgNS=", h.GetAvgNS(),
+               "|MaxNS=", h.GetMaxNS(),
+               "|p50NS=", h.GetPercentileNS(500),
+               "|p99NS=", h.GetPercentileNS(990),
+               "|p999NS=", h.GetPercentileNS(999),
+               "|Buckets=");
+   }
+
+private:
+   Counter  Buckets_[kBucketCount];
+   Counter  Count_;
+   Counter  SumNS_;
+   Counter  MaxNS_;
+};
+
+} // namespace
+#endif//__fon9_LatencyHistogram_hpp__
@@ -22,6 +22,7 @@ fon9_API const LogLevelText  CstrLevelMap[static_cast<int>(LogLevel::Count) + 1]
 static void LogWriteToStdout(const LogArgs& /*logArgs*/, BufferList&& buf) {
    if (buf.empty())
       return;
+   LogBinRender(buf);
    DcQueueList dcQueue{std::move(buf)};
    for (;;) {
       const auto  mem{dcQueue.PeekCurrBlock()};
@@ -42,14 +43,40 @@ static FnLogWriter      FnLogWriter_ = &LogWriteToStdout;
 static TimeZoneOffset   LogTimeZoneAdjust_;
 void (*gWaitLogSystemReady)();
 
-fon9_API void SetLogWriter(FnLogWriter fnLogWriter, TimeZoneOffset tzadj) {
-   FnLogWriter_ = fnLogWriter ? fnLogWriter : &LogWriteToStdout;
+// 預設的 LogWriteToStdout() 支援 LogBin.
+static bool IsLogWriterBinSupported_{true};
+static bool LogBinMode_{false};
+// 曾經啟用過 LogBin: 在 LogBinRender() 才需要檢查是否有 LogBinNode.
+static bool LogBinUsed_{false};
+fon9_API bool LogBinActive_{false};
+
+static void UpdateLogBinActive() {
+   if ((LogBinActive_ = (LogBinMode_ && IsLogWriterBinSupported_)) == true)
+      LogBinUsed_ = true;
+}
+fon9_API void SetLogBinMode(bool isEnabled) {
+   LogBinMode_ = isEnabled;
+   UpdateLogBinActive();
+}
+
+fon9_API void SetLogWriter(FnLogWriter fnLogWriter, TimeZoneOffset tzadj, bool isLogBinSupported) {
+   if (fnLogWriter) {
+      FnLogWriter_ = fnLogWriter;
+      IsLogWriterBinSupported_ = isLogBinSupported;
+   }
+   else {
+      FnLogWriter_ = &LogWriteToStdout;
+      IsLogWriterBinSupported_ = true;
+   }
    LogTimeZoneAdjust_ = tzadj;
+   UpdateLogBinActive();
 }
 fon9_API void UnsetLogWriter(FnLogWriter fnLogWriter) {
    if (FnLogWriter_ == fnLogWriter) {
       FnLogWriter_ = &LogWriteToStdout;
+      IsLogWriterBinSupported_ = true;
       LogTimeZoneAdjust_ = TimeZoneOffset{};
+      UpdateLogBinActive();
    }
 }
 
@@ -61,10 +88,111 @@ fon9_API void AddLogHeader(RevBufferList& rbuf, TimeStamp utctm, LogLevel level)
    RevPrint(rbuf, ThisThread_.GetThreadIdStr(), GetLevelStr(level));
    RevPut_Date_Time_us(rbuf, utctm + LogTimeZoneAdjust_);
 }
+
+// LogWriter 沒有呼叫 LogBinRender() 而被拋棄的 LogBinNode 數量, 及已寫入 "Log.BinDropped|dropped=" 的數量.
+static std::atomic<uint64_t> LogBinDropped_{0};
+static std::atomic<uint64_t> LogBinDroppedReported_{0};
+fon9_API uint64_t GetLogBinDroppedCount() {
+   return LogBinDropped_.load(std::memory_order_relaxed);
+}
+/// 若有新的 LogBinNode 被拋棄, 則寫入一筆(不使用 LogBin 的)文字訊息.
+static void CheckLogBinDropped() {
+   const uint64_t dropped = LogBinDropped_.load(std::memory_order_relaxed);
+   uint64_t       reported = LogBinDroppedReported_.load(std::memory_order_relaxed);
+   if (fon9_LIKELY(dropped == reported))
+      return;
+   if (!LogBinDroppedReported_.compare_exchange_strong(reported, dropped, std::memory_order_relaxed))
+      return;
+   LogArgs        logArgs{LogLevel::Warn};
+   RevBufferList  rbuf{kLogBlockNodeSize};
+   RevPrint(rbuf, "Log.BinDropped|dropped=", dropped - reported, "|total=", dropped, '\n');
+   AddLogHeader(rbuf, logArgs.UtcTime_, logArgs.Level_);
+   FnLogWriter_(logArgs, rbuf.MoveOut());
+}
+
 fon9_API void LogWrite(LogLevel level, RevBufferList&& rbuf) {
    LogArgs logArgs{level};
    AddLogHeader(rbuf, logArgs.UtcTime_, level);
    FnLogWriter_(logArgs, rbuf.MoveOut());
+   if (fon9_UNLIKELY(LogBinUsed_))
+      CheckLogBinDropped();
+}
+
+//--------------------------------------------------------------------------//
+
+LogBinNode::LogBinNode(BufferNodeSize blockSize, LogLevel level, FnLogBinRender fnRender)
+   : base(blockSize, StyleFlag::AllowCrossing)
+   , LogArgs_{level}
+   , FnRender_{fnRender}
+   , ThreadId_(ThisThread_) {
+}
+LogBinNode::~LogBinNode() {
+   // 沒有轉成文字: LogWriter 沒有呼叫 LogBinRender() 就消費(或直接釋放)了 this, 此筆訊息不會輸出:
+   // 計入 GetLogBinDroppedCount(), 之後的 LogWrite() 會補寫一筆 "Log.BinDropped|dropped=" 訊息.
+   if (fon9_UNLIKELY(!this->IsRendered_))
+      LogBinDropped_.fetch_add(1, std::memory_order_relaxed);
+}
+void LogBinNode::OnBufferConsumed() {
+   // 若到達此處, 表示 LogWriter 沒有呼叫 LogBinRender(), 在解構時計入 GetLogBinDroppedCount().
+}
+void LogBinNode::OnBufferConsumedErr(const ErrC&) {
+}
+LogBinNode* LogBinNode::Alloc(LogLevel level, FnLogBinRender fnRender, size_t argsSize) {
+   // 太大的訊息(例: 很長的字串), 直接在呼叫端格式化, 避免單一節點過大.
+   if (fon9_UNLIKELY(argsSize > 1024 * 16))
+      return nullptr;
+   return base::Alloc<LogBinNode>(argsSize, level, fnRender);
+}
+LogBinNode* LogBinNode::CastFrom(BufferNode* node) {
+   if (BufferNodeVirtual* vnode = BufferNodeVirtual::CastFrom(node))
+      return dynamic_cast<LogBinNode*>(vnode);
+   return nullptr;
+}
+void LogBinNode::RenderTo(RevBufferList& rbuf) {
+   this->IsRendered_ = true;
+   RevPutChar(rbuf, '\n');
+   this->FnRender_(rbuf, this->GetArgsBuffer());
+   RevPrint(rbuf, this->ThreadId_.GetThreadIdStr(), GetLevelStr(this->LogArgs_.Level_));
+   RevPut_Date_Time_us(rbuf, this->LogArgs_.UtcTime_ + LogTimeZoneAdjust_);
+}
+
+// 連續的 LogBinNode 從後往前, 轉成文字放入同一個 RevBufferList, 減少輸出節點的數量.
+static void LogBinRenderRun(BufferList& out, std::vector<LogBinNode*>& bins) {
+   if (bins.empty())
+      return;
+   RevBufferList rbuf{kLogBlockNodeSize * 8};
+   for (size_t L = bins.size(); L > 0;) {
+      LogBinNode* bin = bins[--L];
+      bin->RenderTo(rbuf);
+      FreeNode(bin);
+   }
+   bins.clear();
+   out.push_back(rbuf.MoveOut());
+}
+fon9_API void LogBinRender(BufferList& buf) {
+   if (!LogBinUsed_)
+      return;
+   BufferList                 out;
+   std::vector<LogBinNode*>   bins;
+   while (BufferNode* node = buf.pop_front()) {
+      if (LogBinNode* bin = LogBinNode::CastFrom(node))
+         bins.push_back(bin);
+      else {
+         LogBinRenderRun(out, bins);
+         out.push_back(node);
+      }
+   }
+   LogBinRenderRun(out, bins);
+   buf.push_back(std::move(out));
+}
+fon9_API void LogWrite(LogBinNode* node) {
+   {
+      const LogArgs  logArgs{node->LogArgs_};
+      BufferList     buf;
+      buf.push_back(node);
+      FnLogWriter_(logArgs, std::move(buf));
+   } // 若 LogWriter 沒有取走 buf, 則在此釋放 node, 之後的 CheckLogBinDropped() 才能立即發現.
+   CheckLogBinDropped();
 }
 
 fon9_API void WaitLogFlush() {
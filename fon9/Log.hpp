@@ -5,6 +5,11 @@
 #include "fon9/RevFormat.hpp"
 #include "fon9/TimeStamp.hpp"
 #include "fon9/buffer/RevBufferList.hpp"
+#include "fon9/ThreadId.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <tuple>
+fon9_AFTER_INCLUDE_STD;
 
 namespace fon9 {
 
@@ -69,8 +74,10 @@ typedef void (*FnLogWriter) (const LogArgs& logArgs, BufferList&& buf);
 /// \ingroup Misc
 /// 設定 Log 訊息的最後寫入函式, 預設: 寫到 stdout(預設值不是 thread safe: 可能會 interlace)
 /// 如果 fnLogWriter = nullptr 則還原為預設 stdout 輸出.
+/// \param isLogBinSupported fnLogWriter 是否支援 LogBinNode(延後格式化), 請參考 SetLogBinMode();
+///   若支援, 則 fnLogWriter 在寫入前(或在寫檔 thread), 必須透過 LogBinRender() 將 LogBinNode 轉成文字.
 /// NOT thread safe!
-fon9_API void SetLogWriter(FnLogWriter fnLogWriter, TimeZoneOffset tzadj);
+fon9_API void SetLogWriter(FnLogWriter fnLogWriter, TimeZoneOffset tzadj, bool isLogBinSupported = false);
 /// \ingroup Misc
 /// 如果現在的 LogWriter == fnLogWriter, 則還原成預設值: 寫到 stdout.
 fon9_API void UnsetLogWriter(FnLogWriter fnLogWriter);
@@ -91,6 +98,253 @@ fon9_API void WaitLogFlush();
 enum {
    kLogBlockNodeSize = 128 + sizeof(fon9::NumOutBuf),
 };
+
+//--------------------------------------------------------------------------//
+
+/// \ingroup Misc
+/// 支援延後格式化(LogBin)的參數型別, 預設為不支援.
+/// 支援的型別必須提供:
+/// - `enum : bool { IsSupported = true };`
+/// - `using Value = 解碼後的型別;` 用來呼叫 RevPrint(rbuf, value);
+/// - `static size_t Size(const T& v);`      v 需要的空間.
+/// - `static byte* Put(byte* p, const T& v);` 將 v 的內容複製到 p, 傳回下一個位置.
+/// - `static Value Get(const byte*& p);`      從 p 取出 Value, 並將 p 移到下一個位置.
+template <class T, class Enable = void>
+struct LogBinArg {
+   enum : bool { IsSupported = false };
+};
+
+/// \ingroup Misc
+/// 直接複製記憶體內容的 LogBinArg.
+template <class T>
+struct LogBinArgPod {
+   enum : bool { IsSupported = true };
+   using Value = T;
+   static size_t Size(const T&) {
+      return sizeof(T);
+   }
+   static byte* Put(byte* p, const T& v) {
+      memcpy(p, &v, sizeof(T));
+      return p + sizeof(T);
+   }
+   static Value Get(const byte*& p) {
+      Value v;
+      memcpy(&v, p, sizeof(T));
+      p += sizeof(T);
+      return v;
+   }
+};
+template <class T>
+struct LogBinArg<T, enable_if_t<std::is_arithmetic<T>::value || std::is_enum<T>::value>> : public LogBinArgPod<T> {
+};
+template <typename IntTypeT, DecScaleT ScaleN>
+struct LogBinArg<Decimal<IntTypeT, ScaleN>> : public LogBinArgPod<Decimal<IntTypeT, ScaleN>> {
+};
+template <>
+struct LogBinArg<TimeInterval> : public LogBinArgPod<TimeInterval> {
+};
+template <>
+struct LogBinArg<TimeStamp> : public LogBinArgPod<TimeStamp> {
+};
+
+/// \ingroup Misc
+/// 字串: 複製字串內容(不論來源是否為常數), 解碼後為 StrView.
+struct LogBinArgStr {
+   enum : bool { IsSupported = true };
+   using Value = StrView;
+   static size_t Size(StrView v) {
+      return sizeof(uint32_t) + v.size();
+   }
+   static byte* Put(byte* p, StrView v) {
+      const uint32_t sz = static_cast<uint32_t>(v.size());
+      memcpy(p, &sz, sizeof(sz));
+      memcpy(p += sizeof(sz), v.begin(), sz);
+      return p + sz;
+   }
+   static Value Get(const byte*& p) {
+      uint32_t sz;
+      memcpy(&sz, p, sizeof(sz));
+      const char* pstr = reinterpret_cast<const char*>(p + sizeof(sz));
+      p += sizeof(sz) + sz;
+      return StrView{pstr, sz};
+   }
+};
+template <>
+struct LogBinArg<StrView> : public LogBinArgStr {
+};
+template <>
+struct LogBinArg<std::string> : public LogBinArgStr {
+   static size_t Size(const std::string& v) {
+      return LogBinArgStr::Size(ToStrView(v));
+   }
+   static byte* Put(byte* p, const std::string& v) {
+      return LogBinArgStr::Put(p, ToStrView(v));
+   }
+};
+template <>
+struct LogBinArg<const char*> : public LogBinArgStr {
+   static size_t Size(const char* v) {
+      return LogBinArgStr::Size(StrView_cstr(v));
+   }
+   static byte* Put(byte* p, const char* v) {
+      return LogBinArgStr::Put(p, StrView_cstr(v));
+   }
+};
+template <>
+struct LogBinArg<char*> : public LogBinArg<const char*> {
+};
+/// 字元陣列: 與 RevPrint() 相同, 若有 EOS 則只取到 EOS 之前.
+template <size_t arysz>
+struct LogBinArg<char[arysz]> : public LogBinArgStr {
+   static size_t Size(const char (&v)[arysz]) {
+      return LogBinArgStr::Size(StrView_eos_or_all(v));
+   }
+   static byte* Put(byte* p, const char (&v)[arysz]) {
+      return LogBinArgStr::Put(p, StrView_eos_or_all(v));
+   }
+};
+
+template <class T>
+using LogBinArgT = LogBinArg<typename std::remove_cv<typename std::remove_reference<T>::type>::type>;
+
+/// \ingroup Misc
+/// 是否全部的參數都支援 LogBinArg.
+template <class... ArgsT>
+struct IsLogBinArgs : public std::true_type {
+};
+template <class T, class... ArgsT>
+struct IsLogBinArgs<T, ArgsT...> : public std::integral_constant<bool, LogBinArgT<T>::IsSupported && IsLogBinArgs<ArgsT...>::value> {
+};
+
+/// \ingroup Misc
+/// 將 LogBinNode 的參數轉成文字(不含 log header 及尾端的 '\n').
+typedef void (*FnLogBinRender)(RevBufferList& rbuf, const byte* args);
+
+fon9_WARN_DISABLE_PADDING;
+/// \ingroup Misc
+/// 延後格式化的 log 訊息: 在呼叫端只保存 [格式(FnRender_) + 參數內容(binary)],
+/// 由 LogWriter 在寫入前(例: LogFileAppender 的寫檔 thread) 透過 LogBinRender() 轉成文字.
+class fon9_API LogBinNode : public BufferNodeVirtual {
+   fon9_NON_COPY_NON_MOVE(LogBinNode);
+   using base = BufferNodeVirtual;
+   friend class BufferNode;// for BufferNode::Alloc();
+   LogBinNode(BufferNodeSize blockSize, LogLevel level, FnLogBinRender fnRender);
+protected:
+   virtual ~LogBinNode();
+   virtual void OnBufferConsumed() override;
+   virtual void OnBufferConsumedErr(const ErrC& errc) override;
+public:
+   const LogArgs        LogArgs_;
+   const FnLogBinRender FnRender_;
+   /// 呼叫端的 thread id, 因為轉成文字時, 呼叫端的 thread 可能已經結束.
+   const ThreadId       ThreadId_;
+private:
+   bool                 IsRendered_{false};
+public:
+
+   /// 參數內容緊接在 LogBinNode 之後.
+   byte* GetArgsBuffer() {
+      return reinterpret_cast<byte*>(this + 1);
+   }
+   const byte* GetArgsBuffer() const {
+      return reinterpret_cast<const byte*>(this + 1);
+   }
+
+   /// \retval nullptr 無法分配, 例: argsSize 太大.
+   static LogBinNode* Alloc(LogLevel level, FnLogBinRender fnRender, size_t argsSize);
+   /// 若 node 不是 LogBinNode 則傳回 nullptr.
+   static LogBinNode* CastFrom(BufferNode* node);
+
+   /// 與 LogWrite(level, rbuf) 相同格式: `YYYYMMDD-HHMMSS.uuuuuu thrid[LEVEL]...\n`
+   /// 沒有經過 RenderTo() 的 LogBinNode, 在解構時會計入 GetLogBinDroppedCount().
+   void RenderTo(RevBufferList& rbuf);
+};
+fon9_WARN_POP;
+
+/// \ingroup Misc
+/// 透過 FnLogBinRender 的 template, 產生每種參數組合的「格式」.
+template <class... ArgsT>
+struct LogBinFormat {
+   static size_t CalcArgsSize(const ArgsT&... args) {
+      const size_t sizes[] = {LogBinArgT<ArgsT>::Size(args)...};
+      size_t       total = 0;
+      for (size_t sz : sizes)
+         total += sz;
+      return total;
+   }
+   static void PutArgs(byte* p, const ArgsT&... args) {
+      // 使用 braced-init-list 確保依序處理.
+      const int ordered[] = {(p = LogBinArgT<ArgsT>::Put(p, args), 0)...};
+      (void)ordered;
+   }
+   static void Render(RevBufferList& rbuf, const byte* args) {
+      RenderImpl(rbuf, args, make_index_sequence<sizeof...(ArgsT)>());
+   }
+private:
+   template <size_t... I>
+   static void RenderImpl(RevBufferList& rbuf, const byte* p, index_sequence<I...>) {
+      // braced-init-list: 依序從 p 取出每個參數.
+      const std::tuple<typename LogBinArgT<ArgsT>::Value...> values{LogBinArgT<ArgsT>::Get(p)...};
+      RevPrint(rbuf, std::get<I>(values)...);
+   }
+};
+
+/// \ingroup Misc
+/// 是否啟用 LogBin(延後格式化):
+/// - 由 SetLogBinMode() 設定, 且目前的 LogWriter 必須支援(SetLogWriter(..., isLogBinSupported=true)).
+/// - 啟用後, fon9_LOG() 的參數若全都支援 LogBinArg<>, 則使用 LogBinNode;
+///   否則(例: ErrC, Fmt, FmtDef...) 仍在呼叫端立即格式化.
+extern fon9_API bool LogBinActive_;
+
+/// \ingroup Misc
+/// 設定是否使用 LogBin(延後格式化), 預設為 false.
+/// NOT thread safe!
+fon9_API void SetLogBinMode(bool isEnabled);
+
+/// \ingroup Misc
+/// 將 buf 裡面的 LogBinNode 轉成文字, 由支援 LogBin 的 LogWriter 在寫入前呼叫.
+/// - 注意: 必須在放入 DcQueueList 之前處理, 因為 DcQueueList 會立即消費前端的 BufferNodeVirtual.
+/// - 若從未啟用過 LogBin, 則不做任何事.
+fon9_API void LogBinRender(BufferList& buf);
+
+/// \ingroup Misc
+/// 寫入 LogBinNode: `FnLogWriter(node->LogArgs_, BufferList{node});`
+fon9_API void LogWrite(LogBinNode* node);
+
+/// \ingroup Misc
+/// LogWriter 沒有呼叫 LogBinRender() 就消費了 LogBinNode, 因而沒有輸出的訊息數量.
+/// 每當此數量增加, 之後的 LogWrite() 會寫入一筆 "Log.BinDropped|dropped=n|total=n" 訊息.
+fon9_API uint64_t GetLogBinDroppedCount();
+
+/// \ingroup Misc
+/// fon9_LOG() 的實作: 參數有不支援 LogBinArg 的型別, 在呼叫端立即格式化.
+template <class... ArgsT>
+inline void LogPrintArgs(std::false_type, LogLevel level, ArgsT&&... args) {
+   RevBufferList rbuf{kLogBlockNodeSize};
+   RevPutChar(rbuf, '\n');
+   RevPrint(rbuf, std::forward<ArgsT>(args)...);
+   LogWrite(level, std::move(rbuf));
+}
+/// \ingroup Misc
+/// fon9_LOG() 的實作: 參數全都支援 LogBinArg, 若 LogBinActive_ 則只複製參數內容, 延後格式化.
+template <class... ArgsT>
+inline void LogPrintArgs(std::true_type, LogLevel level, ArgsT&&... args) {
+   if (LogBinActive_) {
+      using Format = LogBinFormat<typename std::remove_reference<ArgsT>::type...>;
+      if (LogBinNode* node = LogBinNode::Alloc(level, &Format::Render, Format::CalcArgsSize(args...))) {
+         Format::PutArgs(node->GetArgsBuffer(), args...);
+         LogWrite(node);
+         return;
+      }
+   }
+   LogPrintArgs(std::false_type{}, level, std::forward<ArgsT>(args)...);
+}
+/// \ingroup Misc
+/// 根據 args 的型別, 決定是否可以使用 LogBin, 由 fon9_LOG() 呼叫.
+template <class... ArgsT>
+inline void LogPrint(LogLevel level, ArgsT&&... args) {
+   LogPrintArgs(std::integral_constant<bool, IsLogBinArgs<ArgsT...>::value>{}, level, std::forward<ArgsT>(args)...);
+}
 /// \ingroup Misc
 /// 根據Log等級(level), 寫入 Log.
 /// 記錄的格式: `YYYYMMDD-HHMMSS.uuuuuu thrid[LEVEL]...\n`
@@ -100,13 +354,10 @@ enum {
 ///   - 範例:
 ///      - fon9_LOG_ERROR("TimedFile.OpenNewFile|FileName=", newFile.GetOpenName(), "|OpenMode=", newFile.GetOpenMode(), "|err=", res);
 ///      - fon9_LOG_INFO("DllMgr.LoadConfig|seedName=", this->Name_, "|cfgFileName=", cfgFileName);
+/// - 若有啟用 LogBin(SetLogBinMode()), 且參數全都支援 LogBinArg<>, 則延後到 LogWriter 才格式化.
 #define fon9_LOG(level, ...) do {                           \
-   if (fon9_UNLIKELY(level >= fon9::LogLevel_)) {           \
-      fon9::RevBufferList rbuf_{fon9::kLogBlockNodeSize};   \
-      fon9::RevPutChar(rbuf_, '\n');                        \
-      fon9::RevPrint(rbuf_, __VA_ARGS__);                   \
-      fon9::LogWrite(level, std::move(rbuf_));              \
-   }                                                        \
+   if (fon9_UNLIKELY(level >= fon9::LogLevel_))             \
+      fon9::LogPrint(level, __VA_ARGS__);                   \
 } while(0)
 
 #ifdef fon9_NOLOG_TRACE
@@ -4,6 +4,12 @@
 #include "fon9/Log.hpp"
 #include "fon9/CountDownLatch.hpp"
 
+fon9_BEFORE_INCLUDE_STD;
+#include <vector>
+#include <mutex>
+#include <thread>
+fon9_AFTER_INCLUDE_STD;
+
 namespace fon9 {
 
 LogFileAppender::~LogFileAppender() {
@@ -29,6 +35,9 @@ void LogFileAppender::MakeCallForWork(WorkContentLocker&& lk) {
    if ((FlushNodeCount_ > 0 && lk->GetQueuingNodeCount() > FlushNodeCount_) || this->IsHighWaterLevel(lk))
       base::MakeCallForWork(std::move(lk));
 }
+void LogFileAppender::PrepareAppendBuffer(BufferList& buffer) {
+   LogBinRender(buffer);
+}
 void LogFileAppender::EmitOnTimer(TimerEntry* timer, TimeStamp /*now*/) {
    LogFileAppender& rthis = ContainerOf(*static_cast<Timer*>(timer), &LogFileAppender::Timer_);
    {
@@ -42,6 +51,132 @@ void LogFileAppender::EmitOnTimer(TimerEntry* timer, TimeStamp /*now*/) {
 
 //--------------------------------------------------------------------------//
 
+fon9_WARN_DISABLE_PADDING;
+/// 一個寫 log 的 thread 擁有一個 ring(single producer);
+/// 合併時, 在 LogStaging::RingsMutex_ 的保護下取出(single consumer).
+class LogStagingRing {
+   fon9_NON_COPY_NON_MOVE(LogStagingRing);
+public:
+   struct Item {
+      TimeStamp   UtcTime_;
+      BufferList  Buf_;
+   };
+
+   /// ring 的擁有者(thread)是否仍存在; thread 結束後, ring 可以給新的 thread 使用.
+   std::atomic<bool>       IsOwned_{true};
+   std::atomic<uint64_t>   DroppedCount_{0};
+   /// producer 正在放入時間為 PendingTime_ 的訊息(包含等候 ring 有空位):
+   /// 合併時, 不可取出時間晚於 PendingTime_ 的訊息.
+   std::atomic<bool>       IsPending_{false};
+   std::atomic<TimeStamp>  PendingTime_{TimeStamp{}};
+
+   /// itemCount 必須是 2 的冪次方.
+   explicit LogStagingRing(uint32_t itemCount) : Mask_{itemCount - 1}, Items_{new Item[itemCount]} {
+   }
+   uint32_t GetCapacity() const {
+      return this->Mask_ + 1;
+   }
+
+   /// 只能在 producer thread 呼叫.
+   /// \retval false ring 已滿, buf 不變.
+   bool TryPush(TimeStamp tm, BufferList& buf) {
+      const uint32_t head = this->Head_.load(std::memory_order_relaxed);
+      if (fon9_UNLIKELY(head - this->ProducerTail_ > this->Mask_)) {
+         this->ProducerTail_ = this->Tail_.load(std::memory_order_acquire);
+         if (head - this->ProducerTail_ > this->Mask_)
+            return false;
+      }
+      Item& item = this->Items_[head & this->Mask_];
+      item.UtcTime_ = tm;
+      item.Buf_ = std::move(buf);
+      this->Head_.store(head + 1, std::memory_order_release);
+      return true;
+   }
+   /// 只能在 consumer 呼叫.
+   /// \retval nullptr ring 為空.
+   Item* Front() {
+      const uint32_t tail = this->Tail_.load(std::memory_order_relaxed);
+      if (tail == this->ConsumerHead_) {
+         this->ConsumerHead_ = this->Head_.load(std::memory_order_acquire);
+         if (tail == this->ConsumerHead_)
+            return nullptr;
+      }
+      return &this->Items_[tail & this->Mask_];
+   }
+   /// 只能在 consumer 呼叫, 且必須在 Front() != nullptr 之後.
+   void PopFront() {
+      this->Tail_.store(this->Tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+   }
+
+private:
+   const uint32_t          Mask_;
+   std::unique_ptr<Item[]> Items_;
+   // 避免 producer 與 consumer 寫入的欄位在同一條 cache line.
+   char                    Padding0_[64];
+   std::atomic<uint32_t>   Head_{0};
+   uint32_t                ProducerTail_{0};
+   char                    Padding1_[64 - sizeof(uint32_t) * 2];
+   std::atomic<uint32_t>   Tail_{0};
+   uint32_t                ConsumerHead_{0};
+};
+
+struct LogStaging {
+   /// 在每次寫 log 時檢查, 所以使用 atomic, 其餘設定由 RingsMutex_ 保護.
+   std::atomic<bool> IsEnabled_{false};
+   std::atomic<bool> IsDropWhenFull_{false};
+   uint32_t          RingCapacity_{0};
+   TimeInterval      DrainInterval_;
+   TimeInterval      HoldBack_;
+   /// 已寫入 "LogFile.Staging|dropped=" 訊息的數量.
+   uint64_t          ReportedDropped_{0};
+   /// DrainTimer 是否已啟動; 只有在 rings 有訊息時才啟動 DrainTimer.
+   std::atomic<bool> IsDrainArmed_{false};
+
+   std::mutex        RingsMutex_;
+   using RingSP = std::unique_ptr<LogStagingRing>;
+   std::vector<RingSP>  Rings_;
+
+   LogStagingRing* AcquireRing() {
+      std::lock_guard<std::mutex> lk{this->RingsMutex_};
+      for (RingSP& ring : this->Rings_) {
+         if (ring->GetCapacity() == this->RingCapacity_ && !ring->IsOwned_.load(std::memory_order_acquire)) {
+            ring->IsOwned_.store(true, std::memory_order_relaxed);
+            return ring.get();
+         }
+      }
+      this->Rings_.emplace_back(new LogStagingRing{this->RingCapacity_});
+      return this->Rings_.back().get();
+   }
+   /// 必須在 RingsMutex_ 保護下呼叫.
+   uint64_t GetDroppedCount() const {
+      uint64_t dropped = 0;
+      for (const RingSP& ring : this->Rings_)
+         dropped += ring->DroppedCount_.load(std::memory_order_relaxed);
+      return dropped;
+   }
+   /// 必須在 RingsMutex_ 保護下呼叫.
+   bool IsRingsEmpty() {
+      for (RingSP& ring : this->Rings_) {
+         if (ring->Front())
+            return false;
+      }
+      return true;
+   }
+};
+static LogStaging LogStaging_;
+
+struct LogStagingOwner {
+   LogStagingRing* Ring_{nullptr};
+   ~LogStagingOwner() {
+      if (this->Ring_)
+         this->Ring_->IsOwned_.store(false, std::memory_order_release);
+   }
+};
+static thread_local LogStagingOwner LogStagingOwner_;
+fon9_WARN_POP;
+
+//--------------------------------------------------------------------------//
+
 // 若在 LogFile 啟動期間會呼叫 fon9_LOG (例: DefaultTimerThread, DefaultThreadPool) 則:
 // 在 LogFileImpl::Init() 會設定 gWaitLogSystemReady = &WaitLogSystemReady;
 // 在呼叫 fon9_LOG 之前, 透過 if(gWaitLogSystemReady) (*gWaitLogSystemReady)(); 來等候.
@@ -56,16 +191,100 @@ class LogFileImpl : public LogFileAppender {
 
    std::string OrigStartInfo_;
 
+   static void EmitOnDrainTimer(TimerEntry* timer, TimeStamp now);
+   using DrainTimer = DataMemberEmitOnTimer<&LogFileImpl::EmitOnDrainTimer>;
+   DrainTimer  DrainTimer_{GetDefaultTimerThread()};
+
    LogFileImpl(FileRotate& frConfig) {
       LogFileImpl::gLogFile = this;
       frConfig.CheckTime(UtcNow());
-      SetLogWriter(&LogFileImpl::LogWriteToFile, frConfig.GetFileNameMaker().GetTimeChecker().GetTimeZoneOffset());
+      SetLogWriter(&LogFileImpl::LogWriteToFile, frConfig.GetFileNameMaker().GetTimeChecker().GetTimeZoneOffset(), true);
    }
 
    static void LogWriteToFile(const LogArgs& logArgs, BufferList&& buf) {
+      if (LogStaging_.IsEnabled_.load(std::memory_order_relaxed)) {
+         LogFileImpl::gLogFile->PushToStaging(logArgs.UtcTime_, buf);
+         return;
+      }
       LogFileImpl::gLogFile->CheckRotateTime(logArgs.UtcTime_);
       LogFileImpl::gLogFile->Append(std::move(buf));
    }
+   void PushToStaging(TimeStamp tm, BufferList& buf) {
+      LogStagingRing* ring = LogStagingOwner_.Ring_;
+      if (fon9_UNLIKELY(ring == nullptr))
+         ring = LogStagingOwner_.Ring_ = LogStaging_.AcquireRing();
+      // 在放入之前就先公告 tm: 避免合併時, 先取出了其他 rings 晚於 tm 的訊息.
+      ring->PendingTime_.store(tm, std::memory_order_relaxed);
+      ring->IsPending_.store(true, std::memory_order_release);
+      if (fon9_UNLIKELY(!ring->TryPush(tm, buf))) {
+         if (LogStaging_.IsDropWhenFull_.load(std::memory_order_relaxed)) {
+            ring->IsPending_.store(false, std::memory_order_release);
+            ring->DroppedCount_.fetch_add(1, std::memory_order_relaxed);
+            return; // buf 由呼叫端釋放; ring 已滿, 必定已啟動 DrainTimer.
+         }
+         // 等候 ring 有空位: 若沒有其他 thread 正在合併, 則自己處理.
+         do {
+            {
+               std::unique_lock<std::mutex> lk{LogStaging_.RingsMutex_, std::try_to_lock};
+               if (lk.owns_lock())
+                  this->DrainStagingLocked(false);
+            }
+            std::this_thread::yield();
+         } while (!ring->TryPush(tm, buf));
+      }
+      ring->IsPending_.store(false, std::memory_order_release);
+      // 與 EmitOnDrainTimer() 的 fence 配對:
+      // 確保「DrainTimer 看到 rings 為空而停止」與「這裡看到 IsDrainArmed_ == true」不會同時發生.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!LogStaging_.IsDrainArmed_.load(std::memory_order_relaxed))
+         this->StartDrainTimer();
+   }
+   /// 依照 UtcTime_ 合併各 rings, 一次寫入 Appender; 必須在 LogStaging_.RingsMutex_ 保護下呼叫.
+   /// \param isDrainAll false: 只取出 (UtcNow() - HoldBack_) 之前的訊息.
+   void DrainStagingLocked(bool isDrainAll) {
+      TimeStamp   watermark = UtcNow() - (isDrainAll ? TimeInterval{} : LogStaging_.HoldBack_);
+      for (LogStaging::RingSP& ring : LogStaging_.Rings_) {
+         if (ring->IsPending_.load(std::memory_order_acquire)) {
+            const TimeStamp pending = ring->PendingTime_.load(std::memory_order_relaxed);
+            if (pending < watermark)
+               watermark = pending;
+         }
+      }
+      BufferList  outbuf;
+      for (;;) {
+         // 每個 ring 都是同一個 thread 依序放入, 所以只要比較各 ring 的第一筆.
+         // ring 的數量 = 寫 log 的 threads 數量, 數量不多, 所以直接循序搜尋.
+         LogStagingRing*         minRing = nullptr;
+         LogStagingRing::Item*   minItem = nullptr;
+         for (LogStaging::RingSP& ring : LogStaging_.Rings_) {
+            LogStagingRing::Item* item = ring->Front();
+            if (item && item->UtcTime_ <= watermark && (minItem == nullptr || item->UtcTime_ < minItem->UtcTime_)) {
+               minItem = item;
+               minRing = ring.get();
+            }
+         }
+         if (minItem == nullptr)
+            break;
+         this->CheckRotateTime(minItem->UtcTime_, outbuf);
+         outbuf.push_back(std::move(minItem->Buf_));
+         minRing->PopFront();
+      }
+      const uint64_t dropped = LogStaging_.GetDroppedCount();
+      if (fon9_UNLIKELY(dropped != LogStaging_.ReportedDropped_)) {
+         RevBufferList rbuf{kLogBlockNodeSize};
+         RevPrint(rbuf, "LogFile.Staging|dropped=", dropped - LogStaging_.ReportedDropped_, "|total=", dropped, '\n');
+         AddLogHeader(rbuf, watermark, LogLevel::Warn);
+         LogStaging_.ReportedDropped_ = dropped;
+         this->CheckRotateTime(watermark, outbuf);
+         outbuf.push_back(rbuf.MoveOut());
+      }
+      if (!outbuf.empty())
+         this->Append(std::move(outbuf));
+   }
+   void DrainStaging(bool isDrainAll) {
+      std::lock_guard<std::mutex> lk{LogStaging_.RingsMutex_};
+      this->DrainStagingLocked(isDrainAll);
+   }
 
    static void AddLogInfo(File& fd, RevBufferList& rbuf, TimeStamp utctm, char chHeadNL) {
       AddLogHeader(rbuf, utctm, LogLevel::Important);
@@ -86,7 +305,7 @@ class LogFileImpl : public LogFileAppender {
       TimeZoneOffset tzadj = this->GetRotateTimeChecker().GetTimeZoneOffset();
       // 避免: InitLogWriteToFile(); => SetLogWriter(others); => InitLogWriteToFile();
       // 所以這裡開檔成功後, 在設定一次 SetLogWriter(); 讓第2次的 InitLogWriteToFile(); 能順利重設 LogWriter.
-      SetLogWriter(&LogFileImpl::LogWriteToFile, tzadj);
+      SetLogWriter(&LogFileImpl::LogWriteToFile, tzadj, true);
 
       TimeStamp      utcnow = UtcNow();
       RevBufferList  rbuf{kLogBlockNodeSize};
@@ -116,7 +335,9 @@ class LogFileImpl : public LogFileAppender {
 public:
    static LogFileImpl* gLogFile;
    ~LogFileImpl() {
+      this->DrainTimer_.DisposeAndWait();
       UnsetLogWriter(&LogFileImpl::LogWriteToFile);
+      this->DrainStaging(true);
       this->DisposeAsync();
       if (!this->OrigStartInfo_.empty()) {
          RevBufferList  rbuf{kLogBlockNodeSize};
@@ -139,9 +360,40 @@ public:
       gLogFile->Worker_.TakeCall();//強制處理開檔要求.
       return resfut.get();
    }
+   void StartDrainTimer() {
+      if (!LogStaging_.IsDrainArmed_.exchange(true, std::memory_order_acq_rel))
+         this->DrainTimer_.RunAfter(LogStaging_.DrainInterval_);
+   }
+   /// 必須在 LogStaging_.RingsMutex_ 保護下呼叫.
+   void DrainStagingAll() {
+      this->DrainStagingLocked(true);
+   }
+   bool WaitFlushed() {
+      this->DrainStaging(true);
+      return base::WaitFlushed();
+   }
 };
 LogFileImpl* LogFileImpl::gLogFile;
 
+void LogFileImpl::EmitOnDrainTimer(TimerEntry* timer, TimeStamp /*now*/) {
+   LogFileImpl& rthis = ContainerOf(*static_cast<DrainTimer*>(timer), &LogFileImpl::DrainTimer_);
+   TimeInterval interval;
+   {
+      std::lock_guard<std::mutex> lk{LogStaging_.RingsMutex_};
+      // 若已關閉 staging, 則把 rings 剩餘的訊息全部寫入.
+      rthis.DrainStagingLocked(!LogStaging_.IsEnabled_.load(std::memory_order_acquire));
+      if (LogStaging_.IsRingsEmpty()) {
+         // rings 已清空, 不再啟動計時器, 等到下次放入訊息時再啟動.
+         LogStaging_.IsDrainArmed_.store(false, std::memory_order_relaxed);
+         std::atomic_thread_fence(std::memory_order_seq_cst);
+         if (LogStaging_.IsRingsEmpty() || LogStaging_.IsDrainArmed_.exchange(true, std::memory_order_acq_rel))
+            return;
+      }
+      interval = LogStaging_.DrainInterval_;
+   }
+   rthis.DrainTimer_.RunAfter(interval);
+}
+
 //--------------------------------------------------------------------------//
 
 fon9_API File::Result InitLogWriteToFile(std::string fmtFileName,
@@ -157,4 +409,29 @@ fon9_API bool WaitLogFileFlushed() {
    return false;
 }
 
+fon9_API void SetLogFileStaging(const LogStagingConfig& cfg) {
+   {
+      std::lock_guard<std::mutex> lk{LogStaging_.RingsMutex_};
+      uint32_t capacity = 0;
+      if (cfg.ItemCount_ > 0) {
+         for (capacity = 2; capacity < cfg.ItemCount_; capacity <<= 1) {
+         }
+         // 關閉 staging 時, 保留原本的 RingCapacity_, 讓正在加入的 thread 仍可取得有效的 ring.
+         LogStaging_.RingCapacity_ = capacity;
+      }
+      LogStaging_.DrainInterval_ = cfg.DrainInterval_;
+      LogStaging_.HoldBack_ = cfg.HoldBack_;
+      LogStaging_.IsDropWhenFull_.store(cfg.IsDropWhenFull_, std::memory_order_relaxed);
+      // 關閉 staging 之前, 先把 rings 的訊息全部寫入, 之後直接寫入的訊息才不會排在這些訊息之前.
+      // 關閉期間仍在放入 rings 的訊息, 由放入時啟動的 DrainTimer 處理.
+      if (capacity == 0 && LogFileImpl::gLogFile)
+         LogFileImpl::gLogFile->DrainStagingAll();
+      LogStaging_.IsEnabled_.store(capacity > 0, std::memory_order_release);
+   }
+}
+fon9_API uint64_t GetLogDroppedCount() {
+   std::lock_guard<std::mutex> lk{LogStaging_.RingsMutex_};
+   return LogStaging_.GetDroppedCount();
+}
+
 } // namespace
@@ -23,8 +23,37 @@ fon9_API File::Result InitLogWriteToFile(std::string fmtFileName,
                                          File::SizeType maxFileSize,
                                          size_t highWaterLevelNodeCount);
 
+/// \ingroup Misc
+/// 等候 log 資料寫入檔案.
+/// 若有啟用 staging(SetLogFileStaging()), 則會先將全部 rings 的內容(不考慮 HoldBack_)合併寫入.
 fon9_API bool WaitLogFileFlushed();
 
+/// \ingroup Misc
+/// LogFile 的 per-thread staging 設定.
+/// - 啟用後, 每個寫 log 的 thread 有自己的 SPSC ring, fon9_LOG() 只把訊息放入 ring, 不會 lock LogFileAppender.
+/// - 由 DefaultTimerThread 每隔 DrainInterval_, 依照 LogArgs::UtcTime_ 的順序合併各 rings, 一次寫入 LogFileAppender.
+/// - 合併時, 只取出 (現在時間 - HoldBack_) 之前的訊息, 較新的訊息留到下次合併;
+///   所以只要 [取得 LogArgs::UtcTime_ 到放入 ring] 的時間 < HoldBack_, 寫入檔案的順序必定依照 UtcTime_ 排序.
+struct LogStagingConfig {
+   /// 每個 thread 的 ring 可容納的訊息數量, 會調整為 2 的冪次方.
+   /// 0 = 不使用 staging(預設).
+   uint32_t       ItemCount_{0};
+   /// ring 滿了的處理方式:
+   /// - false(預設): 呼叫 fon9_LOG() 的 thread 等候 ring 有空位.
+   /// - true: 拋棄此筆訊息, 並計入 GetLogDroppedCount(); 合併時會寫入一筆 "LogFile.Staging|dropped=" 訊息.
+   bool           IsDropWhenFull_{false};
+   TimeInterval   DrainInterval_{TimeInterval_Millisecond(1)};
+   TimeInterval   HoldBack_{TimeInterval_Millisecond(1)};
+};
+/// \ingroup Misc
+/// 設定 LogFile 的 per-thread staging.
+/// - 已建立的 ring 容量不會改變, 新的容量僅影響之後建立的 ring(新的 thread).
+/// - 可在 InitLogWriteToFile() 之前或之後呼叫.
+fon9_API void SetLogFileStaging(const LogStagingConfig& cfg);
+/// \ingroup Misc
+/// 因 staging ring 已滿而拋棄的訊息數量(全部 threads 的合計).
+fon9_API uint64_t GetLogDroppedCount();
+
 /// \ingroup Misc
 /// - 寫檔時機:
 ///   - 每隔 n 秒: 透過 SetFlushInterval() 設定, 預設為 1 秒.
@@ -55,6 +84,8 @@ protected:
 
    /// 資料節點數量 > m 個, 才會呼叫 this->MakeCallNow(lk); 否則 do nothing.
    virtual void MakeCallForWork(WorkContentLocker&&) override;
+   /// 在寫檔 thread 將 LogBinNode 轉成文字(延後格式化).
+   virtual void PrepareAppendBuffer(BufferList& buffer) override;
 
 public:
    void SetFlushInterval(TimeInterval ti) {
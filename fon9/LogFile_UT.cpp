@@ -138,6 +138,128 @@ void BenchThreadsWrite() {
 
 //--------------------------------------------------------------------------//
 
+static std::string   gLogBinCaptured;
+static unsigned      gLogBinNodeCount;
+static void CaptureLogWriter(const fon9::LogArgs&, fon9::BufferList&& buf) {
+   if (fon9::LogBinNode::CastFrom(const_cast<fon9::BufferNode*>(buf.cfront())))
+      ++gLogBinNodeCount;
+   fon9::LogBinRender(buf);
+   fon9::BufferAppendTo(buf, gLogBinCaptured);
+}
+static std::string CaptureLogBody(bool isLogBin) {
+   gLogBinCaptured.clear();
+   fon9::SetLogBinMode(isLogBin);
+   std::string       str{"std::string"};
+   char              chary[16] = "char[16]";
+   const char*       cstr = "const char*";
+   fon9::TimeStamp   tm{fon9::TimeStamp::Make<6>(1234567890123456)};
+   fon9_LOG_INFO("LogBin|str=", str, "|chary=", chary, "|cstr=", cstr, "|sv=", fon9::StrView{"StrView"},
+                 "|u=", 123u, "|i=", -456, "|ch=", 'K', "|dec=", fon9::Decimal<int64_t, 6>(-42.42),
+                 "|ti=", fon9::TimeInterval_Millisecond(1234), "|tm=", tm, "|lv=", fon9::LogLevel::Warn);
+   fon9::SetLogBinMode(false);
+   // 移除 log header 的時間及 thread id: 保留第一個 ']' 之後的內容.
+   return gLogBinCaptured.substr(gLogBinCaptured.find(']') + 1);
+}
+/// 宣告支援 LogBin, 但沒有呼叫 LogBinRender() 的 LogWriter: LogBinNode 會被拋棄.
+static void ForgetRenderLogWriter(const fon9::LogArgs&, fon9::BufferList&& buf) {
+   fon9::BufferAppendTo(buf, gLogBinCaptured);
+}
+/// 被拋棄的 LogBinNode 必須計入 GetLogBinDroppedCount(), 並補寫一筆 "Log.BinDropped|dropped=" 訊息.
+static void TestLogBinDropped() {
+   std::cout << "[TEST ] LogBin.Dropped" << std::flush;
+   fon9::SetLogWriter(&ForgetRenderLogWriter, fon9::TimeZoneOffset{}, true);
+   gLogBinCaptured.clear();
+   const uint64_t droppedBefore = fon9::GetLogBinDroppedCount();
+   fon9::SetLogBinMode(true);
+   fon9_LOG_INFO("LogBin|u=", 123u);
+   fon9::SetLogBinMode(false);
+   const uint64_t dropped = fon9::GetLogBinDroppedCount() - droppedBefore;
+   fon9::UnsetLogWriter(&ForgetRenderLogWriter);
+   if (dropped != 1 || gLogBinCaptured.find("Log.BinDropped|dropped=1|") == std::string::npos) {
+      std::cout << "\r[ERROR]|dropped=" << dropped << "|captured=" << gLogBinCaptured << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+void TestLogBin() {
+   fon9::SetLogWriter(&CaptureLogWriter, fon9::TimeZoneOffset{}, true);
+   gLogBinNodeCount = 0;
+   const std::string txtImmediate = CaptureLogBody(false);
+   const std::string txtLogBin = CaptureLogBody(true);
+   std::cout << "[TEST ] LogBin|body=" << txtLogBin << std::flush;
+   if (gLogBinNodeCount != 1 || txtLogBin != txtImmediate) {
+      std::cout << "\r[ERROR]\n"
+         << "|LogBinNodeCount=" << gLogBinNodeCount << "\n"
+         << "|expected=" << txtImmediate << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+   fon9::UnsetLogWriter(&CaptureLogWriter);
+   TestLogBinDropped();
+}
+
+//--------------------------------------------------------------------------//
+
+/// 多個 threads 透過 staging rings 寫 log, 檢查檔案內容是否依照時間排序, 且數量正確.
+void TestLogStaging(bool isDropWhenFull) {
+   const char* fname = isDropWhenFull ? "./logs/staging-drop.log" : "./logs/staging.log";
+   remove(fname);
+   fon9::InitLogWriteToFile(fname, fon9::TimeChecker::TimeScale::No, 0, 0);
+   fon9::LogStagingConfig cfg;
+   cfg.ItemCount_ = isDropWhenFull ? 256 : 1024 * 16;
+   cfg.IsDropWhenFull_ = isDropWhenFull;
+   // 測試環境可能很忙, 所以 HoldBack_ 設長一些, 避免 thread 被切換而造成順序錯誤.
+   cfg.HoldBack_ = fon9::TimeInterval_Millisecond(100);
+   fon9::SetLogFileStaging(cfg);
+   const uint64_t droppedBefore = fon9::GetLogDroppedCount();
+
+   const unsigned kTimesPerThread = 100 * 1000;
+   std::vector<std::thread> threads;
+   fon9::StopWatch stopWatch;
+   for (unsigned t = 0; t < gNumberOfThreads; ++t) {
+      threads.push_back(std::thread([t]() {
+         for (unsigned L = 0; L < kTimesPerThread; ++L)
+            fon9_LOG_INFO("Staging|thr=", t, "|L=", L);
+      }));
+   }
+   fon9::JoinThreads(threads);
+   const double span = stopWatch.StopTimer();
+   fon9::WaitLogFileFlushed();
+   const uint64_t dropped = fon9::GetLogDroppedCount() - droppedBefore;
+   fon9::SetLogFileStaging(fon9::LogStagingConfig{});
+
+   const unsigned kTotal = gNumberOfThreads * kTimesPerThread;
+   stopWatch.PrintResultNoEOL(span, isDropWhenFull ? "Staging(Drop) " : "Staging(Block)", kTotal)
+      << "|dropped=" << dropped << std::endl;
+
+   // 檢查: 時間順序、訊息數量.
+   FILE* fd = fopen(fname, "r");
+   if (fd == nullptr) {
+      std::cout << "[ERROR] Staging|open=" << fname << std::endl;
+      abort();
+   }
+   char        line[1024];
+   char        prevTime[32] = "";
+   unsigned    lineCount = 0, outOfOrder = 0;
+   const size_t kTimeWidth = sizeof("yyyymmdd-HHMMSS.uuuuuu") - 1;
+   while (fgets(line, sizeof(line), fd)) {
+      if (strstr(line, "|thr=") == nullptr)
+         continue;
+      ++lineCount;
+      if (memcmp(prevTime, line, kTimeWidth) > 0)
+         ++outOfOrder;
+      memcpy(prevTime, line, kTimeWidth);
+   }
+   fclose(fd);
+   const bool isCountOK = isDropWhenFull ? (lineCount + dropped == kTotal) : (lineCount == kTotal && dropped == 0);
+   std::cout << (isCountOK && outOfOrder == 0 ? "[OK   ]" : "[ERROR]")
+      << " Staging|lines=" << lineCount << "|dropped=" << dropped << "|outOfOrder=" << outOfOrder << std::endl;
+   if (!isCountOK || outOfOrder != 0)
+      abort();
+}
+
+//--------------------------------------------------------------------------//
+
 uint64_t timestamp_now() {
    return static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch() / std::chrono::nanoseconds(1));
 }
@@ -181,14 +303,27 @@ void run_benchmark(Function && fn, unsigned threadCount, char const * const logg
    fon9::JoinThreads(threads);
 }
 
-void TestThreadsWriteLatency() {
+void TestThreadsWriteLatency(bool isLogBin, bool isStaging) {
    // 使用的測試方法: https://github.com/Iyengar111/NanoLog#latency-benchmark-of-guaranteed-logger
-   fon9::InitLogWriteToFile("./logs/fon9-latency.log", fon9::TimeChecker::TimeScale::No, 0, 0);
+   fon9::InitLogWriteToFile(isStaging ? "./logs/fon9-latency-staging.log"
+                            : isLogBin ? "./logs/fon9-latency-bin.log" : "./logs/fon9-latency.log",
+                            fon9::TimeChecker::TimeScale::No, 0, 0);
+   fon9::SetLogBinMode(isLogBin);
+   if (isStaging) {
+      fon9::LogStagingConfig cfg;
+      cfg.ItemCount_ = 1024 * 16;
+      fon9::SetLogFileStaging(cfg);
+   }
    auto fon9BenchmarkFn = [](unsigned i, char const * const cstr) {
       fon9_LOG_INFO("Logging ", cstr, i, 0, 'K', fon9::Decimal<int64_t, 6>(-42.42));
    };
    for (auto threadCount : {1u, 2u, 4u, 8u})
-      run_benchmark(fon9BenchmarkFn, threadCount, "fon9_LOG");
+      run_benchmark(fon9BenchmarkFn, threadCount,
+                    isStaging ? (isLogBin ? "fon9_LOG(LogBin+Staging)" : "fon9_LOG(Staging)")
+                    : isLogBin ? "fon9_LOG(LogBin)" : "fon9_LOG");
+   fon9::WaitLogFileFlushed();
+   fon9::SetLogFileStaging(fon9::LogStagingConfig{});
+   fon9::SetLogBinMode(false);
 }
 
 //--------------------------------------------------------------------------//
@@ -215,6 +350,7 @@ int main(int argc, char** argv) {
    }
 
    fon9::AutoPrintTestInfo utinfo{"LogFile"};
+   TestLogBin();
    auto res = fon9::InitLogWriteToFile("./logs/Scale_Second_{0:f-t+8}.{1:04}.log", fon9::TimeChecker::TimeScale::Second, 1024, 0);
 
    fon9::RevBufferFixedSize<1024> rbuf;
@@ -242,11 +378,25 @@ int main(int argc, char** argv) {
    BenchLogToFile("/tmp/fon9.log");
 #endif
    BenchLogToFile("./logs/bench.log");
+   // LogBin: 延後到寫檔 thread 才格式化.
+   fon9::SetLogBinMode(true);
+   BenchLogToFile("./logs/bench-bin.log");
+   fon9::SetLogBinMode(false);
 
    utinfo.PrintSplitter();
    BenchThreadsWrite();
 
    utinfo.PrintSplitter();
-   TestThreadsWriteLatency();
+   TestLogStaging(false);
+   TestLogStaging(true);
+
+   utinfo.PrintSplitter();
+   TestThreadsWriteLatency(false, false);
+   utinfo.PrintSplitter();
+   TestThreadsWriteLatency(true, false);
+   utinfo.PrintSplitter();
+   TestThreadsWriteLatency(false, true);
+   utinfo.PrintSplitter();
+   TestThreadsWriteLatency(true, true);
    return 0;
 }
@@ -0,0 +1,61 @@
+﻿// \file fon9/MmapFile.cpp
+// \author fonwinz@gmail.com
+#include "fon9/MmapFile.hpp"
+#ifndef fon9_WINDOWS
+#include <sys/mman.h>
+#endif
+
+namespace fon9 {
+
+MmapFile::~MmapFile() {
+   this->Unmap();
+}
+File::Result MmapFile::OpenMap(std::string fname) {
+   this->Unmap();
+   auto res = this->Open(std::move(fname), FileMode::Read);
+   if (!res)
+      return res;
+   return this->Map();
+}
+void MmapFile::Unmap() {
+   if (this->MapBegin_ == nullptr)
+      return;
+#ifdef fon9_WINDOWS
+   UnmapViewOfFile(this->MapBegin_);
+   CloseHandle(this->MapHandle_);
+   this->MapHandle_ = nullptr;
+#else
+   munmap(const_cast<byte*>(this->MapBegin_), static_cast<size_t>(this->MapSize_));
+#endif
+   this->MapBegin_ = nullptr;
+   this->MapSize_ = 0;
+}
+File::Result MmapFile::Map() {
+   this->Unmap();
+   auto fsz = this->GetFileSize();
+   if (!fsz || fsz.GetResult() == 0)
+      return fsz;
+#ifdef fon9_WINDOWS
+   this->MapHandle_ = CreateFileMapping(this->Fdr_.GetFD(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (this->MapHandle_ == nullptr)
+      return Result{GetSysErrC()};
+   void* mem = MapViewOfFile(this->MapHandle_, FILE_MAP_READ, 0, 0, 0);
+   if (mem == nullptr) {
+      Result res{GetSysErrC()};
+      CloseHandle(this->MapHandle_);
+      this->MapHandle_ = nullptr;
+      return res;
+   }
+#else
+   void* mem = mmap(nullptr, static_cast<size_t>(fsz.GetResult()), PROT_READ, MAP_SHARED, this->Fdr_.GetFD(), 0);
+   if (mem == MAP_FAILED)
+      return Result{GetSysErrC()};
+   // 通常為循序讀取(播放), 偶爾跳躍(Seek);
+   madvise(mem, static_cast<size_t>(fsz.GetResult()), MADV_SEQUENTIAL);
+#endif
+   this->MapBegin_ = static_cast<const byte*>(mem);
+   this->MapSize_ = fsz.GetResult();
+   return fsz;
+}
+
+} // namespaces
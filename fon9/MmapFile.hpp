@@ -0,0 +1,44 @@
+﻿/// \file fon9/MmapFile.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_MmapFile_hpp__
+#define __fon9_MmapFile_hpp__
+#include "fon9/File.hpp"
+
+namespace fon9 {
+
+/// \ingroup Misc
+/// 使用 mmap(Windows: MapViewOfFile) 唯讀對應整個檔案.
+/// - 適用於: 讀取大型記錄檔(例: 行情封包記錄), 需要隨機存取的情況.
+/// - 對應範圍在 Map() 時決定, 之後檔案若有增加, 需要再呼叫一次 Map();
+class fon9_API MmapFile : public File {
+   fon9_NON_COPY_NON_MOVE(MmapFile);
+   using base = File;
+   const byte* MapBegin_{nullptr};
+   PosType     MapSize_{0};
+#ifdef fon9_WINDOWS
+   HANDLE      MapHandle_{nullptr};
+#endif
+
+public:
+   MmapFile() = default;
+   ~MmapFile();
+
+   /// 唯讀開啟檔案, 然後對應整個檔案.
+   /// \retval 成功 對應的大小(檔案大小).
+   Result OpenMap(std::string fname);
+
+   /// 重新對應整個檔案: 例如檔案大小有變動.
+   /// \retval 成功 對應的大小(檔案大小).
+   Result Map();
+   void Unmap();
+
+   const byte* GetMapBegin() const {
+      return this->MapBegin_;
+   }
+   PosType GetMapSize() const {
+      return this->MapSize_;
+   }
+};
+
+} // namespaces
+#endif//__fon9_MmapFile_hpp__
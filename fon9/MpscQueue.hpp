@@ -0,0 +1,91 @@
+﻿/// \file fon9/MpscQueue.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_MpscQueue_hpp__
+#define __fon9_MpscQueue_hpp__
+#include "fon9/sys/Config.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <atomic>
+fon9_AFTER_INCLUDE_STD;
+
+namespace fon9 {
+
+/// \ingroup Thrs
+/// MpscQueue 的節點, 由使用者嵌入在自己的物件裡面(intrusive).
+/// - 同一個節點同時只能在一個 MpscQueue 裡面.
+/// - 從 MpscQueue::pop() 取出後, 就可以立即再放入(任意) MpscQueue.
+struct MpscNode {
+   std::atomic<MpscNode*>  MpscNext_{nullptr};
+};
+
+/// \ingroup Thrs
+/// Multi-producer single-consumer 的 lock-free 佇列(Dmitry Vyukov 的 intrusive MPSC queue).
+/// - push(): 任意 thread 可呼叫, 只有一個 atomic exchange, 不會有 lock, 也不會失敗重試(wait-free).
+/// - pop(), empty(): 只能在同一個(consumer) thread 呼叫.
+/// - 節點的生命週期由使用者負責, MpscQueue 不會 delete 節點; 解構時若仍有節點, 由使用者自行取出處理.
+/// - 若 producer 在 push() 進行到一半(已 exchange, 尚未串起 next)時被中斷,
+///   則 pop() 可能暫時傳回 nullptr(即使佇列內還有節點), 此時 producer 必定尚未完成 push(),
+///   所以只要 producer 在 push() 之後通知 consumer(例: wakeup), consumer 就不會遺漏節點.
+class MpscQueue {
+   fon9_NON_COPY_NON_MOVE(MpscQueue);
+   /// producer 加入節點的位置.
+   std::atomic<MpscNode*>  Head_;
+   /// 避免 Head_(producers 寫入) 與 Tail_(consumer 寫入) 在同一條 cache line.
+   char                    Padding_[64 - sizeof(std::atomic<MpscNode*>)];
+   /// consumer 取出節點的位置.
+   MpscNode*               Tail_;
+   MpscNode                Stub_;
+
+   /// \retval 加入前的 Head_.
+   MpscNode* PushNode(MpscNode* node) {
+      node->MpscNext_.store(nullptr, std::memory_order_relaxed);
+      MpscNode* prev = this->Head_.exchange(node, std::memory_order_acq_rel);
+      prev->MpscNext_.store(node, std::memory_order_release);
+      return prev;
+   }
+
+public:
+   MpscQueue() : Head_{&Stub_}, Tail_{&Stub_} {
+   }
+
+   /// \retval true  加入前 consumer 端看起來是空的(僅供參考, 不可用來取代 wakeup 通知).
+   bool push(MpscNode* node) {
+      return this->PushNode(node) == &this->Stub_;
+   }
+
+   /// 只能在 consumer thread 呼叫.
+   /// \retval nullptr 佇列為空, 或 producer 的 push() 尚未完成.
+   MpscNode* pop() {
+      MpscNode* tail = this->Tail_;
+      MpscNode* next = tail->MpscNext_.load(std::memory_order_acquire);
+      if (tail == &this->Stub_) {
+         if (next == nullptr)
+            return nullptr;
+         this->Tail_ = tail = next;
+         next = next->MpscNext_.load(std::memory_order_acquire);
+      }
+      if (fon9_LIKELY(next)) {
+         this->Tail_ = next;
+         return tail;
+      }
+      if (tail != this->Head_.load(std::memory_order_acquire))
+         return nullptr; // producer 正在 push(), 尚未串起 tail->MpscNext_.
+      // tail 是最後一個節點: 放入 Stub_ 之後才能取出 tail.
+      this->PushNode(&this->Stub_);
+      next = tail->MpscNext_.load(std::memory_order_acquire);
+      if (next) {
+         this->Tail_ = next;
+         return tail;
+      }
+      return nullptr;
+   }
+
+   /// 只能在 consumer thread 呼叫.
+   bool empty() const {
+      const MpscNode* tail = this->Tail_;
+      return tail == &this->Stub_ && tail->MpscNext_.load(std::memory_order_acquire) == nullptr;
+   }
+};
+
+} // namespace
+#endif//__fon9_MpscQueue_hpp__
@@ -105,6 +105,13 @@ public:
       this->FreeIndex_.reserve(sz);
    }
 
+   /// 對全部的 obj 呼叫 fn(T& obj), 包含已移除的位置:
+   /// 透過 RemoveObj() 移除的位置為 T{}, 透過 RemoveObjPtr() 移除的位置則是呼叫者清理後的狀態.
+   template <class Fn>
+   void ForEach(Fn&& fn) {
+      for (T& obj : this->Objs_)
+         fn(obj);
+   }
    SizeT Size() const {
       return this->Objs_.size() - this->FreeIndex_.size();
    }
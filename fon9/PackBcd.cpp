@@ -0,0 +1,167 @@
+﻿/// \file fon9/PackBcd.cpp
+/// \author fonwinz@gmail.com
+#include "fon9/PackBcd.hpp"
+#include "fon9/CpuFeatures.hpp"
+
+#if fon9_HAS_X86_SIMD
+fon9_BEFORE_INCLUDE_STD;
+#include <immintrin.h>
+fon9_AFTER_INCLUDE_STD;
+#endif
+
+namespace fon9 {
+
+using FnPackBcdRun = void (*)(uint64_t* out, const byte* pbcd, size_t stride, size_t count);
+
+template <unsigned kSize>
+static void PackBcdRunScalar(uint64_t* out, const byte* pbcd, size_t stride, size_t count) {
+   for (; count > 0; --count) {
+      *out++ = PackBcdBytesTo<kSize>(pbcd);
+      pbcd += stride;
+   }
+}
+static const FnPackBcdRun kPackBcdRunScalar[] = {
+   nullptr,
+   &PackBcdRunScalar<1>, &PackBcdRunScalar<2>, &PackBcdRunScalar<3>, &PackBcdRunScalar<4>,
+   &PackBcdRunScalar<5>, &PackBcdRunScalar<6>, &PackBcdRunScalar<7>, &PackBcdRunScalar<8>,
+};
+
+#if fon9_HAS_X86_SIMD
+// 為了減少搬移, 每個欄位直接從「欄位開頭」載入 8 bytes, 然後在 lane 裡面左移(捨棄欄位之後的 bytes).
+// - x86 必定是 little-endian: 左移後, 欄位位於 lane 的尾端(前方補 0), lane 內的 byte 順序與記憶體相同(高位數在低位址).
+// - 為了不讀取超過範圍的記憶體, 只有 [欄位開頭 + 8 <= 最後一個欄位的結尾] 的欄位才能用此方式載入,
+//   其餘(通常只有最後 1 個欄位)使用 PackBcdBytesTo();
+static inline size_t PackBcdSafeLoadCount(size_t fieldSize, size_t stride, size_t count) {
+   // 第 i 個欄位可以載入 8 bytes: stride * i + 8 <= stride * (count - 1) + fieldSize;
+   const size_t runEnd = stride * (count - 1) + fieldSize;
+   if (runEnd < 8)
+      return 0;
+   const size_t safe = (runEnd - 8) / stride + 1;
+   return safe < count ? safe : count;
+}
+
+// 每個 64 bits lane 的 16 位數 => uint64_t; 步驟與 impl::PackBcd8To() 相同,
+// 但因為 lane 內的 byte 順序為記憶體順序, 所以使用 maddubs/madd 合併相鄰的 bytes/words.
+fon9_TARGET_SSE41 static inline __m128i PackBcdLanesSse41(__m128i v) {
+   const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0f));
+   const __m128i h2 = _mm_add_epi8(hi, hi);
+   v = _mm_sub_epi8(v, _mm_add_epi8(_mm_add_epi8(h2, h2), h2));   // 0..99
+   v = _mm_maddubs_epi16(v, _mm_set1_epi16(0x0164));              // [lo addr]*100 + [hi addr]: 0..9999
+   v = _mm_madd_epi16(v, _mm_set1_epi32(0x00012710));             // [lo addr]*10000 + [hi addr]: 0..99999999
+   return _mm_add_epi64(_mm_mul_epu32(v, _mm_set1_epi64x(100000000)), _mm_srli_epi64(v, 32));
+}
+template <unsigned kSize>
+fon9_TARGET_SSE41 static inline __m128i PackBcdLoad2Sse41(const byte* pbcd, size_t stride) {
+   const __m128i v = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pbcd)),
+                                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pbcd + stride)));
+   return _mm_slli_epi64(v, (8 - kSize) * 8);
+}
+template <unsigned kSize>
+fon9_TARGET_SSE41 static void PackBcdRunSse41(uint64_t* out, const byte* pbcd, size_t stride, size_t count) {
+   if (count == 0)
+      return;
+   size_t safe = PackBcdSafeLoadCount(kSize, stride, count);
+   count -= safe;
+   for (; safe >= 2; safe -= 2) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), PackBcdLanesSse41(PackBcdLoad2Sse41<kSize>(pbcd, stride)));
+      out += 2;
+      pbcd += stride * 2;
+   }
+   PackBcdRunScalar<kSize>(out, pbcd, stride, count + safe);
+}
+static const FnPackBcdRun kPackBcdRunSse41[] = {
+   nullptr,
+   &PackBcdRunSse41<1>, &PackBcdRunSse41<2>, &PackBcdRunSse41<3>, &PackBcdRunSse41<4>,
+   &PackBcdRunSse41<5>, &PackBcdRunSse41<6>, &PackBcdRunSse41<7>, &PackBcdRunSse41<8>,
+};
+
+fon9_TARGET_AVX2 static inline __m256i PackBcdLanesAvx2(__m256i v) {
+   const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0f));
+   const __m256i h2 = _mm256_add_epi8(hi, hi);
+   v = _mm256_sub_epi8(v, _mm256_add_epi8(_mm256_add_epi8(h2, h2), h2));
+   v = _mm256_maddubs_epi16(v, _mm256_set1_epi16(0x0164));
+   v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00012710));
+   return _mm256_add_epi64(_mm256_mul_epu32(v, _mm256_set1_epi64x(100000000)), _mm256_srli_epi64(v, 32));
+}
+template <unsigned kSize>
+fon9_TARGET_AVX2 static void PackBcdRunAvx2(uint64_t* out, const byte* pbcd, size_t stride, size_t count) {
+   if (count == 0)
+      return;
+   size_t safe = PackBcdSafeLoadCount(kSize, stride, count);
+   count -= safe;
+   for (; safe >= 4; safe -= 4) {
+      const __m256i v = _mm256_inserti128_si256(
+         _mm256_castsi128_si256(PackBcdLoad2Sse41<kSize>(pbcd, stride)),
+         PackBcdLoad2Sse41<kSize>(pbcd + stride * 2, stride), 1);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), PackBcdLanesAvx2(v));
+      out += 4;
+      pbcd += stride * 4;
+   }
+   if (safe >= 2) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), PackBcdLanesSse41(PackBcdLoad2Sse41<kSize>(pbcd, stride)));
+      out += 2;
+      pbcd += stride * 2;
+      safe -= 2;
+   }
+   PackBcdRunScalar<kSize>(out, pbcd, stride, count + safe);
+}
+static const FnPackBcdRun kPackBcdRunAvx2[] = {
+   nullptr,
+   &PackBcdRunAvx2<1>, &PackBcdRunAvx2<2>, &PackBcdRunAvx2<3>, &PackBcdRunAvx2<4>,
+   &PackBcdRunAvx2<5>, &PackBcdRunAvx2<6>, &PackBcdRunAvx2<7>, &PackBcdRunAvx2<8>,
+};
+#endif
+
+//--------------------------------------------------------------------------//
+
+struct PackBcdRunKernelTraits {
+   using Kernel = PackBcdRunKernel;
+   using Fn = const FnPackBcdRun*;
+   static constexpr Kernel kDefaultMax = PackBcdRunKernel::Avx2;
+   static bool IsSupported(PackBcdRunKernel kernel) {
+      switch (kernel) {
+      case PackBcdRunKernel::Scalar:
+         return true;
+   #if fon9_HAS_X86_SIMD
+      case PackBcdRunKernel::Sse41:
+         return GetCpuFeatures().Sse41_;
+      case PackBcdRunKernel::Avx2:
+         return GetCpuFeatures().Avx2_;
+   #else
+      case PackBcdRunKernel::Sse41:
+      case PackBcdRunKernel::Avx2:
+         break;
+   #endif
+      }
+      return false;
+   }
+   static const FnPackBcdRun* GetFn(PackBcdRunKernel kernel) {
+   #if fon9_HAS_X86_SIMD
+      switch (kernel) {
+      case PackBcdRunKernel::Scalar:
+         break;
+      case PackBcdRunKernel::Sse41:
+         return kPackBcdRunSse41;
+      case PackBcdRunKernel::Avx2:
+         return kPackBcdRunAvx2;
+      }
+   #else
+      (void)kernel;
+   #endif
+      return kPackBcdRunScalar;
+   }
+};
+using PackBcdRunKernelSelector = CpuKernelSelector<PackBcdRunKernelTraits>;
+
+fon9_API PackBcdRunKernel GetPackBcdRunKernel() {
+   return PackBcdRunKernelSelector::GetKernel();
+}
+fon9_API bool SetPackBcdRunKernel(PackBcdRunKernel kernel) {
+   return PackBcdRunKernelSelector::SetKernel(kernel);
+}
+fon9_API void PackBcdRunTo(uint64_t* out, const void* pbcd, unsigned fieldSize, size_t stride, size_t count) {
+   assert(0 < fieldSize && fieldSize <= 8);
+   PackBcdRunKernelSelector::GetFn()[fieldSize](out, static_cast<const byte*>(pbcd), stride, count);
+}
+
+} // namespace
@@ -3,6 +3,7 @@
 #ifndef __fon9_PackBcd_hpp__
 #define __fon9_PackBcd_hpp__
 #include "fon9/DecBase.hpp"
+#include "fon9/Endian.hpp"
 
 namespace fon9 {
 
@@ -84,5 +85,62 @@ inline void ToPackBcd(unsigned char (&pbuf)[sz], IntT num) {
    ToPackBcd<sz * 2, IntT>(static_cast<void*>(pbuf), num);
 }
 
+//--------------------------------------------------------------------------//
+
+namespace impl {
+/// SWAR: 一次處理 8 bytes(16 位數) 的 Pack BCD, bcd8 為 big-endian 載入的值(高位數在高位元).
+inline uint64_t PackBcd8To(uint64_t bcd8) {
+   // 每個 byte: hi*16+lo => hi*10+lo; 最大 99, 不會進位到隔壁的 byte.
+   const uint64_t hi = (bcd8 >> 4) & 0x0f0f0f0f0f0f0f0fu;
+   bcd8 -= hi * 6;
+   // 每 2 bytes => 0..9999
+   bcd8 = ((bcd8 >> 8) & 0x00ff00ff00ff00ffu) * 100 + (bcd8 & 0x00ff00ff00ff00ffu);
+   // 每 4 bytes => 0..99999999
+   bcd8 = ((bcd8 >> 16) & 0x0000ffff0000ffffu) * 10000 + (bcd8 & 0x0000ffff0000ffffu);
+   return (bcd8 >> 32) * 100000000u + (bcd8 & 0xffffffffu);
+}
+} // namespace impl
+
+/// \ingroup AlNum
+/// 將 kSize(1..8) bytes 的 Pack BCD 一次轉成整數(SWAR), 不用逐 byte 計算.
+/// - 適合較長的欄位, 例: 序號 PackBcd<10>, 數量 PackBcd<8>, 價格 PackBcd<9>.
+/// - 與 PackBcdTo<unsigned char[kSize]>() 相同, 會包含第一個 byte 的高位數.
+template <unsigned kSize>
+inline uint64_t PackBcdBytesTo(const void* pbcd) {
+   static_assert(0 < kSize && kSize <= 8, "PackBcdBytesTo() kSize must in 1..8.");
+   unsigned char buf[8] = {0};
+   memcpy(buf + (8 - kSize), pbcd, kSize);
+   return impl::PackBcd8To(GetBigEndian<uint64_t>(buf));
+}
+template <typename IntT, unsigned sz>
+inline IntT PackBcdBytesTo(const unsigned char (&pbcd)[sz]) {
+   static_assert(static_cast<IntT>(DecDivisor<uint64_t, sz * 2>::Divisor - 1) == DecDivisor<uint64_t, sz * 2>::Divisor - 1,
+                 "The result may be overflow.");
+   return static_cast<IntT>(PackBcdBytesTo<sz>(pbcd));
+}
+
+/// \ingroup AlNum
+/// PackBcdRunTo() 使用的實作方式.
+enum class PackBcdRunKernel : uint8_t {
+   /// 使用 PackBcdBytesTo(): SWAR, 一次處理一個欄位.
+   Scalar,
+   /// 一次處理 2 個欄位.
+   Sse41,
+   /// 一次處理 4 個欄位.
+   Avx2,
+};
+/// 預設: 根據 GetCpuFeatures() 選擇可用的最快版本.
+fon9_API PackBcdRunKernel GetPackBcdRunKernel();
+/// 通常用於測試、效能評估.
+/// \retval false CPU 不支援, 維持原本的設定.
+fon9_API bool SetPackBcdRunKernel(PackBcdRunKernel kernel);
+
+/// \ingroup AlNum
+/// 一次解碼多個「相同大小」的 Pack BCD 欄位, 例: 5檔買賣的價格(或數量).
+/// - pbcd 指向第一個欄位, 每個欄位相距 stride bytes;
+/// - fieldSize 為每個欄位的 bytes 數, 必須在 1..8 之間;
+/// - out[0..count) = PackBcdBytesTo<fieldSize>(pbcd + stride * i);
+fon9_API void PackBcdRunTo(uint64_t* out, const void* pbcd, unsigned fieldSize, size_t stride, size_t count);
+
 } // namespace fon9
 #endif//__fon9_PackBcd_hpp__
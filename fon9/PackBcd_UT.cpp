@@ -4,6 +4,8 @@
 #include "fon9/PackBcd.hpp"
 #include "fon9/TestTools.hpp"
 #include "fon9/DecBase.hpp"
+#include "fon9/CpuFeatures.hpp"
+#include <random>
 
 template <unsigned kPackedWidth>
 void TestPackBcd() {
@@ -46,6 +48,178 @@ void TestPackBcd() {
    std::cout << "\r[OK   ]" << std::endl;
 }
 
+//--------------------------------------------------------------------------//
+static std::mt19937_64 gRandom{20201018};
+
+/// 產生 kSize bytes 的 Pack BCD 亂數, 並傳回對應的整數.
+static uint64_t RandomPackBcd(unsigned char* pbuf, unsigned kSize) {
+   uint64_t val = 0;
+   for (unsigned L = 0; L < kSize; ++L) {
+      const unsigned v = static_cast<unsigned>(gRandom() % 100);
+      pbuf[L] = static_cast<unsigned char>(((v / 10) << 4) | (v % 10));
+      val = val * 100 + v;
+   }
+   return val;
+}
+
+template <unsigned kSize>
+void TestPackBcdBytesTo() {
+   std::cout << "[TEST ] PackBcdBytesTo<" << kSize << ">" << std::flush;
+   unsigned char buf[kSize];
+   for (unsigned L = 0; L < 100000; ++L) {
+      const uint64_t val = RandomPackBcd(buf, kSize);
+      const uint64_t res = fon9::PackBcdBytesTo<kSize>(buf);
+      if (res != val || res != fon9::PackBcdTo<kSize * 2, uint64_t>(buf)) {
+         std::cout << "|val=" << val << "|res=" << res << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+static const char* PackBcdRunKernelName(fon9::PackBcdRunKernel kernel) {
+   switch (kernel) {
+   case fon9::PackBcdRunKernel::Scalar: return "Scalar";
+   case fon9::PackBcdRunKernel::Sse41:  return "SSE4.1";
+   case fon9::PackBcdRunKernel::Avx2:   return "AVX2";
+   }
+   return "?";
+}
+static const fon9::PackBcdRunKernel kPackBcdRunKernels[] = {
+   fon9::PackBcdRunKernel::Scalar,
+   fon9::PackBcdRunKernel::Sse41,
+   fon9::PackBcdRunKernel::Avx2,
+};
+
+void TestPackBcdRunTo() {
+   const unsigned kMaxCount = 13;
+   const unsigned kPadding = 3;
+   for (fon9::PackBcdRunKernel kernel : kPackBcdRunKernels) {
+      if (!fon9::SetPackBcdRunKernel(kernel)) {
+         std::cout << "[SKIP ] PackBcdRunTo|kernel=" << PackBcdRunKernelName(kernel) << "|not supported." << std::endl;
+         continue;
+      }
+      std::cout << "[TEST ] PackBcdRunTo|kernel=" << PackBcdRunKernelName(kernel) << std::flush;
+      for (unsigned fieldSize = 1; fieldSize <= 8; ++fieldSize) {
+         const size_t   stride = fieldSize + kPadding;
+         unsigned char  buf[(8 + kPadding) * kMaxCount];
+         uint64_t       expected[kMaxCount];
+         uint64_t       out[kMaxCount + 1];
+         for (unsigned count = 0; count <= kMaxCount; ++count) {
+            memset(buf, 0xff, sizeof(buf));
+            for (unsigned L = 0; L < count; ++L)
+               expected[L] = RandomPackBcd(buf + stride * L, fieldSize);
+            out[count] = 0x5a5a5a5a;
+            fon9::PackBcdRunTo(out, buf, fieldSize, stride, count);
+            if (memcmp(out, expected, sizeof(out[0]) * count) != 0 || out[count] != 0x5a5a5a5a) {
+               std::cout << "|fieldSize=" << fieldSize << "|count=" << count << "\r[ERROR]" << std::endl;
+               abort();
+            }
+         }
+      }
+      std::cout << "\r[OK   ]" << std::endl;
+   }
+}
+
+//--------------------------------------------------------------------------//
+// 避免 compiler 把迴圈內的計算移到迴圈外.
+#ifdef _MSC_VER
+   #define BenchClobber(p)    _ReadWriteBarrier()
+#else
+   #define BenchClobber(p)    __asm__ volatile("" : : "g"(p) : "memory")
+#endif
+
+fon9_PACK(1);
+// 與 f9tws::ExgMdPriQty 相同.
+struct BenchPriQty {
+   fon9::PackBcd<9>  PriV4_;
+   fon9::PackBcd<8>  Qty_;
+};
+fon9_PACK_POP;
+
+void BenchPackBcd() {
+   const unsigned    kTimes = 1000000;
+   const unsigned    kCount = 10; // 5檔買 + 5檔賣.
+   BenchPriQty       pqs[kCount];
+   for (BenchPriQty& pq : pqs) {
+      RandomPackBcd(pq.PriV4_, sizeof(pq.PriV4_));
+      RandomPackBcd(pq.Qty_, sizeof(pq.Qty_));
+   }
+   uint64_t          pris[kCount], qtys[kCount];
+   uint64_t          chk = 0;
+   fon9::StopWatch   stopWatch;
+   for (unsigned L = 0; L < kTimes; ++L) {
+      for (unsigned i = 0; i < kCount; ++i) {
+         pris[i] = fon9::PackBcdTo<uint64_t>(pqs[i].PriV4_);
+         qtys[i] = fon9::PackBcdTo<uint64_t>(pqs[i].Qty_);
+      }
+      chk += pris[L % kCount] + qtys[L % kCount];
+      BenchClobber(pqs);
+   }
+   stopWatch.PrintResult("PriQty[10]: PackBcdTo<>     ", kTimes);
+   const uint64_t chk0 = chk;
+
+   chk = 0;
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes; ++L) {
+      for (unsigned i = 0; i < kCount; ++i) {
+         pris[i] = fon9::PackBcdBytesTo<uint64_t>(pqs[i].PriV4_);
+         qtys[i] = fon9::PackBcdBytesTo<uint64_t>(pqs[i].Qty_);
+      }
+      chk += pris[L % kCount] + qtys[L % kCount];
+      BenchClobber(pqs);
+   }
+   stopWatch.PrintResult("PriQty[10]: PackBcdBytesTo<>", kTimes);
+   if (chk != chk0) {
+      std::cout << "[ERROR] PackBcdBytesTo() result not match." << std::endl;
+      abort();
+   }
+
+   for (fon9::PackBcdRunKernel kernel : kPackBcdRunKernels) {
+      if (!fon9::SetPackBcdRunKernel(kernel))
+         continue;
+      chk = 0;
+      stopWatch.ResetTimer();
+      for (unsigned L = 0; L < kTimes; ++L) {
+         fon9::PackBcdRunTo(pris, pqs[0].PriV4_, sizeof(pqs[0].PriV4_), sizeof(pqs[0]), kCount);
+         fon9::PackBcdRunTo(qtys, pqs[0].Qty_, sizeof(pqs[0].Qty_), sizeof(pqs[0]), kCount);
+         chk += pris[L % kCount] + qtys[L % kCount];
+         BenchClobber(pqs);
+      }
+      std::string msg = "PriQty[10]: PackBcdRunTo:";
+      msg.append(PackBcdRunKernelName(kernel));
+      msg.resize(34, ' ');
+      stopWatch.PrintResult(msg.c_str(), kTimes);
+      if (chk != chk0) {
+         std::cout << "[ERROR] PackBcdRunTo() result not match." << std::endl;
+         abort();
+      }
+   }
+
+   // 期交所逐筆行情的 ChannelSeq_: PackBcd<10>;
+   fon9::PackBcd<10> seq;
+   RandomPackBcd(seq, sizeof(seq));
+   chk = 0;
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes * 10; ++L) {
+      chk += fon9::PackBcdTo<uint64_t>(seq);
+      BenchClobber(seq);
+   }
+   stopWatch.PrintResult("PackBcd<10>: PackBcdTo<>     ", kTimes * 10);
+   const uint64_t chkSeq = chk;
+   chk = 0;
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes * 10; ++L) {
+      chk += fon9::PackBcdBytesTo<uint64_t>(seq);
+      BenchClobber(seq);
+   }
+   stopWatch.PrintResult("PackBcd<10>: PackBcdBytesTo<>", kTimes * 10);
+   if (chk != chkSeq) {
+      std::cout << "[ERROR] PackBcdBytesTo<10>() result not match." << std::endl;
+      abort();
+   }
+}
+
 int main() {
    fon9::AutoPrintTestInfo utinfo{"PackBcd"};
    TestPackBcd<1>();
@@ -59,4 +233,22 @@ int main() {
    // TestPackBcd<8>();
    // TestPackBcd<9>();
    // TestPackBcd<10>();
+
+   utinfo.PrintSplitter();
+   TestPackBcdBytesTo<1>();
+   TestPackBcdBytesTo<2>();
+   TestPackBcdBytesTo<3>();
+   TestPackBcdBytesTo<4>();
+   TestPackBcdBytesTo<5>();
+   TestPackBcdBytesTo<6>();
+   TestPackBcdBytesTo<7>();
+   TestPackBcdBytesTo<8>();
+   TestPackBcdRunTo();
+
+   utinfo.PrintSplitter();
+   const fon9::PackBcdRunKernel kernel = fon9::GetPackBcdRunKernel();
+   std::cout << "CpuFeatures: SSE4.1=" << fon9::GetCpuFeatures().Sse41_
+             << "|AVX2=" << fon9::GetCpuFeatures().Avx2_ << std::endl;
+   BenchPackBcd();
+   fon9::SetPackBcdRunKernel(kernel);
 }
@@ -4,6 +4,91 @@
 
 namespace fon9 {
 
+void PkContPendings::ResetRing(size_t slotCount, unsigned slotSize) {
+   if (slotCount > 0) {
+      size_t count = 1;
+      while (count < slotCount)
+         count <<= 1;
+      slotCount = count;
+   }
+   for (size_t idx = 0; idx < this->Heads_.size(); ++idx) {
+      const SlotHead& slot = this->Heads_[idx];
+      if (slot.Seq_ != 0)
+         this->Overflow_.insert(PkRec{slot.Seq_}).first->assign(this->SlotData(idx), slot.Size_);
+   }
+   this->Heads_.assign(slotCount, SlotHead{0, 0, {}});
+   this->Slots_.resize(slotCount * slotSize);
+   this->Slots_.shrink_to_fit();
+   this->SlotMask_ = (slotCount ? slotCount - 1 : 0);
+   this->SlotSize_ = (slotCount ? slotSize : 0);
+   this->RingCount_ = 0;
+}
+void PkContPendings::clear() {
+   if (this->RingCount_ > 0) {
+      for (SeqT seq = this->RingFront_; seq <= this->RingBack_; ++seq)
+         this->Heads_[static_cast<size_t>(seq & this->SlotMask_)].Seq_ = 0;
+      this->RingCount_ = 0;
+   }
+   this->Overflow_.clear();
+}
+void PkContPendings::DropBefore(SeqT nextSeq) {
+   if (this->RingCount_ > 0 && this->RingFront_ < nextSeq) {
+      if (this->RingBack_ < nextSeq) {
+         for (SeqT seq = this->RingFront_; seq <= this->RingBack_; ++seq)
+            this->Heads_[static_cast<size_t>(seq & this->SlotMask_)].Seq_ = 0;
+         this->RingCount_ = 0;
+      }
+      else {
+         do {
+            this->RingErase(static_cast<size_t>(this->RingFront_ & this->SlotMask_));
+         } while (this->RingFront_ < nextSeq);
+      }
+   }
+   if (!this->Overflow_.empty() && this->Overflow_.begin()->Seq_ < nextSeq)
+      this->Overflow_.erase(this->Overflow_.begin(), this->Overflow_.lower_bound(PkRec{nextSeq}));
+}
+bool PkContPendings::Insert(SeqT nextSeq, SeqT seq, const void* pk, unsigned pksz) {
+   assert(seq > nextSeq);
+   this->DropBefore(nextSeq);
+   if (seq - nextSeq < this->Heads_.size() && pksz <= this->SlotSize_) {
+      const size_t idx = static_cast<size_t>(seq & this->SlotMask_);
+      SlotHead&    slot = this->Heads_[idx];
+      if (slot.Seq_ == seq)
+         return false;
+      // 加入後 Ring 的序號範圍必須 < slotCount(例: 衍生者讓 NextSeq_ 往回調整),
+      // 且 Overflow_ 沒有此序號; 否則交給 Overflow_ 處理.
+      if (this->RingCount_ == 0) {
+         this->RingFront_ = this->RingBack_ = seq;
+      }
+      else if (seq < this->RingFront_) {
+         if (this->RingBack_ - seq >= this->Heads_.size())
+            goto __INSERT_OVERFLOW;
+      }
+      else if (seq > this->RingBack_) {
+         if (seq - this->RingFront_ >= this->Heads_.size())
+            goto __INSERT_OVERFLOW;
+      }
+      if (slot.Seq_ == 0 && (this->Overflow_.empty() || this->Overflow_.find(PkRec{seq}) == this->Overflow_.end())) {
+         slot.Seq_ = seq;
+         slot.Size_ = pksz;
+         memcpy(this->Slots_.data() + idx * this->SlotSize_, pk, pksz);
+         if (this->RingCount_++ > 0) {
+            if (seq < this->RingFront_)
+               this->RingFront_ = seq;
+            else if (seq > this->RingBack_)
+               this->RingBack_ = seq;
+         }
+         return true;
+      }
+   }
+__INSERT_OVERFLOW:;
+   auto ires = this->Overflow_.insert(PkRec{seq});
+   if (!ires.second)
+      return false;
+   ires.first->assign(static_cast<const char*>(pk), pksz);
+   return true;
+}
+//--------------------------------------------------------------------------//
 PkContFeeder::PkContFeeder() {
 }
 PkContFeeder::~PkContFeeder() {
@@ -23,12 +108,26 @@ void PkContFeeder::EmitOnTimer(TimerEntry* timer, TimeStamp now) {
    PkContFeeder& rthis = ContainerOf(*static_cast<decltype(PkContFeeder::Timer_)*>(timer), &PkContFeeder::Timer_);
    rthis.PkContOnTimer(rthis.PkPendings_.Lock());
 }
-void PkContFeeder::PkContOnTimer(PkPendings::Locker&& pks) {
-   for (const auto& i : *pks) {
-      this->LostCount_ += (i.Seq_ - this->NextSeq_);
-      this->CallOnReceived(i.data(), static_cast<unsigned>(i.size()), i.Seq_);
+void PkContFeeder::SetPkPendingsRing(uint32_t pkPerSecond, unsigned slotSize) {
+   size_t slotCount = 0;
+   if (pkPerSecond > 0) {
+      // 等候期間, 可能持續收到封包; 所以保留 2 倍的空間.
+      const uint64_t us = static_cast<uint64_t>(this->WaitInterval_.ShiftUnit<6>());
+      slotCount = static_cast<size_t>(us * pkPerSecond * 2 / 1000000);
+      if (slotCount < 64)
+         slotCount = 64;
    }
-   pks->clear();
+   this->PkPendings_.Lock()->ResetRing(slotCount, slotSize);
+}
+void PkContFeeder::PopPendings(PkPendingsImpl& pks, SeqT lastSeq) {
+   pks.PopUntil(lastSeq, this->NextSeq_, [this](const void* pk, unsigned pksz, SeqT seq) {
+      this->LostCount_ += (seq - this->NextSeq_);
+      this->CallOnReceived(pk, pksz, seq);
+      return this->NextSeq_;
+   });
+}
+void PkContFeeder::PkContOnTimer(PkPendings::Locker&& pks) {
+   this->PopPendings(*pks, std::numeric_limits<SeqT>::max());
 }
 void PkContFeeder::PkContOnDropped(const void* pk, unsigned pksz, SeqT seq) {
    (void)pk; (void)pksz; (void)seq;
@@ -41,16 +140,10 @@ __PK_RECEIVED:
          this->CallOnReceived(pk, pksz, seq);
          if (fon9_LIKELY(pks->empty()))
             return;
-         auto const ibeg = pks->begin();
-         auto const iend = pks->end();
-         auto i = ibeg;
-         while (i->Seq_ == this->NextSeq_) {
-            this->CallOnReceived(i->data(), static_cast<unsigned>(i->size()), i->Seq_);
-            if (++i == iend)
-               break;
-         }
-         if (ibeg != i)
-            pks->erase(ibeg, i);
+         pks->PopCont(this->NextSeq_, [this](const void* pkpend, unsigned pkszpend, SeqT seqpend) {
+            this->CallOnReceived(pkpend, pkszpend, seqpend);
+            return this->NextSeq_;
+         });
          return;
       }
       if (seq < this->NextSeq_) {
@@ -61,10 +154,8 @@ __PK_RECEIVED:
       if (this->NextSeq_ == 0 || this->WaitInterval_.GetOrigValue() == 0)
          goto __PK_RECEIVED;
       bool isNeedsRunAfter = pks->empty();
-      auto ires = pks->insert(PkRec{seq});
-      if (!ires.second)
+      if (!pks->Insert(this->NextSeq_, seq, pk, pksz))
          return;
-      ires.first->assign(static_cast<const char*>(pk), pksz);
       if (!isNeedsRunAfter)
          return;
    } // auto unlock this->PkPendings_.
@@ -7,6 +7,187 @@
 
 namespace fon9 {
 
+/// \ingroup Misc.
+/// PkContFeeder 用來保留「不連續(等候中)」的封包.
+/// - 預設只使用 SortedVectorSet<PkRec>: 每個封包需要配置一次記憶體, 且插入為 O(n).
+/// - 若有呼叫 ResetRing(): 預先配置 slotCount 個 slot, 每個 slot 最多可放 slotSize bytes.
+///   - 序號在 [nextSeq, nextSeq + slotCount) 範圍內, 且 pksz <= slotSize 的封包,
+///     直接放到 slot[seq % slotCount]: 插入、依序取出都是 O(1), 且不用配置記憶體.
+///   - 其餘的封包(超過範圍、太大), 仍放在 SortedVectorSet<PkRec>;
+///   - Ring 裡面封包的最小、最大序號範圍必定 < slotCount, 並記錄最小、最大序號,
+///     所以 FrontSeq()、BackSeq() 為 O(1), PopUntil() 不需要排序.
+class fon9_API PkContPendings {
+   fon9_NON_COPY_NON_MOVE(PkContPendings);
+public:
+   using SeqT = uint64_t;
+   struct PkRec : public std::string {
+      SeqT  Seq_;
+      PkRec(SeqT seq) : Seq_{seq} {
+      }
+      bool operator<(const PkRec& rhs) const {
+         return this->Seq_ < rhs.Seq_;
+      }
+   };
+   using OverflowImpl = SortedVectorSet<PkRec>;
+
+   /// 預設的 slot 大小, 可容納大部分的行情封包.
+   enum : unsigned {
+      kDefaultRingSlotSize = 256,
+   };
+
+   PkContPendings() = default;
+
+   /// slotCount 會調整成 2 的冪次; slotCount == 0 表示不使用 Ring.
+   /// 原本在 Ring 裡面的封包, 會移到 SortedVectorSet<PkRec>;
+   void ResetRing(size_t slotCount, unsigned slotSize = kDefaultRingSlotSize);
+   size_t GetRingSlotCount() const {
+      return this->Heads_.size();
+   }
+   unsigned GetRingSlotSize() const {
+      return this->SlotSize_;
+   }
+
+   bool empty() const {
+      return this->RingCount_ == 0 && this->Overflow_.empty();
+   }
+   size_t size() const {
+      return this->RingCount_ + this->Overflow_.size();
+   }
+   void clear();
+
+   /// 加入一個等候中的封包, 必須 seq > nextSeq;
+   /// 加入前會先移除 seq < nextSeq 的過期封包.
+   /// \retval false 序號重複, 沒有加入.
+   bool Insert(SeqT nextSeq, SeqT seq, const void* pk, unsigned pksz);
+
+   /// 移除全部 seq < nextSeq 的過期封包.
+   /// 例: 衍生者在 PkContOnReceived() 調整了 AfterNextSeq_, 跳過了等候中的封包.
+   void DropBefore(SeqT nextSeq);
+
+   /// 最小的序號, 必須 !empty();
+   SeqT FrontSeq() const {
+      assert(!this->empty());
+      if (this->RingCount_ == 0)
+         return this->Overflow_.begin()->Seq_;
+      if (this->Overflow_.empty() || this->RingFront_ < this->Overflow_.begin()->Seq_)
+         return this->RingFront_;
+      return this->Overflow_.begin()->Seq_;
+   }
+   /// 最大的序號, 必須 !empty();
+   SeqT BackSeq() const {
+      assert(!this->empty());
+      if (this->RingCount_ == 0)
+         return this->Overflow_.back().Seq_;
+      if (this->Overflow_.empty() || this->RingBack_ > this->Overflow_.back().Seq_)
+         return this->RingBack_;
+      return this->Overflow_.back().Seq_;
+   }
+
+   /// 從 nextSeq 開始, 依序取出連續的封包: nextSeq = fnOnPk(pk, pksz, seq);
+   /// fnOnPk() 返回: 處理完此封包後, 期望的下一個序號.
+   /// 取出前、後, 都會移除 seq < nextSeq 的過期封包.
+   template <class FnOnPk>
+   void PopCont(SeqT nextSeq, FnOnPk&& fnOnPk) {
+      this->DropBefore(nextSeq);
+      auto const ovBeg = this->Overflow_.begin();
+      auto const ovEnd = this->Overflow_.end();
+      auto       ov = ovBeg;
+      for (;;) {
+         if (this->RingCount_ > 0) {
+            const size_t idx = static_cast<size_t>(nextSeq & this->SlotMask_);
+            SlotHead&    slot = this->Heads_[idx];
+            if (slot.Seq_ == nextSeq) {
+               this->RingErase(idx);
+               nextSeq = fnOnPk(this->SlotData(idx), slot.Size_, nextSeq);
+               continue;
+            }
+         }
+         if (ov == ovEnd || ov->Seq_ != nextSeq)
+            break;
+         nextSeq = fnOnPk(ov->data(), static_cast<unsigned>(ov->size()), ov->Seq_);
+         ++ov;
+      }
+      if (ov != ovBeg)
+         this->Overflow_.erase(ovBeg, ov);
+      this->DropBefore(nextSeq);
+   }
+   /// 依序號順序取出全部 seq <= lastSeq 的封包(不論是否連續), 然後再取出連續的封包.
+   /// 過程中若 fnOnPk() 返回的 nextSeq 跳過了等候中的封包, 則這些封包會被拋棄, 不會通知 fnOnPk().
+   template <class FnOnPk>
+   void PopUntil(SeqT lastSeq, SeqT nextSeq, FnOnPk&& fnOnPk) {
+      this->DropBefore(nextSeq);
+      auto const  ovBeg = this->Overflow_.begin();
+      auto const  ovEnd = this->Overflow_.end();
+      auto        ov = ovBeg;
+      for (;;) {
+         const bool isRing = (this->RingCount_ > 0 && (ov == ovEnd || this->RingFront_ < ov->Seq_));
+         if (!isRing && ov == ovEnd)
+            break;
+         const SeqT seq = (isRing ? this->RingFront_ : ov->Seq_);
+         if (seq > lastSeq && seq != nextSeq)
+            break;
+         if (isRing) {
+            const size_t idx = static_cast<size_t>(seq & this->SlotMask_);
+            this->RingErase(idx);
+            if (seq >= nextSeq)
+               nextSeq = fnOnPk(this->SlotData(idx), this->Heads_[idx].Size_, seq);
+         }
+         else {
+            if (seq >= nextSeq)
+               nextSeq = fnOnPk(ov->data(), static_cast<unsigned>(ov->size()), seq);
+            ++ov;
+         }
+      }
+      if (ov != ovBeg)
+         this->Overflow_.erase(ovBeg, ov);
+      this->DropBefore(nextSeq);
+   }
+
+private:
+   struct SlotHead {
+      /// 0 表示此 slot 沒有封包.
+      SeqT     Seq_;
+      unsigned Size_;
+      char     Padding____[4];
+   };
+   std::vector<SlotHead>   Heads_;
+   std::vector<char>       Slots_;
+   SeqT                    SlotMask_{0};
+   /// RingCount_ > 0 時有效: Ring 裡面封包的最小、最大序號.
+   SeqT                    RingFront_{0};
+   SeqT                    RingBack_{0};
+   size_t                  RingCount_{0};
+   unsigned                SlotSize_{0};
+   char                    Padding____[4];
+   OverflowImpl            Overflow_;
+
+   const char* SlotData(size_t idx) const {
+      return this->Slots_.data() + idx * this->SlotSize_;
+   }
+   /// 移除 Heads_[idx] 的封包(必須有封包), 並調整 RingFront_、RingBack_;
+   /// 因為 RingBack_ - RingFront_ < slotCount, 所以往前(後)找下一個封包時, 必定會在 RingBack_(RingFront_) 停止.
+   /// Slots_ 的內容不變, 所以移除後仍可使用 SlotData(idx);
+   void RingErase(size_t idx) {
+      const SeqT seq = this->Heads_[idx].Seq_;
+      this->Heads_[idx].Seq_ = 0;
+      if (--this->RingCount_ == 0)
+         return;
+      SeqT s = seq;
+      if (seq == this->RingFront_) {
+         do {
+            ++s;
+         } while (this->Heads_[static_cast<size_t>(s & this->SlotMask_)].Seq_ != s);
+         this->RingFront_ = s;
+      }
+      else if (seq == this->RingBack_) {
+         do {
+            --s;
+         } while (this->Heads_[static_cast<size_t>(s & this->SlotMask_)].Seq_ != s);
+         this->RingBack_ = s;
+      }
+   }
+};
+
 /// \ingroup Misc.
 /// 確保收到封包的連續性.
 /// - 可能有多個資訊源, 但序號相同.
@@ -35,6 +216,10 @@ public:
    void SetWaitInterval(TimeInterval v) {
       this->WaitInterval_ = v;
    }
+   /// 使用預先配置的 Ring 保留等候中的封包, 避免在封包遺失(或亂序)時配置記憶體.
+   /// - slot 數量 = WaitInterval_ * pkPerSecond * 2; 所以應在 SetWaitInterval() 之後呼叫.
+   /// - pkPerSecond == 0 表示不使用 Ring;
+   void SetPkPendingsRing(uint32_t pkPerSecond, unsigned slotSize = PkContPendings::kDefaultRingSlotSize);
 
 protected:
    SeqT           NextSeq_{0};
@@ -52,18 +237,15 @@ protected:
    SeqT           AfterNextSeq_;
    TimeInterval   WaitInterval_{TimeInterval_Millisecond(5)};
    
-   struct PkRec : public std::string {
-      SeqT  Seq_;
-      PkRec(SeqT seq) : Seq_{seq} {
-      }
-      bool operator<(const PkRec& rhs) const {
-         return this->Seq_ < rhs.Seq_;
-      }
-   };
-   using PkPendingsImpl = SortedVectorSet<PkRec>;
+   using PkRec = PkContPendings::PkRec;
+   using PkPendingsImpl = PkContPendings;
    using PkPendings = MustLock<PkPendingsImpl>;
    PkPendings  PkPendings_;
 
+   /// 依序處理 pks 裡面 seq <= lastSeq 的封包(不連續的部分計入 LostCount_), 然後再處理連續的封包.
+   /// 呼叫前 pks 必須是 this->PkPendings_ locked 的內容.
+   void PopPendings(PkPendingsImpl& pks, SeqT lastSeq);
+   /// 預設: 處理全部等候中的封包.
    virtual void PkContOnTimer(PkPendings::Locker&& pks);
    static void EmitOnTimer(TimerEntry* timer, TimeStamp now);
    DataMemberEmitOnTimer<&PkContFeeder::EmitOnTimer> Timer_;
@@ -5,6 +5,7 @@
 #include "fon9/TestTools.hpp"
 #include "fon9/Endian.hpp"
 #include "fon9/CountDownLatch.hpp"
+#include <random>
 
 struct Feeder : public fon9::PkContFeeder {
    fon9_NON_COPY_NON_MOVE(Feeder);
@@ -15,6 +16,8 @@ struct Feeder : public fon9::PkContFeeder {
    using base::ReceivedCount_;
    using base::DroppedCount_;
    using base::WaitInterval_;
+   using base::LostCount_;
+   using base::PkPendings_;
    SeqT  ExpectedNextSeq_{0};
    SeqT  ExpectedSeq_{0};
 
@@ -55,36 +58,33 @@ struct Feeder : public fon9::PkContFeeder {
    }
 };
 
-int main(int argc, char* argv[]) {
-   (void)argc; (void)argv;
-   fon9::AutoPrintTestInfo utinfo{"PkCont"};
-   fon9::GetDefaultTimerThread();
-   struct TimeWaiter : public fon9::TimerEntry {
-      fon9_NON_COPY_NON_MOVE(TimeWaiter);
-      using base = fon9::TimerEntry;
-      fon9::CountDownLatch Waiter_{0};
-      TimeWaiter() : base{fon9::GetDefaultTimerThread()} {
-      }
-      virtual void OnTimerEntryReleased() override {
-         // TimeWaiter 作為 local data variable, 不需要 delete, 所以 OnTimerEntryReleased(): do nothing.
-      }
-      virtual void EmitOnTimer(fon9::TimeStamp now) override {
-         (void)now;
-         this->Waiter_.ForceWakeUp();
-      }
-      void WaitFor(fon9::TimeInterval ti) {
-         this->Waiter_.AddCounter(1);
-         this->RunAfter(ti);
-         this->Waiter_.Wait();
-      }
-   };
-   TimeWaiter waiter;
-   waiter.WaitFor(fon9::TimeInterval{});
+struct TimeWaiter : public fon9::TimerEntry {
+   fon9_NON_COPY_NON_MOVE(TimeWaiter);
+   using base = fon9::TimerEntry;
+   fon9::CountDownLatch Waiter_{0};
+   TimeWaiter() : base{fon9::GetDefaultTimerThread()} {
+   }
+   virtual void OnTimerEntryReleased() override {
+      // TimeWaiter 作為 local data variable, 不需要 delete, 所以 OnTimerEntryReleased(): do nothing.
+   }
+   virtual void EmitOnTimer(fon9::TimeStamp now) override {
+      (void)now;
+      this->Waiter_.ForceWakeUp();
+   }
+   void WaitFor(fon9::TimeInterval ti) {
+      this->Waiter_.AddCounter(1);
+      this->RunAfter(ti);
+      this->Waiter_.Wait();
+   }
+};
 
+void TestPkCont(TimeWaiter& waiter, uint32_t pkPerSecond) {
    const Feeder::SeqT   kSeqFrom = 123;
    const Feeder::SeqT   kSeqTo = 200;
    Feeder         feeder;
    Feeder::SeqT   seq = kSeqFrom;
+   feeder.SetPkPendingsRing(pkPerSecond);
+   std::cout << "[INFO ] PkCont|ring.slots=" << feeder.PkPendings_.Lock()->GetRingSlotCount() << std::endl;
    Feeder::SeqT   pkcount = kSeqTo - kSeqFrom + 1;
    feeder.ExpectedSeq_ = seq;
    // 測試1: ExpectedNextSeq==0, 序號=kSeqFrom..kSeqTo
@@ -109,4 +109,157 @@ int main(int argc, char* argv[]) {
       feeder.Feed(seq + L);
    waiter.WaitFor(feeder.WaitInterval_ + fon9::TimeInterval_Millisecond(1));
    feeder.CheckReceivedCount(pkcount += kGapCount + 1);
+
+   // 測試4: 超過 Ring 範圍的封包, 會放到 SortedVectorSet, 仍應依序處理.
+   const Feeder::SeqT kFarGap = feeder.PkPendings_.Lock()->GetRingSlotCount() + 10;
+   seq = feeder.NextSeq_;
+   std::cout << "[TEST ] PkCont.far gap and fill|gap=" << kFarGap;
+   for (Feeder::SeqT L = kFarGap; L > 0; --L)
+      feeder.Feed(seq + L);
+   feeder.Feed(seq);
+   feeder.CheckReceivedCount(pkcount += kFarGap + 1);
+}
+
+//--------------------------------------------------------------------------//
+/// 收到 JumpAt_ 時, 將 AfterNextSeq_ 調整為 JumpTo_; 模擬衍生者跳過了等候中的封包.
+struct JumpFeeder : public fon9::PkContFeeder {
+   fon9_NON_COPY_NON_MOVE(JumpFeeder);
+   using base = fon9::PkContFeeder;
+   JumpFeeder() = default;
+   using base::NextSeq_;
+   using base::PkPendings_;
+   SeqT  JumpAt_{0};
+   SeqT  JumpTo_{0};
+   std::vector<SeqT> Received_;
+
+   void Feed(SeqT seq) {
+      this->FeedPacket(&seq, sizeof(seq), seq);
+   }
+   void PkContOnReceived(const void* pk, unsigned pksz, SeqT seq) override {
+      (void)pk; (void)pksz;
+      this->Received_.push_back(seq);
+      if (seq == this->JumpAt_)
+         this->AfterNextSeq_ = this->JumpTo_;
+   }
+   void CheckPendings(size_t expectedSize, SeqT expectedFront, SeqT expectedBack) {
+      auto pks = this->PkPendings_.Lock();
+      std::cout << "|pendings.size=" << pks->size();
+      if (pks->size() != expectedSize
+          || (expectedSize > 0 && (pks->FrontSeq() != expectedFront || pks->BackSeq() != expectedBack))) {
+         std::cout << "|err=Unexpected pendings|expected.size=" << expectedSize
+            << "|front=" << expectedFront << "|back=" << expectedBack
+            << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   void CheckReceived(const std::vector<SeqT>& expected) {
+      if (this->Received_ != expected) {
+         std::cout << "|err=Unexpected received seqs:";
+         for (SeqT seq : this->Received_)
+            std::cout << ' ' << seq;
+         std::cout << "\r[ERROR]" << std::endl;
+         abort();
+      }
+      std::cout << "\r[OK   ]" << std::endl;
+   }
+};
+void TestPkContJump(uint32_t pkPerSecond) {
+   JumpFeeder feeder;
+   // 測試期間不要觸發 Timer, 所以在 SetPkPendingsRing() 之後才設定 WaitInterval.
+   feeder.SetPkPendingsRing(pkPerSecond);
+   feeder.SetWaitInterval(fon9::TimeInterval_Second(10));
+   std::cout << "[TEST ] PkCont.jump over pendings|ring.slots=" << feeder.PkPendings_.Lock()->GetRingSlotCount();
+   feeder.Feed(1);
+   feeder.Feed(3);
+   feeder.Feed(4);
+   feeder.Feed(5);
+   feeder.Feed(10);
+   feeder.CheckPendings(4, 3, 10);
+   // 收到 2 之後, 直接跳到 5: 3,4 過期應移除, 5 依序處理, 剩下 10 等候中.
+   feeder.JumpAt_ = 2;
+   feeder.JumpTo_ = 5;
+   feeder.Feed(2);
+   feeder.CheckPendings(1, 10, 10);
+   feeder.CheckReceived({1, 2, 5});
+
+   std::cout << "[TEST ] PkCont.fill late gap";
+   feeder.Feed(9);
+   feeder.Feed(7);
+   feeder.Feed(8);
+   feeder.CheckPendings(4, 7, 10);
+   feeder.Feed(6);
+   feeder.CheckPendings(0, 0, 0);
+   feeder.CheckReceived({1, 2, 5, 6, 7, 8, 9, 10});
+   feeder.Clear();
+}
+
+//--------------------------------------------------------------------------//
+struct BenchFeeder : public fon9::PkContFeeder {
+   fon9_NON_COPY_NON_MOVE(BenchFeeder);
+   BenchFeeder() = default;
+   using PkContFeeder::ReceivedCount_;
+   using PkContFeeder::DroppedCount_;
+   using PkContFeeder::LostCount_;
+   using PkContFeeder::WaitInterval_;
+   void PkContOnReceived(const void* pk, unsigned pksz, SeqT seq) override {
+      (void)pk; (void)pksz; (void)seq;
+   }
+};
+/// 模擬 A/B 兩條線路(內容相同, 各自有遺失, B 線路延遲一段距離), 合併後的吞吐量.
+void BenchABMerge(uint32_t pkPerSecond, const std::vector<uint64_t>& seqs, const char* msgHead) {
+   BenchFeeder feeder;
+   // 使用預設的 WaitInterval 計算 Ring 的大小之後,
+   // 測試期間不要觸發 Timer: 讓 A/B 線路自行補齊.
+   feeder.SetPkPendingsRing(pkPerSecond);
+   feeder.SetWaitInterval(fon9::TimeInterval_Second(10));
+   char pk[120];
+   memset(pk, 'x', sizeof(pk));
+   fon9::StopWatch stopWatch;
+   for (uint64_t seq : seqs)
+      feeder.FeedPacket(pk, sizeof(pk), seq);
+   const double secs = stopWatch.StopTimer();
+   std::string  msg = msgHead;
+   msg.resize(26, ' ');
+   stopWatch.PrintResultNoEOL(secs, msg.c_str(), seqs.size());
+   std::cout << "|received=" << feeder.ReceivedCount_
+             << "|dropped=" << feeder.DroppedCount_
+             << "|lost=" << feeder.LostCount_ << std::endl;
+   feeder.Clear();
+}
+void BenchABMerge() {
+   const uint64_t kPkCount = 2000000;
+   const unsigned kLagB = 500;   // B 線路落後 A 線路的封包數.
+   std::mt19937   rnd{20210};
+   std::vector<uint64_t> seqs;
+   seqs.reserve(kPkCount * 2);
+   // A/B 各有 5% 的遺失, 但不會同時遺失; 1 號封包兩條線路都有, 用來建立期望序號.
+   std::vector<char> lost(kPkCount + 1);
+   for (uint64_t seq = 2; seq <= kPkCount; ++seq) {
+      const auto r = rnd() % 40;
+      lost[seq] = static_cast<char>(r == 0 ? 'A' : r == 1 ? 'B' : 0);
+   }
+   for (uint64_t L = 1; L <= kPkCount + kLagB; ++L) {
+      if (L <= kPkCount && lost[L] != 'A')
+         seqs.push_back(L);
+      if (L > kLagB && lost[L - kLagB] != 'B')
+         seqs.push_back(L - kLagB);
+   }
+   BenchABMerge(0,       seqs, "ABMerge:SortedVectorSet");
+   BenchABMerge(100000,  seqs, "ABMerge:Ring");
+}
+
+int main(int argc, char* argv[]) {
+   (void)argc; (void)argv;
+   fon9::AutoPrintTestInfo utinfo{"PkCont"};
+   fon9::GetDefaultTimerThread();
+   TimeWaiter waiter;
+   waiter.WaitFor(fon9::TimeInterval{});
+
+   TestPkCont(waiter, 0);
+   TestPkCont(waiter, 10000);
+   TestPkContJump(0);
+   TestPkContJump(10000);
+
+   utinfo.PrintSplitter();
+   BenchABMerge();
 }
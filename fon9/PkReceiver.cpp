@@ -1,9 +1,133 @@
 ﻿// \file fon9/PkReceiver.cpp
 // \author fonwinz@gmail.com
 #include "fon9/PkReceiver.hpp"
+#include "fon9/CpuFeatures.hpp"
+
+#if fon9_HAS_X86_SIMD
+fon9_BEFORE_INCLUDE_STD;
+#include <immintrin.h>
+fon9_AFTER_INCLUDE_STD;
+#endif
 
 namespace fon9 {
 
+using FnXorSum = byte (*)(const byte* p, size_t sz);
+
+static inline byte XorSumFold64(uint64_t v) {
+   v ^= (v >> 32);
+   v ^= (v >> 16);
+   v ^= (v >> 8);
+   return static_cast<byte>(v);
+}
+static inline byte XorSumTail(const byte* p, size_t sz, uint64_t acc) {
+   uint64_t v;
+   for (; sz >= sizeof(v); sz -= sizeof(v)) {
+      memcpy(&v, p, sizeof(v));
+      acc ^= v;
+      p += sizeof(v);
+   }
+   byte cks = XorSumFold64(acc);
+   while (sz > 0) {
+      --sz;
+      cks = static_cast<byte>(cks ^ *p++);
+   }
+   return cks;
+}
+static byte XorSumScalar(const byte* p, size_t sz) {
+   return XorSumTail(p, sz, 0);
+}
+
+#if fon9_HAS_X86_SIMD
+// XOR 與 byte 的位置無關, 所以可以先把每個 lane 各自 XOR, 最後再摺疊成 1 byte.
+fon9_TARGET_SSE41 static inline uint64_t XorSumFold128(__m128i v) {
+   v = _mm_xor_si128(v, _mm_unpackhi_epi64(v, v));
+   const uint32_t lo = static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+   const uint32_t hi = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_epi64(v, 32)));
+   return lo ^ (static_cast<uint64_t>(hi) << 32);
+}
+fon9_TARGET_SSE41 static byte XorSumSse41(const byte* p, size_t sz) {
+   if (sz < 16)
+      return XorSumTail(p, sz, 0);
+   __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+   p += 16;
+   sz -= 16;
+   for (; sz >= 16; sz -= 16) {
+      acc = _mm_xor_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+      p += 16;
+   }
+   return XorSumTail(p, sz, XorSumFold128(acc));
+}
+fon9_TARGET_AVX2 static byte XorSumAvx2(const byte* p, size_t sz) {
+   if (sz < 32)
+      return XorSumSse41(p, sz);
+   __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+   p += 32;
+   sz -= 32;
+   for (; sz >= 32; sz -= 32) {
+      acc = _mm256_xor_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+      p += 32;
+   }
+   __m128i acc128 = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+   if (sz >= 16) {
+      acc128 = _mm_xor_si128(acc128, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+      p += 16;
+      sz -= 16;
+   }
+   return XorSumTail(p, sz, XorSumFold128(acc128));
+}
+#endif
+
+struct XorSumKernelTraits {
+   using Kernel = XorSumKernel;
+   using Fn = FnXorSum;
+   static constexpr Kernel kDefaultMax = XorSumKernel::Avx2;
+   static bool IsSupported(XorSumKernel kernel) {
+      switch (kernel) {
+      case XorSumKernel::Scalar:
+         return true;
+   #if fon9_HAS_X86_SIMD
+      case XorSumKernel::Sse41:
+         return GetCpuFeatures().Sse41_;
+      case XorSumKernel::Avx2:
+         return GetCpuFeatures().Avx2_;
+   #else
+      case XorSumKernel::Sse41:
+      case XorSumKernel::Avx2:
+         break;
+   #endif
+      }
+      return false;
+   }
+   static FnXorSum GetFn(XorSumKernel kernel) {
+   #if fon9_HAS_X86_SIMD
+      switch (kernel) {
+      case XorSumKernel::Scalar:
+         break;
+      case XorSumKernel::Sse41:
+         return &XorSumSse41;
+      case XorSumKernel::Avx2:
+         return &XorSumAvx2;
+      }
+   #else
+      (void)kernel;
+   #endif
+      return &XorSumScalar;
+   }
+};
+using XorSumKernelSelector = CpuKernelSelector<XorSumKernelTraits>;
+
+fon9_API XorSumKernel GetXorSumKernel() {
+   return XorSumKernelSelector::GetKernel();
+}
+fon9_API bool SetXorSumKernel(XorSumKernel kernel) {
+   return XorSumKernelSelector::SetKernel(kernel);
+}
+fon9_API byte CalcXorSum(const void* p, size_t sz) {
+   return XorSumKernelSelector::GetFn()(static_cast<const byte*>(p), sz);
+}
+
+//--------------------------------------------------------------------------//
+
 PkReceiver::~PkReceiver() {
 }
 bool PkReceiver::FeedBuffer(DcQueue& rxbuf) {
@@ -18,8 +142,8 @@ bool PkReceiver::FeedBuffer(DcQueue& rxbuf) {
             // rxbuf 的資料長度足夠一個封包.
             const char* pkL = static_cast<const char*>(pkptr);
             if (fon9_LIKELY(pkL[pksz - 2] == 0x0d && pkL[pksz - 1] == 0x0a)) {
-               // 尾碼正確, 檢查 CheckSum.
-               if (fon9_LIKELY(CalcCheckSum(pkL, pksz + 1) == 0)) {
+               // 尾碼正確, 檢查 CheckSum: 包含 CheckSum 本身的 XOR 必定為 0.
+               if (fon9_LIKELY(this->IsSkipCheckSum_ || CalcXorSum(pkL + 1, pksz - 3) == 0)) {
                   // CheckSum 正確, 解析封包內容.
                   ++this->ReceivedCount_;
                   if (!this->OnPkReceived(pkptr, pksz)) {
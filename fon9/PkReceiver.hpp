@@ -6,6 +6,26 @@
 
 namespace fon9 {
 
+/// \ingroup Misc.
+/// CalcXorSum() 使用的實作方式.
+enum class XorSumKernel : uint8_t {
+   /// 一次處理 8 bytes(uint64_t).
+   Scalar,
+   /// 一次處理 16 bytes.
+   Sse41,
+   /// 一次處理 32 bytes.
+   Avx2,
+};
+/// 預設: 根據 GetCpuFeatures() 選擇可用的最快版本.
+fon9_API XorSumKernel GetXorSumKernel();
+/// 通常用於測試、效能評估.
+/// \retval false CPU 不支援, 維持原本的設定.
+fon9_API bool SetXorSumKernel(XorSumKernel kernel);
+
+/// \ingroup Misc.
+/// 傳回 [p..p+sz) 每個 byte 的 XOR; 不論使用哪種 XorSumKernel, 結果都相同.
+fon9_API byte CalcXorSum(const void* p, size_t sz);
+
 /// \ingroup Misc.
 /// 用來解析簡易的封包格式框架(例: 交易所行情格式: 台灣證交所、台灣期交所):
 /// - kPkHeadLeader(EscCode:27) ... CheckSum + TerminalCode(0x0d,0x0a).
@@ -43,14 +63,18 @@ public:
    bool FeedBuffer(DcQueue& rxbuf);
 
    static char CalcCheckSum(const char* pkL, unsigned pksz) {
-      const char* pkend = pkL + pksz - 4; // -4 = 排除 kPkHeadLeader, CheckSum, 0x0d, 0x0a.
-      char        cks = *++pkL; // ++pk = 排除 kPkHeadLeader.
-      while (pkL != pkend) {
-         fon9_GCC_WARN_DISABLE("-Wconversion");
-         cks ^= *++pkL;
-         fon9_GCC_WARN_POP;
-      }
-      return cks;
+      // +1 = 排除 kPkHeadLeader; -4 = 排除 kPkHeadLeader, CheckSum, 0x0d, 0x0a.
+      return static_cast<char>(CalcXorSum(pkL + 1, pksz - 4));
+   }
+
+   /// 若資料來源已確保封包正確(例: NIC 已檢查, 或來自可信任的轉發端), 可設定不檢查 CheckSum,
+   /// 行情接收 Session 的設定參數 "ChkSum=N" 即對應 SetSkipCheckSum(true).
+   /// 此時仍會檢查封包框架(kPkHeadLeader, 長度, 0x0d, 0x0a), 但 ChkSumErrCount_ 不會增加.
+   void SetSkipCheckSum(bool isSkip) {
+      this->IsSkipCheckSum_ = isSkip;
+   }
+   bool IsSkipCheckSum() const {
+      return this->IsSkipCheckSum_;
    }
 
    void ClearStatus() {
@@ -65,7 +89,8 @@ public:
    uint64_t GetDroppedBytes()   const { return this->DroppedBytes_;   }
 
 protected:
-   char     Padding___[3];
+   bool     IsSkipCheckSum_{false};
+   char     Padding___[2];
    uint64_t ReceivedCount_{0};
    uint64_t ChkSumErrCount_{0};
    uint64_t DroppedBytes_{0};
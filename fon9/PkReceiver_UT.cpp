@@ -0,0 +1,196 @@
+﻿// \file fon9/PkReceiver_UT.cpp
+// \author fonwinz@gmail.com
+#define _CRT_SECURE_NO_WARNINGS
+#include "fon9/PkReceiver.hpp"
+#include "fon9/TestTools.hpp"
+#include "fon9/Endian.hpp"
+#include "fon9/CpuFeatures.hpp"
+#include <random>
+
+static const char* XorSumKernelName(fon9::XorSumKernel kernel) {
+   switch (kernel) {
+   case fon9::XorSumKernel::Scalar: return "Scalar";
+   case fon9::XorSumKernel::Sse41:  return "SSE4.1";
+   case fon9::XorSumKernel::Avx2:   return "AVX2";
+   }
+   return "?";
+}
+static const fon9::XorSumKernel kXorSumKernels[] = {
+   fon9::XorSumKernel::Scalar,
+   fon9::XorSumKernel::Sse41,
+   fon9::XorSumKernel::Avx2,
+};
+
+static fon9::byte XorSumByByte(const fon9::byte* p, size_t sz) {
+   fon9::byte cks = 0;
+   while (sz > 0) {
+      --sz;
+      cks = static_cast<fon9::byte>(cks ^ *p++);
+   }
+   return cks;
+}
+
+void TestCalcXorSum() {
+   std::mt19937   rnd{20201};
+   fon9::byte     buf[512 + 64];
+   for (fon9::byte& b : buf)
+      b = static_cast<fon9::byte>(rnd());
+   for (fon9::XorSumKernel kernel : kXorSumKernels) {
+      if (!fon9::SetXorSumKernel(kernel)) {
+         std::cout << "[SKIP ] CalcXorSum|kernel=" << XorSumKernelName(kernel) << "|not supported." << std::endl;
+         continue;
+      }
+      std::cout << "[TEST ] CalcXorSum|kernel=" << XorSumKernelName(kernel) << std::flush;
+      // 測試各種起始位置(對齊)及長度.
+      for (size_t ofs = 0; ofs < 64; ++ofs) {
+         for (size_t sz = 0; sz <= 512; ++sz) {
+            if (fon9::CalcXorSum(buf + ofs, sz) != XorSumByByte(buf + ofs, sz)) {
+               std::cout << "|ofs=" << ofs << "|sz=" << sz << "\r[ERROR]" << std::endl;
+               abort();
+            }
+         }
+      }
+      std::cout << "\r[OK   ]" << std::endl;
+   }
+}
+
+//--------------------------------------------------------------------------//
+// 測試用的封包格式: [kPkHeadLeader][BodySize:BigEndian uint16_t][Body...][CheckSum][0x0d][0x0a]
+struct TestPkReceiver : public fon9::PkReceiver {
+   fon9_NON_COPY_NON_MOVE(TestPkReceiver);
+   using base = fon9::PkReceiver;
+   enum : unsigned {
+      kHeadSize = 3,
+      kTailSize = 3,
+   };
+   uint64_t BodyBytes_{0};
+
+   TestPkReceiver() : base{kHeadSize} {
+   }
+   unsigned GetPkSize(const void* pkptr) override {
+      return kHeadSize + fon9::GetBigEndian<uint16_t>(static_cast<const char*>(pkptr) + 1) + kTailSize;
+   }
+   bool OnPkReceived(const void* pkptr, unsigned pksz) override {
+      (void)pkptr;
+      this->BodyBytes_ += pksz - kHeadSize - kTailSize;
+      return true;
+   }
+};
+
+/// 建立一串測試封包, 每 errInterval 個封包, 放一個 CheckSum 錯誤的封包.
+/// 封包大小參考台灣期交所逐筆行情: 大多在 50..300 bytes 之間.
+static std::string MakeTestFeed(size_t pkCount, size_t errInterval, size_t& errCount) {
+   std::mt19937   rnd{20202};
+   std::string    feed;
+   errCount = 0;
+   for (size_t L = 0; L < pkCount; ++L) {
+      const unsigned bodySize = 50 + static_cast<unsigned>(rnd() % 250);
+      const size_t   pkpos = feed.size();
+      feed.resize(pkpos + TestPkReceiver::kHeadSize + bodySize + TestPkReceiver::kTailSize);
+      char* pk = &feed[pkpos];
+      pk[0] = fon9::PkReceiver::kPkHeadLeader;
+      fon9::PutBigEndian(pk + 1, static_cast<uint16_t>(bodySize));
+      for (unsigned i = 0; i < bodySize; ++i)
+         pk[TestPkReceiver::kHeadSize + i] = static_cast<char>(rnd() | 0x80); // 避免出現 kPkHeadLeader.
+      const unsigned pksz = TestPkReceiver::kHeadSize + bodySize + TestPkReceiver::kTailSize;
+      char cks = fon9::PkReceiver::CalcCheckSum(pk, pksz);
+      if (errInterval && L % errInterval == 0) {
+         cks = static_cast<char>(cks ^ 0x01);
+         ++errCount;
+      }
+      pk[pksz - 3] = cks;
+      pk[pksz - 2] = '\x0d';
+      pk[pksz - 1] = '\x0a';
+   }
+   return feed;
+}
+
+void TestFeedBuffer() {
+   size_t            errCount;
+   const size_t      kPkCount = 10000;
+   const std::string feed = MakeTestFeed(kPkCount, 100, errCount);
+   for (fon9::XorSumKernel kernel : kXorSumKernels) {
+      if (!fon9::SetXorSumKernel(kernel))
+         continue;
+      std::cout << "[TEST ] FeedBuffer|kernel=" << XorSumKernelName(kernel) << std::flush;
+      TestPkReceiver          pkReceiver;
+      fon9::DcQueueFixedMem   dcq{feed.c_str(), feed.size()};
+      pkReceiver.FeedBuffer(dcq);
+      if (pkReceiver.GetReceivedCount() != kPkCount - errCount
+          || pkReceiver.GetChkSumErrCount() != errCount
+          || pkReceiver.GetDroppedBytes() != 0) {
+         std::cout << "|received=" << pkReceiver.GetReceivedCount()
+            << "|chkSumErr=" << pkReceiver.GetChkSumErrCount()
+            << "|dropped=" << pkReceiver.GetDroppedBytes()
+            << "\r[ERROR]" << std::endl;
+         abort();
+      }
+      std::cout << "\r[OK   ]" << std::endl;
+   }
+   std::cout << "[TEST ] FeedBuffer|SkipCheckSum" << std::flush;
+   TestPkReceiver          pkReceiver;
+   fon9::DcQueueFixedMem   dcq{feed.c_str(), feed.size()};
+   pkReceiver.SetSkipCheckSum(true);
+   pkReceiver.FeedBuffer(dcq);
+   if (pkReceiver.GetReceivedCount() != kPkCount
+       || pkReceiver.GetChkSumErrCount() != 0
+       || pkReceiver.GetDroppedBytes() != 0) {
+      std::cout << "|received=" << pkReceiver.GetReceivedCount()
+         << "|chkSumErr=" << pkReceiver.GetChkSumErrCount()
+         << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+//--------------------------------------------------------------------------//
+static void PrintFeedResult(fon9::StopWatch& stopWatch, const char* msgHead,
+                            const TestPkReceiver& pkReceiver, size_t feedBytes) {
+   const double secs = stopWatch.StopTimer();
+   std::string  msg = msgHead;
+   msg.resize(26, ' ');
+   stopWatch.PrintResultNoEOL(secs, msg.c_str(), pkReceiver.GetReceivedCount());
+   std::cout << "|" << static_cast<double>(feedBytes) / secs / (1024 * 1024) << " MB/s" << std::endl;
+}
+
+/// 重複將同一串封包餵給 PkReceiver, 評估: 各種 XorSumKernel 及 SkipCheckSum 的吞吐量.
+void BenchFeedBuffer() {
+   size_t            errCount;
+   const unsigned    kTimes = 100;
+   const std::string feed = MakeTestFeed(10000, 0, errCount);
+   fon9::StopWatch   stopWatch;
+   for (fon9::XorSumKernel kernel : kXorSumKernels) {
+      if (!fon9::SetXorSumKernel(kernel))
+         continue;
+      TestPkReceiver pkReceiver;
+      stopWatch.ResetTimer();
+      for (unsigned L = 0; L < kTimes; ++L) {
+         fon9::DcQueueFixedMem dcq{feed.c_str(), feed.size()};
+         pkReceiver.FeedBuffer(dcq);
+      }
+      std::string msg = "FeedBuffer:";
+      msg.append(XorSumKernelName(kernel));
+      PrintFeedResult(stopWatch, msg.c_str(), pkReceiver, feed.size() * kTimes);
+   }
+   TestPkReceiver pkReceiver;
+   pkReceiver.SetSkipCheckSum(true);
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes; ++L) {
+      fon9::DcQueueFixedMem dcq{feed.c_str(), feed.size()};
+      pkReceiver.FeedBuffer(dcq);
+   }
+   PrintFeedResult(stopWatch, "FeedBuffer:SkipCheckSum", pkReceiver, feed.size() * kTimes);
+}
+
+int main() {
+   fon9::AutoPrintTestInfo utinfo{"PkReceiver"};
+   const fon9::XorSumKernel kernel = fon9::GetXorSumKernel();
+   std::cout << "CpuFeatures: SSE4.1=" << fon9::GetCpuFeatures().Sse41_
+             << "|AVX2=" << fon9::GetCpuFeatures().Avx2_ << std::endl;
+   TestCalcXorSum();
+   TestFeedBuffer();
+
+   utinfo.PrintSplitter();
+   BenchFeedBuffer();
+   fon9::SetXorSumKernel(kernel);
+}
@@ -25,13 +25,13 @@ TimerThreadSP GetDefaultTimerThread() {
 //--------------------------------------------------------------------------//
 TimerEntry::~TimerEntry() {
    if (this->TimerThread_->TimerController_.IsThreadEnding())
-      TimerThread::Locker{this->TimerThread_->TimerController_}->Erase(this->Key_);
+      TimerThread::Locker{this->TimerThread_->TimerController_}->Erase(*this);
 }
 void TimerEntry::DisposeAndWait() {
    while(!this->TimerThread_->TimerController_.IsThreadEnding()) {
       TimerThread::Locker   timerThread{this->TimerThread_->TimerController_};
       if (IsTimerWaitInLine(this->Key_.SeqNo_)) {
-         timerThread->Erase(this->Key_);
+         timerThread->Erase(*this);
          this->Key_.SeqNo_ = TimerSeqNo::Disposed;
          this->Key_.EmitTime_.AssignNull();
       }
@@ -44,7 +44,7 @@ void TimerEntry::StopAndWait() {
       TimerThread::Locker   timerThread{this->TimerThread_->TimerController_};
       if (this->Key_.SeqNo_ == TimerSeqNo::Disposed)
          break;
-      timerThread->Erase(this->Key_);
+      timerThread->Erase(*this);
       this->Key_.SeqNo_ = TimerSeqNo::NoWaiting;
       this->Key_.EmitTime_.AssignNull();
       if (!this->TimerThread_->CheckCurrEmit(timerThread, *this))
@@ -56,7 +56,7 @@ void TimerEntry::DisposeNoWait() {
    if (this->TimerThread_->TimerController_.IsThreadEnding())
       return;
    if (IsTimerWaitInLine(this->Key_.SeqNo_))
-      timerThread->Erase(this->Key_);
+      timerThread->Erase(*this);
    this->Key_.SeqNo_ = TimerSeqNo::Disposed;
 }
 void TimerEntry::StopNoWait() {
@@ -64,7 +64,7 @@ void TimerEntry::StopNoWait() {
    if (this->TimerThread_->TimerController_.IsThreadEnding())
       return;
    if (IsTimerWaitInLine(this->Key_.SeqNo_)) {
-      timerThread->Erase(this->Key_);
+      timerThread->Erase(*this);
       this->Key_.SeqNo_ = TimerSeqNo::NoWaiting;
    }
 }
@@ -75,7 +75,7 @@ void TimerEntry::SetupRun(TimeStamp atTimePoint, const TimeInterval* after) {
    if (this->Key_.SeqNo_ == TimerSeqNo::Disposed)
       return;
    if (IsTimerWaitInLine(this->Key_.SeqNo_))
-      timerThread->Erase(this->Key_);
+      timerThread->Erase(*this);
 
    this->Key_.EmitTime_ = atTimePoint;
    timerThread->LastSeqNo_ = static_cast<TimerSeqNo>(cast_to_underlying(timerThread->LastSeqNo_) + 1);
@@ -83,13 +83,14 @@ void TimerEntry::SetupRun(TimeStamp atTimePoint, const TimeInterval* after) {
       timerThread->LastSeqNo_ = TimerSeqNo::WaitInLine;
    this->Key_.SeqNo_ = timerThread->LastSeqNo_;
 
-   auto ifind = timerThread->Timers_.insert(TimerThread::TimerThreadData::Timers::value_type{this->Key_, this}).first;
-   if (fon9_LIKELY(ifind != timerThread->Timers_.end() - 1))
+   if (fon9_LIKELY(!timerThread->Insert(*this)))
       return;
-   TimeInterval wsecs = after ? *after : TimeInterval{atTimePoint - UtcNow()};
-   if (fon9_UNLIKELY(timerThread->CvWaitSecs_ == wsecs))
-      return;
-   timerThread->CvWaitSecs_ = wsecs;
+   if (!timerThread->Wheel_) {
+      TimeInterval wsecs = after ? *after : TimeInterval{atTimePoint - UtcNow()};
+      if (fon9_UNLIKELY(timerThread->CvWaitSecs_ == wsecs))
+         return;
+      timerThread->CvWaitSecs_ = wsecs;
+   }
    this->TimerThread_->TimerController_.NotifyOne(timerThread);
 }
 void TimerEntry::OnTimer(TimeStamp /*now*/) {
@@ -118,9 +119,82 @@ TimerThread::TimerThread(std::string timerName) {
    this->TimerController_.OnBeforeThreadStart(1);
    this->Thread_ = std::thread(&TimerThread::ThrRun, this, std::move(timerName));
 }
+TimerThread::TimerThread(std::string timerName, TimeInterval wheelTick) {
+   if (wheelTick.GetOrigValue() > 0) {
+      Locker timerThread{this->TimerController_};
+      timerThread->WheelTickOrig_ = wheelTick.GetOrigValue();
+      timerThread->Wheel_.reset(new TimerWheel{static_cast<uint64_t>(UtcNow().GetOrigValue() / timerThread->WheelTickOrig_)});
+   }
+   this->TimerController_.OnBeforeThreadStart(1);
+   this->Thread_ = std::thread(&TimerThread::ThrRun, this, std::move(timerName));
+}
 TimerThread::~TimerThread() {
    this->WaitForEndNow();
-   assert(Locker{this->TimerController_}->Timers_.empty());
+   assert(Locker{this->TimerController_}->empty());
+}
+
+//--------------------------------------------------------------------------//
+
+void TimerThread::TimerThreadData::Erase(TimerEntry& timer) {
+   if (timer.Key_.SeqNo_ == TimerSeqNo::NoWaiting)
+      return;
+   if (this->Wheel_) {
+      if (timer.WheelNode_.IsInWheel()) {
+         this->Wheel_->Remove(&timer.WheelNode_);
+         intrusive_ptr_release(&timer);
+      }
+      return;
+   }
+   auto ifind = this->Timers_.find(timer.Key_);
+   if (ifind != this->Timers_.end())
+      this->Timers_.erase(ifind);
+}
+bool TimerThread::TimerThreadData::Insert(TimerEntry& timer) {
+   if (this->Wheel_) {
+      // 到期的 tick 無條件進位: 確保觸發時 now >= EmitTime_.
+      const TimeStamp::OrigType emitTime = timer.Key_.EmitTime_.GetOrigValue();
+      timer.WheelNode_.WheelTick_ = (emitTime <= 0 ? 0
+                                     : static_cast<uint64_t>((emitTime + this->WheelTickOrig_ - 1) / this->WheelTickOrig_));
+      intrusive_ptr_add_ref(&timer);
+      this->Wheel_->Add(&timer.WheelNode_);
+      if (fon9_LIKELY(timer.WheelNode_.WheelTick_ >= this->WheelWakeTick_))
+         return false;
+      this->WheelWakeTick_ = timer.WheelNode_.WheelTick_;
+      return true;
+   }
+   auto ifind = this->Timers_.insert(Timers::value_type{timer.Key_, &timer}).first;
+   return ifind == this->Timers_.end() - 1;
+}
+TimerEntrySP TimerThread::TimerThreadData::PopExpired(TimeStamp now) {
+   if (this->Wheel_) {
+      TimerWheelNode* node = this->Wheel_->PopExpired();
+      if (node == nullptr) {
+         const TimeStamp::OrigType nowOrig = now.GetOrigValue();
+         this->Wheel_->Advance(static_cast<uint64_t>(nowOrig / this->WheelTickOrig_));
+         if ((node = this->Wheel_->PopExpired()) == nullptr) {
+            this->WheelWakeTick_ = this->Wheel_->GetNextTick();
+            if (this->WheelWakeTick_ == TimerWheel::kNoTick)
+               this->CvWaitSecs_ = TimeInterval_Second(-1);
+            else
+               this->CvWaitSecs_ = TimeInterval_Microsecond(static_cast<TimeInterval::OrigType>(this->WheelWakeTick_) * this->WheelTickOrig_ - nowOrig);
+            return nullptr;
+         }
+      }
+      // 轉移 TimerWheel 的參考計數.
+      return TimerEntrySP{&ContainerOf(*node, &TimerEntry::WheelNode_), false};
+   }
+   if (this->Timers_.empty()) {
+      this->CvWaitSecs_ = TimeInterval_Second(-1);
+      return nullptr;
+   }
+   TimerEntrySP   timer = this->Timers_.back().second;
+   TimeInterval   ti = timer->Key_.EmitTime_ - now;
+   if (ti.GetOrigValue() > 0) {
+      this->CvWaitSecs_ = ti;
+      return nullptr;
+   }
+   this->Timers_.pop_back();
+   return timer;
 }
 void TimerThread::WaitForEndNow() {
    this->TimerController_.WaitForEndNow();
@@ -137,19 +211,11 @@ bool TimerThread::CheckCurrEmit(Locker& timerThread, TimerEntry& timer) {
 
 bool TimerThread::RunTimer(Locker& timerThread) {
    while (this->TimerController_.GetState(timerThread) == ThreadState::ExecutingOrWaiting) {
-      if (timerThread->Timers_.empty()) {
-         timerThread->CvWaitSecs_ = TimeInterval_Second(-1);
+      const TimeStamp   now = UtcNow();
+      TimerEntrySP      timer = timerThread->PopExpired(now);
+      if (!timer)
          return true;
-      }
-      TimerEntrySP   timer = timerThread->Timers_.back().second;
-      TimeStamp      now = UtcNow();
-      TimeInterval   ti = timer->Key_.EmitTime_ - now;
-      if (ti.GetOrigValue() > 0) {
-         timerThread->CvWaitSecs_ = ti;
-         return true;
-      }
       timer->Key_.SeqNo_ = TimerSeqNo::NoWaiting;
-      timerThread->Timers_.pop_back();
       timerThread->CurrEntry_ = timer.get();
       timerThread.unlock();
       // callback in unlock...
@@ -6,6 +6,7 @@
 #include "fon9/intrusive_ref_counter.hpp"
 #include "fon9/TimeStamp.hpp"
 #include "fon9/ThreadController.hpp"
+#include "fon9/TimerWheel.hpp"
 
 namespace fon9 {
 
@@ -44,6 +45,9 @@ struct TimerEntryKey {
 /// - 每個 timer 啟動時, 不論設定的是 [間隔時間] or [絕對時間], 都會使用 TimeStamp_ 來處理.
 ///   - 所以如果使用「間隔時間」啟動 timer, 當系統時間有變動時, 則無法在正確的「時間間隔」觸發事件!
 /// - thread 的睡眠時間: 最接近的 timer.TimeStamp_ - now;
+/// - 保存計時器的方式, 在建構時決定:
+///   - 預設使用 SortedVector: 觸發時間精確, 但啟動及停止計時器為 O(n).
+///   - 使用 TimerWheel(hierarchical timing wheel): 啟動及停止計時器為 O(1), 但觸發時間以 wheelTick 為單位(可能延後最多 wheelTick).
 class fon9_API TimerThread;
 using TimerThreadSP = intrusive_ptr<TimerThread>;
 
@@ -96,6 +100,8 @@ class fon9_API TimerEntry : public intrusive_ref_counter<TimerEntry> {
 
    friend class TimerThread;
    TimerEntryKey  Key_;
+   /// 若 TimerThread_ 使用 TimerWheel, 則透過此節點放入 TimerWheel.
+   TimerWheelNode WheelNode_;
 
    void SetupRun(TimeStamp atTimePoint, const TimeInterval* after);
 public:
@@ -233,17 +239,25 @@ class fon9_API TimerThread : public intrusive_ref_counter<TimerThread> {
    friend class TimerEntry;
 
    struct TimerThreadData {
-      void Erase(TimerEntryKey& key) {
-         if (key.SeqNo_ == TimerSeqNo::NoWaiting)
-            return;
-         auto ifind = this->Timers_.find(key);
-         if (ifind != this->Timers_.end())
-            this->Timers_.erase(ifind);
+      void Erase(TimerEntry& timer);
+      /// \retval true timer 比原本等候中的計時器更早到期, 需要喚醒 TimerThread.
+      bool Insert(TimerEntry& timer);
+      /// 取出已到期的 timer; 若沒有, 則設定 CvWaitSecs_ 並傳回 nullptr.
+      TimerEntrySP PopExpired(TimeStamp now);
+      bool empty() const {
+         return this->Wheel_ ? this->Wheel_->empty() : this->Timers_.empty();
       }
 
       using Timers = SortedVector<TimerEntryKey, TimerEntrySP>;
       TimerSeqNo        LastSeqNo_{TimerSeqNo::WaitInLine};
+      /// 沒有使用 TimerWheel 時, 計時器放在這裡.
       Timers            Timers_;
+      /// 使用 TimerWheel 時, 計時器放在這裡; TimerWheel 裡面的每個 TimerEntry 都有一個參考計數.
+      std::unique_ptr<TimerWheel> Wheel_;
+      /// TimerWheel 1 tick 的時間長度(TimeInterval::GetOrigValue()).
+      TimeInterval::OrigType     WheelTickOrig_{0};
+      /// TimerThread 預計醒來的 tick.
+      uint64_t                   WheelWakeTick_{TimerWheel::kNoTick};
       TimeInterval      CvWaitSecs_;
       /// 如果在 TimerThread 正在觸發, 則會設定此值.
       /// 讓另一 thread 呼叫 TimerEntry::StopAndWait() 時, 可以等到 OnTimer() 真的結束後才返回.
@@ -264,7 +278,11 @@ protected:
    }
 
 public:
+   /// 使用 SortedVector 保存計時器.
    TimerThread(std::string timerName);
+   /// wheelTick > 0: 使用 TimerWheel 保存計時器, 觸發時間的精確度為 wheelTick(例: 1ms).
+   /// wheelTick <= 0: 與 TimerThread(timerName) 相同.
+   TimerThread(std::string timerName, TimeInterval wheelTick);
    virtual ~TimerThread();
 
    void WaitForEndNow();
@@ -0,0 +1,125 @@
+﻿// \file fon9/TimerWheel.cpp
+// \author fonwinz@gmail.com
+#include "fon9/TimerWheel.hpp"
+#include "fon9/BitOps.hpp"
+
+namespace fon9 {
+
+constexpr uint64_t TimerWheel::kMaxTickDistance;
+constexpr uint64_t TimerWheel::kNoTick;
+
+TimerWheel::TimerWheel(uint64_t currTick) : CurrTick_{currTick} {
+   for (uint64_t& bits : this->Bitmap_)
+      bits = 0;
+   for (TimerWheelNode& head : this->Slots_)
+      InitHead(head);
+   InitHead(this->Expired_);
+}
+TimerWheel::~TimerWheel() {
+}
+
+void TimerWheel::Place(TimerWheelNode* node) {
+   if (node->WheelTick_ <= this->CurrTick_) {
+      node->WheelSlot_ = kExpiredSlot;
+      LinkBefore(this->Expired_, node);
+      return;
+   }
+   if (fon9_UNLIKELY(node->WheelTick_ - this->CurrTick_ > kMaxTickDistance))
+      node->WheelTick_ = this->CurrTick_ + kMaxTickDistance;
+   // 與 CurrTick_ 最高的不同位元, 決定放在哪一層;
+   // 因為 WheelTick_ > CurrTick_, 所以該層的格子必定在 CurrTick_ 所在的格子之後.
+   const unsigned level = HighestBitIndex(node->WheelTick_ ^ this->CurrTick_) / kSlotBits;
+   const unsigned slot = static_cast<unsigned>(node->WheelTick_ >> (level * kSlotBits)) & (kSlotCount - 1);
+   node->WheelSlot_ = level * kSlotCount + slot;
+   LinkBefore(this->Slots_[node->WheelSlot_], node);
+   this->Bitmap_[level] |= (static_cast<uint64_t>(1) << slot);
+}
+void TimerWheel::Unlink(TimerWheelNode* node) {
+   assert(node->IsInWheel());
+   node->WheelPrev_->WheelNext_ = node->WheelNext_;
+   node->WheelNext_->WheelPrev_ = node->WheelPrev_;
+   if (node->WheelSlot_ != kExpiredSlot) {
+      TimerWheelNode& head = this->Slots_[node->WheelSlot_];
+      if (head.WheelNext_ == &head)
+         this->Bitmap_[node->WheelSlot_ / kSlotCount] &= ~(static_cast<uint64_t>(1) << (node->WheelSlot_ % kSlotCount));
+   }
+   node->WheelPrev_ = node->WheelNext_ = nullptr;
+}
+
+void TimerWheel::Add(TimerWheelNode* node) {
+   assert(!node->IsInWheel());
+   this->Place(node);
+   ++this->Count_;
+}
+void TimerWheel::Remove(TimerWheelNode* node) {
+   this->Unlink(node);
+   --this->Count_;
+}
+TimerWheelNode* TimerWheel::PopExpired() {
+   TimerWheelNode* node = this->Expired_.WheelNext_;
+   if (node == &this->Expired_)
+      return nullptr;
+   this->Unlink(node);
+   --this->Count_;
+   return node;
+}
+
+uint64_t TimerWheel::GetNextTick() const {
+   return this->HasExpired() ? this->CurrTick_ : this->GetNextSlotTick();
+}
+uint64_t TimerWheel::GetNextSlotTick() const {
+   // 低層的格子必定比高層的格子早到期, 所以找到第一個有節點的層即可.
+   for (unsigned level = 0; level < kLevelCount; ++level) {
+      if (const uint64_t bits = this->Bitmap_[level]) {
+         const unsigned shift = level * kSlotBits;
+         const unsigned slot = LowestBitIndex(bits);
+         assert(slot > (static_cast<unsigned>(this->CurrTick_ >> shift) & (kSlotCount - 1)));
+         return ((this->CurrTick_ >> (shift + kSlotBits)) << (shift + kSlotBits))
+              | (static_cast<uint64_t>(slot) << shift);
+      }
+   }
+   return kNoTick;
+}
+
+void TimerWheel::Advance(uint64_t nowTick) {
+   while (this->CurrTick_ < nowTick) {
+      const uint64_t next = this->GetNextSlotTick();
+      if (next > nowTick) {
+         // 在 nowTick 之前沒有需要處理的格子, 直接跳到 nowTick:
+         // 各層節點仍在該層目前位置之後, 不影響節點的分配規則.
+         this->CurrTick_ = nowTick;
+         break;
+      }
+      this->CurrTick_ = next;
+      // 由高層往低層: 到期的格子重新分配到較低的層(或 Expired 串列).
+      for (unsigned level = kLevelCount - 1; level > 0; --level) {
+         const unsigned shift = level * kSlotBits;
+         if ((next & ((static_cast<uint64_t>(1) << shift) - 1)) != 0)
+            continue;
+         const unsigned slot = static_cast<unsigned>(next >> shift) & (kSlotCount - 1);
+         if ((this->Bitmap_[level] & (static_cast<uint64_t>(1) << slot)) == 0)
+            continue;
+         TimerWheelNode& head = this->Slots_[level * kSlotCount + slot];
+         while (head.WheelNext_ != &head) {
+            TimerWheelNode* node = head.WheelNext_;
+            this->Unlink(node);
+            this->Place(node);
+         }
+      }
+      // 第 0 層的格子到期: 整串移到 Expired_ 尾端.
+      const unsigned slot = static_cast<unsigned>(next) & (kSlotCount - 1);
+      if (this->Bitmap_[0] & (static_cast<uint64_t>(1) << slot)) {
+         TimerWheelNode& head = this->Slots_[slot];
+         for (TimerWheelNode* node = head.WheelNext_; node != &head; node = node->WheelNext_)
+            node->WheelSlot_ = kExpiredSlot;
+         head.WheelNext_->WheelPrev_ = this->Expired_.WheelPrev_;
+         this->Expired_.WheelPrev_->WheelNext_ = head.WheelNext_;
+         head.WheelPrev_->WheelNext_ = &this->Expired_;
+         this->Expired_.WheelPrev_ = head.WheelPrev_;
+         InitHead(head);
+         this->Bitmap_[0] &= ~(static_cast<uint64_t>(1) << slot);
+      }
+   }
+}
+
+} // namespace
@@ -0,0 +1,124 @@
+﻿/// \file fon9/TimerWheel.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_TimerWheel_hpp__
+#define __fon9_TimerWheel_hpp__
+#include "fon9/sys/Config.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <stdint.h>
+#include <stddef.h>
+fon9_AFTER_INCLUDE_STD;
+
+namespace fon9 {
+
+fon9_WARN_DISABLE_PADDING;
+/// \ingroup Thrs
+/// TimerWheel 的節點, 由使用者嵌入在自己的物件裡面(intrusive).
+/// 同一個節點同時只能在一個 TimerWheel 裡面.
+struct TimerWheelNode {
+   TimerWheelNode*   WheelPrev_{nullptr};
+   TimerWheelNode*   WheelNext_{nullptr};
+   /// 到期的刻度.
+   uint64_t          WheelTick_{0};
+   /// 所在的格子, 在 TimerWheel 內部使用.
+   unsigned          WheelSlot_{0};
+
+   bool IsInWheel() const {
+      return this->WheelPrev_ != nullptr;
+   }
+};
+
+/// \ingroup Thrs
+/// Hierarchical timing wheel: 共 kLevelCount 層, 每層 kSlotCount 格.
+/// - 時間單位為「刻度(tick)」, 由使用者決定 1 tick 代表多少時間.
+/// - Add(), Remove(): O(1).
+/// - 節點放在「與 CurrTick_ 最高的不同位元」所在的層,
+///   所以每層的節點必定在該層目前位置之後, 不會有繞圈(需要記錄圈數)的問題.
+/// - Advance(): 只處理有節點的格子, 可以直接跳過沒有節點的刻度;
+///   高層的格子到期時, 將節點重新分配到低層; 第 0 層的格子到期時, 將節點移到 Expired 串列.
+/// - 不是 thread safe, 由使用者負責保護.
+/// - 不負責節點的生命週期.
+class fon9_API TimerWheel {
+   fon9_NON_COPY_NON_MOVE(TimerWheel);
+public:
+   enum : unsigned {
+      kSlotBits = 6,
+      kSlotCount = 1u << kSlotBits,
+      /// 若 1 tick = 1ms, 則 7 層可涵蓋 64^7 ms, 約 139 年.
+      kLevelCount = 7,
+   };
+   /// 超過 CurrTick_ + kMaxTickDistance 的節點, 會被調整為 CurrTick_ + kMaxTickDistance.
+   static constexpr uint64_t kMaxTickDistance = (static_cast<uint64_t>(1) << (kSlotBits * kLevelCount)) - 1;
+   /// 沒有任何節點時 GetNextTick() 的傳回值.
+   static constexpr uint64_t kNoTick = ~static_cast<uint64_t>(0);
+
+   TimerWheel(uint64_t currTick = 0);
+   /// 解構時不會處理剩餘的節點, 使用者應在解構前自行取出.
+   ~TimerWheel();
+
+   uint64_t GetCurrTick() const {
+      return this->CurrTick_;
+   }
+   /// 全部節點的數量, 包含已到期但尚未取出的節點.
+   size_t size() const {
+      return this->Count_;
+   }
+   bool empty() const {
+      return this->Count_ == 0;
+   }
+   bool HasExpired() const {
+      return this->Expired_.WheelNext_ != &this->Expired_;
+   }
+
+   /// 加入節點, 到期刻度為 node->WheelTick_.
+   /// 若 node->WheelTick_ <= GetCurrTick() 則直接放入 Expired 串列.
+   /// node 必須不在任何 TimerWheel 裡面.
+   void Add(TimerWheelNode* node);
+   /// 移除節點(不論是否已到期), node 必須在 this 裡面.
+   void Remove(TimerWheelNode* node);
+
+   /// 將 CurrTick_ 推進到 nowTick, 途中到期的節點會依序移到 Expired 串列.
+   /// 若 nowTick <= GetCurrTick() 則不做任何事.
+   void Advance(uint64_t nowTick);
+   /// 取出一個已到期的節點.
+   /// \retval nullptr 沒有已到期的節點.
+   TimerWheelNode* PopExpired();
+
+   /// 下一個需要處理(到期或重新分配)的刻度.
+   /// - 在此刻度之前 Advance() 不會有到期的節點, 可用來計算 thread 的睡眠時間.
+   /// - 若有已到期尚未取出的節點, 則傳回 GetCurrTick().
+   /// \retval kNoTick 沒有任何節點.
+   uint64_t GetNextTick() const;
+
+private:
+   enum : unsigned {
+      kExpiredSlot = kLevelCount * kSlotCount,
+   };
+   uint64_t       CurrTick_;
+   size_t         Count_{0};
+   /// 每層的格子是否有節點.
+   uint64_t       Bitmap_[kLevelCount];
+   /// 每個格子是一個雙向環狀串列, 格子本身為串列的頭(sentinel).
+   TimerWheelNode Slots_[kExpiredSlot];
+   TimerWheelNode Expired_;
+
+   static void InitHead(TimerWheelNode& head) {
+      head.WheelPrev_ = head.WheelNext_ = &head;
+   }
+   static void LinkBefore(TimerWheelNode& head, TimerWheelNode* node) {
+      node->WheelNext_ = &head;
+      node->WheelPrev_ = head.WheelPrev_;
+      head.WheelPrev_->WheelNext_ = node;
+      head.WheelPrev_ = node;
+   }
+   /// 下一個有節點的格子需要處理(到期或重新分配)的刻度, 不考慮 Expired 串列.
+   uint64_t GetNextSlotTick() const;
+   /// 將 node 放到適當的層及格子(或 Expired 串列), 不改變 Count_.
+   void Place(TimerWheelNode* node);
+   /// 將 node 從所在的串列移除, 不改變 Count_.
+   void Unlink(TimerWheelNode* node);
+};
+fon9_WARN_POP;
+
+} // namespace
+#endif//__fon9_TimerWheel_hpp__
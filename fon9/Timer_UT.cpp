@@ -118,8 +118,10 @@ fon9_WARN_POP;
 
 //--------------------------------------------------------------------------//
 
-void TestTimerThread() {
-   fon9::TimerThreadSP timerThread{new fon9::TimerThread{"TestTimerThread"}};
+void TestTimerThread(fon9::TimeInterval wheelTick) {
+   gOnTimerTimes = gSessionCount = gSessionDtor = gUnderOnTimer = gOverOnTimer = gOverBegin = gDtorInTimerThread = 0;
+   std::cout << "TestTimerThread|wheelTick=" << wheelTick.To<double>() << std::endl;
+   fon9::TimerThreadSP timerThread{new fon9::TimerThread{"TestTimerThread", wheelTick}};
    gTimerThread = timerThread.get();
 
    std::thread thrs[4];
@@ -179,9 +181,109 @@ void TestTimerThread() {
 
 //--------------------------------------------------------------------------//
 
-int main() {
+/// 檢查 TimerWheel: 每個節點必須在 Advance() 跨過它的 tick 時到期, 不可提早或延後.
+void TestTimerWheel() {
+   std::cout << "[TEST ] TimerWheel" << std::flush;
+   const uint64_t    kStartTick = 123456789;
+   fon9::TimerWheel  wheel{kStartTick};
+   std::vector<fon9::TimerWheelNode> nodes(100 * 1000);
+   uint64_t rnd = 88172645463325252u; // xorshift64
+   auto nextRand = [&rnd]() {
+      rnd ^= rnd << 13;
+      rnd ^= rnd >> 7;
+      rnd ^= rnd << 17;
+      return rnd;
+   };
+   for (fon9::TimerWheelNode& node : nodes) {
+      // 分散在 1 .. 2^32 ticks 之間, 讓每一層都有節點.
+      node.WheelTick_ = kStartTick + 1 + (nextRand() >> (32 + nextRand() % 32));
+      wheel.Add(&node);
+   }
+   // 移除一部分.
+   size_t expectedCount = nodes.size();
+   for (size_t L = 0; L < nodes.size(); L += 7) {
+      wheel.Remove(&nodes[L]);
+      --expectedCount;
+   }
+   uint64_t prevTick = wheel.GetCurrTick();
+   size_t   expiredCount = 0;
+   while (!wheel.empty()) {
+      const uint64_t nextTick = wheel.GetNextTick();
+      // 隨機推進: 有時剛好到下一個 tick, 有時跳過很多 ticks.
+      const uint64_t nowTick = (nextRand() % 2) ? nextTick : (prevTick + 1 + (nextRand() >> (40 + nextRand() % 24)));
+      wheel.Advance(nowTick);
+      while (fon9::TimerWheelNode* node = wheel.PopExpired()) {
+         if (node->WheelTick_ <= prevTick || node->WheelTick_ > wheel.GetCurrTick()) {
+            std::cout << "\r[ERROR] TimerWheel|tick=" << node->WheelTick_
+               << "|prev=" << prevTick << "|curr=" << wheel.GetCurrTick() << std::endl;
+            abort();
+         }
+         ++expiredCount;
+      }
+      prevTick = wheel.GetCurrTick();
+   }
+   if (expiredCount != expectedCount) {
+      std::cout << "\r[ERROR] TimerWheel|expired=" << expiredCount << "|expected=" << expectedCount << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+//--------------------------------------------------------------------------//
+
+/// 測試計時器的啟動(arm)、重新啟動(rearm)、停止(cancel)的速度.
+struct BenchTimer : public fon9::DataMemberTimer {
+   fon9_NON_COPY_NON_MOVE(BenchTimer);
+   using DataMemberTimer::DataMemberTimer;
+   virtual void EmitOnTimer(fon9::TimeStamp) override {
+   }
+};
+void BenchArmCancel(fon9::TimeInterval wheelTick, size_t timerCount) {
+   fon9::TimerThreadSP  timerThread{new fon9::TimerThread{"BenchTimerThread", wheelTick}};
+   std::vector<std::unique_ptr<BenchTimer>> timers;
+   timers.reserve(timerCount);
+   for (size_t L = 0; L < timerCount; ++L)
+      timers.emplace_back(new BenchTimer{timerThread});
+
+   char  name[64];
+   sprintf(name, "%s|n=%7u", wheelTick.GetOrigValue() > 0 ? "Wheel " : "Sorted", static_cast<unsigned>(timerCount));
+   // 計時時間分散在 10..70 秒之間, 測試期間不會觸發.
+   fon9::StopWatch stopWatch;
+   for (size_t L = 0; L < timerCount; ++L)
+      timers[L]->RunAfter(fon9::TimeInterval_Millisecond(static_cast<int64_t>(10000 + (L * 7919) % 60000)));
+   stopWatch.PrintResult((std::string{name} + "|arm   ").c_str(), timerCount);
+   for (size_t L = 0; L < timerCount; ++L)
+      timers[L]->RunAfter(fon9::TimeInterval_Millisecond(static_cast<int64_t>(10000 + (L * 104729) % 60000)));
+   stopWatch.PrintResult((std::string{name} + "|rearm ").c_str(), timerCount);
+   for (size_t L = 0; L < timerCount; ++L)
+      timers[L]->StopNoWait();
+   stopWatch.PrintResult((std::string{name} + "|cancel").c_str(), timerCount);
+   for (auto& timer : timers)
+      timer->DisposeAndWait();
+}
+void BenchArmCancel() {
+   const fon9::TimeInterval kWheelTick = fon9::TimeInterval_Millisecond(1);
+   for (size_t count : {10 * 1000u, 100 * 1000u, 1000 * 1000u}) {
+      // SortedVector 在 1M 時, 每次 O(n) 的 insert/erase 需要太久, 所以不測.
+      if (count < 1000 * 1000u)
+         BenchArmCancel(fon9::TimeInterval{}, count);
+      BenchArmCancel(kWheelTick, count);
+   }
+}
+
+//--------------------------------------------------------------------------//
+
+int main(int argc, char** argv) {
    fon9::AutoPrintTestInfo utinfo{"Timer"};
-   TestTimerThread();
+   TestTimerWheel();
+   BenchArmCancel();
+   if (argc > 1 && strcmp(argv[1], "bench") == 0)
+      return 0;
+
+   utinfo.PrintSplitter();
+   TestTimerThread(fon9::TimeInterval{});
+   utinfo.PrintSplitter();
+   TestTimerThread(fon9::TimeInterval_Millisecond(1));
 
    // 測試在 main() 結束後, DefaultTimerThread 是否能正常結束.
    fon9::GetDefaultTimerThread();
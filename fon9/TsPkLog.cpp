@@ -0,0 +1,198 @@
+﻿// \file fon9/TsPkLog.cpp
+// \author fonwinz@gmail.com
+#include "fon9/TsPkLog.hpp"
+#include "fon9/Endian.hpp"
+#include "fon9/Bitv.h"
+#include "fon9/Log.hpp"
+#include <algorithm>
+#include <map>
+
+namespace fon9 {
+
+struct TsPkLogIdxHead {
+   char           Magic_[8];
+   uint32_t       RecSize_;
+   uint32_t       IdxInterval_;
+   File::PosType  LogSize_;
+   uint64_t       RecCount_;
+};
+static const char kTsPkLogIdxMagic[8] = {'f', '9', 'T', 's', 'I', 'd', 'x', '1'};
+
+TsPkLogReader::~TsPkLogReader() {
+}
+File::Result TsPkLogReader::Open(std::string fname, FnTsPkSeq fnSeq, bool isSaveIdx, unsigned idxInterval) {
+   this->FnSeq_ = std::move(fnSeq);
+   this->IdxInterval_ = (idxInterval ? idxInterval : 1u);
+   this->Idx_.clear();
+   this->SeqIdx_.clear();
+   this->IdxLogSize_ = 0;
+   auto res = this->Log_.OpenMap(std::move(fname));
+   if (!res)
+      return res;
+   File fdIdx;
+   const bool isIdxOpened = fdIdx.Open(this->Log_.GetOpenName() + ".idx",
+                                       isSaveIdx ? (FileMode::Read | FileMode::Write | FileMode::OpenAlways)
+                                                 : FileMode::Read).HasResult();
+   const bool isIdxLoaded = isIdxOpened && this->LoadIdx(fdIdx);
+   const File::PosType idxLogSize = this->IdxLogSize_;
+   this->BuildIdx();
+   if (isSaveIdx && isIdxOpened && (!isIdxLoaded || idxLogSize != this->IdxLogSize_)) {
+      // 索引檔只是 cache, 寫入失敗不影響 Open() 的結果, 但要記錄下來.
+      auto resIdx = this->SaveIdx(fdIdx);
+      if (!resIdx)
+         fon9_LOG_ERROR("TsPkLogReader.SaveIdx|fname=", fdIdx.GetOpenName(), "|err=", resIdx.GetError());
+   }
+   return res;
+}
+File::Result TsPkLogReader::Reload() {
+   auto res = this->Log_.Map();
+   if (res) {
+      if (this->IdxLogSize_ > res.GetResult()) { // 記錄檔變小了? 重建索引.
+         this->Idx_.clear();
+         this->IdxLogSize_ = 0;
+      }
+      this->BuildIdx();
+   }
+   return res;
+}
+bool TsPkLogReader::LoadIdx(File& fd) {
+   TsPkLogIdxHead head;
+   auto res = fd.Read(0, &head, sizeof(head));
+   if (!res || res.GetResult() != sizeof(head))
+      return false;
+   if (memcmp(head.Magic_, kTsPkLogIdxMagic, sizeof(head.Magic_)) != 0
+       || head.RecSize_ != sizeof(IdxRec)
+       || head.IdxInterval_ != this->IdxInterval_
+       || head.LogSize_ > this->GetLogSize())
+      return false;
+   // 索引檔大小必須與 RecCount_ 相符, 避免損毀的索引檔造成過大的配置(bad_alloc)或讀到無效資料;
+   // 不符時傳回 false, 由 BuildIdx() 重新掃描.
+   res = fd.GetFileSize();
+   if (!res || res.GetResult() < sizeof(head)
+       || (res.GetResult() - sizeof(head)) / sizeof(IdxRec) != head.RecCount_
+       || (res.GetResult() - sizeof(head)) % sizeof(IdxRec) != 0)
+      return false;
+   this->Idx_.resize(static_cast<size_t>(head.RecCount_));
+   const File::SizeType rdsz = head.RecCount_ * sizeof(IdxRec);
+   res = fd.Read(sizeof(head), this->Idx_.data(), rdsz);
+   if (!res || res.GetResult() != rdsz
+       || (!this->Idx_.empty() && this->Idx_.back().Pos_ >= head.LogSize_)) {
+      this->Idx_.clear();
+      return false;
+   }
+   this->IdxLogSize_ = head.LogSize_;
+   return true;
+}
+File::Result TsPkLogReader::SaveIdx(File& fd) const {
+   TsPkLogIdxHead head;
+   memcpy(head.Magic_, kTsPkLogIdxMagic, sizeof(head.Magic_));
+   head.RecSize_ = sizeof(IdxRec);
+   head.IdxInterval_ = this->IdxInterval_;
+   head.LogSize_ = this->IdxLogSize_;
+   head.RecCount_ = this->Idx_.size();
+   auto res = fd.SetFileSize(0);
+   if (res)
+      res = fd.Write(0, &head, sizeof(head));
+   if (res)
+      res = fd.Write(sizeof(head), this->Idx_.data(), this->Idx_.size() * sizeof(IdxRec));
+   return res;
+}
+void TsPkLogReader::BuildIdx() {
+   // 每個 channel 從上次記錄索引之後, 經過的封包數量;
+   // 繼續建立索引時, 從 0 開始計算, 所以每個 channel 一開始都會先記錄一筆.
+   std::map<uint32_t, unsigned>  chCounts;
+   unsigned       pkCount = 0;
+   File::PosType  pos = this->IdxLogSize_;
+   TsPkLogPk      pk;
+   while (this->FetchPk(pos, pk)) {
+      IdxRec rec;
+      rec.Channel_ = 0;
+      rec.Seq_ = 0;
+      rec.HasSeq_ = this->GetPkSeq(pk, rec.Channel_, rec.Seq_);
+      bool isAddRec = (pkCount++ % this->IdxInterval_ == 0);
+      if (rec.HasSeq_) {
+         unsigned& chCount = chCounts[rec.Channel_];
+         if (chCount++ % this->IdxInterval_ == 0)
+            isAddRec = true;
+      }
+      if (isAddRec) {
+         rec.Pos_ = pk.Pos_;
+         rec.Time_ = pk.Time_.GetOrigValue();
+         this->Idx_.push_back(rec);
+      }
+      this->IdxLogSize_ = pos;
+   }
+   // 重建 SeqIdx_: 同一個 channel 的序號遞增, 所以排序時用 Pos_ 做為第二個條件即可.
+   this->SeqIdx_.clear();
+   for (uint32_t L = 0; L < this->Idx_.size(); ++L) {
+      if (this->Idx_[L].HasSeq_)
+         this->SeqIdx_.push_back(L);
+   }
+   const std::vector<IdxRec>& idx = this->Idx_;
+   std::stable_sort(this->SeqIdx_.begin(), this->SeqIdx_.end(), [&idx](uint32_t lhs, uint32_t rhs) {
+      return idx[lhs].Channel_ < idx[rhs].Channel_;
+   });
+}
+bool TsPkLogReader::FetchPk(File::PosType& pos, TsPkLogPk& pk) const {
+   const byte* const pbeg = this->Log_.GetMapBegin();
+   const File::PosType logsz = this->GetLogSize();
+   while (pos + TsReceiver::kHeadSize <= logsz) {
+      const byte* phead = pbeg + pos;
+      if (fon9_UNLIKELY(*phead != fon9_BitvT_TimeStamp_Orig7)) {
+         const void* pnext = memchr(phead, fon9_BitvT_TimeStamp_Orig7, static_cast<size_t>(logsz - pos));
+         if (pnext == nullptr)
+            break;
+         pos = static_cast<File::PosType>(static_cast<const byte*>(pnext) - pbeg);
+         continue;
+      }
+      const TsReceiver::PkszT pksz = GetBigEndian<TsReceiver::PkszT>(phead + sizeof(TimeStamp));
+      if (pos + TsReceiver::kHeadSize + pksz > logsz)
+         break;
+      pk.Pos_ = pos;
+      pk.Time_.SetOrigValue(GetPackedBigEndian<TimeStamp::OrigType>(phead + 1, sizeof(TimeStamp) - 1));
+      pk.Pk_ = phead + TsReceiver::kHeadSize;
+      pk.Size_ = pksz;
+      pos += TsReceiver::kHeadSize + pksz;
+      return true;
+   }
+   return false;
+}
+File::PosType TsPkLogReader::SeekTime(TimeStamp tm) const {
+   const TimeStamp::OrigType tmv = tm.GetOrigValue();
+   auto ifind = std::lower_bound(this->Idx_.begin(), this->Idx_.end(), tmv,
+                                 [](const IdxRec& rec, TimeStamp::OrigType v) {
+      return rec.Time_ < v;
+   });
+   File::PosType  pos = (ifind == this->Idx_.begin() ? 0 : (ifind - 1)->Pos_);
+   TsPkLogPk      pk;
+   while (this->FetchPk(pos, pk)) {
+      if (pk.Time_ >= tm)
+         return pk.Pos_;
+   }
+   return this->GetLogSize();
+}
+File::PosType TsPkLogReader::SeekSeq(uint32_t channel, uint64_t seq) const {
+   const std::vector<IdxRec>& idx = this->Idx_;
+   auto ifind = std::lower_bound(this->SeqIdx_.begin(), this->SeqIdx_.end(), seq,
+                                 [&idx, channel](uint32_t L, uint64_t v) {
+      const IdxRec& rec = idx[L];
+      return rec.Channel_ < channel || (rec.Channel_ == channel && rec.Seq_ < v);
+   });
+   File::PosType pos;
+   if (ifind != this->SeqIdx_.begin() && idx[*(ifind - 1)].Channel_ == channel)
+      pos = idx[*(ifind - 1)].Pos_;
+   else if (ifind != this->SeqIdx_.end() && idx[*ifind].Channel_ == channel)
+      pos = idx[*ifind].Pos_; // channel 的第一個封包, 序號就已經 >= seq;
+   else
+      return this->GetLogSize();
+   TsPkLogPk   pk;
+   uint32_t    pkch;
+   uint64_t    pkseq;
+   while (this->FetchPk(pos, pk)) {
+      if (this->GetPkSeq(pk, pkch, pkseq) && pkch == channel && pkseq >= seq)
+         return pk.Pos_;
+   }
+   return this->GetLogSize();
+}
+
+} // namespaces
@@ -0,0 +1,106 @@
+﻿// \file fon9/TsPkLog.hpp
+// \author fonwinz@gmail.com
+#ifndef __fon9_TsPkLog_hpp__
+#define __fon9_TsPkLog_hpp__
+#include "fon9/MmapFile.hpp"
+#include "fon9/TsReceiver.hpp"
+
+fon9_BEFORE_INCLUDE_STD;
+#include <functional>
+#include <vector>
+fon9_AFTER_INCLUDE_STD;
+
+namespace fon9 {
+
+/// \ingroup Misc
+/// 從 TsAppend() 寫入的記錄檔取出的封包.
+struct TsPkLogPk {
+   /// 此封包(含 TsAppend 的 head)在記錄檔的位置.
+   File::PosType     Pos_;
+   TimeStamp         Time_;
+   const void*       Pk_;
+   TsReceiver::PkszT Size_;
+   char              Padding____[6];
+};
+
+/// \ingroup Misc
+/// 取得封包的「channel 及序號」, 用來建立序號索引.
+/// - 例如台灣證交所行情: channel = Market * 100 + FmtNo; seq = SeqNo;
+/// - 同一個 channel 的序號, 在記錄檔中必須是遞增的.
+/// - 若封包沒有序號(例: Hb), 則傳回 false;
+using FnTsPkSeq = std::function<bool(const void* pk, unsigned pksz, uint32_t& channel, uint64_t& seq)>;
+
+/// \ingroup Misc
+/// 使用 mmap 讀取 TsAppend() 寫入的記錄檔, 並使用索引檔(fname + ".idx")快速定位.
+/// - 索引: 每 IdxInterval 個封包, 及每個 channel 每 IdxInterval 個有序號的封包, 記錄一筆:
+///   [Pos, Time, Channel, Seq];
+///   - 定位時: 先從索引找到最接近的位置, 再從該位置循序找到正確的封包.
+/// - 索引檔只是快取, 使用 native endian, 若格式不符或記錄檔變小, 則會重建.
+/// - 記錄檔若有增加(例如: 盤中正在寫入), 則從索引檔涵蓋的位置, 繼續建立索引.
+class fon9_API TsPkLogReader {
+   fon9_NON_COPY_NON_MOVE(TsPkLogReader);
+public:
+   struct IdxRec {
+      File::PosType        Pos_;
+      TimeStamp::OrigType  Time_;
+      uint64_t             Seq_;
+      uint32_t             Channel_;
+      /// 此筆記錄的 Channel_, Seq_ 是否有效.
+      uint32_t             HasSeq_;
+   };
+   enum : unsigned {
+      kDefaultIdxInterval = 256,
+   };
+
+   TsPkLogReader() = default;
+   ~TsPkLogReader();
+
+   /// 開啟記錄檔, 然後載入(或建立)索引.
+   /// \param fnSeq 若為 nullptr, 則只有時間索引, 無法使用 SeekSeq();
+   /// \param isSaveIdx 索引有異動時, 是否寫入索引檔.
+   File::Result Open(std::string fname, FnTsPkSeq fnSeq, bool isSaveIdx = true,
+                     unsigned idxInterval = kDefaultIdxInterval);
+   /// 記錄檔有增加時, 重新對應並更新索引(不寫入索引檔).
+   /// \retval 成功 記錄檔大小.
+   File::Result Reload();
+
+   File::PosType GetLogSize() const {
+      return this->Log_.GetMapSize();
+   }
+   const std::string& GetOpenName() const {
+      return this->Log_.GetOpenName();
+   }
+   const std::vector<IdxRec>& GetIdx() const {
+      return this->Idx_;
+   }
+   /// 取得 pos 位置的封包, 若 pos 不是封包開頭, 則往後尋找.
+   /// \retval true  成功取得封包, pos 移到下一個封包的位置.
+   /// \retval false 已到檔尾(或檔尾的封包不完整).
+   bool FetchPk(File::PosType& pos, TsPkLogPk& pk) const;
+   /// 第一個時間 >= tm 的封包位置, 若沒有則傳回 GetLogSize();
+   File::PosType SeekTime(TimeStamp tm) const;
+   /// channel 第一個序號 >= seq 的封包位置, 若沒有則傳回 GetLogSize();
+   File::PosType SeekSeq(uint32_t channel, uint64_t seq) const;
+   /// 取得封包的 channel 及序號.
+   bool GetPkSeq(const TsPkLogPk& pk, uint32_t& channel, uint64_t& seq) const {
+      return this->FnSeq_ && this->FnSeq_(pk.Pk_, pk.Size_, channel, seq);
+   }
+
+private:
+   MmapFile             Log_;
+   FnTsPkSeq            FnSeq_;
+   std::vector<IdxRec>  Idx_;
+   /// 依照 [Channel_, Seq_] 排序的 Idx_ 的索引.
+   std::vector<uint32_t>   SeqIdx_;
+   /// Idx_ 已涵蓋的記錄檔大小.
+   File::PosType        IdxLogSize_{0};
+   unsigned             IdxInterval_{kDefaultIdxInterval};
+   char                 Padding____[4];
+
+   bool LoadIdx(File& fd);
+   File::Result SaveIdx(File& fd) const;
+   void BuildIdx();
+};
+
+} // namespaces
+#endif//__fon9_TsPkLog_hpp__
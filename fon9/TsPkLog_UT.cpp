@@ -0,0 +1,207 @@
+﻿// \file fon9/TsPkLog_UT.cpp
+// \author fonwinz@gmail.com
+#define _CRT_SECURE_NO_WARNINGS
+#include "fon9/TsPkLog.hpp"
+#include "fon9/TsAppend.hpp"
+#include "fon9/TestTools.hpp"
+#include "fon9/Endian.hpp"
+#include <random>
+
+//--------------------------------------------------------------------------//
+// 測試用的封包格式: [Channel:BigEndian uint32_t][Seq:BigEndian uint64_t][Filler...]
+// Channel == 0 表示沒有序號(例: Hb);
+static const char    kLogFileName[] = "TsPkLog_UT.log";
+static const unsigned kChannelCount = 5;
+static const unsigned kHbInterval = 50;
+static const fon9::TimeInterval kPkInterval = fon9::TimeInterval_Microsecond(100);
+
+static bool TestPkSeq(const void* pk, unsigned pksz, uint32_t& channel, uint64_t& seq) {
+   if (pksz < sizeof(channel) + sizeof(seq))
+      return false;
+   channel = fon9::GetBigEndian<uint32_t>(pk);
+   seq = fon9::GetBigEndian<uint64_t>(static_cast<const char*>(pk) + sizeof(channel));
+   return channel != 0;
+}
+
+struct TestLogWriter {
+   fon9::AsyncFileAppenderSP  Log_{fon9::AsyncFileAppender::Make()};
+   std::mt19937               Rnd_{20203};
+   fon9::TimeStamp            BaseTime_{fon9::YYYYMMDDHHMMSS_ToTimeStamp(20201020084500)};
+   uint64_t                   Seqs_[kChannelCount + 1];
+   uint64_t                   PkCount_{0};
+
+   TestLogWriter() {
+      memset(this->Seqs_, 0, sizeof(this->Seqs_));
+      auto res = this->Log_->OpenImmediately(kLogFileName, fon9::FileMode::Append | fon9::FileMode::OpenAlways);
+      if (!res) {
+         std::cout << "[ERROR] Open:" << kLogFileName << std::endl;
+         abort();
+      }
+   }
+   fon9::TimeStamp GetPkTime(uint64_t pkIndex) const {
+      return this->BaseTime_ + kPkInterval * static_cast<int64_t>(pkIndex);
+   }
+   void Append(uint64_t count) {
+      char pk[256];
+      while (count-- > 0) {
+         const uint32_t channel = (this->PkCount_ % kHbInterval == 0 ? 0u : static_cast<uint32_t>(this->Rnd_() % kChannelCount + 1));
+         fon9::PutBigEndian(pk, channel);
+         fon9::PutBigEndian(pk + sizeof(channel), ++this->Seqs_[channel]);
+         const uint16_t pksz = static_cast<uint16_t>(12 + this->Rnd_() % 200);
+         fon9::TsAppend(*this->Log_, this->GetPkTime(this->PkCount_++), pk, pksz);
+      }
+      this->Log_->WaitFlushed();
+   }
+};
+
+static void CheckResult(const char* msg, fon9::File::PosType res, fon9::File::PosType expected) {
+   if (res == expected)
+      return;
+   std::cout << "|" << msg << "|res=" << res << "|expected=" << expected << "\r[ERROR]" << std::endl;
+   abort();
+}
+
+/// 使用循序搜尋的結果, 驗證 SeekTime(), SeekSeq();
+static void CheckSeeks(const fon9::TsPkLogReader& reader, const TestLogWriter& writer) {
+   std::mt19937 rnd{20204};
+   std::vector<fon9::TsPkLogPk> pks;
+   fon9::File::PosType pos = 0;
+   fon9::TsPkLogPk     pk;
+   while (reader.FetchPk(pos, pk))
+      pks.push_back(pk);
+   CheckResult("PkCount", pks.size(), writer.PkCount_);
+   for (unsigned L = 0; L < 1000; ++L) {
+      const uint64_t pkIndex = rnd() % (writer.PkCount_ + 10);
+      const fon9::File::PosType expected = (pkIndex < pks.size() ? pks[pkIndex].Pos_ : reader.GetLogSize());
+      CheckResult("SeekTime", reader.SeekTime(writer.GetPkTime(pkIndex)), expected);
+      // 時間在 2 個封包之間: 應找到下一個封包.
+      if (pkIndex > 0)
+         CheckResult("SeekTime.Between", reader.SeekTime(writer.GetPkTime(pkIndex) - kPkInterval / 2), expected);
+   }
+   CheckResult("SeekTime.Begin", reader.SeekTime(fon9::TimeStamp{}), 0);
+   for (unsigned L = 0; L < 1000; ++L) {
+      const uint32_t channel = static_cast<uint32_t>(rnd() % kChannelCount + 1);
+      const uint64_t seq = rnd() % (writer.Seqs_[channel] + 10) + 1;
+      fon9::File::PosType expected = reader.GetLogSize();
+      for (const fon9::TsPkLogPk& ipk : pks) {
+         uint32_t pkch;
+         uint64_t pkseq;
+         if (TestPkSeq(ipk.Pk_, ipk.Size_, pkch, pkseq) && pkch == channel && pkseq >= seq) {
+            expected = ipk.Pos_;
+            break;
+         }
+      }
+      CheckResult("SeekSeq", reader.SeekSeq(channel, seq), expected);
+   }
+   CheckResult("SeekSeq.NoChannel", reader.SeekSeq(kChannelCount + 1, 1), reader.GetLogSize());
+}
+
+void TestTsPkLog() {
+   const uint64_t kPkCount = 100000;
+   std::cout << "[TEST ] TsPkLogReader" << std::flush;
+   TestLogWriter writer;
+   writer.Append(kPkCount);
+   {  // 沒有索引檔: 建立索引.
+      fon9::TsPkLogReader reader;
+      if (!reader.Open(kLogFileName, &TestPkSeq)) {
+         std::cout << "|Open\r[ERROR]" << std::endl;
+         abort();
+      }
+      CheckSeeks(reader, writer);
+      // 使用已建立的索引檔.
+      fon9::TsPkLogReader reader2;
+      reader2.Open(kLogFileName, &TestPkSeq);
+      const auto& idx1 = reader.GetIdx();
+      const auto& idx2 = reader2.GetIdx();
+      if (idx1.size() != idx2.size()
+          || memcmp(idx1.data(), idx2.data(), idx1.size() * sizeof(idx1[0])) != 0) {
+         std::cout << "|LoadIdx\r[ERROR]" << std::endl;
+         abort();
+      }
+      // 索引檔損毀(RecCount_ 與檔案大小不符): 重新掃描建立索引.
+      {
+         fon9::File fdIdx;
+         fdIdx.Open(std::string{kLogFileName} + ".idx", fon9::FileMode::Read | fon9::FileMode::Write);
+         const uint64_t badCount = uint64_t{1} << 60;
+         // TsPkLogIdxHead: Magic_[8], RecSize_, IdxInterval_, LogSize_, RecCount_;
+         fdIdx.Write(8 + 4 + 4 + sizeof(fon9::File::PosType), &badCount, sizeof(badCount));
+      }
+      fon9::TsPkLogReader reader3;
+      reader3.Open(kLogFileName, &TestPkSeq);
+      const auto& idx3 = reader3.GetIdx();
+      if (idx1.size() != idx3.size()
+          || memcmp(idx1.data(), idx3.data(), idx1.size() * sizeof(idx1[0])) != 0) {
+         std::cout << "|BadIdx\r[ERROR]" << std::endl;
+         abort();
+      }
+      // 記錄檔增加: Reload() 之後, 可以找到新的封包.
+      writer.Append(kPkCount / 10);
+      reader.Reload();
+      CheckSeeks(reader, writer);
+   }
+   // 索引檔只涵蓋部分記錄檔: 從涵蓋的位置繼續建立索引.
+   fon9::TsPkLogReader reader;
+   reader.Open(kLogFileName, &TestPkSeq);
+   CheckSeeks(reader, writer);
+   std::cout << "|idx.count=" << reader.GetIdx().size() << "\r[OK   ]" << std::endl;
+}
+
+//--------------------------------------------------------------------------//
+/// 評估: 建立索引, 載入索引, 使用索引定位 vs 從頭循序搜尋.
+void BenchTsPkLog() {
+   const uint64_t  kPkCount = 2000000;
+   TestLogWriter   writer;
+   writer.Append(kPkCount);
+   fon9::StopWatch stopWatch;
+   {
+      fon9::TsPkLogReader reader;
+      reader.Open(kLogFileName, &TestPkSeq);
+      stopWatch.PrintResult("BuildIdx", kPkCount);
+   }
+   fon9::TsPkLogReader reader;
+   stopWatch.ResetTimer();
+   reader.Open(kLogFileName, &TestPkSeq);
+   stopWatch.PrintResult("LoadIdx", reader.GetIdx().size());
+
+   const unsigned kTimes = 1000;
+   std::mt19937   rnd{20205};
+   fon9::File::PosType chk = 0;
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes; ++L)
+      chk += reader.SeekTime(writer.GetPkTime(rnd() % kPkCount));
+   stopWatch.PrintResult("SeekTime", kTimes);
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes; ++L) {
+      const uint32_t channel = static_cast<uint32_t>(rnd() % kChannelCount + 1);
+      chk += reader.SeekSeq(channel, rnd() % writer.Seqs_[channel] + 1);
+   }
+   stopWatch.PrintResult("SeekSeq", kTimes);
+
+   const unsigned kScanTimes = 10;
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kScanTimes; ++L) {
+      const fon9::TimeStamp tm = writer.GetPkTime(rnd() % kPkCount);
+      fon9::File::PosType   pos = 0;
+      fon9::TsPkLogPk       pk;
+      while (reader.FetchPk(pos, pk) && pk.Time_ < tm) {
+      }
+      chk += pk.Pos_;
+   }
+   stopWatch.PrintResult("Scan(NoIdx)", kScanTimes);
+   if (chk == 0)
+      std::cout << "chk=0" << std::endl;
+}
+
+int main() {
+   fon9::AutoPrintTestInfo utinfo{"TsPkLog"};
+   remove(kLogFileName);
+   remove((std::string{kLogFileName} + ".idx").c_str());
+   TestTsPkLog();
+
+   utinfo.PrintSplitter();
+   remove(kLogFileName);
+   remove((std::string{kLogFileName} + ".idx").c_str());
+   BenchTsPkLog();
+   remove(kLogFileName);
+   remove((std::string{kLogFileName} + ".idx").c_str());
+}
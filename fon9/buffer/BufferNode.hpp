@@ -178,6 +178,8 @@ public:
    enum class StyleFlag {
       /// 允許跨越此節點, 若無此旗標, 則必須在前面的節點都用完後才能繼續。
       AllowCrossing = 0x01,
+      /// 此節點為 BufferNodeShared: 參考外部共用的資料.
+      SharedData = 0x02,
    };
    const StyleFlag StyleFlags_;
 
@@ -199,7 +201,88 @@ protected:
    fon9_API friend void FreeNode(BufferNode* node);
 };
 fon9_ENABLE_ENUM_BITWISE_OP(BufferNodeVirtual::StyleFlag);
+
+class BufferShared;
+/// \ingroup Buffer
+/// 參考 BufferShared 資料的節點.
+/// - 節點本身不存放資料, 所以同一份 BufferShared 可以同時串到多個 BufferList, 不用複製資料.
+/// - 對一般的 BufferNode 操作而言, 這是「可跨越、沒有資料」的控制節點:
+///   GetDataBegin()、GetDataSize()、CalcDataSize()... 都看不到共用的資料,
+///   RevBufferList、FwdBufferList 也不會在此節點填入資料.
+/// - 只有傳送端(DcQueueList: 例如 io::Device 的 SendBuffer)會透過 GetSendData() 取得共用的資料,
+///   所以只能用在「直接交給 io::Device 送出」的 BufferList, 例: rc 的訂閱通知.
+/// - 透過 BufferShared::AppendTo() 建立, 由 FreeNode() 釋放(釋放時解除對 BufferShared 的參考).
+class fon9_API BufferNodeShared : public BufferNodeVirtual {
+   fon9_NON_COPY_NON_MOVE(BufferNodeShared);
+   using base = BufferNodeVirtual;
+   friend class BufferNode;
+   friend class BufferShared;
+   const BufferShared* const  Owner_;
+   const byte*                SharedBegin_;
+   const byte* const          SharedEnd_;
+
+   BufferNodeShared(BufferNodeSize blockSize, const BufferShared& owner, const BufferNode& src);
+   ~BufferNodeShared();
+   static BufferNodeShared* Alloc(const BufferShared& owner, const BufferNode& src);
+   void OnBufferConsumed() override;
+   void OnBufferConsumedErr(const ErrC& errc) override;
+
+public:
+   /// node 必須是 BufferNodeShared 才會轉型成功.
+   static const BufferNodeShared* CastFrom(const BufferNode* node) {
+      return(node->GetNodeType() == BufferNodeType::Virtual
+             && IsEnumContains(static_cast<const BufferNodeVirtual*>(node)->StyleFlags_, StyleFlag::SharedData)
+             ? static_cast<const BufferNodeShared*>(node) : nullptr);
+   }
+   static BufferNodeShared* CastFrom(BufferNode* node) {
+      return const_cast<BufferNodeShared*>(CastFrom(static_cast<const BufferNode*>(node)));
+   }
+
+   const BufferShared& Owner() const {
+      return *this->Owner_;
+   }
+   const byte* GetSharedBegin() const {
+      return this->SharedBegin_;
+   }
+   const byte* GetSharedEnd() const {
+      return this->SharedEnd_;
+   }
+   size_t GetSharedSize() const {
+      return static_cast<size_t>(this->SharedEnd_ - this->SharedBegin_);
+   }
+   /// 傳送端送出部分資料後, 移動共用資料的開始位置; 共用的資料內容不會改變.
+   void MoveSharedBegin(size_t offset) {
+      this->SharedBegin_ += offset;
+      assert(this->SharedBegin_ <= this->SharedEnd_);
+   }
+};
 fon9_WARN_POP;
 
+/// \ingroup Buffer
+/// 傳送端取得 node 的資料, 包含 BufferNodeShared 參考的共用資料.
+/// \retval 資料量, *pbeg = 資料開始位置.
+inline size_t GetSendData(const BufferNode* node, const byte** pbeg) {
+   if (const size_t sz = node->GetDataSize()) {
+      *pbeg = node->GetDataBegin();
+      return sz;
+   }
+   if (const BufferNodeShared* snode = BufferNodeShared::CastFrom(node)) {
+      *pbeg = snode->GetSharedBegin();
+      return snode->GetSharedSize();
+   }
+   return 0;
+}
+/// \ingroup Buffer
+/// 計算從 front 開始的傳送資料量(包含front), 包含 BufferNodeShared 參考的共用資料.
+inline size_t CalcSendDataSize(const BufferNode* front) {
+   size_t      sz = 0;
+   const byte* beg;
+   while (front) {
+      sz += GetSendData(front, &beg);
+      front = front->GetNext();
+   }
+   return sz;
+}
+
 } // namespaces
 #endif//__fon9_buffer_BufferNode_hpp__
@@ -0,0 +1,48 @@
+﻿// \file fon9/buffer/BufferShared.cpp
+// \author fonwinz@gmail.com
+#include "fon9/buffer/BufferShared.hpp"
+
+namespace fon9 {
+
+BufferNodeShared::BufferNodeShared(BufferNodeSize blockSize, const BufferShared& owner, const BufferNode& src)
+   : base(blockSize, StyleFlag::AllowCrossing | StyleFlag::SharedData)
+   , Owner_{&owner}
+   , SharedBegin_{src.GetDataBegin()}
+   , SharedEnd_{src.GetDataEnd()} {
+   intrusive_ptr_add_ref(this->Owner_);
+}
+BufferNodeShared::~BufferNodeShared() {
+   intrusive_ptr_release(this->Owner_);
+}
+BufferNodeShared* BufferNodeShared::Alloc(const BufferShared& owner, const BufferNode& src) {
+   return base::Alloc<BufferNodeShared>(0, owner, src);
+}
+void BufferNodeShared::OnBufferConsumed() {
+}
+void BufferNodeShared::OnBufferConsumedErr(const ErrC& errc) {
+   (void)errc;
+}
+//--------------------------------------------------------------------------//
+BufferShared::~BufferShared() {
+}
+BufferSharedSP BufferShared::MakeCopy(const BufferNode* front) {
+   const size_t totsz = CalcDataSize(front);
+   size_t       cpysz = 0;
+   BufferList   buf;
+   for (; front; front = front->GetNext()) {
+      if (const size_t nodesz = front->GetDataSize()) {
+         cpysz += nodesz;
+         AppendToBuffer(buf, front->GetDataBegin(), nodesz, totsz - cpysz);
+      }
+   }
+   return Make(std::move(buf));
+}
+void BufferShared::AppendTo(BufferList& dst) const {
+   for (const BufferNode* node = this->Data_.cfront(); node; node = node->GetNext()) {
+      assert(node->GetNodeType() != BufferNodeType::Virtual);
+      if (node->GetDataSize() > 0)
+         dst.push_back(BufferNodeShared::Alloc(*this, *node));
+   }
+}
+
+} // namespaces
@@ -0,0 +1,57 @@
+﻿/// \file fon9/buffer/BufferShared.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_buffer_BufferShared_hpp__
+#define __fon9_buffer_BufferShared_hpp__
+#include "fon9/buffer/BufferList.hpp"
+#include "fon9/intrusive_ref_counter.hpp"
+
+namespace fon9 {
+
+class BufferShared;
+using BufferSharedSP = intrusive_ptr<const BufferShared>;
+
+/// \ingroup Buffer
+/// 打包一次, 送出 N 次: 不可變動的共用資料.
+/// - 例: 行情發行時, 打包一次, 然後串到 N 個訂閱者(io::Device)的傳送緩衝, 不用複製 N 次.
+/// - 建立後資料就不可變動, 所以可以在多個 thread 同時讀取(例: 多個 Device 同時送出).
+/// - AppendTo() 建立的 BufferNodeShared 會參考 this, 在全部的 BufferNodeShared 都釋放後, this 才會釋放.
+/// - BufferNodeShared 只有傳送端(DcQueueList)認得, 所以 AppendTo() 的結果只能直接交給 io::Device 送出.
+class fon9_API BufferShared : public intrusive_ref_counter<BufferShared> {
+   fon9_NON_COPY_NON_MOVE(BufferShared);
+   const BufferList  Data_;
+   const size_t      DataSize_;
+
+   BufferShared(BufferList&& src)
+      : Data_{std::move(src)}
+      , DataSize_{CalcDataSize(Data_.cfront())} {
+   }
+public:
+   ~BufferShared();
+
+   /// 取得 src 的全部節點(不複製資料).
+   /// src 不可包含 BufferNodeVirtual.
+   static BufferSharedSP Make(BufferList&& src) {
+      return BufferSharedSP{new BufferShared{std::move(src)}};
+   }
+   /// 複製 front 的資料(複製一次), 建立 BufferShared; front 的內容不變.
+   static BufferSharedSP MakeCopy(const BufferNode* front);
+
+   size_t size() const {
+      return this->DataSize_;
+   }
+   const BufferNode* cfront() const {
+      return this->Data_.cfront();
+   }
+
+   /// 在 dst 尾端加入參考 this 的節點(BufferNodeShared), 不會複製資料.
+   void AppendTo(BufferList& dst) const;
+   /// 建立一個參考 this 的 BufferList, 不會複製資料.
+   BufferList MakeBufferList() const {
+      BufferList buf;
+      this->AppendTo(buf);
+      return buf;
+   }
+};
+
+} // namespaces
+#endif//__fon9_buffer_BufferShared_hpp__
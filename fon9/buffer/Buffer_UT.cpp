@@ -3,6 +3,8 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "fon9/TestTools.hpp"
 #include "fon9/buffer/DcQueueList.hpp"
+#include "fon9/buffer/BufferShared.hpp"
+#include "fon9/BitvEncode.hpp"
 #include "fon9/Log.hpp"
 #include "fon9/ThreadId.hpp"
 
@@ -102,6 +104,125 @@ __TEST_ERROR:
    abort();
 }
 
+//--------------------------------------------------------------------------//
+static void CheckShared(const char* item, const std::string& res, const std::string& expected) {
+   if (res == expected)
+      return;
+   std::cout << "|" << item << "|result not match!"
+      << "\r[ERROR]"
+      << "\n|exp=" << expected
+      << "\n|res=" << res
+      << std::endl;
+   abort();
+}
+/// 模擬傳送端: 透過 DcQueueList 取出全部的資料(包含 BufferNodeShared 的共用資料).
+static std::string SendBufferTo(fon9::BufferList&& buf) {
+   fon9::DcQueueList dcq{std::move(buf)};
+   std::string       res;
+   res.resize(dcq.CalcSize());
+   if (!res.empty())
+      dcq.Read(&*res.begin(), res.size());
+   return res;
+}
+void TestBufferShared() {
+   std::cout << "[TEST ] BufferShared";
+   const std::string          msg = fon9::BufferTo<std::string>(InitTestData().MoveOut());
+   const size_t               msgsz = msg.size();
+   const fon9::BufferSharedSP shared = fon9::BufferShared::Make(InitTestData().MoveOut());
+   if (shared->size() != msgsz) {
+      std::cout << "|size=" << shared->size() << "|expected=" << msgsz << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   // 同一份 shared 同時串到多個 BufferList.
+   std::vector<fon9::BufferList> lists;
+   for (unsigned L = 0; L < 10; ++L)
+      lists.emplace_back(shared->MakeBufferList());
+   for (const fon9::BufferList& buf : lists) {
+      // BufferNodeShared 對一般的 BufferNode 操作而言, 是沒有資料的控制節點; 只有傳送端看得到共用的資料.
+      if (fon9::CalcDataSize(buf.cfront()) != 0 || fon9::CalcSendDataSize(buf.cfront()) != msgsz) {
+         std::cout << "|MakeBufferList|CalcDataSize=" << fon9::CalcDataSize(buf.cfront())
+                   << "|CalcSendDataSize=" << fon9::CalcSendDataSize(buf.cfront()) << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   for (fon9::BufferList& buf : lists)
+      CheckShared("MakeBufferList", SendBufferTo(std::move(buf)), msg);
+   for (auto& buf : lists)
+      buf = shared->MakeBufferList();
+   // 使用 DcQueueList 消費.
+   for (size_t step = 1; step < msgsz + 10; ++step) {
+      CheckShared("DcQueue.Read", TestRead(fon9::DcQueueList{shared->MakeBufferList()}, msgsz, step), msg);
+      CheckShared("DcQueue.Fetch", TestFetch(fon9::DcQueueList{shared->MakeBufferList()}, msgsz, step), msg);
+   }
+   // 在前方加上 header: 會分配新的節點, 不會改變 shared 的內容.
+   fon9::RevBufferList rbuf{16, shared->MakeBufferList()};
+   fon9::RevPrint(rbuf, "head|");
+   CheckShared("RevPrint", SendBufferTo(rbuf.MoveOut()), "head|" + msg);
+   CheckShared("Immutable", fon9::BufferTo<std::string>(shared->cfront()), msg);
+   // 部分消費後移出.
+   fon9::DcQueueList dcq{shared->MakeBufferList()};
+   dcq.PopConsumed(5);
+   CheckShared("MoveOut", SendBufferTo(dcq.MoveOut()), msg.substr(5));
+   // MakeCopy(): 複製一次, 來源不變.
+   fon9::BufferList src = InitTestData().MoveOut();
+   CheckShared("MakeCopy", SendBufferTo(fon9::BufferShared::MakeCopy(src.cfront())->MakeBufferList()), msg);
+   CheckShared("MakeCopy.src", fon9::BufferTo<std::string>(src), msg);
+   // 全部的 BufferNodeShared 釋放後, 只剩下 shared 本身的參考.
+   lists.clear();
+   if (shared->use_count() != 1) {
+      std::cout << "|use_count=" << shared->use_count() << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+/// 模擬行情發行: 一個封包, 送給 kSubrCount 個訂閱者(每個訂閱者有自己的傳送緩衝).
+/// - Copy:   發行時轉成 std::string(GetGridView()), 每個訂閱者再 ToBitv() 複製一次.
+/// - Shared: 發行時轉成 BufferShared 一次, 每個訂閱者只串接 BufferNodeShared.
+void BenchBufferShared(const size_t kPkSize) {
+   const unsigned kSubrCount = 500;
+   const unsigned kTicks = 2000;
+   const std::string pk(kPkSize, 'x');
+   std::cout << "pksz=" << kPkSize << std::endl;
+   size_t chkSize = 0;
+
+   fon9::StopWatch stopWatch;
+   for (unsigned t = 0; t < kTicks; ++t) {
+      fon9::RevBufferList rts{128};
+      fon9::RevPrint(rts, pk);
+      const std::string gv = fon9::BufferTo<std::string>(rts.cfront());
+      for (unsigned L = 0; L < kSubrCount; ++L) {
+         fon9::RevBufferList ackbuf{128};
+         fon9::ToBitv(ackbuf, gv);
+         fon9::DcQueueList sendBuffer{ackbuf.MoveOut()};
+         chkSize += sendBuffer.CalcSize();
+      }
+   }
+   stopWatch.PrintResultNoEOL("Copy  ", kTicks)
+      << "|subrs=" << kSubrCount
+      << "|copied/tick=" << (kPkSize * (kSubrCount + 1)) << " bytes" << std::endl;
+
+   stopWatch.ResetTimer();
+   for (unsigned t = 0; t < kTicks; ++t) {
+      fon9::RevBufferList rts{128};
+      fon9::RevPrint(rts, pk);
+      const fon9::BufferSharedSP shared = fon9::BufferShared::Make(rts.MoveOut());
+      for (unsigned L = 0; L < kSubrCount; ++L) {
+         fon9::RevBufferList ackbuf{128, shared->MakeBufferList()};
+         fon9::ByteArraySizeToBitvT(ackbuf, shared->size());
+         fon9::DcQueueList sendBuffer{ackbuf.MoveOut()};
+         chkSize -= sendBuffer.CalcSize();
+      }
+   }
+   stopWatch.PrintResultNoEOL("Shared", kTicks)
+      << "|subrs=" << kSubrCount
+      << "|copied/tick=0 bytes" << std::endl;
+   if (chkSize != 0) {
+      std::cout << "|chkSize=" << chkSize << "\r[ERROR]" << std::endl;
+      abort();
+   }
+}
+
 //--------------------------------------------------------------------------//
 
 int main() {
@@ -143,4 +264,9 @@ int main() {
 
    utinfo.PrintSplitter();
    TestBuffer();
+
+   utinfo.PrintSplitter();
+   TestBufferShared();
+   BenchBufferShared(64);
+   BenchBufferShared(1024);
 }
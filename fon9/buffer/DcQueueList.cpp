@@ -6,13 +6,15 @@ namespace fon9 {
 
 void DcQueueList::FrontToCurrBlock() {
    BufferNode* front = this->BlockList_.front();
+   const byte* beg;
    if (this->MemCurrent_ != nullptr) {
-      assert(front && front->GetDataBegin() <= this->MemCurrent_ && this->MemCurrent_ < front->GetDataEnd());
+      assert(front && GetSendData(front, &beg) > 0);
+      assert(beg <= this->MemCurrent_ && this->MemCurrent_ < beg + GetSendData(front, &beg));
       return;
    }
    while (front) {
-      if (front->GetDataSize() > 0) {
-         this->ResetCurrBlock(front->GetDataBegin(), front->GetDataEnd());
+      if (const size_t sz = GetSendData(front, &beg)) {
+         this->ResetCurrBlock(beg, beg + sz);
          return;
       }
       this->NodeConsumed(this->BlockList_.pop_front());
@@ -21,10 +23,11 @@ void DcQueueList::FrontToCurrBlock() {
 }
 bool DcQueueList::DcQueuePeekMore(byte* tmpbuf, size_t sz) const {
    if (const BufferNode* node = this->BlockList_.front()) {
+      const byte* beg;
       while ((node = node->GetNext()) != nullptr) {
-         if (const size_t nodesz = node->GetDataSize()) {
+         if (const size_t nodesz = GetSendData(node, &beg)) {
             const size_t peeksz = (sz < nodesz ? sz : nodesz);
-            memcpy(tmpbuf, node->GetDataBegin(), peeksz);
+            memcpy(tmpbuf, beg, peeksz);
             if ((sz -= peeksz) <= 0)
                return true;
             tmpbuf += peeksz;
@@ -35,9 +38,10 @@ bool DcQueueList::DcQueuePeekMore(byte* tmpbuf, size_t sz) const {
 }
 bool DcQueueList::DcQueueHasMore(size_t sz) const {
    if (const BufferNode* node = this->BlockList_.front()) {
-      size_t nodesz = 0;
+      size_t      nodesz = 0;
+      const byte* beg;
       while ((node = node->GetNext()) != nullptr) {
-         if ((nodesz += node->GetDataSize()) >= sz)
+         if ((nodesz += GetSendData(node, &beg)) >= sz)
             return true;
       }
    }
@@ -53,10 +57,11 @@ void DcQueueList::DcQueueRemoveMore(size_t sz) {
       return;
    }
    // 從後續的 node 移除資料, 並在返回前設定 curr block.
+   const byte* beg;
    while (BufferNode* node = this->BlockList_.front()) {
-      if (size_t nodesz = node->GetDataSize()) {
+      if (size_t nodesz = GetSendData(node, &beg)) {
          if (sz < nodesz) {
-            this->ResetCurrBlock(node->GetDataBegin() + sz, node->GetDataEnd());
+            this->ResetCurrBlock(beg + sz, beg + nodesz);
             return;
          }
          sz -= nodesz;
@@ -66,17 +71,44 @@ void DcQueueList::DcQueueRemoveMore(size_t sz) {
    assert(sz == 0 && this->BlockList_.empty());
    this->ClearCurrBlock();
 }
+void DcQueueList::PopConsumedTo(size_t sz, BufferList& consumed) {
+   const size_t blkszCurr = this->GetCurrBlockSize();
+   if (fon9_LIKELY(sz < blkszCurr)) {
+      this->MemCurrent_ += sz;
+      return;
+   }
+   sz -= blkszCurr;
+   if (BufferNode* front = this->BlockList_.pop_front())
+      consumed.push_back(front);
+   else {
+      assert(sz == 0);
+      return;
+   }
+   const byte* beg;
+   while (BufferNode* node = this->BlockList_.front()) {
+      if (size_t nodesz = GetSendData(node, &beg)) {
+         if (sz < nodesz) {
+            this->ResetCurrBlock(beg + sz, beg + nodesz);
+            return;
+         }
+         sz -= nodesz;
+      }
+      consumed.push_back(this->BlockList_.pop_front());
+   }
+   assert(sz == 0 && this->BlockList_.empty());
+   this->ClearCurrBlock();
+}
 size_t DcQueueList::DcQueueReadMore(byte* buf, size_t sz) {
    // 先釋放 curr block.
    this->NodeConsumed(this->BlockList_.pop_front());
    // 從後續的 node 取出資料, 並在返回前設定 curr block.
-   size_t rdsz = 0;
+   size_t      rdsz = 0;
+   const byte* beg;
    while (BufferNode* node = this->BlockList_.front()) {
-      if (size_t nodesz = node->GetDataSize()) {
-         byte* beg = node->GetDataBegin();
+      if (size_t nodesz = GetSendData(node, &beg)) {
          if (sz < nodesz) {
             memcpy(buf + rdsz, beg, sz);
-            this->ResetCurrBlock(beg + sz, node->GetDataEnd());
+            this->ResetCurrBlock(beg + sz, beg + nodesz);
             return rdsz + sz;
          }
          memcpy(buf + rdsz, beg, nodesz);
@@ -94,11 +126,13 @@ void DcQueueList::ConsumeErr(const ErrC& errc) {
    BufferNode* node = this->BlockList_.pop_front();
    if (node == nullptr)
       return;
-   this->NodeConsumed(node, errc, static_cast<BufferNodeSize>(this->MemCurrent_ - node->GetDataBegin()));
+   const byte* beg;
+   GetSendData(node, &beg);
+   this->NodeConsumed(node, errc, static_cast<BufferNodeSize>(this->MemCurrent_ - beg));
    while ((node = this->BlockList_.pop_front()) != nullptr) {
       if (BufferNodeVirtual* vnode = BufferNodeVirtual::CastFrom(node))
          vnode->OnBufferConsumedErr(errc);
-      this->NodeConsumed(node, errc, node->GetDataSize());
+      this->NodeConsumed(node, errc, static_cast<BufferNodeSize>(GetSendData(node, &beg)));
    }
    assert(this->BlockList_.empty());
    this->ClearCurrBlock();
@@ -20,6 +20,7 @@ namespace fon9 {
 fon9_MSC_WARN_DISABLE(4265); /* dtor isnot virtual. */
 /// \ingroup Buffer
 /// 訊息消費端的緩衝區處理: 使用 BufferList.
+/// - 這裡是傳送端, 所以會取出 BufferNodeShared 參考的共用資料, 參考 GetSendData();
 class fon9_API DcQueueList : public DcQueue {
    fon9_NON_COPYABLE(DcQueueList);
    using base = DcQueue;
@@ -84,8 +85,14 @@ public:
    BufferList MoveOut() {
       if (BufferNode* front = this->BlockList_.front()) {
          assert(this->MemCurrent_ != nullptr);
-         if (BufferNodeSize szUsed = static_cast<BufferNodeSize>(this->MemCurrent_ - front->GetDataBegin()))
-            front->MoveDataBeginOffset(szUsed);
+         const byte* beg;
+         GetSendData(front, &beg);
+         if (const size_t szUsed = static_cast<size_t>(this->MemCurrent_ - beg)) {
+            if (BufferNodeShared* snode = BufferNodeShared::CastFrom(front))
+               snode->MoveSharedBegin(szUsed);
+            else
+               front->MoveDataBeginOffset(static_cast<BufferNodeSize>(szUsed));
+         }
          this->ClearCurrBlock();
          return std::move(this->BlockList_);
       }
@@ -93,9 +100,14 @@ public:
       return BufferList{};
    }
 
+   /// 與 PopConsumed(sz) 相同, 但用完的節點不歸還(也不觸發 OnBufferConsumed()), 而是移到 consumed 的尾端.
+   /// - 例: MSG_ZEROCOPY, 必須等到核心通知傳送完畢後, 才能歸還節點.
+   /// - 移到 consumed 的節點, 其 DataBegin 不會調整, 所以 consumed 的資料量可能比 sz 多.
+   void PopConsumedTo(size_t sz, BufferList& consumed);
+
    virtual size_t CalcSize() const override {
       if (const BufferNode* node = this->BlockList_.front())
-         return this->GetCurrBlockSize() + CalcDataSize(node->GetNext());
+         return this->GetCurrBlockSize() + CalcSendDataSize(node->GetNext());
       return 0;
    }
 
@@ -113,11 +125,12 @@ public:
       fon9_PutIoVectorElement(vect, const_cast<byte*>(this->MemCurrent_), this->GetCurrBlockSize());
       size_t      count = 1;
       BufferNode* node = this->BlockList_.front();
+      const byte* beg;
       while(count < maxCount) {
          if ((node = node->GetNext()) == nullptr)
             break;
-         if (const size_t blksz = node->GetDataSize())
-            fon9_PutIoVectorElement(vect + count++, node->GetDataBegin(), blksz);
+         if (const size_t blksz = GetSendData(node, &beg))
+            fon9_PutIoVectorElement(vect + count++, const_cast<byte*>(beg), blksz);
          else if (BufferNodeVirtual* vnode = BufferNodeVirtual::CastFrom(node)) {
             // 是否允許跨越控制節點?
             if (!IsEnumContains(vnode->StyleFlags_, BufferNodeVirtual::StyleFlag::AllowCrossing))
@@ -2,6 +2,14 @@
 // \author fonwinz@gmail.com
 #include "fon9/buffer/MemBlockImpl.hpp"
 #include "fon9/StaticPtr.hpp"
+#include <algorithm>
+#include <mutex>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace fon9 {
 
@@ -15,13 +23,173 @@ static std::array<size_t, kMemBlockLevelCount> MemBlockLevelMaxNodeCount_{
    32,   // [6]: Size=64K
 };
 
+static std::array<size_t, kMemBlockLevelCount> MemBlockLevelReservedCount_{
+   4, 4, 4, 4, 4, 4, 4,
+};
+/// 每次 MemBlockSetArenaArgs() 成功後遞增, TCache 在向 center 要求時檢查, 若有變動則轉移到新的 center.
+static std::atomic<uint32_t> MemBlockConfigSeq_{0};
+
 //--------------------------------------------------------------------------//
 namespace impl {
+static MemBlockArenaArgs   MemBlockArenaArgs_;
+
+#if defined(__linux__)
+static unsigned GetCurrentNumaNode() {
+   unsigned cpu = 0, node = 0;
+#ifdef SYS_getcpu
+   if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+      node = 0;
+#endif
+   return node % kMemBlockMaxNumaNodes;
+}
+
+class MemBlockArena {
+   fon9_NON_COPY_NON_MOVE(MemBlockArena);
+   enum : size_t {
+      kHugePageSize = 2 * 1024 * 1024,
+      /// 每個 arena 預留的虛擬位址空間, 實際使用時才分段 commit.
+      kReserveSize = static_cast<size_t>(64) * 1024 * 1024 * 1024,
+   };
+   byte*       Base_{nullptr};
+   std::mutex  Mutex_;
+   byte*       Curr_{nullptr};
+   byte*       CommitEnd_{nullptr};
+   const size_t   ChunkSize_;
+   const bool     IsHugePage_;
+   /// <0 表示不綁定 NUMA node.
+   const int      NodeId_;
+
+   bool CommitChunk() {
+      byte* chunk = this->CommitEnd_;
+      if (chunk + this->ChunkSize_ > this->Base_ + kReserveSize)
+         return false;
+      bool isReady = false;
+   #ifdef MAP_HUGETLB
+      if (this->IsHugePage_)
+         isReady = (mmap(chunk, this->ChunkSize_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB, -1, 0) != MAP_FAILED);
+   #endif
+      if (!isReady) {
+         // MAP_FIXED 失敗時, 原本保留的區間可能已被移除, 所以不能使用 mprotect(), 必須重新 mmap(MAP_FIXED).
+         if (mmap(chunk, this->ChunkSize_, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+            return false;
+      #ifdef MADV_HUGEPAGE
+         if (this->IsHugePage_)
+            madvise(chunk, this->ChunkSize_, MADV_HUGEPAGE);
+      #endif
+      }
+   #ifdef SYS_mbind
+      if (this->NodeId_ >= 0) {
+         // 在 first touch 之前綁定; 使用 MPOL_PREFERRED(=1): 若該 node 記憶體不足, 仍可從其他 node 取得.
+         unsigned long nodemask = (1ul << this->NodeId_);
+         syscall(SYS_mbind, chunk, this->ChunkSize_, 1, &nodemask, sizeof(nodemask) * 8, 0);
+      }
+   #endif
+      this->CommitEnd_ = chunk + this->ChunkSize_;
+      return true;
+   }
+
+public:
+   MemBlockArena(const MemBlockArenaArgs& args, int nodeId)
+      : ChunkSize_{((args.ChunkMB_ ? args.ChunkMB_ : 64u) * size_t{1024 * 1024} + kHugePageSize - 1) / kHugePageSize * kHugePageSize}
+      , IsHugePage_{args.IsHugePage_}
+      , NodeId_{nodeId} {
+      // 多保留 kHugePageSize, 用來將 Base_ 對齊 2MB.
+      void* mem = mmap(nullptr, kReserveSize + kHugePageSize, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (mem == MAP_FAILED)
+         return;
+      uintptr_t base = (reinterpret_cast<uintptr_t>(mem) + kHugePageSize - 1) & ~static_cast<uintptr_t>(kHugePageSize - 1);
+      this->Curr_ = this->CommitEnd_ = this->Base_ = reinterpret_cast<byte*>(base);
+   }
+   bool IsReady() const {
+      return this->Base_ != nullptr;
+   }
+   bool Contains(const void* p) const {
+      return this->Base_ <= p && p < this->Base_ + kReserveSize;
+   }
+   /// \retval nullptr 已無法再取得記憶體, 應改用 malloc().
+   void* Alloc(size_t sz) {
+      std::lock_guard<std::mutex> lk{this->Mutex_};
+      if (this->Curr_ + sz > this->CommitEnd_) {
+         // 剩餘不足的部分直接捨棄, 因為各 level 的大小不同, 無法拼湊.
+         this->Curr_ = this->CommitEnd_;
+         if (!this->CommitChunk())
+            return nullptr;
+      }
+      void* retval = this->Curr_;
+      this->Curr_ += sz;
+      return retval;
+   }
+   /// 釋放 mem 的實體記憶體, 但保留開頭的 FreeMemNode 所在的 page, 位址仍然有效.
+   /// 區塊不一定對齊 page, 所以只處理區塊內完整的 pages; 若為 MAP_HUGETLB 則會失敗(EINVAL), 直接忽略.
+   static void TrimMem(void* mem, size_t sz) {
+      static const uintptr_t kPageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+      const uintptr_t beg = (reinterpret_cast<uintptr_t>(mem) + sizeof(FreeMemNode) + kPageSize - 1) & ~(kPageSize - 1);
+      const uintptr_t end = (reinterpret_cast<uintptr_t>(mem) + sz) & ~(kPageSize - 1);
+      if (beg < end)
+         madvise(reinterpret_cast<void*>(beg), end - beg, MADV_DONTNEED);
+   }
+};
+/// 每個 node 一個 arena, 建立後就不會釋放(直到程式結束), 所以可以安全的用來判斷記憶體來源.
+static std::atomic<MemBlockArena*> MemBlockArenas_[kMemBlockMaxNumaNodes];
+
+static unsigned FindMemBlockArenaNode(const void* p) {
+   for (unsigned L = 0; L < kMemBlockMaxNumaNodes; ++L) {
+      if (const MemBlockArena* arena = MemBlockArenas_[L].load(std::memory_order_acquire))
+         if (arena->Contains(p))
+            return L;
+   }
+   return kMemBlockMaxNumaNodes;
+}
+static MemBlockArena* MakeMemBlockArena(unsigned nodeId) {
+   MemBlockArena* arena = new MemBlockArena(MemBlockArenaArgs_, MemBlockArenaArgs_.IsPerNumaNode_ ? static_cast<int>(nodeId) : -1);
+   if (!arena->IsReady()) {
+      delete arena;
+      return nullptr;
+   }
+   MemBlockArenas_[nodeId].store(arena, std::memory_order_release);
+   MemBlockArenaEnabled_.store(true, std::memory_order_release);
+   return arena;
+}
+fon9_API bool IsInMemBlockArena(const void* p) {
+   return FindMemBlockArenaNode(p) < kMemBlockMaxNumaNodes;
+}
+#else
+class MemBlockArena {
+public:
+   void* Alloc(size_t) {
+      return nullptr;
+   }
+   static void TrimMem(void*, size_t) {
+   }
+};
+static inline unsigned GetCurrentNumaNode() {
+   return 0;
+}
+static inline unsigned FindMemBlockArenaNode(const void*) {
+   return kMemBlockMaxNumaNodes;
+}
+static inline MemBlockArena* MakeMemBlockArena(unsigned) {
+   return nullptr;
+}
+fon9_API bool IsInMemBlockArena(const void*) {
+   return false;
+}
+#endif
+fon9_API std::atomic<bool> MemBlockArenaEnabled_{false};
+
 // kMemBlockCenter_CheckInterval: MemBlock 整理間隔。
 // 不用太頻繁，因為若瞬間有大用量，則應暫時保留較多的緩衝。若用量不大，也沒必要頻繁的整理。
 static const TimeInterval  kMemBlockCenter_CheckInterval{TimeInterval_Millisecond(2000)};
 
-MemBlockCenter::MemBlockCenter() : Timer_{GetDefaultTimerThread()} {
+MemBlockCenter::MemBlockCenter(unsigned nodeId, MemBlockArena* arena)
+   : Timer_{GetDefaultTimerThread()}
+   , NodeId_{nodeId}
+   , Arena_{arena} {
+   for (unsigned lvidx = 0; lvidx < kMemBlockLevelCount; ++lvidx)
+      CenterLevel::Locker{this->Levels_[lvidx]}->ReservedCount_ = MemBlockLevelReservedCount_[lvidx];
    Timer_.RunAfter(TimeInterval{});
 }
 MemBlockCenter::~MemBlockCenter() {
@@ -36,8 +204,8 @@ byte* MemBlockCenter::Alloc(unsigned lvidx, TCacheLevelPool& lv) {
       ++lvCenter->RequiredCount_;
    }
    CenterLevelNode* cnode = lvCenter->Reserved_.pop_front();
-   if (cnode == nullptr)
-      cnode = lvCenter->Recycle_.pop_front();
+   if (cnode == nullptr && (cnode = lvCenter->Recycle_.pop_front()) == nullptr)
+      cnode = lvCenter->Trimmed_.pop_front();
    lvCenter.unlock();
    if (cnode == nullptr)
       return nullptr;
@@ -52,10 +220,37 @@ void MemBlockCenter::FreeFull(unsigned lvidx, FreeMemList&& fmlist) {
       lvCenter->Reserved_.push_front(cnode);
    }
 }
+void MemBlockCenter::FreeRemote(unsigned lvidx, FreeMemList&& fmlist) {
+   if (CenterLevelNode* cnode = CenterLevelNode::FromFreeMemList(std::move(fmlist))) {
+      CenterLevel::Locker lvCenter{this->Levels_[lvidx]};
+      lvCenter->Recycle_.push_front(cnode);
+   }
+}
+void MemBlockCenter::Attach(TCacheLevelPools& levels) {
+   TCaches::Locker tcaches{this->TCaches_};
+   tcaches->Live_.push_back(&levels);
+}
 void MemBlockCenter::Recycle(TCacheLevelPools& levels) {
+   {
+      TCaches::Locker tcaches{this->TCaches_};
+      auto ifind = std::find(tcaches->Live_.begin(), tcaches->Live_.end(), &levels);
+      if (ifind != tcaches->Live_.end())
+         tcaches->Live_.erase(ifind);
+      for (unsigned lvidx = 0; lvidx < kMemBlockLevelCount; ++lvidx) {
+         TCacheLevelPool& lv = levels[lvidx];
+         tcaches->Retired_[lvidx].Add(lv);
+         lv.HitCount_.store(0, std::memory_order_relaxed);
+         lv.MissCount_.store(0, std::memory_order_relaxed);
+         lv.RefillCount_.store(0, std::memory_order_relaxed);
+         lv.EmptyCount_.store(0, std::memory_order_relaxed);
+      }
+   }
    unsigned lvidx = 0;
    for (TCacheLevelPool& lv : levels) {
-      if (IsEnumContains(lv.Flags_, TCacheLevelFlag::Registered)) {
+      // 沒有 Registered 的 level(只有歸還, 沒有分配) 也可能保留記憶體, 一併交給 center,
+      // 否則在 TCache 結束時會直接 free(), 若來自 MemBlockArena 則無法歸還.
+      const bool isRegistered = IsEnumContains(lv.Flags_, TCacheLevelFlag::Registered);
+      if (isRegistered || !lv.FreeMemCurr_.empty() || !lv.FreeMemNext_.empty()) {
          lv.Flags_ -= TCacheLevelFlag::Registered;
          CenterLevelNode*    cnode1 = CenterLevelNode::FromFreeMemList(std::move(lv.FreeMemCurr_));
          CenterLevelNode*    cnode2 = CenterLevelNode::FromFreeMemList(std::move(lv.FreeMemNext_));
@@ -64,13 +259,44 @@ void MemBlockCenter::Recycle(TCacheLevelPools& levels) {
             lvCenter->Recycle_.push_front(cnode1);
          if (cnode2)
             lvCenter->Recycle_.push_front(cnode2);
-         --lvCenter->RequiredCount_;
+         if (isRegistered)
+            --lvCenter->RequiredCount_;
          if (cnode1 || cnode2)
             this->InitLevel(lvidx, lvCenter);
       }
       ++lvidx;
    }
 }
+void MemBlockCenter::AppendStats(MemBlockLevelStats& stats) {
+   const size_t ibeg = stats.size();
+   stats.resize(ibeg + kMemBlockLevelCount);
+   for (unsigned lvidx = 0; lvidx < kMemBlockLevelCount; ++lvidx) {
+      MemBlockLevelStat& st = stats[ibeg + lvidx];
+      st.NodeId_ = this->NodeId_;
+      st.LevelIndex_ = lvidx;
+      st.BlockSize_ = MemBlockLevelSize_[lvidx];
+      st.IsArena_ = (this->Arena_ != nullptr);
+      CenterLevel::Locker lvCenter{this->Levels_[lvidx]};
+      st.ReservedListCount_ = lvCenter->Reserved_.size();
+      st.TrimmedListCount_ = lvCenter->Trimmed_.size();
+      st.ThreadCount_ = lvCenter->RequiredCount_;
+   }
+   TCaches::Locker tcaches{this->TCaches_};
+   for (unsigned lvidx = 0; lvidx < kMemBlockLevelCount; ++lvidx) {
+      MemBlockLevelCounters& dst = stats[ibeg + lvidx];
+      dst = tcaches->Retired_[lvidx];
+      for (TCacheLevelPools* levels : tcaches->Live_)
+         dst.Add((*levels)[lvidx]);
+   }
+}
+intrusive_ptr<MemBlockCenter> MemBlockCenter::GetNodeCenter(unsigned nodeId) {
+   nodeId %= kMemBlockMaxNumaNodes;
+   NodeCenters::Locker centers{this->NodeCenters_};
+   auto& center = (*centers)[nodeId];
+   if (!center)
+      center.reset(new MemBlockCenter{nodeId, MakeMemBlockArena(nodeId)});
+   return center;
+}
 
 static bool FreeMemListMerge(FreeMemList& dst, FreeMemList& src, size_t maxNodeCount) {
    while (dst.size() < maxNodeCount) {
@@ -88,9 +314,16 @@ void MemBlockCenter::InitLevel(unsigned lvidx, CenterLevel::Locker& lvCenter) {
    if (curr > count) {
       CenterLevelList r2 = lvCenter->Reserved_.pop_front(curr - count);
       lvCenter.unlock();
-      // auto free: r2, recycle;
+      if (this->Arena_) {
+         // arena 的記憶體無法 free(), 所以釋放實體記憶體後保留在 Trimmed_.
+         r2.push_front(std::move(recycle));
+         this->TrimArenaLists(lvidx, std::move(r2));
+      }
+      // else auto free: r2, recycle;
       return;
    }
+   if (this->Arena_ && recycle.empty() && curr < count)
+      recycle = std::move(lvCenter->Trimmed_);
    lvCenter.unlock();
 
    const size_t maxNodeCount = MemBlockLevelMaxNodeCount_[lvidx];
@@ -99,7 +332,7 @@ void MemBlockCenter::InitLevel(unsigned lvidx, CenterLevel::Locker& lvCenter) {
       FreeMemList fmlist2{CenterLevelNode::ToFreeMemList(recycle.pop_front())};
       if (!FreeMemListMerge(fmlist, fmlist2, maxNodeCount)) {
          do {
-            fmlist.push_front(InplaceNew<FreeMemNode>(malloc(MemBlockLevelSize_[lvidx])));
+            fmlist.push_front(InplaceNew<FreeMemNode>(this->AllocLevelMem(lvidx)));
          } while (fmlist.size() < maxNodeCount);
       }
       CenterLevelNode* cnode = CenterLevelNode::FromFreeMemList(std::move(fmlist));
@@ -108,10 +341,48 @@ void MemBlockCenter::InitLevel(unsigned lvidx, CenterLevel::Locker& lvCenter) {
       lvCenter->Reserved_.push_front(cnode);
       curr = lvCenter->Reserved_.size();
       count = (lvCenter->ReservedCount_ + lvCenter->RequiredCount_);
-      if (recycle.empty())
+      if (recycle.empty()) {
          recycle = std::move(lvCenter->Recycle_);
+         if (this->Arena_ && recycle.empty())
+            recycle = std::move(lvCenter->Trimmed_);
+      }
       lvCenter.unlock();
    }
+   if (this->Arena_) {
+      // 補足保留數量之後, 剩餘的 arena 記憶體不可 free(), 放回 Trimmed_.
+      if (CenterLevelNode* cnode = CenterLevelNode::FromFreeMemList(std::move(fmlist)))
+         recycle.push_front(cnode);
+      if (!recycle.empty())
+         this->TrimArenaLists(lvidx, std::move(recycle));
+   }
+}
+void MemBlockCenter::TrimArenaLists(unsigned lvidx, CenterLevelList&& lists) {
+   const MemBlockSize   blksz = MemBlockLevelSize_[lvidx];
+   CenterLevelList      trimmed;
+   while (CenterLevelNode* cnode = lists.pop_front()) {
+      FreeMemList fmlist{CenterLevelNode::ToFreeMemList(cnode)};
+      FreeMemList fmdst;
+      while (FreeMemNode* mnode = fmlist.pop_front()) {
+         // arena 用盡時, 會改用 malloc() 分配, 這類的記憶體直接 free().
+         if (!IsInMemBlockArena(mnode))
+            ::free(mnode);
+         else {
+            MemBlockArena::TrimMem(mnode, blksz);
+            fmdst.push_front(mnode);
+         }
+      }
+      if ((cnode = CenterLevelNode::FromFreeMemList(std::move(fmdst))) != nullptr)
+         trimmed.push_front(cnode);
+   }
+   CenterLevel::Locker lvCenter{this->Levels_[lvidx]};
+   lvCenter->Trimmed_.push_front(std::move(trimmed));
+}
+void* MemBlockCenter::AllocLevelMem(unsigned lvidx) {
+   if (this->Arena_) {
+      if (void* mem = this->Arena_->Alloc(MemBlockLevelSize_[lvidx]))
+         return mem;
+   }
+   return malloc(MemBlockLevelSize_[lvidx]);
 }
 void MemBlockCenter::InitLevel(unsigned lvidx, const size_t* reserveFreeListCount) {
    CenterLevel::Locker lvCenter{this->Levels_[lvidx]};
@@ -128,11 +399,18 @@ void MemBlockCenter::EmitOnTimer(TimerEntry* timer, TimeStamp) {
 }
 
 using MemBlockCenterSP = intrusive_ptr<MemBlockCenter>;
-static MemBlockCenterSP GetMemBlockCenter() {
+static MemBlockCenterSP GetDefaultMemBlockCenter() {
    static MemBlockCenterSP MemBlockCenter{new impl::MemBlockCenter{}};
    // 如果系統正在結束 MemBlockCenter 已死, 此時應傳回 nullptr, 然後使用 MemBlock::UseMalloc();
    return MemBlockCenter->use_count() ? MemBlockCenter : nullptr;
 }
+/// 若有設定 MemBlockSetArenaArgs(), 則傳回目前 thread 所在 node 的 center.
+static MemBlockCenterSP GetMemBlockCenter() {
+   MemBlockCenterSP center = GetDefaultMemBlockCenter();
+   if (center && MemBlockConfigSeq_.load(std::memory_order_acquire) != 0)
+      return center->GetNodeCenter(MemBlockArenaArgs_.IsPerNumaNode_ ? GetCurrentNumaNode() : 0);
+   return center;
+}
 
 fon9_API bool MemBlockInit(MemBlockSize size, size_t reserveFreeListCount, size_t maxNodeCount) {
    unsigned lvidx = MemBlockSizeToIndex(size);
@@ -140,8 +418,43 @@ fon9_API bool MemBlockInit(MemBlockSize size, size_t reserveFreeListCount, size_
       return false;
    if (MemBlockLevelMaxNodeCount_[lvidx] < maxNodeCount)
       MemBlockLevelMaxNodeCount_[lvidx] = maxNodeCount;
-   GetMemBlockCenter()->InitLevel(lvidx, &reserveFreeListCount);
+   MemBlockLevelReservedCount_[lvidx] = reserveFreeListCount;
+   MemBlockCenterSP center = GetDefaultMemBlockCenter();
+   center->InitLevel(lvidx, &reserveFreeListCount);
+   center->ForEachNodeCenter([lvidx, reserveFreeListCount](MemBlockCenter& nodeCenter) {
+      nodeCenter.InitLevel(lvidx, &reserveFreeListCount);
+   });
+   return true;
+}
+fon9_API bool MemBlockSetArenaArgs(const MemBlockArenaArgs& args) {
+#if defined(__linux__)
+   if (sizeof(void*) < 8)
+      return false;
+   static std::atomic_flag isConfigured = ATOMIC_FLAG_INIT;
+   if (isConfigured.test_and_set())
+      return false;
+   MemBlockArenaArgs_ = args;
+   // default center 不再需要保留緩衝, 由定時整理釋放.
+   MemBlockCenterSP center = GetDefaultMemBlockCenter();
+   for (unsigned lvidx = 0; lvidx < kMemBlockLevelCount; ++lvidx) {
+      const size_t count = 0;
+      center->InitLevel(lvidx, &count);
+   }
+   MemBlockConfigSeq_.fetch_add(1, std::memory_order_release);
    return true;
+#else
+   (void)args;
+   return false;
+#endif
+}
+fon9_API void MemBlockGetStats(MemBlockLevelStats& stats) {
+   stats.clear();
+   if (MemBlockCenterSP center = GetDefaultMemBlockCenter()) {
+      center->AppendStats(stats);
+      center->ForEachNodeCenter([&stats](MemBlockCenter& nodeCenter) {
+         nodeCenter.AppendStats(stats);
+      });
+   }
 }
 } // namespace impl
 using namespace impl;
@@ -150,13 +463,60 @@ using namespace impl;
 
 class MemBlock::TCache {
    fon9_NON_COPY_NON_MOVE(TCache);
-   TCacheLevelPools        Levels_;
+   TCacheLevelPools  Levels_;
+   uint32_t          ConfigSeq_;
+   /// Center_ 是否為 per NUMA node 且使用 arena? 若是, 則 Free() 需要將其他 node 的記憶體送回.
+   bool              IsNumaArena_{false};
+   /// 其他 node 的記憶體, 累積到 MemBlockLevelMaxNodeCount_ 之後, 送回該 node 的 center.
+   using RemoteLevels = std::array<FreeMemList, kMemBlockLevelCount>;
+   using RemoteNodes = std::array<RemoteLevels, kMemBlockMaxNumaNodes>;
+   std::unique_ptr<RemoteNodes>  RemoteNodes_;
+
+   void OnCenterChanged() {
+      this->IsNumaArena_ = (MemBlockArenaArgs_.IsPerNumaNode_ && this->Center_->Arena_ != nullptr);
+      this->Center_->Attach(this->Levels_);
+   }
+   /// MemBlockSetArenaArgs() 之後, 轉移到新的 center.
+   void Rebind() {
+      this->ConfigSeq_ = MemBlockConfigSeq_.load(std::memory_order_acquire);
+      MemBlockCenterSP center = GetMemBlockCenter();
+      if (!center || center == this->Center_)
+         return;
+      this->Center_->Recycle(this->Levels_);
+      this->Center_ = std::move(center);
+      this->OnCenterChanged();
+   }
+   void FlushRemote(unsigned nodeId, unsigned lvidx, FreeMemList& fmlist) {
+      if (MemBlockCenterSP center = GetDefaultMemBlockCenter())
+         center->GetNodeCenter(nodeId)->FreeRemote(lvidx, std::move(fmlist));
+   }
+   void FreeRemote(unsigned nodeId, unsigned lvidx, void* ptr) {
+      if (!this->RemoteNodes_)
+         this->RemoteNodes_.reset(new RemoteNodes);
+      FreeMemList& fmlist = (*this->RemoteNodes_)[nodeId][lvidx];
+      fmlist.push_front(InplaceNew<FreeMemNode>(ptr));
+      if (fmlist.size() >= MemBlockLevelMaxNodeCount_[lvidx])
+         this->FlushRemote(nodeId, lvidx, fmlist);
+   }
+
 public:
-   const MemBlockCenterSP  Center_;
-   TCache() : Center_{GetMemBlockCenter()} {
+   MemBlockCenterSP  Center_;
+   TCache() : ConfigSeq_{MemBlockConfigSeq_.load(std::memory_order_acquire)}, Center_{GetMemBlockCenter()} {
+      if (this->Center_)
+         this->OnCenterChanged();
    }
    ~TCache() {
-      this->Center_->Recycle(this->Levels_);
+      if (this->RemoteNodes_) {
+         for (unsigned nodeId = 0; nodeId < kMemBlockMaxNumaNodes; ++nodeId) {
+            for (unsigned lvidx = 0; lvidx < kMemBlockLevelCount; ++lvidx) {
+               FreeMemList& fmlist = (*this->RemoteNodes_)[nodeId][lvidx];
+               if (!fmlist.empty())
+                  this->FlushRemote(nodeId, lvidx, fmlist);
+            }
+         }
+      }
+      if (this->Center_)
+         this->Center_->Recycle(this->Levels_);
    }
    static byte* UseMalloc(MemBlock& mblk, MemBlockSize sz) {
       if (fon9_UNLIKELY(mblk.MemPtr_))
@@ -181,9 +541,16 @@ public:
       if (lv.FreeMemCurr_.empty())
          lv.FreeMemCurr_ = std::move(lv.FreeMemNext_);
       byte* pmem = reinterpret_cast<byte*>(lv.FreeMemCurr_.pop_front());
-      if (fon9_UNLIKELY(pmem == nullptr)) {
-         if ((pmem = this->Center_->Alloc(lvidx, lv)) == nullptr) {
-            ++lv.EmptyCount_;
+      if (fon9_LIKELY(pmem != nullptr))
+         TCacheLevelPool::IncCounter(lv.HitCount_);
+      else {
+         TCacheLevelPool::IncCounter(lv.MissCount_);
+         if (fon9_UNLIKELY(this->ConfigSeq_ != MemBlockConfigSeq_.load(std::memory_order_relaxed)))
+            this->Rebind();
+         if ((pmem = this->Center_->Alloc(lvidx, lv)) != nullptr)
+            TCacheLevelPool::IncCounter(lv.RefillCount_);
+         else {
+            TCacheLevelPool::IncCounter(lv.EmptyCount_);
             if ((pmem = static_cast<byte*>(malloc(newsz))) == nullptr)
                return nullptr;
          }
@@ -200,6 +567,13 @@ public:
          return;
       }
       assert(sz == MemBlockLevelSize_[lvidx]);
+      if (fon9_UNLIKELY(this->IsNumaArena_)) {
+         const unsigned nodeId = FindMemBlockArenaNode(ptr);
+         if (nodeId < kMemBlockMaxNumaNodes && nodeId != this->Center_->NodeId_) {
+            this->FreeRemote(nodeId, lvidx, ptr);
+            return;
+         }
+      }
       // 重建 node = 初始值. 然後放入 list.
       FreeMemNode*      node = InplaceNew<FreeMemNode>(ptr);
       const size_t      maxNodeCount = MemBlockLevelMaxNodeCount_[lvidx];
@@ -238,8 +612,19 @@ void MemBlock::FreeBlock(void* mem, MemBlockSize sz) {
       auto* TCache_ = TlsTCache_.get();
       if (fon9_LIKELY(TCache_))
          TCache_->Free(mem, sz);
-      else
+      else if (fon9_LIKELY(!MemBlockArenaEnabled_.load(std::memory_order_relaxed)))
          free(mem);
+      else {
+         // thread 正在結束(TCache 已死), arena 的記憶體不可 free(), 直接送回所屬 node 的 center.
+         const unsigned nodeId = FindMemBlockArenaNode(mem);
+         if (nodeId >= kMemBlockMaxNumaNodes)
+            free(mem);
+         else if (MemBlockCenterSP center = GetDefaultMemBlockCenter()) {
+            FreeMemList fmlist;
+            fmlist.push_front(InplaceNew<FreeMemNode>(mem));
+            center->GetNodeCenter(nodeId)->FreeRemote(MemBlockSizeToIndex(sz), std::move(fmlist));
+         }
+      }
    }
 }
 
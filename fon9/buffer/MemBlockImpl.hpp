@@ -7,6 +7,8 @@
 #include "fon9/SpinMutex.hpp"
 #include "fon9/Timer.hpp"
 #include <array>
+#include <atomic>
+#include <vector>
 
 namespace fon9 {
 
@@ -30,7 +32,9 @@ inline unsigned MemBlockSizeToIndex(MemBlockSize sz) {
 }
 
 enum : unsigned {
-   kMemBlockLevelCount = 7
+   kMemBlockLevelCount = 7,
+   /// 超過此數量的 NUMA node, 使用 (node % kMemBlockMaxNumaNodes).
+   kMemBlockMaxNumaNodes = 8,
 };
 
 constexpr std::array<MemBlockSize, kMemBlockLevelCount> MemBlockLevelSize_{
@@ -46,11 +50,23 @@ constexpr std::array<MemBlockSize, kMemBlockLevelCount> MemBlockLevelSize_{
 //--------------------------------------------------------------------------//
 
 namespace impl {
+/// 是否曾經建立過 MemBlockArena? 一旦設定就不會清除.
+/// 用來讓 FreeNode() 在沒有使用 arena 時, 不用逐一檢查每個 arena 的位址範圍.
+extern fon9_API std::atomic<bool> MemBlockArenaEnabled_;
+/// 逐一檢查已建立的 MemBlockArena, p 是否在其中.
+fon9_API bool IsInMemBlockArena(const void* p);
+/// p 是否為 MemBlockArena 分配的記憶體? 若是, 則不可使用 free() 釋放.
+inline bool IsMemBlockArenaMem(const void* p) {
+   return MemBlockArenaEnabled_.load(std::memory_order_relaxed) && IsInMemBlockArena(p);
+}
+
 struct FreeMemNode : public SinglyLinkedListNode<FreeMemNode> {
    fon9_NON_COPY_NON_MOVE(FreeMemNode);
    FreeMemNode() = default;
    inline friend void FreeNode(FreeMemNode* mnode) {
-      ::free(mnode);
+      // MemBlockArena 的記憶體不會歸還給系統.
+      if (!IsMemBlockArenaMem(mnode))
+         ::free(mnode);
    }
 };
 using FreeMemList = SinglyLinkedList<FreeMemNode>;
@@ -68,11 +84,65 @@ struct TCacheLevelPool {
    TCacheLevelPool() = default;
    FreeMemList       FreeMemCurr_;
    FreeMemList       FreeMemNext_;
-   size_t            EmptyCount_{0};
    TCacheLevelFlag   Flags_{};
+
+   /// 統計資料只有擁有此 pool 的 thread 會異動, 其他 thread 僅讀取(MemBlockGetStats()),
+   /// 所以使用 load() + store(), 不需要 lock 指令.
+   using Counter = std::atomic<uint64_t>;
+   /// 直接從 thread cache 取得.
+   Counter  HitCount_{0};
+   /// thread cache 已空, 需要向 MemBlockCenter 要求.
+   Counter  MissCount_{0};
+   /// 從 MemBlockCenter 取得一個串列.
+   Counter  RefillCount_{0};
+   /// MemBlockCenter 也沒有可用的串列, 改用 malloc().
+   Counter  EmptyCount_{0};
+
+   static void IncCounter(Counter& c) {
+      c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   }
 };
 using TCacheLevelPools = std::array<TCacheLevelPool, kMemBlockLevelCount>;
 
+struct MemBlockLevelCounters {
+   uint64_t HitCount_{0};
+   uint64_t MissCount_{0};
+   uint64_t RefillCount_{0};
+   uint64_t EmptyCount_{0};
+   void Add(const TCacheLevelPool& lv) {
+      this->HitCount_ += lv.HitCount_.load(std::memory_order_relaxed);
+      this->MissCount_ += lv.MissCount_.load(std::memory_order_relaxed);
+      this->RefillCount_ += lv.RefillCount_.load(std::memory_order_relaxed);
+      this->EmptyCount_ += lv.EmptyCount_.load(std::memory_order_relaxed);
+   }
+};
+
+/// MemBlockGetStats() 的結果, 每個 MemBlockCenter 的每個 level 一筆.
+struct MemBlockLevelStat : public MemBlockLevelCounters {
+   /// NUMA node; 若沒有啟用 MemBlockArenaArgs::IsPerNumaNode_, 則為 0;
+   /// kMemBlockMaxNumaNodes 表示 default center(不分 node, 使用 malloc()).
+   unsigned       NodeId_;
+   unsigned       LevelIndex_;
+   MemBlockSize   BlockSize_;
+   /// 是否使用 MemBlockArena 分配.
+   bool           IsArena_;
+   /// MemBlockCenter 保留的串列數量.
+   uint64_t       ReservedListCount_;
+   /// 超過保留數量, 已釋放實體記憶體的 arena 串列數量.
+   uint64_t       TrimmedListCount_;
+   /// 正在使用此 level 的 thread 數量.
+   uint64_t       ThreadCount_;
+};
+using MemBlockLevelStats = std::vector<MemBlockLevelStat>;
+
+//--------------------------------------------------------------------------//
+
+/// 從預先保留的虛擬位址區間, 分段(ChunkSize)向系統要求記憶體, 切割給 MemBlockCenter 使用.
+/// - 可綁定 NUMA node(mbind), 可使用 huge page(MAP_HUGETLB 或 MADV_HUGEPAGE).
+/// - 分配出去的位址不會歸還給系統, 直到程式結束;
+///   但 MemBlockCenter 超過保留數量的區塊, 會釋放實體記憶體(MADV_DONTNEED), 位址保留等候再次使用.
+class MemBlockArena;
+
 //--------------------------------------------------------------------------//
 
 class MemBlockCenter : public intrusive_ref_counter<MemBlockCenter> {
@@ -127,6 +197,7 @@ class MemBlockCenter : public intrusive_ref_counter<MemBlockCenter> {
       CenterLevelImpl() = default;
       CenterLevelList   Reserved_; // 透過 FreeFull() 的歸還, 或 InitLevel() 建立的備用緩衝.
       CenterLevelList   Recycle_;  // 尚未整理的歸還, 每個 FreeMemList 數量不定.
+      CenterLevelList   Trimmed_;  // 使用 arena 時, 超過保留數量的串列: 已釋放實體記憶體, 在 Reserved_, Recycle_ 用完後才使用.
       size_t            ReservedCount_{4}; // 預設 or 透過 MemBlockInit() 設定的最少串列保留數量.
       size_t            RequiredCount_{0}; // 每個 thread 會要求增加一個保留數量.
    };
@@ -135,22 +206,79 @@ class MemBlockCenter : public intrusive_ref_counter<MemBlockCenter> {
    using CenterLevelArray = std::array<CenterLevel, kMemBlockLevelCount>;
    CenterLevelArray  Levels_;
 
+   struct TCachesImpl {
+      std::vector<TCacheLevelPools*>   Live_;
+      /// 已結束(或轉移到其他 center)的 thread 統計.
+      std::array<MemBlockLevelCounters, kMemBlockLevelCount> Retired_;
+   };
+   using TCaches = MustLock<TCachesImpl>;
+   TCaches  TCaches_;
+
+   /// 只有 default center(不使用 arena 的全域 center) 使用: 各 NUMA node 的 center.
+   using NodeCenters = MustLock<std::array<intrusive_ptr<MemBlockCenter>, kMemBlockMaxNumaNodes>>;
+   NodeCenters NodeCenters_;
+
    static void EmitOnTimer(TimerEntry* timer, TimeStamp now);
    DataMemberEmitOnTimer<&MemBlockCenter::EmitOnTimer> Timer_;
 
    void InitLevel(unsigned lvidx, CenterLevel::Locker& lvCenter);
+   void* AllocLevelMem(unsigned lvidx);
+   /// 釋放 lists 的實體記憶體, 然後放入 Trimmed_(不是來自 arena 的則直接 free()); 僅在使用 arena 時呼叫, 呼叫時不可鎖定 Levels_[lvidx].
+   void TrimArenaLists(unsigned lvidx, CenterLevelList&& lists);
 public:
-   MemBlockCenter();
+   /// kMemBlockMaxNumaNodes 表示 default center: 不分 node, 使用 malloc().
+   const unsigned       NodeId_;
+   /// nullptr 表示使用 malloc().
+   MemBlockArena* const Arena_;
+
+   MemBlockCenter(unsigned nodeId = kMemBlockMaxNumaNodes, MemBlockArena* arena = nullptr);
    ~MemBlockCenter();
 
    byte* Alloc(unsigned lvidx, TCacheLevelPool& lv);
    void FreeFull(unsigned lvidx, FreeMemList&& fmlist);
+   /// 其他 node 的 thread 歸還的記憶體, 放入 Recycle_ 等候整理.
+   void FreeRemote(unsigned lvidx, FreeMemList&& fmlist);
+   /// TCache 建立時(或轉移到 this 時)呼叫, 用來統計.
+   void Attach(TCacheLevelPools& levels);
+   /// TCache 結束時(或轉移到其他 center 時)呼叫, 歸還 levels 保留的記憶體, 並累計統計資料.
    void Recycle(TCacheLevelPools& levels);
    void InitLevel(unsigned lvidx, const size_t* reserveFreeListCount);
+   void AppendStats(MemBlockLevelStats& stats);
+
+   /// 由 default center 呼叫, 取得(若不存在則建立) nodeId 的 center.
+   intrusive_ptr<MemBlockCenter> GetNodeCenter(unsigned nodeId);
+   /// 由 default center 呼叫, 取得已建立的 node centers.
+   template <class FnCenter>
+   void ForEachNodeCenter(FnCenter&& fn) {
+      NodeCenters::Locker centers{this->NodeCenters_};
+      for (auto& c : *centers) {
+         if (c)
+            fn(*c);
+      }
+   }
 };
 fon9_WARN_POP;
 
 fon9_API bool MemBlockInit(MemBlockSize size, size_t reserveFreeListCount, size_t maxNodeCount);
+
+struct MemBlockArenaArgs {
+   /// 依 NUMA node 建立各自的 MemBlockCenter(及 MemBlockArena, 使用 mbind() 綁定該 node).
+   /// thread 在建立 TCache 時, 或設定改變後第一次向 center 要求時, 依當時所在的 node 選擇 center.
+   /// 在其他 node 歸還的記憶體, 會送回原本的 node, 不會在不同 node 之間交錯使用.
+   bool     IsPerNumaNode_{false};
+   /// 使用 2MB huge page: 優先使用 MAP_HUGETLB, 若失敗(例: 沒有設定 vm.nr_hugepages), 則使用 madvise(MADV_HUGEPAGE).
+   bool     IsHugePage_{false};
+   char     Padding___[2];
+   /// 每次向系統要求的記憶體量(MB), 會調整為 2MB 的倍數; 0 = 使用預設值 64MB.
+   uint32_t ChunkMB_{0};
+};
+/// 設定 MemBlockCenter 改用 MemBlockArena 分配記憶體, 只能設定一次, 應在程式啟動後儘早設定.
+/// - 已建立的 thread cache, 會在下次向 center 要求時, 轉移到新的 center.
+/// - 目前僅支援 64 位元的 Linux.
+/// \retval false 不支援, 或已經設定過.
+fon9_API bool MemBlockSetArenaArgs(const MemBlockArenaArgs& args);
+/// 取得全部 MemBlockCenter 的統計.
+fon9_API void MemBlockGetStats(MemBlockLevelStats& stats);
 } // namespace impl
 } // namespace fon9
 #endif//__fon9_buffer_MemBlockImpl_hpp__
@@ -126,6 +126,87 @@ fon9_WARN_POP;
 
 //--------------------------------------------------------------------------//
 
+void PrintMemBlockStats(const fon9::impl::MemBlockLevelStats& stats) {
+   for (const fon9::impl::MemBlockLevelStat& st : stats) {
+      std::cout << "node=" << st.NodeId_
+         << "|size=" << std::setw(5) << st.BlockSize_
+         << "|arena=" << st.IsArena_
+         << "|hits=" << st.HitCount_
+         << "|misses=" << st.MissCount_
+         << "|refills=" << st.RefillCount_
+         << "|empty=" << st.EmptyCount_
+         << "|reserved=" << st.ReservedListCount_
+         << "|trimmed=" << st.TrimmedListCount_
+         << "|threads=" << st.ThreadCount_
+         << std::endl;
+   }
+}
+/// 分配及釋放 256B 之後, 檢查統計資料有增加.
+void TestMemBlockStats(bool isArena) {
+   std::cout << "--- MemBlockGetStats(): " << (isArena ? "Arena" : "Default") << " ---\n";
+   const unsigned lvidx = fon9::MemBlockSizeToIndex(256);
+   auto getHits = [lvidx, isArena]() {
+      fon9::impl::MemBlockLevelStats stats;
+      fon9::impl::MemBlockGetStats(stats);
+      uint64_t hits = 0;
+      for (const fon9::impl::MemBlockLevelStat& st : stats) {
+         if (st.LevelIndex_ == lvidx && st.IsArena_ == isArena)
+            hits += st.HitCount_;
+      }
+      return hits;
+   };
+   const uint64_t hitsBefore = getHits();
+   {
+      std::vector<fon9::MemBlock> blks(100);
+      for (fon9::MemBlock& blk : blks)
+         blk.Alloc(256);
+      for (fon9::MemBlock& blk : blks)
+         blk.Free();
+      for (fon9::MemBlock& blk : blks)
+         blk.Alloc(256);
+   }
+   const uint64_t hitsAfter = getHits();
+   fon9::impl::MemBlockLevelStats stats;
+   fon9::impl::MemBlockGetStats(stats);
+   PrintMemBlockStats(stats);
+   if (hitsAfter <= hitsBefore) {
+      std::cout << "[ERROR] HitCount not increased: before=" << hitsBefore << "|after=" << hitsAfter << std::endl;
+      abort();
+   }
+   std::cout << "[OK   ] HitCount: before=" << hitsBefore << "|after=" << hitsAfter << std::endl;
+}
+
+/// arena: 預留大量的 64K, 在另一個 thread 分配及釋放, 該 thread 結束後, 降低保留數量,
+/// 超過保留數量的串列應移到 Trimmed.
+void TestMemBlockArenaTrim() {
+   std::cout << "--- MemBlock Arena trim ---\n";
+   const unsigned lvidx = fon9::MemBlockSizeToIndex(64 * 1024);
+   auto getTrimmed = [lvidx]() {
+      fon9::impl::MemBlockLevelStats stats;
+      fon9::impl::MemBlockGetStats(stats);
+      uint64_t trimmed = 0;
+      for (const fon9::impl::MemBlockLevelStat& st : stats) {
+         if (st.LevelIndex_ == lvidx && st.IsArena_)
+            trimmed += st.TrimmedListCount_;
+      }
+      return trimmed;
+   };
+   fon9::impl::MemBlockInit(64 * 1024, 40, 32);
+   std::thread thr{[]() {
+      std::vector<fon9::MemBlock> blks(1000);
+      for (fon9::MemBlock& blk : blks)
+         blk.Alloc(64 * 1024);
+   }};
+   thr.join();
+   fon9::impl::MemBlockInit(64 * 1024, 4, 32);
+   const uint64_t trimmed = getTrimmed();
+   if (trimmed == 0) {
+      std::cout << "[ERROR] TrimmedListCount not increased." << std::endl;
+      abort();
+   }
+   std::cout << "[OK   ] TrimmedListCount=" << trimmed << std::endl;
+}
+
 int main() {
 #if defined(_MSC_VER) && defined(_DEBUG)
    _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
@@ -185,4 +266,22 @@ int main() {
    std::cout << "--- ThrA:Alloc => ThrB:Free ---\n";
    TestMemThread<fon9::MemBlock>(kTimes, "MemBlock.Thread:");
    TestMemThread<MemAuto>       (kTimes, "malloc.Thread:  ");
+
+   utinfo.PrintSplitter();
+   TestMemBlockStats(false);
+#ifdef __linux__
+   fon9::impl::MemBlockArenaArgs arenaArgs;
+   arenaArgs.IsPerNumaNode_ = true;
+   arenaArgs.IsHugePage_ = true;
+   arenaArgs.ChunkMB_ = 2;
+   if (!fon9::impl::MemBlockSetArenaArgs(arenaArgs)) {
+      std::cout << "[ERROR] MemBlockSetArenaArgs()" << std::endl;
+      abort();
+   }
+   std::cout << "--- (alloc + free)*times: Arena ---\n";
+   TestMemAlloc<fon9::MemBlock, 256>(kTimes, "MemBlock(256)   ");
+   TestMemBasket<fon9::MemBlock, 256>(kTimes, "MemBlock(256)   ");
+   TestMemBlockStats(true);
+   TestMemBlockArenaTrim();
+#endif
 }
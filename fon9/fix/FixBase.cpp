@@ -1,7 +1,31 @@
 ﻿// \file fon9/fix/FixBase.cpp
 // \author fonwinz@gmail.com
 #include "fon9/fix/FixBase.hpp"
+#include "fon9/CpuFeatures.hpp"
+
+#if fon9_HAS_SSE2
+fon9_BEFORE_INCLUDE_STD;
+#include <immintrin.h>
+fon9_AFTER_INCLUDE_STD;
+#endif
 
 namespace fon9 { namespace fix {
 
+fon9_API byte CalcFixByteSum(const void* p, size_t sz) {
+   const byte* pbeg = static_cast<const byte*>(p);
+   uint32_t    sum = 0;
+#if fon9_HAS_SSE2
+   // _mm_sad_epu8(v, 0): 每 8 bytes 加總成一個 uint64.
+   const __m128i zero = _mm_setzero_si128();
+   __m128i acc = zero;
+   for (; sz >= 16; sz -= 16, pbeg += 16)
+      acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pbeg)), zero));
+   sum = static_cast<uint32_t>(_mm_cvtsi128_si32(acc))
+       + static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc)));
+#endif
+   for (; sz > 0; --sz)
+      sum += *pbeg++;
+   return static_cast<byte>(sum);
+}
+
 } } // namespaces
@@ -2,6 +2,7 @@
 /// \author fonwinz@gmail.com
 #ifndef __fon9_fix_FixBase_hpp__
 #define __fon9_fix_FixBase_hpp__
+#include "fon9/sys/Config.hpp"
 #include "fon9/intrusive_ref_counter.hpp"
 
 namespace fon9 { namespace fix {
@@ -95,5 +96,10 @@ enum : uint32_t {
    kFixMaxBodyLength = 1024 * 1024,
 };
 
+/// \ingroup fix
+/// 計算 [p..p+sz) 每個 byte 的加總(mod 256), 用於 FIX CheckSum.
+/// 若支援 SSE2, 則每次加總 16 bytes.
+fon9_API byte CalcFixByteSum(const void* p, size_t sz);
+
 } } // namespaces
 #endif//__fon9_fix_FixBase_hpp__
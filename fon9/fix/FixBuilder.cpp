@@ -15,28 +15,73 @@ void FixBuilder::PutUtcNow() {
       this->PutUtcTime(UtcNow());
 }
 
-BufferList FixBuilder::Final(const StrView& beginHeader) {
+void FixBuilder::AccumulateCheckSum() {
+   const char* const pcur = this->Buffer_.GetCurrent();
+   const char* const psummed = this->SummedPos_;
+   if (pcur == psummed)
+      return;
+   this->SummedPos_ = pcur;
+   // 新的資料在前方: 從 cfront() 往後累計, 直到 psummed 所在的節點.
+   byte sum = this->Sum_;
+   for (const BufferNode* node = this->Buffer_.cfront(); node; node = node->GetNext()) {
+      const char* pbeg = reinterpret_cast<const char*>(node->GetDataBegin());
+      const char* pend = reinterpret_cast<const char*>(node->GetDataEnd());
+      if (pbeg <= psummed && psummed <= pend) {
+         sum = static_cast<byte>(sum + CalcFixByteSum(pbeg, static_cast<size_t>(psummed - pbeg)));
+         break;
+      }
+      sum = static_cast<byte>(sum + CalcFixByteSum(pbeg, static_cast<size_t>(pend - pbeg)));
+   }
+   this->Sum_ = sum;
+}
+BufferList FixBuilder::Final(const StrView& beginHeader, byte beginHeaderSum) {
    assert(this->CheckSumPos_ != nullptr);
    const size_t bodyLength = CalcDataSize(this->Buffer_.cfront()) - kFixTailWidth;
-   RevPrint(this->Buffer_, beginHeader, bodyLength);
+   RevPrint(this->Buffer_, bodyLength);
+   this->PutSummed(beginHeader, beginHeaderSum);
 
    char* const psum = this->CheckSumPos_;
    this->CheckSumPos_ = nullptr;
    this->TimeFIXMS_ = nullptr;
+   this->SummedPos_ = nullptr;
+   // 尾端 "|10=" 的 '|' 也要算在 CheckSum 裡面.
+   this->PutCheckSumField(psum, static_cast<byte>(this->Sum_ + f9fix_kCHAR_SPL));
+   return this->Buffer_.MoveOut();
+}
 
-   const BufferNode* cfront = this->Buffer_.cfront();
-   byte  cks = f9fix_kCHAR_SPL;
-   while (cfront) {
-      const byte* pend = cfront->GetDataEnd();
-      const byte* pbeg = cfront->GetDataBegin();
-      if ((cfront = cfront->GetNext()) == nullptr)
-         pend = reinterpret_cast<byte*>(psum);
-      for (; pbeg != pend; ++pbeg)
-         cks = static_cast<byte>(cks + *pbeg);
-   }
+//--------------------------------------------------------------------------//
+static const char kHdrSendingTime[] = f9fix_SPLTAGEQ(SendingTime);
+static constexpr size_t kHdrSendingTimeWidth = sizeof(kHdrSendingTime) - 1;
 
-   this->PutCheckSumField(psum, cks);
-   return this->Buffer_.MoveOut();
+FixMsgTemplate::FixMsgTemplate(const StrView& beginHeader, const StrView& compIDsHeader)
+   : BeginHeader_{beginHeader}
+   , BeginHeaderSum_{CalcFixByteSum(beginHeader.begin(), beginHeader.size())}
+   , HdrSendingTimeSum_{CalcFixByteSum(kHdrSendingTime, kHdrSendingTimeWidth)}
+   , CompIDsHeaderSum_{CalcFixByteSum(compIDsHeader.begin(), compIDsHeader.size())}
+   , SendingTimeSum_{0} {
+   this->SendingTimeCompIDs_.append(kHdrSendingTime, kHdrSendingTimeWidth);
+   this->SendingTimeCompIDs_.append(kDateTimeStrWidth_FIXMS, ' ');
+   this->SendingTimeCompIDs_.append(compIDsHeader);
+}
+void FixMsgTemplate::UpdateSendingTime(TimeStamp now) {
+   const TimeStamp::OrigType ms = now.GetOrigValue() / (TimeStamp::Divisor / 1000);
+   if (this->SendingTimeMS_ == ms)
+      return;
+   this->SendingTimeMS_ = ms;
+   char* const ptm = this->SendingTimeCompIDs_.begin() + kHdrSendingTimeWidth;
+   ToStrRev_FIXMS(ptm + kDateTimeStrWidth_FIXMS, now);
+   this->SendingTimeSum_ = static_cast<byte>(this->HdrSendingTimeSum_
+                                             + CalcFixByteSum(ptm, kDateTimeStrWidth_FIXMS)
+                                             + this->CompIDsHeaderSum_);
+}
+void FixMsgTemplate::PutSendingTimeCompIDs(FixBuilder& fixb) {
+   const TimeStamp now = (fixb.IsUtcTimePut() ? fixb.Time_ : UtcNow());
+   this->UpdateSendingTime(now);
+   fixb.PutSummed(ToStrView(this->SendingTimeCompIDs_), this->SendingTimeSum_);
+   if (!fixb.IsUtcTimePut()) {
+      fixb.TimeFIXMS_ = fixb.Buffer_.GetCurrent() + kHdrSendingTimeWidth;
+      fixb.Time_ = now;
+   }
 }
 
 } } // namespaces
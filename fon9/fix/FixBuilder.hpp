@@ -5,6 +5,7 @@
 #include "fon9/fix/FixBase.hpp"
 #include "fon9/RevPrint.hpp"
 #include "fon9/TimeStamp.hpp"
+#include "fon9/CharVector.hpp"
 
 namespace fon9 { namespace fix {
 
@@ -31,15 +32,22 @@ namespace fon9 { namespace fix {
 /// \endcode
 class fon9_API FixBuilder {
    fon9_NON_COPYABLE(FixBuilder);
+   friend class FixMsgTemplate;
    RevBufferList  Buffer_{512};
    char*          CheckSumPos_;
    const char*    TimeFIXMS_;
    TimeStamp      Time_;
+   /// [SummedPos_..CheckSumPos_) 的 byte 加總已累計在 Sum_;
+   const char*    SummedPos_;
+   byte           Sum_;
+   char           Padding___[7];
 
    void Start() {
       this->TimeFIXMS_ = nullptr;
       this->CheckSumPos_ = this->Buffer_.AllocPrefix(kFixTailWidth);
       this->Buffer_.SetPrefixUsed(this->CheckSumPos_ -= kFixTailWidth);
+      this->SummedPos_ = this->CheckSumPos_;
+      this->Sum_ = 0;
    }
 public:
    FixBuilder() {
@@ -49,6 +57,7 @@ public:
       if (isManualStart) {
          this->CheckSumPos_ = nullptr;
          this->TimeFIXMS_ = nullptr;
+         this->SummedPos_ = nullptr;
       }
       else
          this->Start();
@@ -92,7 +101,24 @@ public:
    /// 訊息建立完畢, 最終填入 BeginString, BodyLength, 計算 CheckSum.
    /// \param beginHeader "8=FIX.4.x|9=" 這裡不檢查 header 是否正確!
    /// \return 傳回建立好的 FIX Message: 包含 beginHeader + body + checksum.
-   BufferList Final(const StrView& beginHeader);
+   BufferList Final(const StrView& beginHeader) {
+      return this->Final(beginHeader, CalcFixByteSum(beginHeader.begin(), beginHeader.size()));
+   }
+   /// 同 Final(beginHeader); 但 beginHeader 的 CheckSum(byte 加總) 已事先算好.
+   BufferList Final(const StrView& beginHeader, byte beginHeaderSum);
+
+   /// 累計「上次累計之後, 新填入的資料」的 CheckSum.
+   /// - 可在 RevPrint() 之後呼叫, 趁資料還在 cache 裡面時累計.
+   /// - Final() 只需要再累計尚未累計的部分.
+   void AccumulateCheckSum();
+   /// 填入 str, 其 CheckSum(byte 加總) 已事先算好, 不用再讀一次.
+   /// 例: 同一個 session 固定不變的 CompIDs.
+   void PutSummed(const StrView& str, byte sum) {
+      this->AccumulateCheckSum();
+      RevPutMem(this->Buffer_, str.begin(), str.size());
+      this->SummedPos_ = this->Buffer_.GetCurrent();
+      this->Sum_ = static_cast<byte>(this->Sum_ + sum);
+   }
 
    /// 填入 CheckSum: "|10=xxx|"  xxx=CheckSum(cks).
    static void PutCheckSumField(char psum[kFixTailWidth], byte cks) {
@@ -116,6 +142,50 @@ public:
    TimeStamp GetUtcNow() const {
       return this->Time_;
    }
+   /// 是否已呼叫過 PutUtcNow() 或 PutUtcTime();
+   bool IsUtcTimePut() const {
+      return this->TimeFIXMS_ != nullptr;
+   }
+};
+
+/// \ingroup fix
+/// 同一個 FIX session 送出訊息時, 固定不變(或很少改變)的部分:
+/// - BeginHeader: "8=FIX.4.x|9="
+/// - "|52=SendingTime" + CompIDs.Header_: SendingTime 的字串, 同一毫秒內重複使用.
+/// - 預先計算這些字串的 CheckSum(byte 加總), 建立訊息時, 不用再讀一次.
+/// - 非 thread safe, 例: 在 FixSender 的鎖定狀態下使用.
+class fon9_API FixMsgTemplate {
+   fon9_NON_COPY_NON_MOVE(FixMsgTemplate);
+   const CharVector  BeginHeader_;
+   const byte        BeginHeaderSum_;
+   /// CompIDsHeader_ 之前的 "|52=" 的 CheckSum;
+   const byte        HdrSendingTimeSum_;
+   const byte        CompIDsHeaderSum_;
+   byte              SendingTimeSum_;
+   /// "|52=YYYYMMDD-HH:MM:SS.sss" + CompIDs.Header_;
+   CharVector        SendingTimeCompIDs_;
+   /// SendingTimeCompIDs_ 裡面的時間(ms);
+   TimeStamp::OrigType  SendingTimeMS_{-1};
+
+   void UpdateSendingTime(TimeStamp now);
+
+public:
+   /// \param beginHeader    "8=FIX.4.x|9="
+   /// \param compIDsHeader  CompIDs.Header_: "|49=SenderCompID|56=TargetCompID..."
+   FixMsgTemplate(const StrView& beginHeader, const StrView& compIDsHeader);
+
+   const CharVector& GetBeginHeader() const {
+      return this->BeginHeader_;
+   }
+   /// 填入 "|52=SendingTime" + CompIDs.Header_;
+   /// - 若 fixb 已填過時間(fixb.IsUtcTimePut()), 則使用相同的時間;
+   ///   否則使用 UtcNow(), 之後 fixb.PutUtcNow() 也會使用此時間.
+   /// - 返回前 fixb.GetUtcNow() 為 SendingTime.
+   void PutSendingTimeCompIDs(FixBuilder& fixb);
+   /// 訊息建立完畢, 最終填入 BeginHeader, BodyLength, 計算 CheckSum.
+   BufferList Final(FixBuilder& fixb) const {
+      return fixb.Final(ToStrView(this->BeginHeader_), this->BeginHeaderSum_);
+   }
 };
 
 } } // namespace
@@ -150,6 +150,17 @@ public:
    /// 當有 Replay 的需求時(FixSender::Replay), 一律使用 FixSender::GapFill.
    /// 例如: 券商與交易所之間的連線, 券商端斷線後重連, 可能全都不重送.
    bool  IsNoReplay_{false};
+   /// 使用此 FixConfig 的 IoFixSession, 是否啟用 FixFeeder::IsZeroCopy_;
+   /// - 預設為 false: 使用 RxBuf_ 累積不完整的訊息.
+   /// - 實測在每次收到的資料都在新的 BufferNode 時(例: 小封包), IsZeroCopy_ 反而較慢,
+   ///   所以僅在確定收到的資料大多附加在同一個 BufferNode 時, 才建議啟用.
+   bool  IsZeroCopyFeed_{false};
+
+   /// 使用此 FixConfig 的 FixSender, 其 FixRecorder 的 group commit 設定, 參閱 FileAppender::SetGroupCommit();
+   /// - 必須在 FixRecorder::Initialize() 之前套用(例: MakeExgTradingLineFixSender()).
+   /// - RecorderGroupCommitDelay_ <= 0(預設): 不啟用, 有持久化要求時, 寫完就立即 Sync().
+   TimeInterval   RecorderGroupCommitDelay_{};
+   size_t         RecorderGroupCommitBytes_{0};
 };
 fon9_WARN_POP;
 
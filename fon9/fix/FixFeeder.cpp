@@ -37,6 +37,8 @@ FixParser::Result FixFeeder::OnFixStreamReceived(const StrView fixmsgStream) {
    return FixParser::ParseEnd;
 }
 FixParser::Result FixFeeder::FeedBuffer(DcQueue& rxbuf) {
+   if (this->IsZeroCopy_)
+      return this->FeedBufferZeroCopy(rxbuf);
    for (;;) {
       auto blk{rxbuf.PeekCurrBlock()};
       if (!blk.second)
@@ -77,4 +79,76 @@ FixParser::Result FixFeeder::FeedBuffer(DcQueue& rxbuf) {
    return FixParser::ParseEnd;
 }
 
+//--------------------------------------------------------------------------//
+FixParser::Result FixFeeder::ParseInPlace(StrView& fixmsgStream) {
+   const char* const pend = fixmsgStream.end();
+   while (!fixmsgStream.empty()) {
+      const char*       pbeg = fixmsgStream.begin();
+      FixParser::Result res = this->FixParser_.Parse(fixmsgStream);
+      if (res > FixParser::NeedsMore) {
+         fixmsgStream.Reset(pbeg + static_cast<size_t>(res), pend);
+         this->OnFixMessageParsed(StrView{pbeg, fixmsgStream.begin()});
+         this->FixParser_.Clear();
+         continue;
+      }
+      if (res == FixParser::NeedsMore) {
+         fixmsgStream.Reset(pbeg, pend);
+         return FixParser::NeedsMore;
+      }
+      const char* perr = fixmsgStream.begin();
+      fixmsgStream.Reset(pbeg, pend);
+      if ((res = this->OnFixMessageError(res, fixmsgStream, perr)) <= FixParser::NeedsMore)
+         return res;
+      this->FixParser_.Clear();
+   }
+   return FixParser::ParseEnd;
+}
+FixParser::Result FixFeeder::FeedBufferZeroCopy(DcQueue& rxbuf) {
+   for (;;) {
+      const auto  blk{rxbuf.PeekCurrBlock()};
+      if (!blk.second)
+         break;
+      const char* const pblk = reinterpret_cast<const char*>(blk.first);
+      StrView           fixmsgStream{pblk, blk.second};
+      FixParser::Result res = this->ParseInPlace(fixmsgStream);
+      rxbuf.PopConsumed(static_cast<size_t>(fixmsgStream.begin() - pblk));
+      if (res != FixParser::NeedsMore) {
+         if (res < FixParser::NeedsMore)
+            return res;
+         continue;
+      }
+      // 剩餘的資料不足一筆訊息: 訊息跨越 BufferNode, 或尚未收足.
+      // 只有訊息跨越 BufferNode 時, 才需要複製.
+      for (;;) {
+         const size_t expsz = this->FixParser_.GetExpectSize();
+         if (fon9_UNLIKELY(expsz == 0)) // OnFixMessageError() 傳回 NeedsMore.
+            return FixParser::NeedsMore;
+         // 尚未收足, 保留在 rxbuf, 等下次收到資料時再解析.
+         // 先用 IsSizeEnough() 判斷, 避免 Peek() 在資料不足時, 仍複製了部分資料.
+         if (!rxbuf.IsSizeEnough(expsz))
+            return FixParser::NeedsMore;
+         char*        scratch = this->Scratch_;
+         if (fon9_UNLIKELY(expsz > sizeof(this->Scratch_))) {
+            this->RxBuf_.resize(expsz);
+            scratch = &*this->RxBuf_.begin();
+         }
+         const char* pmsg = static_cast<const char*>(rxbuf.Peek(scratch, expsz));
+         assert(pmsg != nullptr);
+         if (pmsg == scratch)
+            ++this->StraddleCount_;
+         fixmsgStream.Reset(pmsg, pmsg + expsz);
+         res = this->ParseInPlace(fixmsgStream);
+         rxbuf.PopConsumed(static_cast<size_t>(fixmsgStream.begin() - pmsg));
+         if (res < FixParser::NeedsMore)
+            return res;
+         if (res != FixParser::NeedsMore)
+            break;
+         // 只取了 GetExpectSize() 的資料量, 若仍為 NeedsMore, 則必定會有更大的 GetExpectSize();
+         if (fon9_UNLIKELY(this->FixParser_.GetExpectSize() <= expsz))
+            return FixParser::NeedsMore;
+      }
+   }
+   return FixParser::ParseEnd;
+}
+
 } } // namespaces
@@ -15,15 +15,27 @@ class fon9_API FixFeeder {
    std::string RxBuf_;
 public:
    FixParser   FixParser_;
+   /// 直接在 rxbuf 的資料區塊上解析, 不複製到 RxBuf_;
+   /// - rxbuf 必須保留 FeedBuffer() 沒用完的資料(例: io::Device 的 RecvBuffer),
+   ///   下次 FeedBuffer() 時, 會從未用完的地方繼續解析.
+   /// - 只有跨越 BufferNode 的訊息, 才會複製到 Scratch_(訊息太大時才使用 RxBuf_).
+   /// - 預設為 false: FeedBuffer() 返回時, rxbuf 的資料全部用完, 不完整的訊息保留在 RxBuf_.
+   bool        IsZeroCopy_{false};
+   char        Padding___[7];
 
    FixFeeder() = default;
    virtual ~FixFeeder();
 
    /// Device 收到的訊息透過這裡處理.
-   /// 返回時機: rxbuf 用完, 或解析有錯.
+   /// 返回時機: rxbuf 用完(IsZeroCopy_ 則為: rxbuf 剩餘資料不足一筆訊息), 或解析有錯.
    /// \retval <FixParser::NeedsMore 表示訊息有問題, 應該中斷連線.
    FixParser::Result FeedBuffer(DcQueue& rxbuf);
 
+   /// IsZeroCopy_ 時, 因為訊息跨越 BufferNode 而複製的次數.
+   uint64_t GetStraddleCount() const {
+      return this->StraddleCount_;
+   }
+
    void ClearFeedBuffer() {
       this->FixParser_.Clear();
       this->RxBuf_.clear();
@@ -39,7 +51,20 @@ protected:
    virtual FixParser::Result OnFixMessageError(FixParser::Result res, StrView& fixmsgStream, const char* perr);
 
 private:
+   enum : size_t {
+      /// 一般的 FIX 訊息(例: ExecutionReport) 都在 1K 以內.
+      kScratchSize = 1024 * 2,
+   };
+   uint64_t StraddleCount_{0};
+   char     Scratch_[kScratchSize];
+
    FixParser::Result OnFixStreamReceived(StrView fixmsgStream);
+   /// 解析 fixmsgStream 裡面的完整訊息, 返回時 fixmsgStream.begin() 為尚未處理的位置.
+   /// \retval FixParser::NeedsMore 剩餘的資料不足一筆訊息.
+   /// \retval FixParser::ParseEnd  資料全部用完.
+   /// \retval <FixParser::NeedsMore 表示訊息有問題, 應該中斷連線.
+   FixParser::Result ParseInPlace(StrView& fixmsgStream);
+   FixParser::Result FeedBufferZeroCopy(DcQueue& rxbuf);
 };
 
 } } // namespaces
@@ -6,9 +6,28 @@
 #include "fon9/fix/FixBuilder.hpp"
 #include "fon9/fix/FixCompID.hpp"
 #include "fon9/Timer.hpp"
+#include "fon9/buffer/DcQueueList.hpp"
+#include <atomic>
+#include <random>
 
 namespace f9fix = fon9::fix;
 
+//--------------------------------------------------------------------------//
+// 計算記憶體分配次數, 用來評估 FeedBuffer() 每筆訊息的分配次數.
+static std::atomic<uint64_t> AllocCount_{0};
+void* operator new(size_t sz) {
+   ++AllocCount_;
+   if (void* p = malloc(sz ? sz : 1))
+      return p;
+   throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept {
+   free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+   free(p);
+}
+
 //--------------------------------------------------------------------------//
 void BuildTestMessage(f9fix::FixBuilder& fixb, fon9::StrView headerCompIds, unsigned seqNum) {
    #define f9fix_kMSGTYPE_NewOrderSingle  "D"
@@ -17,26 +36,32 @@ void BuildTestMessage(f9fix::FixBuilder& fixb, fon9::StrView headerCompIds, unsi
    fon9::RevPrint(fixb.GetBuffer(), f9fix_SPLTAGEQ(SendingTime));
    fon9::RevPrint(fixb.GetBuffer(), f9fix_SPLFLDMSGTYPE(NewOrderSingle) f9fix_SPLTAGEQ(MsgSeqNum), seqNum, headerCompIds);
 }
-void TestFixFeeder() {
+std::string BuildTestStream(unsigned msgCount) {
    f9fix::CompIDs compIds{"SenderCoId", "SenderSubId", "TargetCoId", "TargetSubId"};
    std::string fixStream;
-   for (unsigned L = 0; L < 500;) {
+   for (unsigned L = 0; L < msgCount;) {
       ++L;
       f9fix::FixBuilder fixb;
       BuildTestMessage(fixb, fon9::ToStrView(compIds.Header_), L);
       fon9::BufferAppendTo(fixb.Final(f9fix_BEGIN_HEADER_V42), fixStream);
    }
+   return fixStream;
+}
+struct TestFeeder : public f9fix::FixFeeder {
+   fon9_NON_COPY_NON_MOVE(TestFeeder);
+   size_t ParsedSize_{0};
+   size_t ParsedCount_{0};
+   TestFeeder() = default;
+   void OnFixMessageParsed(fon9::StrView fixmsg) override {
+      this->ParsedSize_ += fixmsg.size();
+      ++this->ParsedCount_;
+   }
+};
+void TestFixFeeder() {
+   const std::string fixStream = BuildTestStream(500);
 
    std::cout << "[TEST ] FixFeeder.";
-   struct FixFeeder : public f9fix::FixFeeder {
-      fon9_NON_COPY_NON_MOVE(FixFeeder);
-      size_t ParsedSize_{0};
-      FixFeeder() = default;
-      void OnFixMessageParsed(fon9::StrView fixmsg) override {
-         this->ParsedSize_ += fixmsg.size();
-      }
-   };
-   FixFeeder  fixFeeder;
+   TestFeeder fixFeeder;
    const size_t totsz = fixStream.size();
    const char*  pStreamEnd = fixStream.c_str() + totsz;
    size_t       pers = 0;
@@ -76,6 +101,87 @@ void TestFixFeeder() {
    }
    std::cout << "\r" "[OK   ]" << std::endl;
 }
+
+/// 模擬 io::Device 收到資料:
+/// - isNewNode == true:  每次收到的資料放在新的 BufferNode, 所以訊息可能會跨越 BufferNode.
+/// - isNewNode == false: 收到的資料盡量放在最後的 BufferNode 尾端.
+/// - FeedBuffer() 沒用完的資料, 保留在 rxbuf.
+static void FeedZeroCopy(TestFeeder& fixFeeder, fon9::StrView fixStream, size_t feedsz, bool isNewNode) {
+   fon9::DcQueueList rxbuf;
+   while (!fixStream.empty()) {
+      const size_t sz = std::min(feedsz, fixStream.size());
+      if (isNewNode) {
+         fon9::BufferList buf;
+         fon9::AppendToBuffer(buf, fixStream.begin(), sz);
+         rxbuf.push_back(std::move(buf));
+      }
+      else
+         rxbuf.Append(fixStream.begin(), sz, 1024 * 4);
+      fixStream.SetBegin(fixStream.begin() + sz);
+      auto res = fixFeeder.FeedBuffer(rxbuf);
+      if (res < f9fix::FixParser::NeedsMore) {
+         std::cout << "|feedsz=" << feedsz << "|FeedBuffer()|err=" << res << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   if (!rxbuf.empty()) {
+      std::cout << "|feedsz=" << feedsz << "|remain=" << rxbuf.CalcSize() << "\r[ERROR]" << std::endl;
+      abort();
+   }
+}
+void TestFixFeederZeroCopy(bool isNewNode) {
+   const std::string fixStream = BuildTestStream(500);
+   std::cout << "[TEST ] FixFeeder.ZeroCopy|" << (isNewNode ? "NewNode" : "Append") << std::flush;
+   TestFeeder fixFeeder;
+   fixFeeder.IsZeroCopy_ = true;
+   const size_t totsz = fixStream.size();
+   std::vector<size_t> feedszs;
+   for (size_t feedsz = 1; feedsz <= 1000; ++feedsz)
+      feedszs.push_back(feedsz);
+   for (size_t feedsz = 1001; feedsz <= totsz; feedsz += 997)
+      feedszs.push_back(feedsz);
+   feedszs.push_back(totsz);
+   for (size_t feedsz : feedszs) {
+      fixFeeder.ParsedSize_ = 0;
+      FeedZeroCopy(fixFeeder, fon9::ToStrView(fixStream), feedsz, isNewNode);
+      if (fixFeeder.ParsedSize_ != totsz) {
+         std::cout << "|feedsz=" << feedsz << "|ParsedSize=" << fixFeeder.ParsedSize_ << "|expected=" << totsz
+            << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   std::cout << "|straddle=" << fixFeeder.GetStraddleCount() << "\r" "[OK   ]" << std::endl;
+}
+
+/// 評估: 一般模式(RxBuf_) vs IsZeroCopy_; 每筆訊息的時間, 及記憶體分配次数.
+void BenchFixFeeder() {
+   const unsigned    kMsgCount = 10000;
+   const unsigned    kTimes = 100;
+   const std::string fixStream = BuildTestStream(kMsgCount);
+   std::cout << "avg msg size=" << fixStream.size() / kMsgCount << std::endl;
+   // 接收的資料量: 一般 TCP 封包(1460), 及零碎的資料(37).
+   const size_t kFeedSizes[] = {1460, 37};
+   for (size_t feedsz : kFeedSizes) {
+      for (unsigned iMode = 0; iMode < 3; ++iMode) {
+         TestFeeder fixFeeder;
+         fixFeeder.IsZeroCopy_ = (iMode != 0);
+         const bool isNewNode = (iMode != 2);
+         const uint64_t allocCount = AllocCount_;
+         fon9::StopWatch stopWatch;
+         for (unsigned L = 0; L < kTimes; ++L)
+            FeedZeroCopy(fixFeeder, fon9::ToStrView(fixStream), feedsz, isNewNode);
+         const double secs = stopWatch.StopTimer();
+         const uint64_t allocs = AllocCount_ - allocCount;
+         std::string msg = "FeedBuffer|feedsz=" + std::to_string(feedsz);
+         msg.append(iMode == 0 ? "|RxBuf   " : iMode == 1 ? "|ZeroCopy(NewNode)" : "|ZeroCopy(Append) ");
+         stopWatch.PrintResultNoEOL(secs, msg.c_str(), fixFeeder.ParsedCount_)
+            // 每次收到資料的 BufferNode 分配, 不算在 FixFeeder 的分配次數.
+            << "|allocs/msg=" << static_cast<double>(allocs) / static_cast<double>(fixFeeder.ParsedCount_)
+            << "|straddle/msg=" << static_cast<double>(fixFeeder.GetStraddleCount()) / static_cast<double>(fixFeeder.ParsedCount_)
+            << std::endl;
+      }
+   }
+}
 //--------------------------------------------------------------------------//
 
 int main() {
@@ -88,4 +194,9 @@ int main() {
    std::this_thread::sleep_for(std::chrono::milliseconds{10});
 
    TestFixFeeder();
+   TestFixFeederZeroCopy(true);
+   TestFixFeederZeroCopy(false);
+
+   utinfo.PrintSplitter();
+   BenchFixFeeder();
 }
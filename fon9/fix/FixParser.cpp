@@ -2,15 +2,176 @@
 // \author fonwinz@gmail.com
 #include "fon9/fix/FixParser.hpp"
 #include "fon9/StrTo.hpp"
+#include "fon9/CpuFeatures.hpp"
+#include "fon9/BitOps.hpp"
+
+#if fon9_HAS_SSE2
+fon9_BEFORE_INCLUDE_STD;
+#include <immintrin.h>
+fon9_AFTER_INCLUDE_STD;
+#endif
 
 namespace fon9 { namespace fix {
 
+/// 舊的(逐字元)解析方式, 也用於不支援 SIMD 的環境.
+struct FixScannerScalar {
+   FixScannerScalar(const char* pbeg, const char* pend) {
+      (void)pbeg; (void)pend;
+   }
+   static FixTag FetchTag(const char*& pcur, const char* pend) {
+      StrView tagstr{pcur, pend};
+      const FixTag tag = StrTo(&tagstr, 0u);
+      pcur = tagstr.begin();
+      return tag;
+   }
+   static const char* FindSpl(const char* pcur, const char* pend) {
+      const void* pspl = memchr(pcur, f9fix_kCHAR_SPL, static_cast<size_t>(pend - pcur));
+      return pspl ? static_cast<const char*>(pspl) : pend;
+   }
+};
+
+/// 使用 SIMD 建立 SOH 位置的 bitmask(每次 kWidth bytes),
+/// 同一個 bitmask 通常可以找到多個欄位的結束位置, 不用每個欄位都呼叫一次 memchr().
+/// BlockT::Load(p) 傳回 [p..p+kWidth) 之中 SOH 位置的 bitmask.
+template <class BlockT>
+class FixScannerSimd {
+   static constexpr size_t kWidth = 32;
+   /// Mask_ 對應的位置: [Base_..Base_+kWidth);
+   /// 若剩餘資料不足 kWidth, 則 Base_ = pend, 之後使用 memchr() 尋找.
+   const char* Base_;
+   uint32_t    Mask_;
+public:
+   FixScannerSimd(const char* pbeg, const char* pend) {
+      if (static_cast<size_t>(pend - pbeg) >= kWidth) {
+         this->Base_ = pbeg;
+         this->Mask_ = BlockT::Load(pbeg);
+      }
+      else {
+         this->Base_ = pend;
+         this->Mask_ = 0;
+      }
+   }
+   /// 一般的 tag 為 2..4 碼, 直接逐字元計算, 最多 9 碼(避免 uint32_t 溢位);
+   /// 超過 9 碼, 則停在第 10 碼, 由呼叫端視為格式錯誤.
+   static FixTag FetchTag(const char*& pcur, const char* pend) {
+      const char* p = pcur;
+      const char* const plim = (pend - p > 9 ? p + 9 : pend);
+      FixTag tag = 0;
+      for (; p < plim; ++p) {
+         const unsigned d = static_cast<unsigned>(static_cast<unsigned char>(*p) - '0');
+         if (d > 9)
+            break;
+         tag = tag * 10 + d;
+      }
+      pcur = p;
+      return tag;
+   }
+   const char* FindSpl(const char* pcur, const char* pend) {
+      for (;;) {
+         const size_t ofs = static_cast<size_t>(pcur - this->Base_);
+         if (fon9_LIKELY(ofs < kWidth)) {
+            if (const uint32_t m = (this->Mask_ >> ofs))
+               return pcur + LowestBitIndex(m);
+            pcur = this->Base_ + kWidth;
+         }
+         if (pcur >= pend) // 最後一個欄位, 值為空白, 且沒有 SOH.
+            return pend;
+         if (static_cast<size_t>(pend - pcur) < kWidth) {
+            this->Base_ = pend;
+            this->Mask_ = 0;
+            return FixScannerScalar::FindSpl(pcur, pend);
+         }
+         this->Base_ = pcur;
+         this->Mask_ = BlockT::Load(pcur);
+      }
+   }
+};
+
+#if fon9_HAS_SSE2
+struct FixBlockSse2 {
+   static uint32_t Load(const char* p) {
+      const __m128i spl = _mm_set1_epi8(f9fix_kCHAR_SPL);
+      const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lo, spl)))
+         | (static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(hi, spl))) << 16);
+   }
+};
+/// AVX2 的函式無法 inline 到一般的函式裡面, 所以每 32 bytes 會有一次函式呼叫;
+/// 欄位結束位置大多可從現有的 bitmask 取得, 只有重新載入時才會呼叫.
+struct FixBlockAvx2 {
+   fon9_TARGET_AVX2 static uint32_t Load(const char* p) {
+      return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)),
+         _mm256_set1_epi8(f9fix_kCHAR_SPL))));
+   }
+};
+using FixScannerSse2 = FixScannerSimd<FixBlockSse2>;
+using FixScannerAvx2 = FixScannerSimd<FixBlockAvx2>;
+#endif
+
+static byte FixByteSumScalar(const char* pbeg, const char* pend) {
+   byte sum = 0;
+   while (pbeg < pend)
+      sum = static_cast<byte>(sum + static_cast<byte>(*pbeg++));
+   return sum;
+}
+
+struct FixScanKernelTraits {
+   using Kernel = FixScanKernel;
+   using Fn = FixParser::Result (FixParser::*)(StrView& fixmsg, FixParser::Until until);
+   /// 預設不使用 Avx2: 因為 FixBlockAvx2::Load() 無法 inline, 實測與 Sse2 差不多.
+   static constexpr Kernel kDefaultMax = FixScanKernel::Sse2;
+   static bool IsSupported(FixScanKernel kernel) {
+      switch (kernel) {
+      case FixScanKernel::Scalar:
+         return true;
+      case FixScanKernel::Sse2:
+         return fon9_HAS_SSE2 != 0;
+      case FixScanKernel::Avx2:
+         return fon9_HAS_SSE2 && GetCpuFeatures().Avx2_;
+      }
+      return false;
+   }
+   static Fn GetFn(FixScanKernel kernel) {
+      switch (kernel) {
+   #if fon9_HAS_SSE2
+      case FixScanKernel::Avx2:
+         return &FixParser::ParseFieldsT<FixScannerAvx2>;
+      case FixScanKernel::Sse2:
+         return &FixParser::ParseFieldsT<FixScannerSse2>;
+   #else
+      case FixScanKernel::Avx2:
+      case FixScanKernel::Sse2:
+   #endif
+      case FixScanKernel::Scalar:
+         break;
+      }
+      return &FixParser::ParseFieldsT<FixScannerScalar>;
+   }
+};
+using FixScanKernelSelector = CpuKernelSelector<FixScanKernelTraits>;
+
+static inline byte FixByteSum(const char* pbeg, const char* pend) {
+   if (fon9_LIKELY(FixScanKernelSelector::GetKernel() != FixScanKernel::Scalar))
+      return CalcFixByteSum(pbeg, static_cast<size_t>(pend - pbeg));
+   return FixByteSumScalar(pbeg, pend);
+}
+
+fon9_API FixScanKernel GetFixScanKernel() {
+   return FixScanKernelSelector::GetKernel();
+}
+fon9_API bool SetFixScanKernel(FixScanKernel kernel) {
+   return FixScanKernelSelector::SetKernel(kernel);
+}
+
+//--------------------------------------------------------------------------//
+
 FixParser::FixParser() {
-   // 預先分配必用(常用)的欄位: 1..511.
-   // 0..0xff(255)
-   this->FieldArray_[8];// "8=FIX.4.2"
-   // 0x100..0x1ff(511)
-   this->FieldArray_[0x100];
+   // 預先分配常用的欄位: 0..kLowTagCount-1.
+   static_assert(kLowTagCount % 0x100 == 0, "kLowTagCount must be a multiple of 0x100.");
+   for (FixTag L = 0; L < kLowTagCount / 0x100; ++L)
+      this->LowTagBlocks_[L] = &this->FieldArray_[L * 0x100];
 }
 void FixParser::Clear() {
    this->MsgSeqNum_ = 0;
@@ -81,8 +242,7 @@ FixParser::Result FixParser::Verify(StrView& fixmsg, VerifyItem vitem) {
           || pend[3] != '=')
          return EFormat;
       byte cks = Pic9StrTo<3, byte>(pend + 4);// static_cast<byte>(((pend[4] - '0') * 10 + (pend[5] - '0')) * 10 + (pend[6] - '0'));
-      while (pbeg < pend)
-         cks = static_cast<byte>(cks - static_cast<byte>(*pbeg++));
+      cks = static_cast<byte>(cks - FixByteSum(pbeg, pend));
       if (cks != f9fix_kCHAR_SPL) {
          this->Clear();
          this->ExpectSize_ = static_cast<ExpectSize>(expsz);
@@ -105,16 +265,26 @@ FixParser::Result FixParser::Parse(StrView& fixmsg, Until until) {
    return rcode;
 }
 FixParser::Result FixParser::ParseFields(StrView& fixmsg, Until until) {
-   const char* msgend = fixmsg.end();
-   while (fixmsg.begin() < msgend) {
-      const FixTag tag = StrTo(&fixmsg, 0u);
-      if (fon9_UNLIKELY(tag == 0 || fixmsg.Get1st() != '='))
+   return (this->*FixScanKernelSelector::GetFn())(fixmsg, until);
+}
+template <class Scanner>
+FixParser::Result FixParser::ParseFieldsT(StrView& fixmsg, Until until) {
+   const char* const msgend = fixmsg.end();
+   const char*       pcur = fixmsg.begin();
+   Scanner           scanner{pcur, msgend};
+   while (pcur < msgend) {
+      const FixTag tag = scanner.FetchTag(pcur, msgend);
+      if (fon9_UNLIKELY(tag == 0 || pcur >= msgend || *pcur != '=')) {
+         fixmsg.SetBegin(pcur);
          return EFormat;
-      fixmsg.SetBegin(fixmsg.begin() + 1); //移除 '='
+      }
+      ++pcur; //移除 '='
 
-      FixField& fld = this->FieldArray_[tag];
-      if (fon9_UNLIKELY(fld.ValueCount_ >= kMaxDupFieldCount + 1))
+      FixField& fld = this->FetchField(tag);
+      if (fon9_UNLIKELY(fld.ValueCount_ >= kMaxDupFieldCount + 1)) {
+         fixmsg.SetBegin(pcur);
          return EDupField;
+      }
       fld.Tag_ = tag;
       StrView* pValue;
       if (fon9_LIKELY(fld.ValueCount_ == 0))
@@ -131,24 +301,23 @@ FixParser::Result FixParser::ParseFields(StrView& fixmsg, Until until) {
          pValue = &this->MFields_[fld.MIndex_ * static_cast<size_t>(kMaxDupFieldCount) + (fld.ValueCount_ - 1)];
       }
 
-      if (fon9_LIKELY(tag != f9fix_kTAG_RawData))
-         *pValue = StrFetchNoTrim(fixmsg, f9fix_kCHAR_SPL);
+      const FixField* fldRawDataLength;
+      if (fon9_LIKELY(tag != f9fix_kTAG_RawData)
+          // 如果沒有 RawDataLength 則使用分隔字元.
+          || fon9_UNLIKELY((fldRawDataLength = GetField(f9fix_kTAG_RawDataLength)) == nullptr)) {
+         const char* pspl = scanner.FindSpl(pcur, msgend);
+         pValue->Reset(pcur, pspl);
+         pcur = (pspl < msgend ? pspl + 1 : msgend);
+      }
       else { // RawData 可包含任意字元, 所以要用 RawDataLength 來判斷長度.
-         const FixField* fldRawDataLength = GetField(f9fix_kTAG_RawDataLength);
-         if (fon9_UNLIKELY(!fldRawDataLength)) {
-            // 如果沒有 RawDataLength 則使用分隔字元.
-            *pValue = StrFetchNoTrim(fixmsg, f9fix_kCHAR_SPL);
-            // return ERawData;
-         }
-         else {
-            uint32_t rawDataLength = StrTo(fldRawDataLength->Value_, static_cast<uint32_t>(-1));
-            if (fon9_UNLIKELY(rawDataLength > fixmsg.size()))
-               return ERawData;
-            if (fon9_UNLIKELY(fixmsg.begin()[rawDataLength] != f9fix_kCHAR_SPL))
-               return ERawData;
-            pValue->Reset(fixmsg.begin(), fixmsg.begin() + rawDataLength);
-            fixmsg.SetBegin(pValue->end() + 1);// +1 移除 f9fix_kCHAR_SPL
+         uint32_t rawDataLength = StrTo(fldRawDataLength->Value_, static_cast<uint32_t>(-1));
+         if (fon9_UNLIKELY(rawDataLength > static_cast<size_t>(msgend - pcur)
+                           || pcur[rawDataLength] != f9fix_kCHAR_SPL)) {
+            fixmsg.SetBegin(pcur);
+            return ERawData;
          }
+         pValue->Reset(pcur, pcur + rawDataLength);
+         pcur = pValue->end() + 1;// +1 移除 f9fix_kCHAR_SPL
       }
       ++fld.ValueCount_;
       this->FieldList_.push_back(&fld);
@@ -165,6 +334,7 @@ FixParser::Result FixParser::ParseFields(StrView& fixmsg, Until until) {
       if (until == Until::FullMessage)
          break;
    }
+   fixmsg.SetBegin(pcur);
    const FixField* fldMsgSeqNum = this->GetField(f9fix_kTAG_MsgSeqNum);
    this->MsgSeqNum_ = (fldMsgSeqNum ? StrTo(fldMsgSeqNum->Value_, 0u) : 0);
    return ParseEnd;
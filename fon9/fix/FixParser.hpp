@@ -9,6 +9,27 @@
 
 namespace fon9 { namespace fix {
 
+/// \ingroup fix
+/// FixParser::ParseFields() 使用的欄位掃描方式.
+/// - 正確的 FIX Message, 不論使用哪種 FixScanKernel, 解析的結果都相同.
+/// - 格式錯誤時(例: tag 前方有空白, tag 超過 9 碼), Scalar 的錯誤位置可能與其他 kernel 不同.
+enum class FixScanKernel : uint8_t {
+   /// 逐字元解析: StrTo() 取得 tag, memchr() 尋找 SOH, 逐字元計算 CheckSum.
+   Scalar,
+   /// 每次 32 bytes(2 * SSE2) 建立 SOH 位置的 bitmask, 同一個 bitmask 可找出多個欄位的結束位置.
+   /// CheckSum 使用 CalcFixByteSum().
+   Sse2,
+   /// 同 Sse2, 但 SOH 的 bitmask 使用 AVX2 建立.
+   Avx2,
+};
+/// \ingroup fix
+/// 預設: 若 CPU(及編譯環境) 支援 SSE2, 則使用 Sse2, 否則使用 Scalar.
+fon9_API FixScanKernel GetFixScanKernel();
+/// \ingroup fix
+/// 若 CPU(或編譯環境) 不支援 kernel, 則傳回 false, 不改變目前的設定.
+/// 通常用於測試或評估.
+fon9_API bool SetFixScanKernel(FixScanKernel kernel);
+
 /// \ingroup fix
 /// Fix Message 解析器.
 /// - 解析後的結果, 透過 GetField() 取得,
@@ -160,7 +181,7 @@ public:
    /// \retval nullptr  欄位不存在
    /// \retval !nullptr 在 Clear() 之後的 ParseFields() 欄位至少出現過一次.
    const FixField* GetField(FixTag tag) const {
-      const FixField& fld = this->FieldArray_[tag];
+      const FixField& fld = this->FetchField(tag);
       return(fld.ValueCount_ > 0 ? &fld : nullptr);
    }
    /// 當同一個欄位重複出現, 則透過此處找後續出現的 values.
@@ -189,8 +210,25 @@ public:
    }
 private:
    using FieldArray = LevelArray<FixTag, FixField>;
+   enum : FixTag {
+      /// 常用的 tag(0..kLowTagCount-1) 在建構時就分配好,
+      /// 直接使用 LowTagBlocks_[tag >> 8][tag & 0xff] 取得, 不用經過 LevelArray 的 4 層查找.
+      kLowTagCount = 0x400,
+   };
+   FixField& FetchField(FixTag tag) const {
+      return fon9_LIKELY(tag < kLowTagCount)
+         ? this->LowTagBlocks_[tag >> 8][tag & 0xff]
+         : const_cast<FieldArray&>(this->FieldArray_)[tag];
+   }
+   template <class Scanner>
+   Result ParseFieldsT(StrView& fixmsg, Until until);
+   /// 選擇 FixScanKernel 時, 需要取得 ParseFieldsT<Scanner> 的位址.
+   friend struct FixScanKernelTraits;
+
    CharVector  ExpectHeader_;
    FieldArray  FieldArray_;
+   /// 指向 FieldArray_ 裡面 [0x000..0x0ff], [0x100..0x1ff]... 的區塊, 在 FixParser 建構時設定.
+   FixField*   LowTagBlocks_[kLowTagCount / 0x100];
    FieldList   FieldList_;
    FixSeqNum   MsgSeqNum_;
    ExpectSize  ExpectSize_{0};
@@ -4,6 +4,7 @@
 #include "fon9/TestTools.hpp"
 #include "fon9/fix/FixParser.hpp"
 #include "fon9/fix/FixBuilder.hpp"
+#include "fon9/fix/FixApDef.hpp"
 #include "fon9/Timer.hpp"
 
 namespace f9fix = fon9::fix;
@@ -78,19 +79,115 @@ f9fix::FixParser::Result TestFixParser(const char* testName,
    return res;
 }
 
-int main(int argc, char** args) {
-   (void)argc; (void)args;
+static const char* FixScanKernelName(f9fix::FixScanKernel kernel) {
+   switch (kernel) {
+   case f9fix::FixScanKernel::Scalar: return "Scalar";
+   case f9fix::FixScanKernel::Sse2:   return "SSE2";
+   case f9fix::FixScanKernel::Avx2:   return "AVX2";
+   }
+   return "?";
+}
+static const f9fix::FixScanKernel kFixScanKernels[] = {
+   f9fix::FixScanKernel::Scalar,
+   f9fix::FixScanKernel::Sse2,
+   f9fix::FixScanKernel::Avx2,
+};
 
-#if defined(_MSC_VER) && defined(_DEBUG)
-   _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
-#endif
+#define _   f9fix_kCSTR_SPL
+/// 模擬回報: 一般長度(約 300 bytes)的 ExecutionReport.
+static std::string MakeExecutionReport(unsigned seqNum) {
+   f9fix::FixBuilder fbuf;
+   fon9::RevPrint(fbuf.GetBuffer(),
+                  _ "35=8" _ "34=", seqNum,
+                  _ "49=Broker" _ "56=Client" _ "52=20201020-01:02:03.456" _ "57=TraderA"
+                  _ "1=1234567" _ "6=123.45" _ "11=Cl", seqNum, _ "14=1000" _ "17=Exec", seqNum,
+                  _ "20=0" _ "31=123.5" _ "32=500" _ "37=Ord", seqNum, _ "38=2000" _ "39=1" _ "40=2"
+                  _ "44=123.5" _ "54=1" _ "55=2330" _ "59=0" _ "60=20201020-01:02:03.456" _ "150=F" _ "151=1000"
+                  _ "207=TWSE" _ "10000=UserDefined" _ "10001=", seqNum * 7);
+   return fon9::BufferTo<std::string>(fbuf.Final("8=FIX.4.4" _ "9="));
+}
 
-   fon9::AutoPrintTestInfo utinfo{"FixParser/FixBuilder"};
-   fon9::GetDefaultTimerThread();
-   std::this_thread::sleep_for(std::chrono::milliseconds{10});
+/// 每個 kernel 解析的結果, 都要與 Scalar 相同.
+static void CheckFixScanKernels() {
+   std::vector<std::string> msgs;
+   for (unsigned L = 1; L <= 100; ++L)
+      msgs.emplace_back(MakeExecutionReport(L * 37));
+   // 不同長度的欄位, 讓 SOH 出現在 bitmask 邊界的各種位置.
+   for (unsigned L = 0; L < 70; ++L) {
+      f9fix::FixBuilder fbuf;
+      fon9::RevPrint(fbuf.GetBuffer(), _ "35=D" _ "34=", L, _ "58=", std::string(L, 'x'), _ "1=A" _ "96=", std::string(L % 7, 'y'));
+      msgs.emplace_back(fon9::BufferTo<std::string>(fbuf.Final("8=FIX.4.4" _ "9=")));
+   }
+   using FldList = std::vector<std::pair<f9fix::FixTag, std::string>>;
+   std::vector<FldList> expected;
+   for (f9fix::FixScanKernel kernel : kFixScanKernels) {
+      if (!f9fix::SetFixScanKernel(kernel)) {
+         std::cout << "[SKIP ] FixScanKernel=" << FixScanKernelName(kernel) << "|not supported." << std::endl;
+         continue;
+      }
+      std::cout << "[TEST ] FixScanKernel=" << FixScanKernelName(kernel) << std::flush;
+      f9fix::FixParser fixpr;
+      for (size_t iMsg = 0; iMsg < msgs.size(); ++iMsg) {
+         fon9::StrView fixmsg = fon9::ToStrView(msgs[iMsg]);
+         if (fixpr.Parse(fixmsg) != static_cast<f9fix::FixParser::Result>(msgs[iMsg].size())) {
+            std::cout << "|msg=" << iMsg << "|Parse()" "\r" "[ERROR]" << std::endl;
+            abort();
+         }
+         FldList flds;
+         for (auto fld : fixpr)
+            flds.emplace_back(fld->Tag_, fld->Value_.ToString());
+         if (kernel == f9fix::FixScanKernel::Scalar)
+            expected.emplace_back(std::move(flds));
+         else if (expected[iMsg] != flds) {
+            std::cout << "|msg=" << iMsg << "|result not match Scalar." "\r" "[ERROR]" << std::endl;
+            abort();
+         }
+      }
+      std::cout << "\r" "[OK   ]" << std::endl;
+   }
+}
+
+/// 評估: 各種 FixScanKernel 解析全部欄位, 及只解析 header(Until) 的速度.
+static void BenchFixScanKernels() {
+   const unsigned kMsgCount = 1000;
+   const unsigned kTimes = 1000;
+   std::vector<std::string> msgs;
+   size_t totsz = 0;
+   for (unsigned L = 1; L <= kMsgCount; ++L) {
+      msgs.emplace_back(MakeExecutionReport(L));
+      totsz += msgs.back().size();
+   }
+   std::cout << "ExecutionReport|avgsz=" << totsz / kMsgCount << std::endl;
+   const auto kUntilHeader = f9fix::FixParser::Until::MsgSeqNum | f9fix::FixParser::Until::MsgType | f9fix::FixParser::Until::SendingTime;
+   f9fix::FixParser fixpr;
+   for (f9fix::FixScanKernel kernel : kFixScanKernels) {
+      if (!f9fix::SetFixScanKernel(kernel))
+         continue;
+      for (unsigned iUntil = 0; iUntil < 2; ++iUntil) {
+         const auto until = (iUntil == 0 ? f9fix::FixParser::Until::FullMessage : kUntilHeader);
+         size_t chk = 0;
+         fon9::StopWatch stopWatch;
+         for (unsigned L = 0; L < kTimes; ++L) {
+            for (const std::string& msg : msgs) {
+               fon9::StrView fixmsg = fon9::ToStrView(msg);
+               chk += static_cast<size_t>(fixpr.Parse(fixmsg, until));
+            }
+         }
+         const double secs = stopWatch.StopTimer();
+         std::string msg{"Parse|"};
+         msg.append(iUntil == 0 ? "Full  |" : "Header|");
+         msg.append(FixScanKernelName(kernel));
+         stopWatch.PrintResultNoEOL(secs, msg.c_str(), kTimes * kMsgCount)
+            << "|msgs/sec=" << static_cast<uint64_t>(kTimes * kMsgCount / secs);
+         if (chk != totsz * kTimes)
+            std::cout << "|chk=" << chk << "\r" "[ERROR]";
+         std::cout << std::endl;
+      }
+   }
+}
 
+void TestFixParserCases() {
    f9fix::FixParser   fixpr;
-   #define _   f9fix_kCSTR_SPL
 
    // 一般訊息.
    const FldValue vs1[] = {{35,"A"},{56,"Client"},{49,"Server"},{34,"1"},{52,"20170426-00:49:26.625"},{108,"3000"},{98,"0"}};
@@ -154,3 +251,127 @@ int main(int argc, char** args) {
                  "99=A" _ "99=B" _ "99=C" _ "99=D" _ "99=E" _ "10=240" _,
                  vs7, fon9::numofele(vs7));
 }
+
+//--------------------------------------------------------------------------//
+static const char kTmplBeginHeader[] = "8=FIX.4.4" _ "9=";
+static const char kTmplCompIDs[] = _ "49=SenderCompID" _ "56=TargetCompID" _ "50=SenderSubID";
+
+/// 不使用 FixMsgTemplate: 與 FixSender 原本的做法相同.
+static fon9::BufferList BuildMsgPlain(f9fix::FixBuilder& fixb, unsigned seqNum) {
+   fon9::RevPrint(fixb.GetBuffer(), kTmplCompIDs);
+   fixb.PutUtcNow();
+   fon9::RevPrint(fixb.GetBuffer(), f9fix_SPLTAGEQ(SendingTime));
+   fon9::RevPrint(fixb.GetBuffer(), f9fix_SPLFLDMSGTYPE(NewOrderSingle), f9fix_SPLTAGEQ(MsgSeqNum), seqNum);
+   return fixb.Final(kTmplBeginHeader);
+}
+static fon9::BufferList BuildMsgTemplate(f9fix::FixMsgTemplate& tmpl, f9fix::FixBuilder& fixb, unsigned seqNum) {
+   tmpl.PutSendingTimeCompIDs(fixb);
+   fon9::RevPrint(fixb.GetBuffer(), f9fix_SPLFLDMSGTYPE(NewOrderSingle), f9fix_SPLTAGEQ(MsgSeqNum), seqNum);
+   return tmpl.Final(fixb);
+}
+/// 模擬下單: 一般長度的 NewOrderSingle 的 body.
+static void PutNewOrderSingleBody(f9fix::FixBuilder& fixb, unsigned seqNum, size_t textLen) {
+   fixb.PutUtcNow();
+   fon9::RevPrint(fixb.GetBuffer(),
+                  _ "1=1234567" _ "11=Cl", seqNum, _ "38=2000" _ "40=2" _ "44=123.5" _ "54=1" _ "55=2330" _ "59=0"
+                  _ "10000=", std::string(textLen, 'x'), _ "60=");
+}
+
+/// FixMsgTemplate 建立的訊息, 必須與 BuildMsgPlain() 相同.
+static void TestFixMsgTemplate() {
+   std::cout << "[TEST ] FixMsgTemplate" << std::flush;
+   f9fix::FixMsgTemplate   tmpl{kTmplBeginHeader, kTmplCompIDs};
+   f9fix::FixParser        fixpr;
+   const fon9::TimeStamp   tmBase = fon9::UtcNow();
+   for (unsigned L = 0; L < 3000; ++L) {
+      // 每 3 筆跨越 1 ms, 測試 SendingTime 的重複使用及更新;
+      // body 長度變化, 讓訊息跨越多個 BufferNode.
+      const fon9::TimeStamp tm = tmBase + fon9::TimeInterval_Microsecond(L * 333);
+      const size_t          textLen = L % 1500;
+      f9fix::FixBuilder fixbPlain;
+      fixbPlain.PutUtcTime(tm);
+      PutNewOrderSingleBody(fixbPlain, L, textLen);
+      const std::string msgPlain = fon9::BufferTo<std::string>(BuildMsgPlain(fixbPlain, L));
+
+      f9fix::FixBuilder fixbTmpl;
+      fixbTmpl.PutUtcTime(tm);
+      PutNewOrderSingleBody(fixbTmpl, L, textLen);
+      if (L % 2)
+         fixbTmpl.AccumulateCheckSum();
+      const std::string msgTmpl = fon9::BufferTo<std::string>(BuildMsgTemplate(tmpl, fixbTmpl, L));
+      if (msgPlain != msgTmpl) {
+         std::cout << "|L=" << L << "|not match." "\r" "[ERROR]" << std::endl;
+         abort();
+      }
+      fon9::StrView fixmsg = fon9::ToStrView(msgTmpl);
+      if (fixpr.Parse(fixmsg) != static_cast<f9fix::FixParser::Result>(msgTmpl.size())) {
+         std::cout << "|L=" << L << "|Parse()" "\r" "[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   // 沒有事先填入時間: 使用 UtcNow(), 且可透過 fixb.GetUtcNow() 取得 SendingTime.
+   f9fix::FixBuilder fixb;
+   fon9::RevPrint(fixb.GetBuffer(), _ "58=NoTime");
+   tmpl.PutSendingTimeCompIDs(fixb);
+   const std::string msg = fon9::BufferTo<std::string>(tmpl.Final(fixb));
+   fon9::StrView fixmsg = fon9::ToStrView(msg);
+   char strTime[fon9::kDateTimeStrWidth_FIXMS];
+   fon9::ToStrRev_FIXMS(strTime + sizeof(strTime), fixb.GetUtcNow());
+   const fon9::StrView expTime{strTime, sizeof(strTime)};
+   if (fixpr.Parse(fixmsg) != static_cast<f9fix::FixParser::Result>(msg.size())
+       || fixpr.GetField(f9fix_kTAG_SendingTime)->Value_ != expTime) {
+      std::cout << "|UtcNow" "\r" "[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r" "[OK   ]" << std::endl;
+}
+
+/// 評估: 每筆下單建立 FIX 訊息的時間: 不使用 FixMsgTemplate vs 使用 FixMsgTemplate.
+static void BenchFixMsgTemplate() {
+   const unsigned          kTimes = 1000000;
+   f9fix::FixMsgTemplate   tmpl{kTmplBeginHeader, kTmplCompIDs};
+   for (unsigned iTmpl = 0; iTmpl < 2; ++iTmpl) {
+      size_t          chk = 0;
+      fon9::StopWatch stopWatch;
+      for (unsigned L = 0; L < kTimes; ++L) {
+         f9fix::FixBuilder fixb;
+         PutNewOrderSingleBody(fixb, L, 0);
+         fon9::BufferList fixmsg{iTmpl == 0 ? BuildMsgPlain(fixb, L) : BuildMsgTemplate(tmpl, fixb, L)};
+         chk += fon9::CalcDataSize(fixmsg.cfront());
+      }
+      stopWatch.PrintResultNoEOL(stopWatch.StopTimer(), iTmpl == 0 ? "Build|Plain   " : "Build|Template", kTimes)
+         << "|avgsz=" << chk / kTimes << std::endl;
+   }
+}
+
+int main(int argc, char** args) {
+   (void)argc; (void)args;
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+   _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+   fon9::AutoPrintTestInfo utinfo{"FixParser/FixBuilder"};
+   fon9::GetDefaultTimerThread();
+   std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+   const f9fix::FixScanKernel defaultKernel = f9fix::GetFixScanKernel();
+   std::cout << "Default FixScanKernel=" << FixScanKernelName(defaultKernel) << std::endl;
+   for (f9fix::FixScanKernel kernel : kFixScanKernels) {
+      if (!f9fix::SetFixScanKernel(kernel))
+         continue;
+      utinfo.PrintSplitter();
+      std::cout << "FixScanKernel=" << FixScanKernelName(kernel) << std::endl;
+      TestFixParserCases();
+   }
+   utinfo.PrintSplitter();
+   CheckFixScanKernels();
+
+   utinfo.PrintSplitter();
+   BenchFixScanKernels();
+   f9fix::SetFixScanKernel(defaultKernel);
+
+   utinfo.PrintSplitter();
+   TestFixMsgTemplate();
+   BenchFixMsgTemplate();
+}
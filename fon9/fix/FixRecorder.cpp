@@ -12,6 +12,7 @@ FixRecorder::~FixRecorder() {
    WorkContentController* app = static_cast<WorkContentController*>(&WorkContentController::StaticCast(*lk));
    app->AddWork(std::move(lk), rbuf.MoveOut());
    this->Worker_.TakeCallLocked(std::move(lk));
+   this->SaveSentIdx();
 }
 
 File::Result FixRecorder::Initialize(std::string fileName) {
@@ -20,10 +21,21 @@ File::Result FixRecorder::Initialize(std::string fileName) {
    auto res = this->OpenImmediately(std::move(fileName), FileMode::Append | FileMode::CreatePath | FileMode::Read | FileMode::DenyWrite);
    if (!res)
       return res;
+   File& file = this->GetStorage();
+   res = file.GetFileSize();
+   if (!res) {
+      file.Close();
+      return res;
+   }
+   this->AppendPos_ = res.GetResult();
+   this->LoadSentIdx(this->AppendPos_);
+
    FixParser fixParser;
    fixParser.ResetExpectHeader(ToStrView(this->BeginHeader_));
    LastSeqSearcher   seqSearcher{fixParser};
-   File&             file = this->GetStorage();
+   // 有送出過訊息, 則直接從 SentIdx_ 取得 NextSendSeq, 只需要往前尋找 NextRecvSeq.
+   if (!this->SentIdx_.empty())
+      seqSearcher.NextSendSeq_ = this->SentIdx_.back().NextSeq_;
    res = seqSearcher.Start(file);
    if (!res)
       file.Close();
@@ -41,15 +53,31 @@ File::Result FixRecorder::Initialize(std::string fileName) {
    return res;
 }
 
+void FixRecorder::WriteAfterSend(Locker&& lk, RevBufferList&& lineMessage, FixSeqNum nextSendSeq) {
+   SentIdxRec  rec{this->AppendPos_, 0, nextSendSeq};
+   const char* pcur = lineMessage.GetCurrent();
+   if (fon9_LIKELY(pcur && *pcur == f9fix_kCSTR_HdrSend[0]))
+      rec.Seq_ = this->NextSendSeq_;
+   this->SentIdx_.push_back(rec);
+   if (fon9_UNLIKELY(rec.IsSeqReset()))
+      this->SentIdxEpoch_ = this->SentIdx_.size();
+   this->NextSendSeq_ = nextSendSeq;
+   this->WriteBuffer(std::move(lk), std::move(lineMessage));
+}
 void FixRecorder::WriteBuffer(Locker&& lk, RevBufferList&& rbuf) {
-   BufferList wbuf = rbuf.MoveOut();
-   if (fon9_UNLIKELY((this->IdxInfoSizeInterval_ += CalcDataSize(wbuf.cfront())) > kIdxInfoSizeInterval)) {
+   BufferList   wbuf = rbuf.MoveOut();
+   const size_t wsz = CalcDataSize(wbuf.cfront());
+   this->AppendPos_ += wsz;
+   if (fon9_UNLIKELY((this->IdxInfoSizeInterval_ += wsz) > kIdxInfoSizeInterval)) {
       this->IdxInfoSizeInterval_ = 0;
       RevPrint(rbuf, f9fix_kCSTR_HdrIdx
                f9fix_kCSTR_HdrNextSendSeq, this->NextSendSeq_,
                f9fix_kCSTR_HdrNextRecvSeq, this->NextRecvSeq_,
                '\n');
-      wbuf.push_back(rbuf.MoveOut());
+      BufferList ibuf = rbuf.MoveOut();
+      this->AppendPos_ += CalcDataSize(ibuf.cfront());
+      wbuf.push_back(std::move(ibuf));
+      this->SaveSentIdx(wbuf);
    }
    WorkContentController* app = static_cast<WorkContentController*>(&WorkContentController::StaticCast(*lk));
    app->AddWork(std::move(lk), std::move(wbuf));
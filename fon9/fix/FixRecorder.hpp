@@ -6,6 +6,7 @@
 #include "fon9/fix/FixCompID.hpp"
 #include "fon9/buffer/RevBufferList.hpp"
 #include "fon9/FileAppender.hpp"
+#include <vector>
 
 namespace fon9 { namespace fix {
 
@@ -38,6 +39,11 @@ fon9_WARN_DISABLE_PADDING;
 ///               FIX 有 Sequence Reset 機制, 當發生此情況時, 必定會跟隨一個 RST 訊息.
 ///        其他 = 額外資訊, 參考 f9fix_kCSTR_Hdr*
 ///   \endcode
+/// - 送出訊息的序號索引(SentIdx): 記錄檔名 + ".sentidx"
+///   - 每次 WriteAfterSend() 記錄一筆 SentIdxRec, 固定大小, native endian, 可直接 mmap;
+///   - 大約每 kIdxInfoSizeInterval 寫入一次索引檔, 及 ~FixRecorder();
+///   - 索引檔只是快取: Initialize() 時檢查, 並從索引涵蓋的位置循序讀取記錄檔補齊(或重建)索引.
+///   - ReloadSent 使用索引直接定位, 回補 N 筆訊息只需要讀 N 筆訊息的範圍, 不用從檔尾往前找.
 class fon9_API FixRecorder : protected AsyncFileAppender {
    fon9_NON_COPY_NON_MOVE(FixRecorder);
    using base = AsyncFileAppender;
@@ -52,6 +58,46 @@ class fon9_API FixRecorder : protected AsyncFileAppender {
 public:
    using Locker = base::WorkContentLocker;
 
+   /// 送出訊息的序號索引, 每次 WriteAfterSend() 一筆.
+   struct SentIdxRec {
+      /// 此次寫入("S timestamp FIX Message\n" 或 RST 訊息)在記錄檔的位置.
+      File::PosType  Pos_;
+      /// 送出的訊息序號; 0 表示此次寫入沒有送出訊息(僅有 "RST|S=n").
+      FixSeqNum      Seq_;
+      /// 此次寫入之後的 NextSendSeq;
+      FixSeqNum      NextSeq_;
+
+      /// 是否有 "RST|S=n": 在此之前送出的訊息, 不會再被回補.
+      bool IsSeqReset() const {
+         return this->NextSeq_ != this->Seq_ + 1;
+      }
+   };
+   using SentIdx = std::vector<SentIdxRec>;
+
+private:
+   /// 記錄檔的寫入位置(包含尚未寫入的資料), 用來建立 SentIdx_;
+   File::PosType  AppendPos_{0};
+   SentIdx        SentIdx_;
+   /// 最後一次 seq reset 之後的第一筆: [SentIdxEpoch_..end) 的 Seq_ 為遞增.
+   size_t         SentIdxEpoch_{0};
+   /// 已寫入索引檔的筆數.
+   size_t         SentIdxSaved_{0};
+   File           SentIdxFile_;
+
+   /// Initialize() 時: 載入索引檔, 然後從索引涵蓋的位置開始, 循序讀取記錄檔, 補齊索引.
+   void LoadSentIdx(File::PosType logSize);
+   /// 從記錄檔的 pos 位置(必須是一行的開頭)開始, 循序讀取記錄檔, 建立索引.
+   void ScanSentIdx(File::PosType pos);
+   /// 將尚未寫入索引檔的 SentIdx_ 直接寫入索引檔, 僅用於 Worker 已停止時(~FixRecorder()).
+   void SaveSentIdx();
+   struct NodeSaveSentIdx;
+   /// 將尚未寫入索引檔的 SentIdx_ 複製到 NodeSaveSentIdx, 放到 wbuf 尾端(IDX 訊息之後),
+   /// 由 Worker 寫入索引檔, 避免在 lock 保護下寫檔.
+   void SaveSentIdx(BufferList& wbuf);
+   /// 在 [SentIdxEpoch_..end) 尋找第一筆 Seq_ >= seq 的索引.
+   bool FindSentIdx(FixSeqNum seq, SentIdxRec& rec);
+
+public:
    /// "8=FIX.n.m|9="
    const CharVector  BeginHeader_;
    /// 僅供 FixReceiver, FixSender 使用.
@@ -77,6 +123,12 @@ public:
    virtual ~FixRecorder();
 
    using base::WaitFlushed;
+   /// 記錄檔的 group commit 及持久化通知, 例:
+   /// - 啟用: fixRecorder.SetGroupCommit(TimeInterval_Microsecond(500), 64 * 1024);
+   /// - FixSender 送出訊息後: GetFixRecorder().AddDurableNotify(node);
+   ///   當 node->OnBufferConsumed() 時, 表示之前送出的訊息都已寫入磁碟, 此時才回覆 ack 給上游.
+   using base::SetGroupCommit;
+   using base::AddDurableNotify;
 
    /// 初次建立 FixRecorder:
    /// 1. 開啟記錄檔.
@@ -90,6 +142,9 @@ public:
    FixSeqNum GetNextRecvSeq() const {
       return this->NextRecvSeq_;
    }
+   const SentIdx& GetSentIdx(const Locker&) const {
+      return this->SentIdx_;
+   }
 
    Locker Lock() {
       return this->Worker_.Lock();
@@ -123,12 +178,12 @@ public:
 
    /// 送出後, 設定 this->NextSendSeq_, 並寫入送出的訊息;
    /// lineMessage 必須為一行完整的訊息: "S " + timestamp + ' ' + FIX Message + '\n';
+   /// - 送出訊息的序號必須為 GetNextSendSeq();
+   /// - 若有 seq reset, 則在訊息之後加上 "RST|S=nextSendSeq\n";
+   /// - 或 lineMessage 只有 "RST|S=nextSendSeq\n";
    /// 請參考 FixSender::Send()
    /// 返回前 lk 可能已被解鎖!
-   void WriteAfterSend(Locker&& lk, RevBufferList&& lineMessage, FixSeqNum nextSendSeq) {
-      this->NextSendSeq_ = nextSendSeq;
-      this->WriteBuffer(std::move(lk), std::move(lineMessage));
-   }
+   void WriteAfterSend(Locker&& lk, RevBufferList&& lineMessage, FixSeqNum nextSendSeq);
 
    /// 寫入依正常順序收到的 FIX Message.
    /// 返回前 ++this->NextRecvSeq_;
@@ -145,7 +200,9 @@ public:
    /// 寫入 buf, 前後都不加料.
    /// 返回前 lk 可能已被解鎖!
    void Append(Locker&& lk, BufferList&& buf) {
-      this->IdxInfoSizeInterval_ += CalcDataSize(buf.cfront());
+      const size_t bufsz = CalcDataSize(buf.cfront());
+      this->IdxInfoSizeInterval_ += bufsz;
+      this->AppendPos_ += bufsz;
       WorkContentController* app = static_cast<WorkContentController*>(&WorkContentController::StaticCast(*lk));
       app->AddWork(std::move(lk), std::move(buf));
    }
@@ -160,6 +217,9 @@ public:
       const char* FoundDataEnd_;
       friend struct SentMessageSearcher;
       bool InitStart(FixRecorder& fixRecorder, FixSeqNum seqFrom);
+      /// 使用 SentIdx 定位: 載入並檢查第一筆 Seq_ >= seq 的訊息.
+      /// \retval false 索引找不到, 或記錄檔內容與索引不符, 此時應從檔尾往前尋找.
+      bool StartBySentIdx(FixRecorder& fixRecorder, FixSeqNum seq);
 
    public:
       FixParser  FixParser_;
@@ -1,10 +1,13 @@
 ﻿// \file fon9/fix/FixRecorder_Searcher.cpp
 // \author fonwinz@gmail.com
 #include "fon9/fix/FixRecorder_Searcher.hpp"
+#include <algorithm>
+#include <memory>
 
 namespace fon9 { namespace fix {
 
-// 當有回補要求時, 一律從檔案尾端往前尋找.
+// 當有回補要求時, 先使用 SentIdx_ 直接定位;
+// 若索引找不到, 或記錄檔內容與索引不符, 才從檔案尾端往前尋找.
 // - 因為可能會有 seq reset.
 // - 索引訊息寫入時機:
 //   - 不定時寫入: 大約輸出 n KB 時, 寫一次.
@@ -194,6 +197,232 @@ LoopControl FixRecorder::SentMessageSearcher::OnFoundChar(char* pbeg, char* pend
    return LoopControl::Continue;
 }
 //--------------------------------------------------------------------------//
+struct FixSentIdxHead {
+   char     Magic_[8];
+   uint32_t RecSize_;
+   uint32_t Reserved_;
+};
+static const char kFixSentIdxMagic[8] = {'f', '9', 'F', 'i', 'x', 'S', 'q', '1'};
+
+void FixRecorder::LoadSentIdx(File::PosType logSize) {
+   this->SentIdx_.clear();
+   this->SentIdxEpoch_ = this->SentIdxSaved_ = 0;
+   File&          fdIdx = this->SentIdxFile_;
+   File::Result   res = fdIdx.Open(this->GetStorage().GetOpenName() + ".sentidx",
+                                   FileMode::Read | FileMode::Write | FileMode::OpenAlways | FileMode::DenyWrite);
+   if (res)
+      res = fdIdx.GetFileSize();
+   FixSentIdxHead head;
+   if (res && res.GetResult() >= sizeof(head)) {
+      const File::SizeType idxsz = res.GetResult() - sizeof(head);
+      res = fdIdx.Read(0, &head, sizeof(head));
+      if (res && res.GetResult() == sizeof(head)
+          && memcmp(head.Magic_, kFixSentIdxMagic, sizeof(head.Magic_)) == 0
+          && head.RecSize_ == sizeof(SentIdxRec)) {
+         this->SentIdx_.resize(static_cast<size_t>(idxsz / sizeof(SentIdxRec)));
+         const File::SizeType rdsz = this->SentIdx_.size() * sizeof(SentIdxRec);
+         res = fdIdx.Read(sizeof(head), this->SentIdx_.data(), rdsz);
+         if (!res || res.GetResult() != rdsz)
+            this->SentIdx_.clear();
+      }
+   }
+   // 索引的 Pos_ 必須遞增, 且在記錄檔範圍內(記錄檔尾端可能在寫入前就當機了).
+   size_t count = 0;
+   for (; count < this->SentIdx_.size(); ++count) {
+      const File::PosType pos = this->SentIdx_[count].Pos_;
+      if (pos >= logSize || (count > 0 && pos <= this->SentIdx_[count - 1].Pos_))
+         break;
+   }
+   // 最後一筆, 從記錄檔重新解析: 除了補齊之後的索引, 也用來檢查索引是否與記錄檔相符.
+   if (count > 0) {
+      const SentIdxRec last = this->SentIdx_[--count];
+      this->SentIdx_.resize(count);
+      this->ScanSentIdx(last.Pos_);
+      if (count >= this->SentIdx_.size()
+          || this->SentIdx_[count].Pos_ != last.Pos_
+          || this->SentIdx_[count].Seq_ != last.Seq_) {
+         this->SentIdx_.clear();
+         count = 0;
+      }
+      else
+         this->SentIdxSaved_ = count;
+   }
+   if (count == 0) { // 沒有索引, 或索引不正確: 從頭建立索引.
+      this->SentIdx_.clear();
+      this->ScanSentIdx(0);
+   }
+   for (size_t L = this->SentIdx_.size(); L > 0; --L) {
+      if (this->SentIdx_[L - 1].IsSeqReset()) {
+         this->SentIdxEpoch_ = L;
+         break;
+      }
+   }
+   if (!fdIdx.IsOpened())
+      return;
+   // 捨棄索引檔尾端不正確的部分(或重建), 然後寫入新的索引.
+   if (this->SentIdxSaved_ == 0) {
+      memcpy(head.Magic_, kFixSentIdxMagic, sizeof(head.Magic_));
+      head.RecSize_ = sizeof(SentIdxRec);
+      head.Reserved_ = 0;
+      res = fdIdx.SetFileSize(0);
+      if (res)
+         res = fdIdx.Write(0, &head, sizeof(head));
+      if (!res) {
+         fdIdx.Close();
+         return;
+      }
+   }
+   else
+      fdIdx.SetFileSize(sizeof(head) + this->SentIdxSaved_ * sizeof(SentIdxRec));
+   this->SaveSentIdx();
+}
+void FixRecorder::ScanSentIdx(File::PosType pos) {
+   FixParser   fixParser;
+   File&       file = this->GetStorage();
+   std::unique_ptr<char[]> buffer{new char[kReloadSentBufferSize + kMaxFixMsgBufferSize]};
+   char* const pbuf = buffer.get();
+   size_t      remainSize = 0;
+   // 上一行是否為 "S timestamp FIX Message": 若下一行為 "RST|S=n", 則屬於同一次 WriteAfterSend().
+   bool        isPrevSend = false;
+   for (;;) {
+      File::Result res = file.Read(pos + remainSize, pbuf + remainSize, kReloadSentBufferSize);
+      if (!res || res.GetResult() == 0)
+         break;
+      const char* pbeg = pbuf;
+      const char* const pend = pbuf + remainSize + res.GetResult();
+      while (const char* pln = static_cast<const char*>(memchr(pbeg, '\n', static_cast<size_t>(pend - pbeg)))) {
+         const File::PosType lnpos = pos + static_cast<File::PosType>(pbeg - pbuf);
+         const bool          isSend = isPrevSend;
+         isPrevSend = false;
+         if (*pbeg == f9fix_kCSTR_HdrSend[0]) {
+            if (const char* pmsg = SkipTimestamp(pbeg, pln)) {
+               StrView fixmsg{pmsg, pln};
+               fixParser.Clear();
+               fixParser.ParseFields(fixmsg, FixParser::Until::MsgSeqNum);
+               const FixSeqNum seq = fixParser.GetMsgSeqNum();
+               if (seq > 0) {
+                  this->SentIdx_.push_back(SentIdxRec{lnpos, seq, seq + 1});
+                  isPrevSend = true;
+               }
+            }
+         }
+         else if (*pbeg == f9fix_kCHAR_HdrCtrlMsgSeqNum) {
+            static const char kRstSend[] = f9fix_kCSTR_HdrRst f9fix_kCSTR_HdrNextSendSeq;
+            const size_t kRstSendWidth = sizeof(kRstSend) - 1;
+            if (static_cast<size_t>(pln - pbeg) > kRstSendWidth && memcmp(pbeg, kRstSend, kRstSendWidth) == 0) {
+               const FixSeqNum nextSeq = GetSeqNum(pbeg + kRstSendWidth, pln, nullptr);
+               if (isSend)
+                  this->SentIdx_.back().NextSeq_ = nextSeq;
+               else
+                  this->SentIdx_.push_back(SentIdxRec{lnpos, 0, nextSeq});
+            }
+         }
+         pbeg = pln + 1;
+      }
+      remainSize = static_cast<size_t>(pend - pbeg);
+      if (remainSize >= kMaxFixMsgBufferSize) { // 此行太長, 不是 FIX Message, 捨棄.
+         pbeg = pend;
+         remainSize = 0;
+      }
+      pos += static_cast<File::PosType>(pbeg - pbuf);
+      memmove(pbuf, pbeg, remainSize);
+   }
+}
+void FixRecorder::SaveSentIdx() {
+   if (!this->SentIdxFile_.IsOpened() || this->SentIdxSaved_ >= this->SentIdx_.size())
+      return;
+   const size_t count = this->SentIdx_.size() - this->SentIdxSaved_;
+   const auto   res = this->SentIdxFile_.Write(sizeof(FixSentIdxHead) + this->SentIdxSaved_ * sizeof(SentIdxRec),
+                                               &this->SentIdx_[this->SentIdxSaved_], count * sizeof(SentIdxRec));
+   if (res && res.GetResult() == count * sizeof(SentIdxRec))
+      this->SentIdxSaved_ += count;
+   else // 寫入失敗, 不再使用索引檔, 下次 Initialize() 會重建.
+      this->SentIdxFile_.Close();
+}
+
+fon9_WARN_DISABLE_PADDING;
+/// 在之前的資料(包含 IDX 訊息)寫入記錄檔之後, 由 Worker 將 Recs_ 寫入索引檔的 Offset_ 位置.
+struct FixRecorder::NodeSaveSentIdx : public BufferNodeVirtual {
+   fon9_NON_COPY_NON_MOVE(NodeSaveSentIdx);
+   using base = BufferNodeVirtual;
+   friend class BufferNode;// for BufferNode::Alloc();
+   using base::base;
+   FixRecorder*         Owner_;
+   const File::PosType  Offset_;
+   const SentIdx        Recs_;
+protected:
+   NodeSaveSentIdx(BufferNodeSize blockSize, FixRecorder* owner, File::PosType offset,
+                   SentIdx::const_iterator ibeg, SentIdx::const_iterator iend)
+      : base(blockSize, StyleFlag{})
+      , Owner_(owner)
+      , Offset_{offset}
+      , Recs_(ibeg, iend) {
+   }
+   virtual void OnBufferConsumed() override {
+      File& fdIdx = this->Owner_->SentIdxFile_;
+      if (!fdIdx.IsOpened())
+         return;
+      const size_t wrsz = this->Recs_.size() * sizeof(SentIdxRec);
+      const auto   res = fdIdx.Write(this->Offset_, this->Recs_.data(), wrsz);
+      if (!res || res.GetResult() != wrsz) // 寫入失敗, 不再使用索引檔, 下次 Initialize() 會重建.
+         fdIdx.Close();
+   }
+   virtual void OnBufferConsumedErr(const ErrC&) override {
+      // 記錄檔寫入失敗, 索引已不可信, 不再使用索引檔.
+      this->Owner_->SentIdxFile_.Close();
+   }
+public:
+   static NodeSaveSentIdx* Alloc(FixRecorder& owner, File::PosType offset,
+                                 SentIdx::const_iterator ibeg, SentIdx::const_iterator iend) {
+      return base::Alloc<NodeSaveSentIdx>(0, &owner, offset, ibeg, iend);
+   }
+};
+fon9_WARN_POP;
+
+void FixRecorder::SaveSentIdx(BufferList& wbuf) {
+   // 此時 Worker 可能正在寫入索引檔(或因失敗而關閉), 所以不檢查 SentIdxFile_.IsOpened(), 由 Worker 處理.
+   if (this->SentIdxSaved_ >= this->SentIdx_.size())
+      return;
+   const auto ibeg = this->SentIdx_.cbegin() + static_cast<SentIdx::difference_type>(this->SentIdxSaved_);
+   wbuf.push_back(NodeSaveSentIdx::Alloc(*this, sizeof(FixSentIdxHead) + this->SentIdxSaved_ * sizeof(SentIdxRec),
+                                         ibeg, this->SentIdx_.cend()));
+   this->SentIdxSaved_ = this->SentIdx_.size();
+}
+bool FixRecorder::FindSentIdx(FixSeqNum seq, SentIdxRec& rec) {
+   auto        lk{this->Worker_.Lock()};
+   const auto  iend = this->SentIdx_.end();
+   const auto  ifind = std::lower_bound(this->SentIdx_.begin() + static_cast<SentIdx::difference_type>(this->SentIdxEpoch_),
+                                        iend, seq, [](const SentIdxRec& i, FixSeqNum v) {
+      return i.Seq_ < v;
+   });
+   if (ifind == iend)
+      return false;
+   rec = *ifind;
+   return true;
+}
+bool FixRecorder::ReloadSent::StartBySentIdx(FixRecorder& fixRecorder, FixSeqNum seq) {
+   SentIdxRec rec;
+   if (!fixRecorder.FindSentIdx(seq, rec))
+      return false;
+   File::Result res = fixRecorder.GetStorage().Read(rec.Pos_, this->Buffer_, kReloadSentBufferSize);
+   if (!res || this->Buffer_[0] != f9fix_kCSTR_HdrSend[0])
+      return false;
+   const char* const pend = this->Buffer_ + res.GetResult();
+   const char* const pln = static_cast<const char*>(memchr(this->Buffer_, '\n', res.GetResult()));
+   const char*       pmsg;
+   if (pln == nullptr || (pmsg = SkipTimestamp(this->Buffer_, pln)) == nullptr)
+      return false;
+   StrView fixmsg{pmsg, pln};
+   this->FixParser_.Clear();
+   this->FixParser_.ParseFields(fixmsg, FixParser::Until::MsgSeqNum);
+   if (this->FixParser_.GetMsgSeqNum() != rec.Seq_)
+      return false;
+   this->CurBufferPos_ = rec.Pos_;
+   this->FoundDataEnd_ = pend;
+   this->CurMsg_.Reset(pmsg, pln);
+   return true;
+}
+//--------------------------------------------------------------------------//
 bool FixRecorder::ReloadSent::InitStart(FixRecorder& fixRecorder, FixSeqNum seqFrom) {
    this->FixParser_.ResetExpectHeader(ToStrView(fixRecorder.BeginHeader_));
    this->CurBufferPos_ = 0;
@@ -206,6 +435,11 @@ bool FixRecorder::ReloadSent::InitStart(FixRecorder& fixRecorder, FixSeqNum seqF
 StrView FixRecorder::ReloadSent::Find(FixRecorder& fixRecorder, FixSeqNum seq) {
    if (!this->InitStart(fixRecorder, seq))
       return StrView{};
+   if (this->StartBySentIdx(fixRecorder, seq)) {
+      if (this->FixParser_.GetMsgSeqNum() == seq)
+         return this->CurMsg_;
+      return this->CurMsg_ = nullptr;
+   }
    SentMessageSearcher  searcher{*this};
    File::Result         res = searcher.Start(*this, seq, fixRecorder.GetStorage());
    if (fon9_LIKELY(res && !searcher.FoundLine_.empty())) {
@@ -217,6 +451,15 @@ StrView FixRecorder::ReloadSent::Find(FixRecorder& fixRecorder, FixSeqNum seq) {
 StrView FixRecorder::ReloadSent::Start(FixRecorder& fixRecorder, FixSeqNum seqFrom) {
    if (!this->InitStart(fixRecorder, seqFrom))
       return StrView{};
+   if (this->StartBySentIdx(fixRecorder, seqFrom)) {
+      fixRecorder.Write(f9fix_kCSTR_HdrInfo,
+                        "ReloadSent:"
+                        "|seq=", seqFrom,
+                        "|foundAt=", this->CurBufferPos_,
+                        "|foundSeq=", this->FixParser_.GetMsgSeqNum(),
+                        "|bySentIdx");
+      return this->CurMsg_;
+   }
    SentMessageSearcher  searcher{*this};
    File::Result         res = searcher.Start(*this, seqFrom, fixRecorder.GetStorage());
    if (!res)
@@ -2,7 +2,7 @@
 // \author fonwinz@gmail.com
 #define _CRT_SECURE_NO_WARNINGS
 #include "fon9/TestTools.hpp"
-#include "fon9/fix/FixRecorder.hpp"
+#include "fon9/fix/FixRecorder_Searcher.hpp"
 #include "fon9/fix/FixBuilder.hpp"
 #include "fon9/Timer.hpp"
 #include "fon9/DefaultThreadPool.hpp"
@@ -64,6 +64,264 @@ void CheckReloadSent(f9fix::FixRecorder& fixr, f9fix::FixSeqNum seqFrom, f9fix::
    }
 }
 //--------------------------------------------------------------------------//
+using SentIdx = f9fix::FixRecorder::SentIdx;
+static bool IsSameSentIdx(const SentIdx& lhs, const SentIdx& rhs) {
+   if (lhs.size() != rhs.size())
+      return false;
+   for (size_t L = 0; L < lhs.size(); ++L) {
+      if (lhs[L].Pos_ != rhs[L].Pos_ || lhs[L].Seq_ != rhs[L].Seq_ || lhs[L].NextSeq_ != rhs[L].NextSeq_)
+         return false;
+   }
+   return true;
+}
+static void ReopenFixRecorder(f9fix::FixRecorderSP& fixr, const f9fix::CompIDs& compIds, const char* fixrFileName) {
+   fixr.reset(new f9fix::FixRecorder(f9fix_BEGIN_HEADER_V42, f9fix::CompIDs{compIds}));
+   int count = 100;
+   while (!fixr->Initialize(fixrFileName)) {
+      if (--count <= 0) {
+         std::cout << "Reopen FixRecorder|fileName=" << fixrFileName << "\r[ERROR]" << std::endl;
+         abort();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+   }
+}
+/// 重新開啟: 載入索引檔 or 重建索引, 結果必須與關閉前相同.
+void TestSentIdxReopen(f9fix::FixRecorderSP& fixr, const f9fix::CompIDs& compIds, const char* fixrFileName) {
+   std::cout << "[TEST ] SentIdx reopen." << std::flush;
+   const SentIdx  sentIdx = fixr->GetSentIdx(fixr->Lock());
+   // 關閉前: 由 Worker 在 IDX 訊息之後寫入的索引, 必須與 sentIdx 的前段相同.
+   fixr->WaitFlushed();
+   fon9::File fdIdx;
+   fdIdx.Open(std::string{fixrFileName} + ".sentidx", fon9::FileMode::Read);
+   const size_t kIdxHeadSize = 16;
+   const auto   idxsz = fdIdx.GetFileSize();
+   if (!idxsz || idxsz.GetResult() <= kIdxHeadSize || idxsz.GetResult() > kIdxHeadSize + sentIdx.size() * sizeof(SentIdx::value_type)) {
+      std::cout << "|err=SentIdx file size." "\r" "[ERROR]" << std::endl;
+      abort();
+   }
+   SentIdx saved(static_cast<size_t>((idxsz.GetResult() - kIdxHeadSize) / sizeof(SentIdx::value_type)));
+   fdIdx.Read(kIdxHeadSize, saved.data(), saved.size() * sizeof(SentIdx::value_type));
+   if (!IsSameSentIdx(saved, SentIdx(sentIdx.begin(), sentIdx.begin() + static_cast<SentIdx::difference_type>(saved.size())))) {
+      std::cout << "|err=Saved SentIdx." "\r" "[ERROR]" << std::endl;
+      abort();
+   }
+   fdIdx.Close();
+   ReopenFixRecorder(fixr, compIds, fixrFileName);
+   if (!IsSameSentIdx(sentIdx, fixr->GetSentIdx(fixr->Lock()))) {
+      std::cout << "|err=Load SentIdx." "\r" "[ERROR]" << std::endl;
+      abort();
+   }
+   // 沒有索引檔(例: 舊版的記錄檔): 重建.
+   fixr.reset();
+   fon9::WaitRemoveFile((std::string{fixrFileName} + ".sentidx").c_str());
+   ReopenFixRecorder(fixr, compIds, fixrFileName);
+   if (!IsSameSentIdx(sentIdx, fixr->GetSentIdx(fixr->Lock()))) {
+      std::cout << "|err=Rebuild SentIdx." "\r" "[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "|count=" << sentIdx.size() << "\r" "[OK   ]" << std::endl;
+}
+/// seq reset 之後, 之前送出的訊息不會被回補.
+void TestSentIdxSeqReset(f9fix::FixRecorderSP& fixr, const f9fix::CompIDs& compIds, const char* fixrFileName, const unsigned kTimes) {
+   std::cout << "[TEST ] SentIdx seq reset." << std::flush;
+   const f9fix::FixSeqNum kNewSeq = fixr->GetNextSendSeq(fixr->Lock()) + 100;
+   fon9::RevBufferList    rbuf{128};
+   fon9::RevPrint(rbuf, f9fix_kCSTR_HdrRst f9fix_kCSTR_HdrNextSendSeq, kNewSeq, '\n');
+   fixr->WriteAfterSend(fixr->Lock(), std::move(rbuf), kNewSeq);
+   TestFixRecorder(*fixr, kTimes);
+   for (unsigned iReopen = 0; iReopen < 2; ++iReopen) {
+      CheckReloadSent(*fixr, kNewSeq, kTimes);
+      CheckReloadSent(*fixr, kNewSeq + kTimes / 2, kTimes - kTimes / 2);
+      f9fix::FixRecorder::ReloadSent reloader;
+      CheckFixMessage(reloader.Start(*fixr, 1), kNewSeq);
+      if (!reloader.Find(*fixr, 1).empty()) {
+         std::cout << "|err=Find() before reset." "\r" "[ERROR]" << std::endl;
+         abort();
+      }
+      CheckFixMessage(reloader.Find(*fixr, kNewSeq + 1), kNewSeq + 1);
+      ReopenFixRecorder(fixr, compIds, fixrFileName);
+   }
+   std::cout << "\r" "[OK   ]" << std::endl;
+}
+/// 評估: 大量訊息之後, 回補最早的訊息.
+void BenchReloadSent(f9fix::FixRecorderSP& fixr, const f9fix::CompIDs& compIds, const char* fixrFileName) {
+   const unsigned kMsgCount = 200000;
+   const unsigned kReplayCount = 100;
+   f9fix::FixSeqNum seqFrom = fixr->GetNextSendSeq(fixr->Lock());
+   TestFixRecorder(*fixr, kMsgCount);
+   fixr->WaitFlushed();
+
+   fon9::StopWatch stopWatch;
+   ReopenFixRecorder(fixr, compIds, fixrFileName);
+   stopWatch.PrintResult("Initialize(Load SentIdx)", 1);
+
+   const unsigned kTimes = 100;
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kTimes; ++L) {
+      f9fix::FixRecorder::ReloadSent reloader;
+      CheckFixMessage(reloader.Start(*fixr, seqFrom + L), seqFrom + L);
+      for (unsigned i = 1; i < kReplayCount; ++i)
+         reloader.FindNext(*fixr);
+   }
+   stopWatch.PrintResult("ReloadSent(early seq, 100 msgs)", kTimes);
+
+   fixr.reset();
+   fon9::WaitRemoveFile((std::string{fixrFileName} + ".sentidx").c_str());
+   stopWatch.ResetTimer();
+   ReopenFixRecorder(fixr, compIds, fixrFileName);
+   stopWatch.PrintResult("Initialize(Rebuild SentIdx)", 1);
+   std::cout << "SentIdx.count=" << fixr->GetSentIdx(fixr->Lock()).size() << std::endl;
+}
+//--------------------------------------------------------------------------//
+struct DurableCounter {
+   std::atomic<unsigned>   Ok_{0};
+   std::atomic<unsigned>   Err_{0};
+   bool                    IsOutOfOrder_{false};
+   char                    Padding____[7];
+
+   unsigned GetCount() const {
+      return this->Ok_ + this->Err_;
+   }
+   /// 等候 GetCount() >= expected, 若逾時則傳回 false;
+   bool Wait(unsigned expected, fon9::TimeInterval timeout = fon9::TimeInterval_Second(5)) const {
+      const fon9::TimeStamp endTime = fon9::UtcNow() + timeout;
+      while (this->GetCount() < expected) {
+         if (fon9::UtcNow() > endTime)
+            return false;
+         std::this_thread::yield();
+      }
+      return true;
+   }
+};
+/// 持久化通知: 檢查通知的順序.
+class DurableNotify : public fon9::BufferNodeVirtual {
+   fon9_NON_COPY_NON_MOVE(DurableNotify);
+   using base = fon9::BufferNodeVirtual;
+   friend class fon9::BufferNode;// for BufferNode::Alloc();
+   using base::base;
+   DurableCounter&   Counter_;
+   const unsigned    Index_;
+   DurableNotify(fon9::BufferNodeSize blockSize, DurableCounter& counter, unsigned index)
+      : base(blockSize, StyleFlag{})
+      , Counter_(counter)
+      , Index_{index} {
+   }
+   virtual void OnBufferConsumed() override {
+      if (this->Index_ != this->Counter_.GetCount())
+         this->Counter_.IsOutOfOrder_ = true;
+      ++this->Counter_.Ok_;
+   }
+   virtual void OnBufferConsumedErr(const fon9::ErrC&) override {
+      ++this->Counter_.Err_;
+   }
+public:
+   /// index = 要求通知的順序(從 0 開始).
+   static DurableNotify* Alloc(DurableCounter& counter, unsigned index) {
+      return base::Alloc<DurableNotify>(0, counter, index);
+   }
+};
+/// 送出 1 筆訊息, 並要求持久化通知.
+static void SendDurable(f9fix::FixRecorder& fixr, DurableCounter& counter, unsigned& notifyCount) {
+   TestFixRecorder(fixr, 1);
+   fixr.AddDurableNotify(DurableNotify::Alloc(counter, notifyCount++));
+}
+static void CheckDurable(const char* msg, const DurableCounter& counter, unsigned expectedOk) {
+   if (counter.Ok_ == expectedOk && counter.Err_ == 0 && !counter.IsOutOfOrder_)
+      return;
+   std::cout << "|" << msg << "|ok=" << counter.Ok_ << "|err=" << counter.Err_
+             << "|outOfOrder=" << counter.IsOutOfOrder_ << "|expected=" << expectedOk << "\r[ERROR]" << std::endl;
+   abort();
+}
+void TestGroupCommit(f9fix::FixRecorderSP& fixr, const f9fix::CompIDs& compIds, const char* fixrFileName) {
+   std::cout << "[TEST ] GroupCommit." << std::flush;
+   DurableCounter counter;
+   unsigned       notifyCount = 0;
+   // 沒有啟用 group commit: 寫完就立即 Sync() 並通知.
+   SendDurable(*fixr, counter, notifyCount);
+   fixr->WaitFlushed();
+   CheckDurable("Default", counter, notifyCount);
+
+   // 啟用 group commit: 寫入後, 要等 maxDelay 才會 Sync() 並通知.
+   fixr->SetGroupCommit(fon9::TimeInterval_Millisecond(200), 0);
+   SendDurable(*fixr, counter, notifyCount);
+   fixr->WaitFlushed();
+   CheckDurable("Delay.Pending", counter, notifyCount - 1);
+   counter.Wait(notifyCount);
+   CheckDurable("Delay", counter, notifyCount);
+
+   // 尚未 Sync() 的資料量超過 maxBytes: 立即 Sync() 並通知.
+   fixr->SetGroupCommit(fon9::TimeInterval_Second(10), 64);
+   SendDurable(*fixr, counter, notifyCount);
+   fixr->WaitFlushed();
+   CheckDurable("MaxBytes", counter, notifyCount);
+
+   // 大量訊息: 通知的順序必須正確.
+   fixr->SetGroupCommit(fon9::TimeInterval_Millisecond(1), 16 * 1024);
+   for (unsigned L = 0; L < 1000; ++L)
+      SendDurable(*fixr, counter, notifyCount);
+   counter.Wait(notifyCount);
+   CheckDurable("Burst", counter, notifyCount);
+
+   // 解構時: 尚未 Sync() 的資料, 必須在解構時 Sync() 並通知.
+   fixr->SetGroupCommit(fon9::TimeInterval_Second(10), 0);
+   SendDurable(*fixr, counter, notifyCount);
+   fixr->WaitFlushed();
+   CheckDurable("Dtor.Pending", counter, notifyCount - 1);
+   ReopenFixRecorder(fixr, compIds, fixrFileName);
+   // 舊的 FixRecorder 可能仍被 DefaultThreadPool 的工作持有, 所以要等它解構後的通知.
+   counter.Wait(notifyCount);
+   CheckDurable("Dtor", counter, notifyCount);
+   std::cout << "\r" "[OK   ]" << std::endl;
+}
+/// Sync() 失敗: 持久化通知必須透過 OnBufferConsumedErr() 通知.
+/// 使用 "/dev/null": 可寫入, 但 fdatasync() 傳回 EINVAL.
+void TestDurableSyncErr() {
+#ifndef fon9_WINDOWS
+   std::cout << "[TEST ] Durable.SyncErr." << std::flush;
+   DurableCounter    counter;
+   fon9::FileAppender appender;
+   if (!appender.OpenImmediately(std::string{"/dev/null"}, fon9::FileMode::Append)) {
+      std::cout << "|open=/dev/null" "\r[ERROR]" << std::endl;
+      abort();
+   }
+   appender.Append(fon9::StrView{"SyncErr\n"});
+   appender.AddDurableNotify(DurableNotify::Alloc(counter, 0));
+   appender.WaitFlushed();
+   if (counter.Ok_ != 0 || counter.Err_ != 1) {
+      std::cout << "|ok=" << counter.Ok_ << "|err=" << counter.Err_ << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r" "[OK   ]" << std::endl;
+#endif
+}
+/// 評估: 每筆訊息都等 Sync() vs 連續送出(預設: 每次寫檔後 Sync()) vs group commit.
+void BenchGroupCommit(f9fix::FixRecorderSP& fixr, const f9fix::CompIDs& compIds, const char* fixrFileName) {
+   const unsigned    kMsgCount = 1000;
+   fon9::StopWatch   stopWatch;
+   DurableCounter    counter;
+   unsigned          notifyCount = 0;
+   for (unsigned L = 0; L < kMsgCount; ++L) {
+      SendDurable(*fixr, counter, notifyCount);
+      counter.Wait(notifyCount);
+   }
+   stopWatch.PrintResult("Durable(wait each msg)", kMsgCount);
+
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kMsgCount; ++L)
+      SendDurable(*fixr, counter, notifyCount);
+   counter.Wait(notifyCount);
+   stopWatch.PrintResult("Durable(burst, sync each write)", kMsgCount);
+
+   fixr->SetGroupCommit(fon9::TimeInterval_Microsecond(500), 64 * 1024);
+   stopWatch.ResetTimer();
+   for (unsigned L = 0; L < kMsgCount; ++L)
+      SendDurable(*fixr, counter, notifyCount);
+   counter.Wait(notifyCount);
+   stopWatch.PrintResult("Durable(burst, group commit 500us/64KB)", kMsgCount);
+   CheckDurable("Bench", counter, notifyCount);
+   ReopenFixRecorder(fixr, compIds, fixrFileName);
+}
+//--------------------------------------------------------------------------//
 
 int main(int argc, char** argv) {
 #if defined(_MSC_VER) && defined(_DEBUG)
@@ -78,7 +336,9 @@ int main(int argc, char** argv) {
    f9fix::CompIDs       compIds{"SenderCoId", "SenderSubId", "TargetCoId", "TargetSubId"};
    f9fix::FixRecorderSP fixr{new f9fix::FixRecorder(f9fix_BEGIN_HEADER_V42, f9fix::CompIDs{compIds})};
    const char           fixrFileName[] = "FixRecorder_UT.log";
+   const std::string    sentIdxFileName = std::string{fixrFileName} + ".sentidx";
    remove(fixrFileName);
+   remove(sentIdxFileName.c_str());
    auto res = fixr->Initialize(fixrFileName);
    if (!res) {
       std::cout << "Open FixRecorder|fileName=" << fixrFileName
@@ -132,8 +392,20 @@ int main(int argc, char** argv) {
       abort();
    }
 
+   TestSentIdxReopen(fixr, compIds, fixrFileName);
+   TestSentIdxSeqReset(fixr, compIds, fixrFileName, kTimes);
+   TestGroupCommit(fixr, compIds, fixrFileName);
+   TestDurableSyncErr();
+
+   utinfo.PrintSplitter();
+   BenchReloadSent(fixr, compIds, fixrFileName);
+   utinfo.PrintSplitter();
+   BenchGroupCommit(fixr, compIds, fixrFileName);
+
    // 結束前刪除測試檔.
    fixr.reset();
-   if (!fon9::IsKeepTestFiles(argc, argv))
+   if (!fon9::IsKeepTestFiles(argc, argv)) {
       fon9::WaitRemoveFile(fixrFileName);
+      fon9::WaitRemoveFile(sentIdxFileName.c_str());
+   }
 }
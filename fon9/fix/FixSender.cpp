@@ -15,13 +15,10 @@ void FixSender::Send(Locker&&       locker,
                      FixBuilder&&   fixmsgBuilder,
                      FixSeqNum      nextSeqNum,
                      RevBufferList* fixmsgDupOut) {
-   // CompIDs
+   // "|52=SendingTime" + CompIDs: 使用 MsgTemplate_ 快取的字串及 CheckSum.
    RevBuffer& msgRBuf = fixmsgBuilder.GetBuffer();
-   RevPrint(msgRBuf, this->CompIDs_.Header_);
-   // SendingTime.
-   fixmsgBuilder.PutUtcNow();
+   this->MsgTemplate_.PutSendingTimeCompIDs(fixmsgBuilder);
    TimeStamp now = this->LastSentTime_ = fixmsgBuilder.GetUtcNow();
-   RevPrint(msgRBuf, f9fix_SPLTAGEQ(SendingTime));
 
    // MsgType: ** ALWAYS THIRD FIELD IN MESSAGE. (Always unencrypted) **
    // 底下的欄位順序不可改變, 因為 Replayer::Rebuild() 依賴此順序重建要 replay 的訊息.
@@ -32,7 +29,7 @@ void FixSender::Send(Locker&&       locker,
    RevPrint(msgRBuf, fldMsgType, f9fix_SPLTAGEQ(MsgSeqNum), msgSeqNum);
 
    // 產出 FIX Message.
-   BufferList  fixmsg{fixmsgBuilder.Final(ToStrView(this->BeginHeader_))};
+   BufferList  fixmsg{this->MsgTemplate_.Final(fixmsgBuilder)};
    const auto  fixmsgSize = CalcDataSize(fixmsg.cfront());
    // 建立要寫入 FixRecorder 的訊息.
    RevBufferList rlog{static_cast<BufferNodeSize>(64 + fixmsgSize)};
@@ -25,6 +25,9 @@ class fon9_API FixSender : protected FixRecorder {
 
    bool       IsReplayingAll_{false};
    TimeStamp  LastSentTime_;
+   /// BeginHeader_, CompIDs_ 不會改變, 所以預先算好 CheckSum, SendingTime 在同一毫秒內重複使用.
+   /// 在 Send() 的鎖定狀態下使用.
+   FixMsgTemplate MsgTemplate_{ToStrView(this->BeginHeader_), ToStrView(this->CompIDs_.Header_)};
    struct Replayer;
    void Send(Locker&&       locker,
              StrView        fldMsgType,
@@ -57,6 +57,7 @@ int main(int argc, char** argv) {
 
    const char  fixrFileName[] = "FixSender_UT.log";
    remove(fixrFileName);
+   remove((std::string{fixrFileName} + ".sentidx").c_str());
 
    struct FixSender : public f9fix::FixSender {
       fon9_NON_COPY_NON_MOVE(FixSender);
@@ -191,7 +192,9 @@ int main(int argc, char** argv) {
 
    // 結束前刪除測試檔.
    fixSender.reset();
-   if (!fon9::IsKeepTestFiles(argc, argv))
+   if (!fon9::IsKeepTestFiles(argc, argv)) {
       fon9::WaitRemoveFile(fixrFileName);
+      fon9::WaitRemoveFile((std::string{fixrFileName} + ".sentidx").c_str());
+   }
 }
 fon9_WARN_POP;
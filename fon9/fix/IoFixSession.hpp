@@ -95,6 +95,8 @@ public:
    IoFixSession(IoFixManager& mgr, const FixConfig& cfg)
       : baseFix{cfg}
       , FixManager_(mgr) {
+      // io::Device 的 RecvBuffer 會保留沒用完的資料, 所以可以選擇直接在 RecvBuffer 上解析.
+      this->IsZeroCopy_ = cfg.IsZeroCopyFeed_;
    }
 
    /// 通常只會在 OnDevice_LinkReady() 事件時,
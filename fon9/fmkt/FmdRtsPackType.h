@@ -57,6 +57,7 @@ fon9_ENUM(f9sv_RtsPackType, uint8_t) {
    ///   - (first & RtBSType::Mask) : RtBSType::OrderBuy, OrderSell, DerivedBuy, DerivedSell;
    ///   - Count 4 bits = (first & 0x0f) + 1;
    ///   - 例如: first = 0x13: first 之後, 提供「第4檔..第1檔」的賣出報價 Pri(Bitv), Qty(Bitv);
+   ///   - 若 (first & 0x40): 超過 16 檔的委託簿, first 之後的 1 byte 為 Count-1, 此時不使用 (first & 0x0f);
    f9sv_RtsPackType_SnapshotBS,
    /// 試算委託簿快照, 後續內容與 SnapshotBS 相同.
    f9sv_RtsPackType_CalculatedBS,
@@ -67,7 +68,7 @@ fon9_ENUM(f9sv_RtsPackType, uint8_t) {
    ///   - MSB 1 bit = (first & 0x80) = Calculated?
    ///   - Count 7 bits = (first & 7f) + 1; 底下的資料重複次數.
    /// - type(1 byte)
-   ///   - (type & 0x0f) : Level;
+   ///   - (type & 0x0f) : Level; 若為 0x0f, 則 type 之後的 1 byte 為 Level(第 16 檔以後);
    ///   - (type & RtBSType::Mask) : RtBSType::OrderBuy, OrderSell, DerivedBuy, DerivedSell;
    ///   - (type & RtBSAction::Mask) : RtBSAction::ChangePQ, ChangeQty, Delete, New;
    /// - Action != RtBSAction::Delete, 則接著提供該檔位的 Pri(Bitv), Qty(Bitv);
@@ -0,0 +1,182 @@
+﻿// \file fon9/fmkt/MdRtConflator_UT.cpp
+// \author fonwinz@gmail.com
+#include "fon9/fmkt/MdSymbs.hpp"
+#include "fon9/fmkt/SymbBS.hpp"
+#include "fon9/fmkt/SymbDeal.hpp"
+#include "fon9/seed/FieldMaker.hpp"
+#include "fon9/TestTools.hpp"
+#include <algorithm>
+#include <thread>
+#include <memory>
+
+//--------------------------------------------------------------------------//
+class MdSymb : public fon9::fmkt::Symb {
+   fon9_NON_COPY_NON_MOVE(MdSymb);
+   using base = fon9::fmkt::Symb;
+public:
+   fon9::fmkt::SymbTwsBS   BS_;
+   fon9::fmkt::SymbDeal    Deal_;
+   fon9::fmkt::MdRtStream  MdRtStream_;
+
+   MdSymb(const fon9::StrView& symbid, fon9::fmkt::MdRtStreamInnMgr& innMgr)
+      : base{symbid}
+      , MdRtStream_{innMgr} {
+   }
+   fon9::fmkt::SymbData* GetSymbData(int tabid) override {
+      switch (tabid) {
+      case 0: return this;
+      case 1: return &this->BS_;
+      case 2: return &this->Deal_;
+      case 3: return &this->MdRtStream_;
+      }
+      return nullptr;
+   }
+   fon9::fmkt::SymbData* FetchSymbData(int tabid) override {
+      return this->GetSymbData(tabid);
+   }
+   static fon9::seed::LayoutSP MakeLayout() {
+      using namespace fon9::seed;
+      using namespace fon9::fmkt;
+      constexpr auto kTabFlag = TabFlag::NoSapling_NoSeedCommand_Writable;
+      return LayoutSP{new LayoutN(
+         fon9_MakeField(Symb, SymbId_, "Id"), TreeFlag::AddableRemovable | TreeFlag::Unordered,
+         TabSP{new Tab{fon9::Named{fon9_kCSTR_TabName_Base}, MakeFields(),               kTabFlag}},
+         TabSP{new Tab{fon9::Named{fon9_kCSTR_TabName_BS},   SymbTwsBS_MakeFields(),     kTabFlag}},
+         TabSP{new Tab{fon9::Named{fon9_kCSTR_TabName_Deal}, SymbTwsDeal_MakeFields(),   kTabFlag}},
+         TabSP{new Tab{fon9::Named{fon9_kCSTR_TabName_Rt},   MdRtStream::MakeFields(),   kTabFlag}}
+      )};
+   }
+};
+class MdSymbs : public fon9::fmkt::MdSymbsT<MdSymb> {
+   fon9_NON_COPY_NON_MOVE(MdSymbs);
+   using base = fon9::fmkt::MdSymbsT<MdSymb>;
+public:
+   MdSymbs() : base(MdSymb::MakeLayout(), std::string{}, EnAllowSubrTree) {
+   }
+   fon9::fmkt::SymbSP MakeSymb(const fon9::StrView& symbid) override {
+      return new MdSymb(symbid, this->RtInnMgr_);
+   }
+};
+using MdSymbsSP = fon9::intrusive_ptr<MdSymbs>;
+//--------------------------------------------------------------------------//
+/// 記錄訂閱者收到的即時訊息: "SymbId:RtsPackType".
+struct RtsRecorder {
+   std::mutex                 Mutex_;
+   std::vector<std::string>   Rts_;
+
+   void operator()(const fon9::seed::SeedNotifyArgs& e) {
+      if (e.NotifyKind_ != fon9::seed::SeedNotifyKind::StreamData)
+         return;
+      const std::string& gv = e.GetGridView();
+      std::string rts = e.KeyText_.ToString();
+      rts.push_back(':');
+      rts.append(std::to_string(gv.empty() ? -1 : static_cast<int>(static_cast<uint8_t>(gv[0]))));
+      std::lock_guard<std::mutex> lk{this->Mutex_};
+      this->Rts_.push_back(std::move(rts));
+   }
+   std::vector<std::string> MoveOut() {
+      std::lock_guard<std::mutex> lk{this->Mutex_};
+      std::vector<std::string> res{std::move(this->Rts_)};
+      this->Rts_.clear();
+      return res;
+   }
+};
+static std::string RtsStr(const char* symbid, f9sv_RtsPackType pkType) {
+   return std::string{symbid} + ":" + std::to_string(static_cast<int>(pkType));
+}
+static void CheckRts(const char* testName, std::vector<std::string> rts, std::vector<std::string> expected) {
+   std::cout << "[TEST ] " << testName << std::flush;
+   std::sort(rts.begin(), rts.end());
+   std::sort(expected.begin(), expected.end());
+   if (rts == expected) {
+      std::cout << "\r[OK   ]" << std::endl;
+      return;
+   }
+   std::cout << "|rts=";
+   for (const auto& s : rts)
+      std::cout << s << ';';
+   std::cout << "|expected=";
+   for (const auto& s : expected)
+      std::cout << s << ';';
+   std::cout << "\r[ERROR]" << std::endl;
+   abort();
+}
+static void PublishRts(MdSymbs& symbs, const char* symbid, f9sv_RtsPackType pkType) {
+   auto     symbsLk = symbs.SymbMap_.Lock();
+   MdSymb*  symb = static_cast<MdSymb*>(symbs.FetchSymb(symbsLk, fon9::StrView_cstr(symbid)).get());
+   fon9::RevBufferList rts{64};
+   fon9::RevPutBitv(rts, fon9_BitvV_NumberNull);
+   if (fon9::fmkt::GetMdRtsKind(pkType) == (f9sv_MdRtsKind_Base | f9sv_MdRtsKind_Ref))
+      symb->MdRtStream_.PublishAndSave(fon9::StrView_cstr(symbid), pkType, std::move(rts));
+   else
+      symb->MdRtStream_.Publish(fon9::StrView_cstr(symbid), pkType, fon9::DayTime::Null(), std::move(rts));
+}
+//--------------------------------------------------------------------------//
+int main() {
+#if defined(_MSC_VER) && defined(_DEBUG)
+   _CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+   fon9::AutoPrintTestInfo utinfo{"MdRtConflator"};
+
+   const auto                 kWaitConflate = std::chrono::milliseconds(300);
+   MdSymbsSP                  symbs{new MdSymbs};
+   RtsRecorder                recorder;
+   fon9::SubConn              subConn{};
+   // 用來檢查訂閱者(及其 Callback_)是否已釋放.
+   auto                       subrToken = std::make_shared<int>(0);
+   // 訂閱整棵樹: RtFilter=All, ConflateInterval=0.05 秒.
+   auto res = symbs->SubscribeStream(&subConn, *symbs->RtTab_, "MdRts:FFFF/0.05",
+                                     [&recorder, subrToken](const fon9::seed::SeedNotifyArgs& e) { recorder(e); });
+   if (res != fon9::seed::OpResult::no_error) {
+      std::cout << "[ERROR] SubscribeStream|res=" << static_cast<int>(res) << std::endl;
+      abort();
+   }
+   // -----
+   // 同一商品在合併間隔內的 UpdateBS、DealPack, 合併成一個 TabValues_NoInfoTime;
+   for (int L = 0; L < 10; ++L) {
+      PublishRts(*symbs, "2330", f9sv_RtsPackType_UpdateBS);
+      PublishRts(*symbs, "2330", f9sv_RtsPackType_DealPack);
+      PublishRts(*symbs, "2317", f9sv_RtsPackType_UpdateBS);
+   }
+   PublishRts(*symbs, "1101", f9sv_RtsPackType_DealBS);
+   CheckRts("Conflate: pending", recorder.MoveOut(), {});
+   std::this_thread::sleep_for(kWaitConflate);
+   CheckRts("Conflate: one TabValues per symbol", recorder.MoveOut(), {
+      RtsStr("2330", f9sv_RtsPackType_TabValues_NoInfoTime),
+      RtsStr("2317", f9sv_RtsPackType_TabValues_NoInfoTime),
+      RtsStr("1101", f9sv_RtsPackType_TabValues_NoInfoTime),
+   });
+   // 下一個合併間隔, 重新累積.
+   PublishRts(*symbs, "2330", f9sv_RtsPackType_UpdateBS);
+   PublishRts(*symbs, "2330", f9sv_RtsPackType_UpdateBS);
+   std::this_thread::sleep_for(kWaitConflate);
+   CheckRts("Conflate: next interval", recorder.MoveOut(), {
+      RtsStr("2330", f9sv_RtsPackType_TabValues_NoInfoTime),
+   });
+   // -----
+   // 非 BS、Deal 的即時訊息, 立即送出.
+   PublishRts(*symbs, "2330", f9sv_RtsPackType_BaseInfoTw);
+   PublishRts(*symbs, "2330", f9sv_RtsPackType_TradingSessionId);
+   CheckRts("Pass through: immediately", recorder.MoveOut(), {
+      RtsStr("2330", f9sv_RtsPackType_BaseInfoTw),
+      RtsStr("2330", f9sv_RtsPackType_TradingSessionId),
+   });
+   // -----
+   // 有等候送出的快照時取消訂閱, 到時不應再送出.
+   PublishRts(*symbs, "2330", f9sv_RtsPackType_UpdateBS);
+   PublishRts(*symbs, "2317", f9sv_RtsPackType_DealPack);
+   res = symbs->UnsubscribeStream(subConn, *symbs->RtTab_);
+   if (res != fon9::seed::OpResult::no_error) {
+      std::cout << "[ERROR] UnsubscribeStream|res=" << static_cast<int>(res) << std::endl;
+      abort();
+   }
+   // 取消訂閱時, 即使計時尚未到(或 TimerThread 已結束), 訂閱者也應立即釋放.
+   std::cout << "[TEST ] Unsubscribe: subscriber released" << std::flush;
+   if (subrToken.use_count() != 1) {
+      std::cout << "|use_count=" << subrToken.use_count() << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+   std::this_thread::sleep_for(kWaitConflate);
+   CheckRts("Unsubscribe: pending dropped", recorder.MoveOut(), {});
+}
@@ -21,8 +21,10 @@ seed::OpResult MdRtStream::SubscribeStream(SubConn*           pSubConn,
                                            SymbPodOp&         op,
                                            StrView            args,
                                            seed::FnSeedSubr&& subr) {
-   // args = "MdRts:F:F,RecoverTime"
+   // args = "MdRts:F/Interval:F,RecoverTime"
    // 1st F(hex) is MdRtsKind MdRtSubr.RtFilter_;
+   //   /Interval 可省略, MdRtSubr.ConflateInterval_: 合併(限速)訂閱, 例: "MdRts:F/0.2";
+   //   BS、Deal 的即時訊息, 最多每 Interval 送出一次最新快照(TabValues_NoInfoTime);
    // 2nd F(hex) is MdRtsKind MdRtRecover.Filter_;
    const StrView decoderName = StrFetchTrim(args, ':');
    if (decoderName != "MdRts")
@@ -124,21 +126,11 @@ void MdRtStream::BeforeRemove(SymbTree& tree, Symb& symb) {
    this->InnMgr_.MdSymbs_.UnsafePublish(f9sv_RtsPackType_Count, e);
 }
 // -----
-void MdRtStream::PublishUpdateBS(const StrView& keyText, SymbBSData& symbBS, RevBufferList&& rts) {
-   // 每秒儲存一次 SnapshotBS, 回補時才能正確處理 UpdateBS;
-   this->Publish(keyText, f9sv_RtsPackType_UpdateBS, symbBS.InfoTime_, std::move(rts));
-   const auto bstm = static_cast<uint32_t>(symbBS.InfoTime_.GetIntPart());
-   if (this->LastTimeSnapshotBS_ != bstm) {
-      this->LastTimeSnapshotBS_ = bstm;
-      rts.MoveOut();
-      symbBS.Flags_ |= f9sv_BSFlag_OrderBuy | f9sv_BSFlag_OrderSell | f9sv_BSFlag_DerivedBuy | f9sv_BSFlag_DerivedSell;
-      MdRtsPackSnapshotBS(rts, symbBS);
-      ToBitv(rts, symbBS.InfoTime_);
-      *rts.AllocPacket<uint8_t>() = cast_to_underlying(IsEnumContains(symbBS.Flags_, f9sv_BSFlag_Calculated)
-                                                       ? f9sv_RtsPackType_CalculatedBS
-                                                       : f9sv_RtsPackType_SnapshotBS);
-   }
-   this->Save(std::move(rts));
+void MdRtStream::PackSnapshotBSHead(RevBufferList& rts, DayTime infoTime, f9sv_BSFlag flags) {
+   ToBitv(rts, infoTime);
+   *rts.AllocPacket<uint8_t>() = cast_to_underlying(IsEnumContains(flags, f9sv_BSFlag_Calculated)
+                                                    ? f9sv_RtsPackType_CalculatedBS
+                                                    : f9sv_RtsPackType_SnapshotBS);
 }
 void MdRtStream::Publish(const StrView& keyText, f9sv_RtsPackType pkType, const DayTime infoTime, RevBufferList&& rts) {
    const auto rtsKind = GetMdRtsKind(pkType);
@@ -198,7 +190,12 @@ void MdRtStream::Save(RevBufferList&& rts) {
 }
 //--------------------------------------------------------------------------//
 void MdRtsNotifyArgs::MakeGridView() const {
-   this->CacheGV_ = BufferTo<std::string>(this->RtsForGvStr_);
+   this->CacheGV_ = BufferTo<std::string>(this->Rts_.cfront());
+}
+BufferList MdRtsNotifyArgs::GetGridViewShared() const {
+   if (!this->RtsShared_)
+      this->RtsShared_ = BufferShared::MakeCopy(this->Rts_.cfront());
+   return this->RtsShared_->MakeBufferList();
 }
 
 } } // namespaces
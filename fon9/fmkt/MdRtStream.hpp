@@ -3,6 +3,7 @@
 #ifndef __fon9_fmkt_MdRtStream_hpp__
 #define __fon9_fmkt_MdRtStream_hpp__
 #include "fon9/fmkt/MdRtStreamInn.hpp"
+#include "fon9/buffer/BufferShared.hpp"
 
 namespace fon9 { namespace fmkt {
 
@@ -19,6 +20,14 @@ class fon9_API MdRtStream : public SymbData {
    uint32_t          LastTimeSnapshotBS_{};
 
    void Save(RevBufferList&& rts);
+   bool IsNeedsSaveSnapshotBS(DayTime infoTime) {
+      const auto bstm = static_cast<uint32_t>(infoTime.GetIntPart());
+      if (this->LastTimeSnapshotBS_ == bstm)
+         return false;
+      this->LastTimeSnapshotBS_ = bstm;
+      return true;
+   }
+   static void PackSnapshotBSHead(RevBufferList& rts, DayTime infoTime, f9sv_BSFlag flags);
 
    seed::OpResult SubscribeStream(SubConn* pSubConn, seed::Tab& tabRt, SymbPodOp& op, StrView args, seed::FnSeedSubr&& subr);
    seed::OpResult UnsubscribeStream(SubConn subConn) {
@@ -71,7 +80,19 @@ public:
    /// 打包並發行:
    /// pkType + infoTime(Bitv,Null表示InfoTime沒變) + rts;
    void Publish(const StrView& keyText, f9sv_RtsPackType pkType, DayTime infoTime, RevBufferList&& rts);
-   void PublishUpdateBS(const StrView& keyText, SymbBSData& symbBS, RevBufferList&& rts);
+   /// 發行 UpdateBS, 並在需要時(每秒一次), 儲存 SnapshotBS, 回補時才能正確處理 UpdateBS;
+   /// - BSData = SymbTwfBSDataT<N> or SymbTwsBSDataT<N>;
+   template <class BSData>
+   void PublishUpdateBS(const StrView& keyText, BSData& symbBS, RevBufferList&& rts) {
+      this->Publish(keyText, f9sv_RtsPackType_UpdateBS, symbBS.InfoTime_, std::move(rts));
+      if (this->IsNeedsSaveSnapshotBS(symbBS.InfoTime_)) {
+         rts.MoveOut();
+         symbBS.Flags_ |= f9sv_BSFlag_OrderBuy | f9sv_BSFlag_OrderSell | f9sv_BSFlag_DerivedBuy | f9sv_BSFlag_DerivedSell;
+         MdRtsPackSnapshotBS(rts, symbBS);
+         PackSnapshotBSHead(rts, symbBS.InfoTime_, symbBS.Flags_);
+      }
+      this->Save(std::move(rts));
+   }
 
    /// 先把 pkType 打包進 rts: *rts.AllocPacket<uint8_t>() = cast_to_underlying(pkType);
    /// 然後: 發行 & 儲存.
@@ -81,13 +102,17 @@ public:
 class fon9_API MdRtsNotifyArgs : public seed::SeedNotifyArgs {
    fon9_NON_COPY_NON_MOVE(MdRtsNotifyArgs);
    using base = seed::SeedNotifyArgs;
+   RevBufferList&          Rts_;
+   mutable BufferSharedSP  RtsShared_;
 public:
-   const BufferNode* const RtsForGvStr_;
    MdRtsNotifyArgs(seed::Tree& tree, const StrView& keyText, f9sv_MdRtsKind rtsKind, RevBufferList& rts)
       : base(tree, nullptr/*tab*/, keyText, rtsKind)
-      , RtsForGvStr_{rts.cfront()} {
+      , Rts_(rts) {
    }
    void MakeGridView() const override;
+   /// 第一次呼叫時, 將 rts 的內容複製一次到 BufferShared, 之後的訂閱者都共用此份資料, 不用再複製.
+   /// - rts 的內容不變, 所以發行者在發行後, 仍可繼續使用 rts(例: MdRtStream::Save()).
+   BufferList GetGridViewShared() const override;
 };
 
 } } // namespaces
@@ -8,7 +8,97 @@
 
 namespace fon9 { namespace fmkt {
 
+MdRtSubr::MdRtSubr(seed::FnSeedSubr&& sub, StrView* args)
+   : RtFilter_{StrToMdRtsKind(args)}
+   , Callback_{std::move(sub)} {
+   if (StrTrimHead(args).Get1st() == '/') {
+      StrTrimHead(args, args->begin() + 1);
+      this->ConflateInterval_ = StrTo(args, TimeInterval{});
+   }
+}
 MdRtSubr::~MdRtSubr() {
+   // 若有 PendingSubr_ 則不會來到此處, 所以只要停止計時即可.
+   if (this->Conflator_)
+      this->Conflator_->DisposeNoWait();
+}
+void MdRtSubr::SetUnsubscribed() {
+   this->RtFilter_ = f9sv_MdRtsKind{};
+   if (this->Conflator_)
+      this->Conflator_->Dispose();
+}
+void MdRtSubr::Conflate(const seed::SeedNotifyArgs& e) {
+   assert(static_cast<SymbTree*>(&e.Tree_)->SymbMap_.IsLocked());
+   if (!this->Conflator_) {
+      // MdRtStream、MdSymbsBase 的即時訊息, e.Tree_ 必定為 MdSymbsBase;
+      MdSymbsBase&  mdSymbs = *static_cast<MdSymbsBase*>(&e.Tree_);
+      TimerThreadSP thr = mdSymbs.RtInnMgr_.RecoverThread_;
+      this->Conflator_.reset(new MdRtConflator(mdSymbs, thr ? std::move(thr) : GetDefaultTimerThread()));
+   }
+   this->Conflator_->Mark(*this, e.KeyText_, static_cast<f9sv_MdRtsKind>(e.StreamDataKind_));
+}
+//--------------------------------------------------------------------------//
+static void PackConflateTab(RevBuffer& rts, const seed::Tab* tab, Symb& symb) {
+   if (tab == nullptr)
+      return;
+   if (const SymbData* dat = symb.GetSymbData(tab->GetIndex()))
+      MdRtsPackTabValues(rts, *tab, *dat);
+}
+MdRtConflator::~MdRtConflator() {
+}
+void MdRtConflator::Mark(MdRtSubr& subr, const StrView& keyText, f9sv_MdRtsKind rtsKind) {
+   auto ifind = this->Pending_.find(CharVector::MakeRef(keyText));
+   if (ifind != this->Pending_.end()) {
+      ifind->second |= rtsKind;
+      return;
+   }
+   this->Pending_.emplace(CharVector{keyText}, rtsKind);
+   if (this->PendingSubr_)
+      return;
+   this->PendingSubr_.reset(&subr);
+   this->RunAfter(subr.ConflateInterval_);
+}
+void MdRtConflator::Dispose() {
+   this->DisposeNoWait();
+   this->Pending_.clear();
+   // 呼叫端(MdRtSubr::SetUnsubscribed()) 仍保有 MdRtSubr, 所以這裡釋放 PendingSubr_ 不會造成 this 被刪除.
+   this->PendingSubr_.reset();
+}
+void MdRtConflator::OnTimer(TimeStamp now) {
+   (void)now;
+   auto       symbsLk = this->MdSymbs_.SymbMap_.ConstLock();
+   MdRtSubrSP subr{std::move(this->PendingSubr_)};
+   PendingMap pending{std::move(this->Pending_)};
+   this->Pending_.clear();
+   if (!subr || subr->IsUnsubscribed())
+      return;
+   seed::Layout&  layout = *this->MdSymbs_.LayoutSP_;
+   const seed::Tab* tabBS = layout.GetTab(fon9_kCSTR_TabName_BS);
+   const seed::Tab* tabsDeal[] = {
+      layout.GetTab(fon9_kCSTR_TabName_Deal),
+      layout.GetTab(fon9_kCSTR_TabName_Open),
+      layout.GetTab(fon9_kCSTR_TabName_High),
+      layout.GetTab(fon9_kCSTR_TabName_Low),
+   };
+   for (auto& ipend : pending) {
+      auto isymb = symbsLk->find(ToStrView(ipend.first));
+      if (isymb == symbsLk->end()) // 商品已移除, 已經送過 PodRemoved, 不用再送快照.
+         continue;
+      Symb&          symb = *isymb->second;
+      RevBufferList  rts{256};
+      if (IsEnumContains(ipend.second, f9sv_MdRtsKind_BS))
+         PackConflateTab(rts, tabBS, symb);
+      if (IsEnumContains(ipend.second, f9sv_MdRtsKind_Deal)) {
+         for (const seed::Tab* tab : tabsDeal)
+            PackConflateTab(rts, tab, symb);
+      }
+      if (rts.cfront() == nullptr)
+         continue;
+      *rts.AllocPacket<uint8_t>() = cast_to_underlying(f9sv_RtsPackType_TabValues_NoInfoTime);
+      MdRtsNotifyArgs e{this->MdSymbs_, ToStrView(symb.SymbId_), GetMdRtsKind(f9sv_RtsPackType_TabValues_NoInfoTime), rts};
+      subr->Callback_(e);
+      if (subr->IsUnsubscribed()) // 在 Callback_ 裡面取消訂閱了.
+         return;
+   }
 }
 //--------------------------------------------------------------------------//
 MdRtStreamInnMgr::MdRtStreamInnMgr(MdSymbsBase& symbs, std::string rtiPathFmt)
@@ -7,6 +7,7 @@
 #include "fon9/buffer/RevBufferList.hpp"
 #include "fon9/InnApf.hpp"
 #include "fon9/Timer.hpp"
+#include <unordered_map>
 
 namespace fon9 { namespace fmkt {
 
@@ -50,23 +51,42 @@ public:
    InnApf::OpenResult RtOpen(InnApf::StreamRW& rw, const Symb& symb);
 };
 //--------------------------------------------------------------------------//
+class fon9_API MdRtConflator;
+using MdRtConflatorSP = intrusive_ptr<MdRtConflator>;
+
 struct fon9_API MdRtSubr : public intrusive_ref_counter<MdRtSubr> {
    f9sv_MdRtsKind    RtFilter_{f9sv_MdRtsKind_All};
+   /// 合併(限速)訂閱的最短送出間隔, IsNullOrZero() 表示不合併: 每個即時訊息都立即送出.
+   TimeInterval      ConflateInterval_;
    seed::FnSeedSubr  Callback_;
-   /// 從 args 取出 RtFiller_ = f9sv_MdRtsKind(hex): empty() or 0 表示訂閱全部的即時訊息;
+   /// 合併訂閱: 在第一個需要合併的即時訊息到達時建立.
+   MdRtConflatorSP   Conflator_;
+
+   /// 從 args 取出 "F/Interval":
+   /// - RtFiller_ = f9sv_MdRtsKind(hex): empty() or 0 表示訂閱全部的即時訊息;
+   /// - 若有 '/' 則後面接著 ConflateInterval_, 例: "F/0.2" 表示 BS、Deal 最多每 0.2 秒送出一次;
    /// 並移動 args->begin() 到後面的參數位置.
-   MdRtSubr(seed::FnSeedSubr&& sub, StrView* args)
-      : RtFilter_{StrToMdRtsKind(args)}
-      , Callback_{std::move(sub)} {
-   }
+   MdRtSubr(seed::FnSeedSubr&& sub, StrView* args);
    virtual ~MdRtSubr();
 
    bool IsUnsubscribed() const {
       return this->RtFilter_ == f9sv_MdRtsKind{};
    }
-   void SetUnsubscribed() {
-      this->RtFilter_ = f9sv_MdRtsKind{};
+   /// 呼叫前必須: lock tree;
+   /// 若有合併訂閱, 則同時 MdRtConflator::Dispose(): 停止計時, 並解除與 Conflator_ 的互相參考.
+   void SetUnsubscribed();
+   /// 合併訂閱時, 此次的即時訊息是否需要合併?
+   /// - 只有 BS、Deal 的即時訊息(UpdateBS, SnapshotBS, DealPack, DealBS...)會合併,
+   ///   其餘(例: TradingSessionId, BaseInfo, PodRemoved...)仍立即送出.
+   bool IsNeedsConflate(const seed::SeedNotifyArgs& e) const {
+      return !this->ConflateInterval_.IsNullOrZero()
+         && e.NotifyKind_ == seed::SeedNotifyKind::StreamData
+         && !seed::IsTextBeginOrEnd(e.KeyText_)
+         && (e.StreamDataKind_ & ~static_cast<uintmax_t>(f9sv_MdRtsKind_Deal | f9sv_MdRtsKind_BS)) == 0;
    }
+   /// 呼叫前必須: lock tree;
+   /// 記錄 e.KeyText_ 有異動, 等候 ConflateInterval_ 到時, 送出該商品最新的 BS、Deal 快照.
+   void Conflate(const seed::SeedNotifyArgs& e);
 };
 struct MdRtSubrSP : public intrusive_ptr<MdRtSubr> {
    using base = intrusive_ptr<MdRtSubr>;
@@ -75,8 +95,12 @@ struct MdRtSubrSP : public intrusive_ptr<MdRtSubr> {
    void operator()(const seed::SeedNotifyArgs& e) const {
       assert(static_cast<SymbTree*>(&e.Tree_)->SymbMap_.IsLocked());
       assert(!this->get()->IsUnsubscribed());
-      if (IsEnumContainsAny(this->get()->RtFilter_, static_cast<f9sv_MdRtsKind>(e.StreamDataKind_)))
-         this->get()->Callback_(e);
+      if (IsEnumContainsAny(this->get()->RtFilter_, static_cast<f9sv_MdRtsKind>(e.StreamDataKind_))) {
+         if (fon9_UNLIKELY(this->get()->IsNeedsConflate(e)))
+            this->get()->Conflate(e);
+         else
+            this->get()->Callback_(e);
+      }
    }
 };
 using MdRtUnsafeSubj = seed::UnsafeSeedSubjT<MdRtSubrSP>;
@@ -142,5 +166,43 @@ private:
 };
 using MdRtRecoverSP = intrusive_ptr<MdRtRecover>;
 
+//--------------------------------------------------------------------------//
+/// 合併(限速)訂閱: 慢速的訂閱者(例: 網路較慢的 WebSocket 或 rc client), 若訂閱大量商品,
+/// 則即時訊息可能會在 SendBuffer 無限制的累積.
+/// - 合併期間內, 同一商品的 BS、Deal 異動, 只記錄「有異動」;
+/// - 到時, 使用 f9sv_RtsPackType_TabValues_NoInfoTime 送出該商品最新的 BS、Deal(及 Open、High、Low) Tab;
+/// - 所以占用的記憶體上限為「商品數量」, 每個合併間隔最多每個商品送出一次快照.
+/// - 所有的操作必定處在 lock tree 狀態.
+class fon9_API MdRtConflator : public TimerEntry {
+   fon9_NON_COPY_NON_MOVE(MdRtConflator);
+   using base = TimerEntry;
+   friend struct MdRtSubr;
+   MdSymbsBase&   MdSymbs_;
+   /// 有等候送出的快照時, 才保留訂閱者, 送出後就釋放,
+   /// 避免 MdRtSubr.Conflator_ 與 this 互相參考, 造成無法釋放.
+   MdRtSubrSP     PendingSubr_;
+   /// 有異動的商品 => 異動的種類(f9sv_MdRtsKind_BS, f9sv_MdRtsKind_Deal);
+   using PendingMap = std::unordered_map<CharVector, f9sv_MdRtsKind>;
+   PendingMap     Pending_;
+
+   void OnTimer(TimeStamp now) override;
+   void Mark(MdRtSubr& subr, const StrView& keyText, f9sv_MdRtsKind rtsKind);
+   /// 停止計時, 並清除 PendingSubr_, Pending_;
+   /// 若 TimerThread 已先結束, OnTimer() 不會再被觸發, 必須在此解除 PendingSubr_ 的參考, 否則無法釋放.
+   void Dispose();
+
+public:
+   MdRtConflator(MdSymbsBase& mdSymbs, TimerThreadSP timerThread)
+      : base{std::move(timerThread)}
+      , MdSymbs_(mdSymbs) {
+   }
+   ~MdRtConflator();
+
+   /// 等候送出快照的商品數量.
+   size_t GetPendingCount() const {
+      return this->Pending_.size();
+   }
+};
+
 } } // namespaces
 #endif//__fon9_fmkt_MdRtStreamInn_hpp__
@@ -52,33 +52,41 @@ static bool MdRtsPackSingleBS(RevBuffer& rbuf, RtBSType bsType, const PriQty& pq
    return true;
 }
 
-/// 將委託簿「買方 or 賣方」的 pqs[SymbBS::kBSCount] 填入 rbuf;
-static bool MdRtsPackOrderBS(RevBuffer& rbuf, RtBSType bsType, const PriQty* pqs) {
-   unsigned bsCount = 0;
-   for (bsCount = 0; bsCount < SymbBSData::kBSCount; ++bsCount) {
+/// 將委託簿「買方 or 賣方」的 pqs[bsCount] 填入 rbuf;
+static bool MdRtsPackOrderBS(RevBuffer& rbuf, RtBSType bsType, const PriQty* pqs, unsigned bsCount) {
+   unsigned count;
+   for (count = 0; count < bsCount; ++count) {
       if (pqs->Qty_ == 0)
          break;
       ToBitv(rbuf, pqs->Qty_);
       ToBitv(rbuf, pqs->Pri_);
       ++pqs;
    }
-   if (bsCount == 0)
+   if (count == 0)
       return false;
-   *rbuf.AllocPacket<uint8_t>() = static_cast<uint8_t>(cast_to_underlying(bsType) | (bsCount - 1));
    static_assert(sizeof(bsType) == 1, "");
+   --count;
+   if (fon9_LIKELY(count <= kRtBSSnapshotCountMask)) {
+      *rbuf.AllocPacket<uint8_t>() = static_cast<uint8_t>(cast_to_underlying(bsType) | count);
+      return true;
+   }
+   assert(count < kSymbBSCountMax);
+   *rbuf.AllocPacket<uint8_t>() = static_cast<uint8_t>(count);
+   *rbuf.AllocPacket<uint8_t>() = static_cast<uint8_t>(cast_to_underlying(bsType) | kRtBSSnapshotCountExt);
    return true;
 }
 
-fon9_API void MdRtsPackSnapshotBS(RevBuffer& rbuf, const SymbBSData& symbBS) {
-   const auto  curFlags = symbBS.Flags_;
-   if (IsEnumContains(curFlags, f9sv_BSFlag_DerivedSell))
-      MdRtsPackSingleBS(rbuf, RtBSType::DerivedSell, static_cast<const SymbTwfBSData*>(&symbBS)->DerivedSell_);
-   if (IsEnumContains(curFlags, f9sv_BSFlag_DerivedBuy))
-      MdRtsPackSingleBS(rbuf, RtBSType::DerivedBuy, static_cast<const SymbTwfBSData*>(&symbBS)->DerivedBuy_);
-   if (IsEnumContains(curFlags, f9sv_BSFlag_OrderSell))
-      MdRtsPackOrderBS(rbuf, RtBSType::OrderSell, symbBS.Sells_);
-   if (IsEnumContains(curFlags, f9sv_BSFlag_OrderBuy))
-      MdRtsPackOrderBS(rbuf, RtBSType::OrderBuy, symbBS.Buys_);
+fon9_API void MdRtsPackSnapshotBS(RevBuffer& rbuf, f9sv_BSFlag flags, unsigned bsCount,
+                                  const PriQty* sells, const PriQty* buys,
+                                  const PriQty* derivedSell, const PriQty* derivedBuy) {
+   if (derivedSell && IsEnumContains(flags, f9sv_BSFlag_DerivedSell))
+      MdRtsPackSingleBS(rbuf, RtBSType::DerivedSell, *derivedSell);
+   if (derivedBuy && IsEnumContains(flags, f9sv_BSFlag_DerivedBuy))
+      MdRtsPackSingleBS(rbuf, RtBSType::DerivedBuy, *derivedBuy);
+   if (IsEnumContains(flags, f9sv_BSFlag_OrderSell))
+      MdRtsPackOrderBS(rbuf, RtBSType::OrderSell, sells, bsCount);
+   if (IsEnumContains(flags, f9sv_BSFlag_OrderBuy))
+      MdRtsPackOrderBS(rbuf, RtBSType::OrderBuy, buys, bsCount);
 }
 
 fon9_API void MdRtsPackTabValues(RevBuffer& rbuf, const seed::Tab& tab, const SymbData& dat) {
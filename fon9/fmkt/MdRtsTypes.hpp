@@ -2,7 +2,7 @@
 // \author fonwinz@gmail.com
 #ifndef __fon9_fmkt_MdRtsTypes_hpp__
 #define __fon9_fmkt_MdRtsTypes_hpp__
-#include "fon9/fmkt/FmktTypes.hpp"
+#include "fon9/fmkt/SymbBSData.hpp"
 #include "fon9/fmkt/FmdRtsPackType.h"
 #include "fon9/seed/Tab.hpp"
 #include "fon9/TimeStamp.hpp"
@@ -50,11 +50,53 @@ enum class RtBSAction : uint8_t {
    ChangePQ = 0x80,
    ChangeQty = 0xc0,
 };
+enum : uint8_t {
+   /// SnapshotBS 的 first: Count 4 bits 的遮罩.
+   kRtBSSnapshotCountMask = 0x0f,
+   /// SnapshotBS 的 first: 若有此旗標, 則 first 之後的 1 byte 為 Count-1; 用於超過 16 檔的委託簿.
+   kRtBSSnapshotCountExt = 0x40,
+   /// UpdateBS 的 type: Level 4 bits 的遮罩.
+   kRtBSLevelMask = 0x0f,
+   /// UpdateBS 的 type: 若 (type & kRtBSLevelMask) == kRtBSLevelExt, 則 type 之後的 1 byte 為 Level;
+   kRtBSLevelExt = 0x0f,
+};
+static_assert((kRtBSSnapshotCountExt & (cast_to_underlying(RtBSType::Mask) | kRtBSSnapshotCountMask | 0x80)) == 0,
+              "kRtBSSnapshotCountExt conflicts with RtBSType or Count.");
+
+/// 將 UpdateBS 的 [type + Level] 填入 pout, 傳回使用的 bytes 數量(1 or 2).
+/// - bsType = RtBSType | RtBSAction;
+/// - lv < kRtBSLevelExt: 使用 1 byte;
+/// - 否則使用 2 bytes: [bsType | kRtBSLevelExt][lv];
+inline unsigned MdRtsPutUpdateBSType(byte* pout, uint8_t bsType, unsigned lv) {
+   assert(lv < kSymbBSCountMax);
+   if (fon9_LIKELY(lv < kRtBSLevelExt)) {
+      *pout = static_cast<byte>(bsType | lv);
+      return 1;
+   }
+   pout[0] = static_cast<byte>(bsType | kRtBSLevelExt);
+   pout[1] = static_cast<byte>(lv);
+   return 2;
+}
 //--------------------------------------------------------------------------//
 class SymbData;
-struct SymbBSData;
 
-fon9_API void MdRtsPackSnapshotBS(RevBuffer& rbuf, const SymbBSData& symbBS);
+/// 打包委託簿快照, 不含 InfoTime 及 f9sv_RtsPackType.
+/// - 依照 flags 打包: f9sv_BSFlag_OrderSell, f9sv_BSFlag_OrderBuy, f9sv_BSFlag_DerivedSell, f9sv_BSFlag_DerivedBuy;
+/// - derivedSell, derivedBuy 可為 nullptr, 表示不支援衍生買賣.
+/// - sells, buys 的數量為 bsCount, 若 bsCount > 16, 則可能使用 kRtBSSnapshotCountExt 格式.
+fon9_API void MdRtsPackSnapshotBS(RevBuffer& rbuf, f9sv_BSFlag flags, unsigned bsCount,
+                                  const PriQty* sells, const PriQty* buys,
+                                  const PriQty* derivedSell, const PriQty* derivedBuy);
+
+template <unsigned kBSCountN>
+inline void MdRtsPackSnapshotBS(RevBuffer& rbuf, const SymbTwfBSDataT<kBSCountN>& symbBS) {
+   MdRtsPackSnapshotBS(rbuf, symbBS.Flags_, kBSCountN, symbBS.Sells_, symbBS.Buys_,
+                       &symbBS.DerivedSell_, &symbBS.DerivedBuy_);
+}
+template <unsigned kBSCountN>
+inline void MdRtsPackSnapshotBS(RevBuffer& rbuf, const SymbTwsBSDataT<kBSCountN>& symbBS) {
+   MdRtsPackSnapshotBS(rbuf, symbBS.Flags_, kBSCountN, symbBS.Sells_, symbBS.Buys_, nullptr, nullptr);
+}
 
 /// 用 f9sv_RtsPackType_TabValues 格式打包 dat.
 /// - 「不包含」最後的 *rbuf.AllocPacket<uint8_t>() = cast_to_underlying(f9sv_RtsPackType_TabValues);
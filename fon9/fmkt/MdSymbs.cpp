@@ -150,8 +150,9 @@ void MdSymbsBase::UnsafePublish(f9sv_RtsPackType pkType, seed::SeedNotifyArgs& e
 seed::OpResult MdSymbsBase::SubscribeStream(SubConn* pSubConn, seed::Tab& tab, StrView args, seed::FnSeedSubr&& fnSubr) {
    if (!(this->EnAllows_ & EnAllowSubrTree) || &tab != this->RtTab_)
       return seed::SubscribeStreamUnsupported(pSubConn);
-   // args = "MdRts:F,S"
+   // args = "MdRts:F/Interval,S"
    // F(hex) = MdRtsKind MdRtSubr.RtFilter_;
+   // /Interval = 可省略, MdRtSubr.ConflateInterval_: 合併(限速)訂閱, 例: "MdRts:F/0.5,S";
    // 'S' = get all SnapshotSymb; 建構時必須提供 EnAllowSubrSnapshotSymb 旗標;
    const StrView decoderName = StrFetchTrim(args, ':');
    if (decoderName != "MdRts")
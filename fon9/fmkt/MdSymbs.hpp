@@ -28,8 +28,12 @@ class fon9_API MdSymbsBase : public SymbTree {
          assert(static_cast<SymbTree*>(&e.Tree_)->SymbMap_.IsLocked());
          assert(!this->get()->IsUnsubscribed());
          auto& symbs = this->get()->SymbsRecovering_;
-         if (symbs.empty() || symbs.find(e.KeyText_) == symbs.end())
-            this->get()->Callback_(e);
+         if (symbs.empty() || symbs.find(e.KeyText_) == symbs.end()) {
+            if (fon9_UNLIKELY(this->get()->IsNeedsConflate(e)))
+               this->get()->Conflate(e);
+            else
+               this->get()->Callback_(e);
+         }
       }
    };
    using UnsafeSubj = seed::UnsafeSeedSubjT<SymbsSubrSP>;
@@ -2,52 +2,53 @@
 // \author fonwinz@gmail.com
 #include "fon9/fmkt/SymbBS.hpp"
 #include "fon9/seed/FieldMaker.hpp"
+#include "fon9/ToStr.hpp"
 
 namespace fon9 { namespace fmkt {
 
-static void SymbBS_MakeFields(int ofsadj, seed::Fields& flds) {
+/// 檔位名稱: ch + (idx+1) + ('P' or 'Q'); 例: "S1P", "B10Q";
+static void AppendPQ(seed::Fields& flds, char ch, unsigned idx, int32_t ofs) {
+   NumOutBuf   nbuf;
+   char* const pend = nbuf.end();
+   char*       pbeg = ToStrRev(pend - 1, idx + 1);
+   *--pbeg = ch;
+   const StrView fldName{pbeg, pend};
+   PriQty* const pq = reinterpret_cast<PriQty*>(0x1000);
+   *(pend - 1) = 'P';
+   flds.Add(seed::MakeField(Named(fldName.ToString()), ofs + static_cast<int32_t>(fon9_OffsetOf(PriQty, Pri_)), pq->Pri_));
+   *(pend - 1) = 'Q';
+   flds.Add(seed::MakeField(Named(fldName.ToString()), ofs + static_cast<int32_t>(fon9_OffsetOf(PriQty, Qty_)), pq->Qty_));
+}
+fon9_API void SymbBS_MakeFields(int ofsadj, unsigned bsCount, int32_t ofsSells, int32_t ofsBuys, seed::Fields& flds) {
    flds.Add(fon9_MakeField_OfsAdj(ofsadj, SymbBSData, InfoTime_, "InfoTime"));
-   char bsPriName[] = "-nP";
-   char bsQtyName[] = "-nQ";
-   int  idx;
-   bsPriName[0] = bsQtyName[0] = 'S';
-   for (idx = SymbBSData::kBSCount - 1; idx >= 0; --idx) {
-      bsPriName[1] = bsQtyName[1] = static_cast<char>(idx + '1');
-      flds.Add(fon9_MakeField_OfsAdj(ofsadj, SymbBSData, Sells_[idx].Pri_, bsPriName));
-      flds.Add(fon9_MakeField_OfsAdj(ofsadj, SymbBSData, Sells_[idx].Qty_, bsQtyName));
-   }
-   bsPriName[0] = bsQtyName[0] = 'B';
-   for (idx = 0; idx < SymbBSData::kBSCount; ++idx) {
-      bsPriName[1] = bsQtyName[1] = static_cast<char>(idx + '1');
-      flds.Add(fon9_MakeField_OfsAdj(ofsadj, SymbBSData, Buys_[idx].Pri_, bsPriName));
-      flds.Add(fon9_MakeField_OfsAdj(ofsadj, SymbBSData, Buys_[idx].Qty_, bsQtyName));
+   for (unsigned idx = bsCount; idx > 0;) {
+      --idx;
+      AppendPQ(flds, 'S', idx, ofsadj + ofsSells + static_cast<int32_t>(idx * sizeof(PriQty)));
    }
+   for (unsigned idx = 0; idx < bsCount; ++idx)
+      AppendPQ(flds, 'B', idx, ofsadj + ofsBuys + static_cast<int32_t>(idx * sizeof(PriQty)));
    flds.Add(seed::FieldSP{new seed::FieldIntHx<underlying_type_t<f9sv_BSFlag>>(
       Named("Flags"), ofsadj + fon9_OffsetOfRawPointer(SymbBSData, Flags_))});
 }
-static void AppendLmtFlags(int ofsadj, seed::Fields& flds) {
+fon9_API void SymbBS_AppendLmtFlags(int ofsadj, seed::Fields& flds) {
    flds.Add(seed::FieldSP{new seed::FieldIntHx<underlying_type_t<f9sv_BSLmtFlag>>(
       Named("LmtFlags"), ofsadj + fon9_OffsetOfRawPointer(SymbBSData, LmtFlags_))});
 }
+fon9_API void SymbBS_AppendDerived(int ofsDerivedSell, int ofsDerivedBuy, seed::Fields& flds) {
+   PriQty* const pq = reinterpret_cast<PriQty*>(0x1000);
+   flds.Add(seed::MakeField(Named("DS1P"), ofsDerivedSell + static_cast<int32_t>(fon9_OffsetOf(PriQty, Pri_)), pq->Pri_));
+   flds.Add(seed::MakeField(Named("DS1Q"), ofsDerivedSell + static_cast<int32_t>(fon9_OffsetOf(PriQty, Qty_)), pq->Qty_));
+   flds.Add(seed::MakeField(Named("DB1P"), ofsDerivedBuy + static_cast<int32_t>(fon9_OffsetOf(PriQty, Pri_)), pq->Pri_));
+   flds.Add(seed::MakeField(Named("DB1Q"), ofsDerivedBuy + static_cast<int32_t>(fon9_OffsetOf(PriQty, Qty_)), pq->Qty_));
+}
 fon9_API seed::Fields SymbTwsBS_MakeFields() {
-   seed::Fields flds;
-   SymbBS_MakeFields(fon9_OffsetOf(SymbTwsBS, Data_), flds);
-   AppendLmtFlags(fon9_OffsetOf(SymbTwsBS, Data_), flds);
-   return flds;
+   return SymbTwsBST_MakeFields<SymbBSData::kBSCount>();
 }
 fon9_API seed::Fields SymbTwfBS_MakeFields() {
-   seed::Fields flds;
-   SymbBS_MakeFields(fon9_OffsetOf(SymbTwfBS, Data_), flds);
-   flds.Add(fon9_MakeField(SymbTwfBS, Data_.DerivedSell_.Pri_, "DS1P"));
-   flds.Add(fon9_MakeField(SymbTwfBS, Data_.DerivedSell_.Qty_, "DS1Q"));
-   flds.Add(fon9_MakeField(SymbTwfBS, Data_.DerivedBuy_.Pri_,  "DB1P"));
-   flds.Add(fon9_MakeField(SymbTwfBS, Data_.DerivedBuy_.Qty_,  "DB1Q"));
-   return flds;
+   return SymbTwfBST_MakeFields<SymbBSData::kBSCount>();
 }
 fon9_API seed::Fields SymbTwaBS_MakeFields() {
-   seed::Fields flds = SymbTwfBS_MakeFields();
-   AppendLmtFlags(fon9_OffsetOf(SymbTwfBS, Data_), flds);
-   return flds;
+   return SymbTwaBST_MakeFields<SymbBSData::kBSCount>();
 }
 
 SymbBSTabDy::SymbDataSP SymbBSTabDy::FetchSymbData(Symb&) {
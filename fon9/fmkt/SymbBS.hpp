@@ -12,6 +12,52 @@ namespace fon9 { namespace fmkt {
 fon9_API_TEMPLATE_CLASS(SymbTwsBS, SimpleSymbData, SymbTwsBSData);
 fon9_API_TEMPLATE_CLASS(SymbTwfBS, SimpleSymbData, SymbTwfBSData);
 
+template <unsigned kBSCountN>
+using SymbTwsBST = SimpleSymbData<SymbTwsBSDataT<kBSCountN>>;
+template <unsigned kBSCountN>
+using SymbTwfBST = SimpleSymbData<SymbTwfBSDataT<kBSCountN>>;
+
+/// 建立委託簿欄位: InfoTime, S{bsCount}P, S{bsCount}Q...S1P, S1Q, B1P, B1Q...B{bsCount}P, B{bsCount}Q, Flags;
+/// \param ofsadj  SymbBSDataT<> 在 Raw 裡面的位置.
+/// \param ofsSells, ofsBuys  Sells_[], Buys_[] 在 SymbBSDataT<> 裡面的位置.
+fon9_API void SymbBS_MakeFields(int ofsadj, unsigned bsCount, int32_t ofsSells, int32_t ofsBuys, seed::Fields& flds);
+fon9_API void SymbBS_AppendLmtFlags(int ofsadj, seed::Fields& flds);
+fon9_API void SymbBS_AppendDerived(int ofsDerivedSell, int ofsDerivedBuy, seed::Fields& flds);
+
+template <class SymbBST>
+inline void SymbBST_MakeFields(seed::Fields& flds) {
+   // SymbBSDataT<> 的 InfoTime_, Flags_, LmtFlags_ 位於 Sells_[] 之前, 位置與 kBSCount 無關.
+   using BSData = typename SymbBST::Data;
+   SymbBS_MakeFields(static_cast<int>(fon9_OffsetOf(SymbBST, Data_)), BSData::kBSCount,
+                     static_cast<int32_t>(fon9_OffsetOf(BSData, Sells_)),
+                     static_cast<int32_t>(fon9_OffsetOf(BSData, Buys_)), flds);
+}
+/// 不包含「衍生買賣」, 包含 LmtFlags.
+template <unsigned kBSCountN>
+inline seed::Fields SymbTwsBST_MakeFields() {
+   seed::Fields flds;
+   SymbBST_MakeFields<SymbTwsBST<kBSCountN>>(flds);
+   SymbBS_AppendLmtFlags(static_cast<int>(fon9_OffsetOf(SymbTwsBST<kBSCountN>, Data_)), flds);
+   return flds;
+}
+/// 包含「衍生買賣」, 不包含 LmtFlags.
+template <unsigned kBSCountN>
+inline seed::Fields SymbTwfBST_MakeFields() {
+   using SymbBST = SymbTwfBST<kBSCountN>;
+   seed::Fields flds;
+   SymbBST_MakeFields<SymbBST>(flds);
+   SymbBS_AppendDerived(static_cast<int>(fon9_OffsetOf(SymbBST, Data_.DerivedSell_)),
+                        static_cast<int>(fon9_OffsetOf(SymbBST, Data_.DerivedBuy_)), flds);
+   return flds;
+}
+/// 包含「衍生買賣」, 包含 LmtFlags.
+template <unsigned kBSCountN>
+inline seed::Fields SymbTwaBST_MakeFields() {
+   seed::Fields flds = SymbTwfBST_MakeFields<kBSCountN>();
+   SymbBS_AppendLmtFlags(static_cast<int>(fon9_OffsetOf(SymbTwfBST<kBSCountN>, Data_)), flds);
+   return flds;
+}
+
 /// 不包含「衍生買賣」, 包含 LmtFlags.
 fon9_API seed::Fields SymbTwsBS_MakeFields();
 /// 包含「衍生買賣」, 不包含 LmtFlags.
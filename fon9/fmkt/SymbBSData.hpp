@@ -10,18 +10,48 @@ fon9_ENABLE_ENUM_BITWISE_OP(f9sv_BSFlag);
 
 namespace fon9 { namespace fmkt {
 
-struct SymbBSData {
+/// 委託簿的最大檔數: 受限於 MdRts 的編碼(Level, Count 使用 1 byte).
+constexpr unsigned kSymbBSCountMax = 256;
+
+/// 在 pqs[lv] 插入一檔: 原本的 pqs[lv..count-2] 往後移一檔, pqs[count-1] 被移出.
+/// - 返回後 pqs[lv] 仍為舊值, 由呼叫端填入新的價量.
+/// - 呼叫端必須確定 lv < count;
+/// - 使用 memmove(): 與「固定執行 count-1 次、不依 lv 分支」的複製比較,
+///   在 5..20 檔時 memmove() 仍較快, 請參考 fon9/fmkt/SymbBS_UT.cpp 的評估.
+inline void SymbBS_InsertLevel(PriQty* pqs, unsigned count, unsigned lv) {
+   assert(lv < count);
+   memmove(pqs + lv + 1, pqs + lv, (count - lv - 1) * sizeof(*pqs));
+}
+/// 刪除 pqs[lv]: 原本的 pqs[lv+1..count-1] 往前移一檔, 清除 pqs[count-1];
+/// - 呼叫端必須確定 lv < count;
+inline void SymbBS_DeleteLevel(PriQty* pqs, unsigned count, unsigned lv) {
+   assert(lv < count);
+   memmove(pqs + lv, pqs + lv + 1, (count - lv - 1) * sizeof(*pqs));
+   pqs[count - 1] = PriQty{};
+}
+template <unsigned kBSCountN>
+inline void SymbBS_InsertLevel(PriQty (&pqs)[kBSCountN], unsigned lv) {
+   SymbBS_InsertLevel(pqs, kBSCountN, lv);
+}
+template <unsigned kBSCountN>
+inline void SymbBS_DeleteLevel(PriQty (&pqs)[kBSCountN], unsigned lv) {
+   SymbBS_DeleteLevel(pqs, kBSCountN, lv);
+}
+
+/// 委託簿, 檔數由 kBSCountN 決定.
+/// - 將 InfoTime_, Flags_, LmtFlags_ 放在最前面(共 16 bytes), 之後緊接著最佳幾檔賣出價量;
+///   更新委託簿時, 最常異動的是前幾檔, 較少觸及後面的檔位.
+/// - 不保證對齊 cache line: C++17 之前 operator new 不保證會依照 over-aligned(alignas(64)) 的要求配置記憶體.
+template <unsigned kBSCountN>
+struct SymbBSDataT {
+   static_assert(0 < kBSCountN && kBSCountN <= kSymbBSCountMax, "Bad SymbBSDataT<kBSCountN>");
    enum {
       /// 買賣價量列表數量.
-      kBSCount = 5,
+      kBSCount = kBSCountN,
    };
 
    /// 報價時間.
    DayTime  InfoTime_{DayTime::Null()};
-   /// 賣出價量列表, [0]=最佳賣出價量.
-   PriQty   Sells_[kBSCount];
-   /// 買進價量列表, [0]=最佳買進價量.
-   PriQty   Buys_[kBSCount];
 
    f9sv_BSFlag Flags_{};
 
@@ -29,9 +59,16 @@ struct SymbBSData {
    f9sv_BSLmtFlag  LmtFlags_{};
 
    char     Padding___[6];
+
+   /// 賣出價量列表, [0]=最佳賣出價量.
+   PriQty   Sells_[kBSCount];
+   /// 買進價量列表, [0]=最佳買進價量.
+   PriQty   Buys_[kBSCount];
 };
+using SymbBSData = SymbBSDataT<5>;
 
-struct SymbTwfBSData : public SymbBSData {
+template <unsigned kBSCountN>
+struct SymbTwfBSDataT : public SymbBSDataT<kBSCountN> {
    /// 衍生賣出.
    PriQty   DerivedSell_{};
    /// 衍生買進.
@@ -42,13 +79,16 @@ struct SymbTwfBSData : public SymbBSData {
       this->InfoTime_ = tm;
    }
 };
+using SymbTwfBSData = SymbTwfBSDataT<SymbBSData::kBSCount>;
 
-struct SymbTwsBSData : public SymbBSData {
+template <unsigned kBSCountN>
+struct SymbTwsBSDataT : public SymbBSDataT<kBSCountN> {
    void Clear(DayTime tm = DayTime::Null()) {
       memset(this, 0, sizeof(*this));
       this->InfoTime_ = tm;
    }
 };
+using SymbTwsBSData = SymbTwsBSDataT<SymbBSData::kBSCount>;
 
 } } // namespaces
 #endif//__fon9_fmkt_SymbBSData_hpp__
@@ -0,0 +1,256 @@
+﻿// \file fon9/fmkt/SymbBS_UT.cpp
+//
+// 委託簿插入/刪除一檔(New/Delete 交替, 隨機檔位), Linux + g++ -O2:
+// Branch-free: 7.53 ns|BSCount=5  / 14.68 ns|BSCount=10 / 29.64 ns|BSCount=20
+// memmove    : 6.89 ns|BSCount=5  /  7.23 ns|BSCount=10 /  9.26 ns|BSCount=20
+// 因此 SymbBS_InsertLevel(), SymbBS_DeleteLevel() 使用 memmove();
+//
+// \author fonwinz@gmail.com
+#include "fon9/fmkt/SymbBS.hpp"
+#include "fon9/fmkt/MdRtsTypes.hpp"
+#include "fon9/seed/FieldMaker.hpp"
+#include "fon9/seed/RawRd.hpp"
+#include "fon9/BitvDecode.hpp"
+#include "fon9/buffer/RevBufferList.hpp"
+#include "fon9/buffer/DcQueueList.hpp"
+#include "fon9/TestTools.hpp"
+#include <random>
+
+using PriQty = fon9::fmkt::PriQty;
+//--------------------------------------------------------------------------//
+// 固定執行 count-1 次複製, 迴圈內沒有與 lv 有關的分支.
+// 用來驗證 SymbBS_InsertLevel(), SymbBS_DeleteLevel(); 並評估與 memmove() 的差異.
+static void BranchFreeInsertLevel(PriQty* pqs, unsigned count, unsigned lv) {
+   for (unsigned L = count - 1; L > 0; --L)
+      pqs[L] = pqs[L - (L > lv)];
+}
+static void BranchFreeDeleteLevel(PriQty* pqs, unsigned count, unsigned lv) {
+   for (unsigned L = 0; L < count - 1; ++L)
+      pqs[L] = pqs[L + (L >= lv)];
+   pqs[count - 1] = PriQty{};
+}
+static void FillPQ(PriQty& pq, uint64_t v) {
+   pq.Pri_.Assign<0>(static_cast<int64_t>(v));
+   pq.Qty_ = v;
+}
+
+template <unsigned kBSCount>
+static void TestInsertDelete() {
+   std::cout << "[TEST ] InsertLevel/DeleteLevel: BSCount=" << kBSCount << std::flush;
+   std::mt19937 rnd{kBSCount};
+   PriQty pqs[kBSCount], chk[kBSCount];
+   memset(pqs, 0, sizeof(pqs));
+   memset(chk, 0, sizeof(chk));
+   for (uint64_t L = 1; L < 100000; ++L) {
+      const unsigned lv = static_cast<unsigned>(rnd() % kBSCount);
+      if (rnd() % 3 == 0) {
+         fon9::fmkt::SymbBS_DeleteLevel(pqs, lv);
+         BranchFreeDeleteLevel(chk, kBSCount, lv);
+      }
+      else {
+         fon9::fmkt::SymbBS_InsertLevel(pqs, lv);
+         BranchFreeInsertLevel(chk, kBSCount, lv);
+         FillPQ(pqs[lv], L);
+         FillPQ(chk[lv], L);
+      }
+      if (memcmp(pqs, chk, sizeof(pqs)) != 0) {
+         std::cout << "|L=" << L << "|lv=" << lv << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+//--------------------------------------------------------------------------//
+template <unsigned kBSCount>
+static void TestFields() {
+   std::cout << "[TEST ] SymbTwaBST_MakeFields: BSCount=" << kBSCount << std::flush;
+   using SymbBS = fon9::fmkt::SymbTwfBST<kBSCount>;
+   fon9::seed::Fields flds = fon9::fmkt::SymbTwaBST_MakeFields<kBSCount>();
+   // InfoTime + (S + B) * (P + Q) + Flags + Derived(4) + LmtFlags;
+   if (flds.size() != 1 + kBSCount * 4 + 1 + 4 + 1) {
+      std::cout << "|fields.size=" << flds.size() << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   SymbBS symbBS;
+   symbBS.Data_.Clear();
+   for (unsigned L = 0; L < kBSCount; ++L) {
+      FillPQ(symbBS.Data_.Sells_[L], 1000 + L);
+      FillPQ(symbBS.Data_.Buys_[L], 2000 + L);
+   }
+   FillPQ(symbBS.Data_.DerivedSell_, 3000);
+   FillPQ(symbBS.Data_.DerivedBuy_, 4000);
+   fon9::seed::SimpleRawRd rd{symbBS};
+   auto checkField = [&flds, &rd](std::string fldName, uint64_t expected) {
+      const fon9::seed::Field* fld = flds.Get(fon9::ToStrView(fldName));
+      const auto v = (fld ? fld->GetNumber(rd, 0, 0) : -1);
+      if (v != static_cast<fon9::seed::FieldNumberT>(expected)) {
+         std::cout << "|fld=" << fldName << "|v=" << v << "|expected=" << expected << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   };
+   for (unsigned L = 0; L < kBSCount; ++L) {
+      const std::string lvstr = fon9::RevPrintTo<std::string>(L + 1);
+      checkField("S" + lvstr + "P", 1000 + L);
+      checkField("S" + lvstr + "Q", 1000 + L);
+      checkField("B" + lvstr + "P", 2000 + L);
+      checkField("B" + lvstr + "Q", 2000 + L);
+   }
+   checkField("DS1P", 3000);
+   checkField("DB1Q", 4000);
+   std::cout << "\r[OK   ]" << std::endl;
+}
+//--------------------------------------------------------------------------//
+static void CheckPackedPQs(fon9::DcQueue& dcq, const PriQty* pqs, unsigned count) {
+   // 打包時使用 RevBuffer, 所以取出的順序為: 第 count 檔 ... 第 1 檔.
+   while (count > 0) {
+      PriQty pq;
+      fon9::BitvTo(dcq, pq.Pri_);
+      fon9::BitvTo(dcq, pq.Qty_);
+      --count;
+      if (pq.Pri_ != pqs[count].Pri_ || pq.Qty_ != pqs[count].Qty_) {
+         std::cout << "|lv=" << count + 1 << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+}
+static uint8_t ReadByte(fon9::DcQueue& dcq) {
+   uint8_t v = 0;
+   if (dcq.Read(&v, 1) != 1) {
+      std::cout << "|err=No more data\r[ERROR]" << std::endl;
+      abort();
+   }
+   return v;
+}
+static void CheckByte(const char* msg, uint8_t v, uint8_t expected) {
+   if (v == expected)
+      return;
+   std::cout << "|" << msg << "=" << static_cast<unsigned>(v)
+      << "|expected=" << static_cast<unsigned>(expected) << "\r[ERROR]" << std::endl;
+   abort();
+}
+template <unsigned kBSCount>
+static void TestPackSnapshotBS(unsigned sellCount, unsigned buyCount) {
+   std::cout << "[TEST ] MdRtsPackSnapshotBS: BSCount=" << kBSCount
+      << "|sells=" << sellCount << "|buys=" << buyCount << std::flush;
+   fon9::fmkt::SymbTwsBSDataT<kBSCount> symbBS;
+   symbBS.Clear();
+   for (unsigned L = 0; L < sellCount; ++L)
+      FillPQ(symbBS.Sells_[L], 1000 + L);
+   for (unsigned L = 0; L < buyCount; ++L)
+      FillPQ(symbBS.Buys_[L], 2000 + L);
+   symbBS.Flags_ = f9sv_BSFlag_OrderBuy | f9sv_BSFlag_OrderSell;
+   fon9::RevBufferList rbuf{128};
+   fon9::fmkt::MdRtsPackSnapshotBS(rbuf, symbBS);
+   fon9::DcQueueList dcq{rbuf.MoveOut()};
+   // 打包順序: Sells 之後 Buys, 所以取出的順序為: Buys, Sells;
+   const struct {
+      fon9::fmkt::RtBSType Type_;
+      unsigned             Count_;
+      const PriQty*        PQs_;
+   } chks[] = {
+      {fon9::fmkt::RtBSType::OrderBuy,  buyCount,  symbBS.Buys_},
+      {fon9::fmkt::RtBSType::OrderSell, sellCount, symbBS.Sells_},
+   };
+   for (const auto& chk : chks) {
+      if (chk.Count_ == 0)
+         continue;
+      const uint8_t first = ReadByte(dcq);
+      CheckByte("first.Type", static_cast<uint8_t>(first & fon9::cast_to_underlying(fon9::fmkt::RtBSType::Mask)),
+                fon9::cast_to_underlying(chk.Type_));
+      unsigned count = (first & fon9::fmkt::kRtBSSnapshotCountMask) + 1u;
+      if (chk.Count_ > fon9::fmkt::kRtBSSnapshotCountMask + 1u) {
+         CheckByte("first.CountExt", static_cast<uint8_t>(first & fon9::fmkt::kRtBSSnapshotCountExt),
+                   fon9::fmkt::kRtBSSnapshotCountExt);
+         count = ReadByte(dcq) + 1u;
+      }
+      CheckByte("Count", static_cast<uint8_t>(count), static_cast<uint8_t>(chk.Count_));
+      CheckPackedPQs(dcq, chk.PQs_, count);
+   }
+   if (!dcq.empty()) {
+      std::cout << "|remain=" << dcq.CalcSize() << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+//--------------------------------------------------------------------------//
+static void TestUpdateBSType() {
+   std::cout << "[TEST ] MdRtsPutUpdateBSType" << std::flush;
+   const uint8_t bsType = fon9::cast_to_underlying(fon9::fmkt::RtBSType::OrderSell)
+                        | fon9::cast_to_underlying(fon9::fmkt::RtBSAction::New);
+   fon9::byte out[2];
+   for (unsigned lv = 0; lv < fon9::fmkt::kSymbBSCountMax; ++lv) {
+      const unsigned sz = fon9::fmkt::MdRtsPutUpdateBSType(out, bsType, lv);
+      unsigned outlv = (out[0] & fon9::fmkt::kRtBSLevelMask);
+      if (outlv == fon9::fmkt::kRtBSLevelExt)
+         outlv = out[1];
+      if (outlv != lv || sz != (lv < fon9::fmkt::kRtBSLevelExt ? 1u : 2u)
+          || (out[0] & ~fon9::fmkt::kRtBSLevelMask) != bsType) {
+         std::cout << "|lv=" << lv << "|sz=" << sz << "|outlv=" << outlv << "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+//--------------------------------------------------------------------------//
+struct BranchFreeLevel {
+   static void Insert(PriQty* pqs, unsigned count, unsigned lv) {
+      BranchFreeInsertLevel(pqs, count, lv);
+   }
+   static void Delete(PriQty* pqs, unsigned count, unsigned lv) {
+      BranchFreeDeleteLevel(pqs, count, lv);
+   }
+};
+/// SymbBS_InsertLevel(), SymbBS_DeleteLevel() 使用 memmove();
+struct MemmoveLevel {
+   static void Insert(PriQty* pqs, unsigned count, unsigned lv) {
+      fon9::fmkt::SymbBS_InsertLevel(pqs, count, lv);
+   }
+   static void Delete(PriQty* pqs, unsigned count, unsigned lv) {
+      fon9::fmkt::SymbBS_DeleteLevel(pqs, count, lv);
+   }
+};
+template <unsigned kBSCount, class LevelOp>
+static void BenchInsertDelete(const char* name) {
+   const unsigned kTimes = 10000000;
+   std::vector<uint8_t> lvs(1024);
+   std::mt19937 rnd{20201020};
+   for (uint8_t& lv : lvs)
+      lv = static_cast<uint8_t>(rnd() % kBSCount);
+   PriQty pqs[kBSCount];
+   memset(pqs, 0, sizeof(pqs));
+   fon9::StopWatch stopWatch;
+   for (unsigned L = 0; L < kTimes; ++L) {
+      const unsigned lv = lvs[L % lvs.size()];
+      if (L & 1)
+         LevelOp::Delete(pqs, kBSCount, lv);
+      else {
+         LevelOp::Insert(pqs, kBSCount, lv);
+         pqs[lv].Qty_ = L;
+      }
+   }
+   stopWatch.PrintResultNoEOL(name, kTimes) << "|BSCount=" << kBSCount << "|chk=" << pqs[0].Qty_ << std::endl;
+}
+template <unsigned kBSCount>
+static void BenchInsertDelete() {
+   BenchInsertDelete<kBSCount, BranchFreeLevel>("Branch-free");
+   BenchInsertDelete<kBSCount, MemmoveLevel>("memmove    ");
+}
+
+int main() {
+   fon9::AutoPrintTestInfo utinfo{"SymbBS"};
+
+   TestInsertDelete<1>();
+   TestInsertDelete<5>();
+   TestInsertDelete<20>();
+   TestFields<5>();
+   TestFields<20>();
+   TestUpdateBSType();
+   TestPackSnapshotBS<5>(5, 3);
+   TestPackSnapshotBS<20>(20, 16);
+   TestPackSnapshotBS<20>(17, 0);
+
+   utinfo.PrintSplitter();
+   BenchInsertDelete<5>();
+   BenchInsertDelete<10>();
+   BenchInsertDelete<20>();
+}
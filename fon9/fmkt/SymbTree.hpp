@@ -197,6 +197,9 @@ protected:
 
 /// \ingroup fmkt
 /// 商品資料表, 一般行情系統使用: multi thread(mutex) + unordered
+/// - 不提供分段(sharded)或 lock-free 查找: MdRtStream 的 publish 必須在整個 SymbMap_ 鎖定狀態下進行,
+///   此鎖同時保護: tree 訂閱及回補、BlockPublish、合併訂閱的 timer、DailyClear;
+///   因此查找後仍需鎖定整個 tree, 分段查找無法降低 feed 的競爭.
 class fon9_API SymbTree : public SymbTreeT<SymbMap, std::mutex> {
    fon9_NON_COPY_NON_MOVE(SymbTree);
 public:
@@ -2,6 +2,9 @@
 // \author fonwinz@gmail.com
 #include "fon9/framework/Framework.hpp"
 #include "fon9/seed/SysEnv.hpp"
+#include "fon9/seed/MemBlockTree.hpp"
+#include "fon9/buffer/MemBlockImpl.hpp"
+#include "fon9/ConfigParser.hpp"
 #include "fon9/ConfigLoader.hpp"
 #include "fon9/InnSyncerFile.hpp"
 #include "fon9/FilePath.hpp"
@@ -19,6 +22,21 @@ bool SetCurrentDirectory(const char* path) {
 
 namespace fon9 {
 
+/// $MemBlock=Numa=Y|HugePage=Y|ChunkMB=64
+struct MemBlockArenaConfig : public impl::MemBlockArenaArgs {
+   ConfigParser::Result OnTagValue(StrView tag, StrView& value) {
+      if (tag == "Numa")
+         this->IsPerNumaNode_ = (toupper(static_cast<unsigned char>(value.Get1st())) == 'Y');
+      else if (tag == "HugePage")
+         this->IsHugePage_ = (toupper(static_cast<unsigned char>(value.Get1st())) == 'Y');
+      else if (tag == "ChunkMB")
+         this->ChunkMB_ = StrTo(value, 0u);
+      else
+         return ConfigParser::Result::EUnknownTag;
+      return ConfigParser::Result::Success;
+   }
+};
+
 Framework::~Framework() {
    this->Dispose();
 }
@@ -72,6 +90,37 @@ int Framework::Initialize(int argc, char** argv) {
    RevBufferList  rbuf{128};
    std::string    fname, desc;
 
+   // MemBlock 的設定應儘早處理, 才能讓之後建立的 thread(例: log) 直接使用正確的 MemBlockCenter.
+#define fon9_kCSTR_MemBlock   "MemBlock"
+   if (auto varMemBlock = cfgld.GetVariable(fon9_kCSTR_MemBlock)) {
+      cfgstr = &varMemBlock->Value_.Str_;
+      if (!StrTrim(&cfgstr).empty()) {
+         MemBlockArenaConfig args;
+         if (!ParseConfig(args, cfgstr, rbuf))
+            desc = BufferTo<std::string>(rbuf.MoveOut());
+         else if (impl::MemBlockSetArenaArgs(args))
+            desc = "OK";
+         else
+            desc = "err=Not supported";
+         sysEnv->Add(new seed::SysEnvItem(fon9_kCSTR_MemBlock, cfgstr.ToString(), std::string{}, desc));
+      }
+   }
+   this->Root_->AddNamedSapling(new seed::MemBlockTree{}, fon9_kCSTR_MemBlock "Stat");
+
+   // $LogStaging=ItemCount[,Drop]: 啟用 LogFile 的 per-thread staging rings, 預設 ring 滿了會等候.
+   if (auto logStaging = cfgld.GetVariable("LogStaging")) {
+      cfgstr = &logStaging->Value_.Str_;
+      LogStagingConfig cfg;
+      cfg.ItemCount_ = StrTo(&cfgstr, 0u);
+      if (cfg.ItemCount_ > 0) {
+         if (StrTrimHead(&cfgstr).Get1st() == ',') {
+            cfgstr.SetBegin(cfgstr.begin() + 1);
+            cfg.IsDropWhenFull_ = (toupper(static_cast<unsigned char>(StrTrimHead(&cfgstr).Get1st())) == 'D');
+         }
+         SetLogFileStaging(cfg);
+         sysEnv->Add(new seed::SysEnvItem("LogStaging", RevPrintTo<std::string>(cfg.ItemCount_, cfg.IsDropWhenFull_ ? ",Drop" : "")));
+      }
+   }
    // 如果沒設定, log 就輸出在 console.
    if (auto logFileFmt = cfgld.GetVariable("LogFileFmt")) {
       cfgstr = &logFileFmt->Value_.Str_;
@@ -88,6 +137,14 @@ int Framework::Initialize(int argc, char** argv) {
          sysEnv->Add(new seed::SysEnvItem("LogFileFmt", std::move(fname), std::string{}, BufferTo<std::string>(rbuf.MoveOut())));
       }
    }
+   // $LogBin=Y: fon9_LOG() 只保存參數, 由 log 寫入端(LogFileAppender 的 thread)負責格式化.
+   if (auto logBin = cfgld.GetVariable("LogBin")) {
+      cfgstr = &logBin->Value_.Str_;
+      if (toupper(static_cast<unsigned char>(StrTrimHead(&cfgstr).Get1st())) == 'Y') {
+         SetLogBinMode(true);
+         sysEnv->Add(new seed::SysEnvItem("LogBin", "Y"));
+      }
+   }
 
 #define fon9_kCSTR_HostId   "HostId"
    if (auto hostId = cfgld.GetVariable(fon9_kCSTR_HostId)) {
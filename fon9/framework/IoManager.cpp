@@ -207,6 +207,15 @@ void IoManager::OnDevice_Accepted(io::DeviceServer& server, io::DeviceAcceptedCl
       cliItem->Sapling_ = serverItem->Sapling_;
    }
 }
+StrView IoManager::GetDeviceName(io::Device& dev) {
+   // 建立 accepted client 時, client 尚未設定 ManagerBookmark, 所以 dev 通常是 server;
+   // DeviceItem::Id_ 在建立後就不會改變, 所以不用鎖住 DeviceMap_.
+   if (DeviceRun* item = this->FromManagerBookmark(dev)) {
+      if (item->IsDeviceItem())
+         return ToStrView(static_cast<DeviceItem*>(item)->Id_);
+   }
+   return StrView{};
+}
 void IoManager::OnDevice_StateChanged(io::Device& dev, const io::StateChangedArgs& e) {
    this->UpdateDeviceState(dev, e.After_);
 }
@@ -177,6 +177,7 @@ protected:
    void OnDevice_Destructing(io::Device& dev) override;
    void OnDevice_StateChanged(io::Device& dev, const io::StateChangedArgs& e) override;
    void OnDevice_StateUpdated(io::Device& dev, const io::StateUpdatedArgs& e) override;
+   StrView GetDeviceName(io::Device& dev) override;
    void UpdateDeviceState(io::Device& dev, const io::StateUpdatedArgs& e);
    void UpdateDeviceStateLocked(io::Device& dev, const io::StateUpdatedArgs& e);
    void UpdateSessionStateLocked(io::Device& dev, StrView stmsg, LogLevel lv);
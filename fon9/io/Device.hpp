@@ -58,6 +58,10 @@ public:
    Bookmark GetSessionBookmark() const { return this->SessionBookmark_; }
    void SetManagerBookmark(Bookmark n) { this->ManagerBookmark_ = n; }
    Bookmark GetManagerBookmark() const { return this->ManagerBookmark_; }
+   /// 透過 Manager_->GetDeviceName(*this) 取得名稱, 若沒有 Manager_ 則傳回 StrView{}.
+   StrView GetManagerDeviceName() {
+      return this->Manager_ ? this->Manager_->GetDeviceName(*this) : StrView{};
+   }
 
    /// - 如果 !cfgstr.empty() 或 (this->State_ <= State::Initialized) 則使用 OpImpl_Open(cfgstr) 來開啟.
    /// - 如果 cfgstr.empty()  會先檢查現在狀態是否允許 reopen, 如果可以, 則使用 OpImpl_Reopen() 來開啟.
@@ -1,6 +1,10 @@
 ﻿/// \file fon9/io/DgramBase.cpp
 /// \author fonwinz@gmail.com
 #include "fon9/io/DgramBase.hpp"
+#include "fon9/Decimal.hpp"
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
 
 namespace fon9 { namespace io {
 //
@@ -29,6 +33,12 @@ namespace fon9 { namespace io {
 //       Loopback=Y or N
 //       TTL=hops    必須有提供 Loopback 選項.
 //
+// 收的額外選項(Linux):
+//    RecvBatch=n    每次 readable 使用 recvmmsg() 最多取出 n 個 datagram, 每個 datagram 仍個別觸發事件.
+//    MaxDgram=n     RecvBatch 模式每個 datagram 的接收緩衝大小(bytes), 超過的 datagram 會被拋棄並計入 TruncDgrams.
+//    Gro=Y          啟用 UDP_GRO, 核心合併的 datagrams 取出後會依 segment size 拆開.
+//    GroBatch=n     啟用 UDP_GRO 時, 每次 recvmmsg() 最多取出 n 個(每個緩衝 64K).
+//
 
 bool DgramBase::CreateSocket(Socket& so, const SocketAddress& addr, SocketResult& soRes) {
    this->Config_.Options_.TCP_NODELAY_ = 0;
@@ -75,6 +85,16 @@ bool DgramBase::CreateSocket(Socket& so, const SocketAddress& addr, SocketResult
          return false;
       }
    }
+#ifdef UDP_GRO
+   if (this->IsUdpGro_) {
+      int isEnabled = 1;
+      // 核心不支援 UDP_GRO 時, 不視為錯誤, 仍使用一般的接收方式.
+      if (setsockopt(so.GetSocketHandle(), SOL_UDP, UDP_GRO, &isEnabled, sizeof(isEnabled)) != 0)
+         this->IsUdpGro_ = false;
+   }
+#else
+   this->IsUdpGro_ = false;
+#endif
    return true;
 }
 void DgramBase::OpImpl_Open(std::string cfgstr) {
@@ -82,6 +102,13 @@ void DgramBase::OpImpl_Open(std::string cfgstr) {
    this->Interface_.Addr_.sa_family = AF_UNSPEC;
    this->TTL_ = 0;
    this->Loopback_ = -1;
+   this->IsUdpGro_ = false;
+   this->RecvBatch_ = 0;
+   this->GroBatch_ = kDefaultGroBatch;
+   this->MaxDgramSize_ = kDefaultMaxDgramSize;
+   this->RecvCalls_.store(0, std::memory_order_relaxed);
+   this->RecvDgrams_.store(0, std::memory_order_relaxed);
+   this->TruncDgrams_.store(0, std::memory_order_relaxed);
    base::OpImpl_Open(std::move(cfgstr));
 }
 ConfigParser::Result DgramBase::OpImpl_SetProperty(StrView tag, StrView& value) {
@@ -103,6 +130,32 @@ ConfigParser::Result DgramBase::OpImpl_SetProperty(StrView tag, StrView& value)
       this->Loopback_ = (toupper(value.Get1st()) == 'Y');
       return ConfigParser::Result::Success;
    }
+   if (iequals(tag, "RecvBatch")) {
+      this->RecvBatch_ = StrTo(value, this->RecvBatch_);
+      if (this->RecvBatch_ > kMaxRecvBatch)
+         this->RecvBatch_ = kMaxRecvBatch;
+      return ConfigParser::Result::Success;
+   }
+   if (iequals(tag, "Gro")) {
+      this->IsUdpGro_ = (toupper(value.Get1st()) == 'Y');
+      return ConfigParser::Result::Success;
+   }
+   if (iequals(tag, "GroBatch")) {
+      this->GroBatch_ = StrTo(value, this->GroBatch_);
+      if (this->GroBatch_ <= 0)
+         this->GroBatch_ = 1;
+      else if (this->GroBatch_ > kMaxRecvBatch)
+         this->GroBatch_ = kMaxRecvBatch;
+      return ConfigParser::Result::Success;
+   }
+   if (iequals(tag, "MaxDgram")) {
+      this->MaxDgramSize_ = StrTo(value, this->MaxDgramSize_);
+      if (this->MaxDgramSize_ <= 0)
+         this->MaxDgramSize_ = kDefaultMaxDgramSize;
+      else if (this->MaxDgramSize_ > kGroBufferSize)
+         this->MaxDgramSize_ = kGroBufferSize;
+      return ConfigParser::Result::Success;
+   }
    return base::OpImpl_SetProperty(tag, value);
 }
 
@@ -114,6 +167,19 @@ void DgramBase::OpImpl_Connected(Socket::socket_t) {
    StrView  uidstr = MakeTcpConnectionUID(uidbuf, GetAddrOrNull(this->RemoteAddress_), GetAddrOrNull(this->Config_.AddrBind_));
    this->OpImpl_SetConnected(uidstr.ToString());
 }
+void DgramBase::OpImpl_AppendDeviceInfo(std::string& info) {
+   if (this->RecvBatch_ <= 1 && !this->IsUdpGro_)
+      return;
+   const uint64_t calls = this->RecvCalls_.load(std::memory_order_relaxed);
+   const uint64_t dgrams = this->RecvDgrams_.load(std::memory_order_relaxed);
+   RevBufferList  rbuf{128};
+   RevPrint(rbuf, "|RecvBatch=", this->IsUdpGro_ ? this->GroBatch_ : this->RecvBatch_,
+            "|RecvCalls=", calls,
+            "|RecvDgrams=", dgrams,
+            "|DgramsPerCall=", Decimal<uint64_t, 2>(calls ? (dgrams * 100 / calls) : 0u, 2),
+            "|TruncDgrams=", this->TruncDgrams_.load(std::memory_order_relaxed));
+   BufferAppendTo(rbuf.MoveOut(), info);
+}
 void DgramBase::OpImpl_OnAddrListEmpty() {
    this->AddrList_.resize(1);
    this->AddrList_[0].SetAddrAny(AddressFamily::INET4, 0);
@@ -19,6 +19,14 @@ class fon9_API DgramBase : public SocketClientDevice {
    SocketAddress  Interface_;
    int            Loopback_;
    uint8_t        TTL_;
+   bool           IsUdpGro_;
+   uint16_t       RecvBatch_;
+   uint16_t       GroBatch_;
+   uint32_t       MaxDgramSize_;
+   /// RecvBatch 模式的統計: 接收的系統呼叫次數, 收到的 datagram 數量, 因超過緩衝大小而被截斷(拋棄)的 datagram 數量.
+   std::atomic<uint64_t>   RecvCalls_;
+   std::atomic<uint64_t>   RecvDgrams_;
+   std::atomic<uint64_t>   TruncDgrams_;
 
 protected:
    void OpImpl_Open(std::string cfgstr) override;
@@ -26,11 +34,58 @@ protected:
    bool CreateSocket(Socket& so, const SocketAddress& addr, SocketResult& soRes) override;
    void OpImpl_Connected(Socket::socket_t so);
    void OpImpl_OnAddrListEmpty() override;
+   /// 若有啟用 RecvBatch, 則加上 "|RecvBatch=n|RecvCalls=n|RecvDgrams=n|DgramsPerCall=n.nn|TruncDgrams=n"
+   void OpImpl_AppendDeviceInfo(std::string& info) override;
 
 public:
    DgramBase(SessionSP ses, ManagerSP mgr)
       : base(std::move(ses), std::move(mgr), Style::Client) {
    }
+
+   enum : uint16_t {
+      kMaxRecvBatch = 64,
+      /// 啟用 Gro 時, 預設每次 recvmmsg() 最多取出的數量.
+      kDefaultGroBatch = 4,
+   };
+   enum : uint32_t {
+      /// 沒有設定 "MaxDgram=n" 時, 每個 datagram 的接收緩衝大小.
+      kDefaultMaxDgramSize = 1024 * 4,
+      /// 核心 UDP_GRO 合併後的最大資料量, 啟用 Gro 時, 每個接收緩衝必須有此大小, 否則合併的資料會被截斷.
+      kGroBufferSize = 1024 * 64,
+   };
+   /// 設定 "RecvBatch=n": 每次 readable 時, 使用 recvmmsg() 一次最多取出 n 個 datagram.
+   /// - 每個 datagram 仍會個別觸發 OnDevice_Recv(), 所以 PkReceiver(IsDgram_=true) 可以正常運作.
+   /// - 0 or 1 表示不使用 RecvBatch 模式: 每次 readv() 取出一個 datagram.
+   /// - 不支援 recvmmsg() 的平台(例: Windows) 不理會此設定.
+   uint16_t GetRecvBatch() const {
+      return this->RecvBatch_;
+   }
+   /// 設定 "Gro=Y": 若 OS 支援(Linux UDP_GRO), 則允許核心將多個 datagram 合併後一次取出;
+   /// 取出後會依照 segment size 拆回個別的 datagram 再觸發事件.
+   /// - 啟用後一定使用 recvmmsg() 接收, 每個接收緩衝為 kGroBufferSize.
+   bool IsUdpGro() const {
+      return this->IsUdpGro_;
+   }
+   /// 設定 "GroBatch=n": 啟用 Gro 時, 每次 recvmmsg() 最多取出 n 個(合併後的)datagram, 預設 kDefaultGroBatch;
+   /// 因為每個接收緩衝都是 kGroBufferSize, 所以與 RecvBatch 分開設定.
+   uint16_t GetGroBatch() const {
+      return this->GroBatch_;
+   }
+   /// 設定 "MaxDgram=n": RecvBatch 模式(未啟用 Gro)每個 datagram 的接收緩衝大小, 預設 kDefaultMaxDgramSize;
+   /// 超過此大小的 datagram 會被截斷, 此時會拋棄該 datagram, 並記錄在 TruncDgrams.
+   uint32_t GetMaxDgramSize() const {
+      return this->MaxDgramSize_;
+   }
+   /// 由 io thread 在每次 recvmmsg() 之後呼叫.
+   void AddRecvBatchStat(unsigned dgramCount) {
+      this->RecvCalls_.fetch_add(1, std::memory_order_relaxed);
+      this->RecvDgrams_.fetch_add(dgramCount, std::memory_order_relaxed);
+   }
+   /// 由 io thread 在收到被截斷(MSG_TRUNC)的 datagram 時呼叫.
+   /// \retval 之前的截斷數量.
+   uint64_t AddTruncDgramStat() {
+      return this->TruncDgrams_.fetch_add(1, std::memory_order_relaxed);
+   }
 };
 fon9_WARN_POP;
 
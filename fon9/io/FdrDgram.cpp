@@ -3,9 +3,21 @@
 #include "fon9/sys/Config.h"
 #ifdef fon9_POSIX
 #include "fon9/io/FdrDgram.hpp"
+#include "fon9/Log.hpp"
+#ifdef __linux__
+#include <netinet/udp.h>
+#endif
 
 namespace fon9 { namespace io {
 
+FdrDgramImpl::~FdrDgramImpl() {
+   for (FwdBufferNode* node : this->BatchNodes_) {
+      if (node)
+         FreeNode(node);
+   }
+   this->ClearPendingDgrams();
+}
+
 bool FdrDgramImpl::OpImpl_ConnectTo(const SocketAddress& addr, SocketResult& soRes) {
    this->State_ = State::Connecting;
    if (!addr.IsEmpty()) {
@@ -24,8 +36,16 @@ void FdrDgramImpl::OnFdrEvent_Handling(FdrEventFlag evs) {
    FdrEventProcessor(this, *this->Owner_, evs);
 }
 void FdrDgramImpl::OnFdrEvent_StartSend() {
+   // 在 op thread 處理完 Recv 事件後, 透過 StartSendInFdrThread() 回到 fdr thread 繼續處理剩餘的 datagrams.
+   if (fon9_UNLIKELY(this->PendingIndex_ < this->PendingDgrams_.size())) {
+      if (this->State_ == State::Connected && !this->RecvBuffer_.IsInvokingEvent() && !this->RecvBuffer_.IsReceiving())
+         this->DeliverPendingDgrams(*this->Owner_, &OwnerDevice::OpImpl_IsRecvBufferAlive);
+   }
    this->StartSend(*this->Owner_);
 }
+bool FdrDgramImpl::IsFdrEventIdle() const {
+   return this->PendingIndex_ >= this->PendingDgrams_.size() && base::IsFdrEventIdle();
+}
 void FdrDgramImpl::OnFdrSocket_Error(std::string errmsg) {
    this->Owner_->OnSocketError(this, std::move(errmsg));
 }
@@ -38,5 +58,163 @@ void FdrDgramImpl::SocketError(StrView fnName, int eno) {
    base::SocketError(fnName, eno);
 }
 
+//--------------------------------------------------------------------------//
+
+struct FdrDgramImpl::DgramRecvAux : public FdrRecvAux {
+   FnIsRecvBufferAlive  FnIsRecvBufferAlive_;
+   DgramRecvAux(FnIsRecvBufferAlive fnIsRecvBufferAlive) : FnIsRecvBufferAlive_{fnIsRecvBufferAlive} {
+   }
+   bool IsRecvBufferAlive(Device& dev, RecvBuffer& rbuf) const {
+      return this->FnIsRecvBufferAlive_ == nullptr || this->FnIsRecvBufferAlive_(dev, rbuf);
+   }
+   static void ContinueRecv(RecvBuffer& rbuf, RecvBufferSize expectSize, bool isEnableReadable) {
+      FdrRecvAux::ContinueRecv(rbuf, expectSize, isEnableReadable);
+      if (isEnableReadable) {
+         // 在 op thread 處理完 Recv 事件, 可能還有剩餘的 datagrams 尚未處理,
+         // 回到 fdr thread 的 OnFdrEvent_StartSend() 繼續處理.
+         FdrSocket& impl = ContainerOf(rbuf, &FdrDgramImpl::RecvBuffer_);
+         impl.StartSendInFdrThread();
+      }
+   }
+};
+void FdrDgramImpl::ClearPendingDgrams() {
+   for (size_t L = this->PendingIndex_; L < this->PendingDgrams_.size(); ++L)
+      FreeNode(this->PendingDgrams_[L]);
+   this->PendingDgrams_.clear();
+   this->PendingIndex_ = 0;
+}
+bool FdrDgramImpl::DeliverPendingDgrams(Device& dev, FnIsRecvBufferAlive fnIsRecvBufferAlive) {
+   while (this->PendingIndex_ < this->PendingDgrams_.size()) {
+      if (fon9_UNLIKELY(this->RecvSize_ < RecvBufferSize::Default)) {
+         // Session 決定不要再處理 OnDevice_Recv() 事件, 所以拋棄全部已收到的資料.
+         this->ClearPendingDgrams();
+         this->RecvBuffer_.Clear();
+         return true;
+      }
+      FwdBufferNode* node = this->PendingDgrams_[this->PendingIndex_];
+      this->PendingDgrams_[this->PendingIndex_++] = nullptr;
+      DgramRecvAux aux{fnIsRecvBufferAlive};
+      DeviceRecvBufferReady(dev, this->RecvBuffer_.SetDataReceived(node), aux);
+      if (fon9_UNLIKELY(aux.IsNeedsUpdateFdrEvent_))
+         return false;
+   }
+   this->PendingDgrams_.clear();
+   this->PendingIndex_ = 0;
+   return true;
+}
+bool FdrDgramImpl::CheckReadBatch(Device& dev, FnIsRecvBufferAlive fnIsRecvBufferAlive) {
+   // 先處理上次尚未處理完的 datagrams.
+   if (!this->DeliverPendingDgrams(dev, fnIsRecvBufferAlive))
+      return true;
+   if (fon9_UNLIKELY(this->RecvSize_ < RecvBufferSize::Default))
+      return base::CheckRead(dev, fnIsRecvBufferAlive);
+#ifndef __linux__
+   return base::CheckRead(dev, fnIsRecvBufferAlive);
+#else
+   const unsigned batchCount = this->RecvBatch_;
+   struct mmsghdr msgs[DgramBase::kMaxRecvBatch];
+   struct iovec   iovs[DgramBase::kMaxRecvBatch];
+#ifdef UDP_GRO
+   using GroCMsgBuf = char[CMSG_SPACE(sizeof(int))];
+   GroCMsgBuf     cmsgBufs[DgramBase::kMaxRecvBatch];
+#endif
+   // 啟用 GRO 時, 核心可能將多個 datagram 合併, 所以需要 kGroBufferSize 的空間;
+   // 否則使用 "MaxDgram=n" 的設定, 超過的 datagram 會有 MSG_TRUNC, 此時拋棄該 datagram.
+   const size_t nodeSize = this->BatchNodeSize_;
+   this->BatchNodes_.resize(batchCount);
+   size_t totrd = 0;
+   for (;;) {
+      for (unsigned L = 0; L < batchCount; ++L) {
+         FwdBufferNode*& node = this->BatchNodes_[L];
+         if (node && node->GetRemainSize() < nodeSize) {
+            FreeNode(node);
+            node = nullptr;
+         }
+         if (node == nullptr)
+            node = FwdBufferNode::Alloc(nodeSize);
+         // MemBlock 分配的空間可能比 nodeSize 大, 但只接收 nodeSize, 讓 "MaxDgram=n" 的截斷規則一致.
+         fon9_PutIoVectorElement(&iovs[L], node->GetDataEnd(), nodeSize);
+         ZeroStruct(msgs[L]);
+         msgs[L].msg_hdr.msg_iov = &iovs[L];
+         msgs[L].msg_hdr.msg_iovlen = 1;
+      #ifdef UDP_GRO
+         if (this->IsUdpGro_) {
+            msgs[L].msg_hdr.msg_control = cmsgBufs[L];
+            msgs[L].msg_hdr.msg_controllen = sizeof(cmsgBufs[L]);
+         }
+      #endif
+      }
+      const int rcount = recvmmsg(this->GetFD(), msgs, batchCount, MSG_DONTWAIT, nullptr);
+      if (fon9_UNLIKELY(rcount <= 0)) {
+         if (rcount == 0)
+            break;
+         if (int eno = ErrorCannotRetry(errno)) {
+            this->SocketError("Recv", eno);
+            return false;
+         }
+         break;
+      }
+      this->Owner_->AddRecvBatchStat(static_cast<unsigned>(rcount));
+      for (int L = 0; L < rcount; ++L) {
+         const size_t rdsz = msgs[L].msg_len;
+         if (fon9_UNLIKELY(rdsz <= 0))
+            continue;
+         if (fon9_UNLIKELY(msgs[L].msg_hdr.msg_flags & MSG_TRUNC)) {
+            // 資料不完整, 不能交給 session 處理; node 沒有使用, 留到下次接收.
+            if (this->Owner_->AddTruncDgramStat() == 0)
+               fon9_LOG_WARN("FdrDgram.Recv|dev=", ToPtr(this->Owner_.get()),
+                             "|err=datagram truncated|bufsz=", nodeSize, "|info=Check MaxDgram or Gro setting.");
+            continue;
+         }
+         totrd += rdsz;
+         FwdBufferNode* node = this->BatchNodes_[static_cast<unsigned>(L)];
+         this->BatchNodes_[static_cast<unsigned>(L)] = nullptr;
+         node->SetDataEnd(node->GetDataEnd() + rdsz);
+         size_t segSize = 0;
+      #ifdef UDP_GRO
+         if (this->IsUdpGro_) {
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msgs[L].msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msgs[L].msg_hdr, cmsg)) {
+               if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                  int gsoSize;
+                  memcpy(&gsoSize, CMSG_DATA(cmsg), sizeof(gsoSize));
+                  segSize = static_cast<size_t>(gsoSize);
+                  break;
+               }
+            }
+         }
+      #endif
+         if (fon9_LIKELY(segSize <= 0 || rdsz <= segSize)) {
+            this->PendingDgrams_.push_back(node);
+            continue;
+         }
+         // GRO 合併的 datagrams: 依照 segSize 拆開(最後一個可能較小), 讓每個 datagram 個別觸發事件.
+         const byte* pseg = node->GetDataEnd() - rdsz;
+         for (size_t remain = rdsz; remain > 0;) {
+            const size_t   sz = (remain < segSize ? remain : segSize);
+            FwdBufferNode* seg = FwdBufferNode::Alloc(sz);
+            memcpy(seg->GetDataEnd(), pseg, sz);
+            seg->SetDataEnd(seg->GetDataEnd() + sz);
+            this->PendingDgrams_.push_back(seg);
+            pseg += sz;
+            remain -= sz;
+         }
+         FreeNode(node);
+      }
+      if (!this->DeliverPendingDgrams(dev, fnIsRecvBufferAlive))
+         return true;
+      // 實際取出的數量, 比要求的少 => 資料已全部取出, 所以結束 Recv.
+      if (static_cast<unsigned>(rcount) < batchCount)
+         break;
+      // 避免一次占用太久, 所以先結束.
+      if (totrd > 1024 * 256)
+         break;
+      // Session 決定不要再處理 OnDevice_Recv() 事件, 所以拋棄全部已收到的資料.
+      if (fon9_UNLIKELY(this->RecvSize_ < RecvBufferSize::Default))
+         return base::CheckRead(dev, fnIsRecvBufferAlive);
+   }
+   return true;
+#endif
+}
+
 } } // namespaces
 #endif
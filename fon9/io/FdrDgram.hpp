@@ -10,10 +10,33 @@ namespace fon9 { namespace io {
 struct FdrDgramImpl : public FdrSocketClientImpl {
    fon9_NON_COPY_NON_MOVE(FdrDgramImpl);
    using base = FdrSocketClientImpl;
+   using FnIsRecvBufferAlive = bool (*)(Device& dev, RecvBuffer& rbuf);
+
+   /// RecvBatch 模式, 建構時從 Owner_ 取得設定.
+   /// 若有啟用 Gro, 則 RecvBatch_ = Owner_->GetGroBatch();
+   const uint16_t RecvBatch_;
+   const bool     IsUdpGro_;
+   /// 每個 BatchNodes_ 的大小: 啟用 Gro 時為 DgramBase::kGroBufferSize, 否則為 Owner_->GetMaxDgramSize();
+   const uint32_t BatchNodeSize_;
+   /// recvmmsg() 的接收緩衝, 每個 datagram 使用一個 node, 沒用到的 node 留到下次使用.
+   std::vector<FwdBufferNode*>   BatchNodes_;
+   /// 已收到, 但尚未觸發 OnDevice_Recv() 的 datagrams.
+   /// 當 Recv 事件被移到 op thread 處理時, 剩餘的 datagrams 會留在這裡, 等 op thread 處理完後再繼續.
+   std::vector<FwdBufferNode*>   PendingDgrams_;
+   size_t                        PendingIndex_{0};
+
+   struct DgramRecvAux;
+   /// \retval false 事件被移到 op thread 處理, 此時不應再繼續接收.
+   bool DeliverPendingDgrams(Device& dev, FnIsRecvBufferAlive fnIsRecvBufferAlive);
+   void ClearPendingDgrams();
+   bool CheckReadBatch(Device& dev, FnIsRecvBufferAlive fnIsRecvBufferAlive);
+
    virtual void OnFdrEvent_Handling(FdrEventFlag evs) override;
    virtual void OnFdrEvent_StartSend() override;
    virtual void OnFdrSocket_Error(std::string errmsg) override;
    virtual void SocketError(StrView fnName, int eno) override;
+   /// 尚有等候 op thread 處理完畢後才能繼續觸發的 PendingDgrams_, 則不是閒置.
+   virtual bool IsFdrEventIdle() const override;
 
 public:
    using OwnerDevice = DgramT<FdrServiceSP, FdrDgramImpl>;
@@ -21,10 +44,23 @@ public:
    const OwnerDeviceSP  Owner_;
 
    FdrDgramImpl(OwnerDevice* owner, Socket&& so, SocketResult&)
-      : base{*owner->IoService_, std::move(so)}
+      : base{*owner->IoService_, std::move(so), owner->GetManagerDeviceName()}
+      , RecvBatch_{owner->IsUdpGro() ? owner->GetGroBatch() : owner->GetRecvBatch()}
+      , IsUdpGro_{owner->IsUdpGro()}
+      , BatchNodeSize_{owner->IsUdpGro() ? static_cast<uint32_t>(DgramBase::kGroBufferSize) : owner->GetMaxDgramSize()}
       , Owner_{owner} {
    }
+   ~FdrDgramImpl();
+
    bool OpImpl_ConnectTo(const SocketAddress& addr, SocketResult& soRes);
+
+   /// 若有設定 RecvBatch(或啟用 Gro), 則使用 recvmmsg() 一次取出多個 datagram,
+   /// 否則使用 FdrSocket::CheckRead();
+   bool CheckRead(Device& dev, FnIsRecvBufferAlive fnIsRecvBufferAlive) {
+      if (this->RecvBatch_ <= 1 && !this->IsUdpGro_)
+         return base::CheckRead(dev, fnIsRecvBufferAlive);
+      return this->CheckReadBatch(dev, fnIsRecvBufferAlive);
+   }
 };
 
 //--------------------------------------------------------------------------//
@@ -0,0 +1,254 @@
+﻿/// \file fon9/io/FdrDgram_UT.cpp
+/// \author fonwinz@gmail.com
+#include "fon9/TestTools.hpp"
+#include "fon9/sys/Config.h"
+#if defined(fon9_POSIX) && defined(__linux__)
+#include "fon9/io/SimpleManager.hpp"
+#include "fon9/io/FdrServiceEpoll.hpp"
+#include "fon9/io/FdrDgram.hpp"
+#include "fon9/MustLock.hpp"
+#include <netinet/udp.h>
+
+//--------------------------------------------------------------------------//
+fon9_WARN_DISABLE_PADDING;
+/// 每次 OnDevice_Recv() 收到的資料, 各自存成一個 std::string;
+/// 用來檢查: 每個 datagram 是否個別觸發一次事件.
+class DgramSession : public fon9::io::Session {
+   fon9_NON_COPY_NON_MOVE(DgramSession);
+   using Dgrams = fon9::MustLock<std::vector<std::string>>;
+   Dgrams   Dgrams_;
+
+   fon9::io::RecvBufferSize OnDevice_LinkReady(fon9::io::Device&) override {
+      this->IsLinkReady_ = true;
+      return fon9::io::RecvBufferSize::Default;
+   }
+   fon9::io::RecvBufferSize OnDevice_Recv(fon9::io::Device&, fon9::DcQueueList& rxbuf) override {
+      this->Dgrams_.Lock()->push_back(fon9::BufferTo<std::string>(rxbuf.MoveOut()));
+      if (this->IsHoldFirstRecv_) {
+         // 停在第一個事件, 讓後續的 datagrams 累積在 socket 裡, 之後才能一次取出多個.
+         this->IsHoldFirstRecv_ = false;
+         this->IsHolding_ = true;
+         while (this->IsHolding_)
+            std::this_thread::yield();
+      }
+      return fon9::io::RecvBufferSize::Default;
+   }
+public:
+   std::atomic<bool> IsLinkReady_{false};
+   std::atomic<bool> IsHoldFirstRecv_{false};
+   std::atomic<bool> IsHolding_{false};
+
+   DgramSession() = default;
+
+   std::vector<std::string> WaitDgrams(size_t count) {
+      for (unsigned L = 0; L < 2000; ++L) {
+         {
+            Dgrams::Locker dgrams{this->Dgrams_};
+            if (dgrams->size() >= count) {
+               std::vector<std::string> retval;
+               retval.swap(*dgrams);
+               return retval;
+            }
+         }
+         std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      }
+      return std::move(*this->Dgrams_.Lock());
+   }
+};
+using DgramSessionSP = fon9::intrusive_ptr<DgramSession>;
+fon9_WARN_POP;
+
+static fon9::io::FdrServiceSP  IoService_;
+
+struct DgramTester {
+   fon9_NON_COPY_NON_MOVE(DgramTester);
+   fon9::io::ManagerCSP Mgr_{new fon9::io::SimpleManager{}};
+   DgramSessionSP       Ses_{new DgramSession{}};
+   fon9::io::DeviceSP   Dev_;
+   int                  Sender_;
+   sockaddr_in          Addr_;
+
+   DgramTester(const char* cfgs) {
+      // 先取得一個可用的 port.
+      this->Sender_ = socket(AF_INET, SOCK_DGRAM, 0);
+      fon9::ZeroStruct(this->Addr_);
+      this->Addr_.sin_family = AF_INET;
+      this->Addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      bind(this->Sender_, reinterpret_cast<sockaddr*>(&this->Addr_), sizeof(this->Addr_));
+      socklen_t addrlen = sizeof(this->Addr_);
+      getsockname(this->Sender_, reinterpret_cast<sockaddr*>(&this->Addr_), &addrlen);
+      close(this->Sender_);
+      this->Sender_ = socket(AF_INET, SOCK_DGRAM, 0);
+
+      this->Dev_.reset(new fon9::io::FdrDgram(IoService_, this->Ses_, this->Mgr_));
+      this->Dev_->Initialize();
+      this->Dev_->AsyncOpen(fon9::RevPrintTo<std::string>(
+         "Bind=127.0.0.1:", ntohs(this->Addr_.sin_port), '|', cfgs));
+      for (unsigned L = 0; L < 2000 && !this->Ses_->IsLinkReady_; ++L)
+         std::this_thread::sleep_for(std::chrono::milliseconds{1});
+      if (!this->Ses_->IsLinkReady_) {
+         std::cout << "|cfgs=" << cfgs << "|err=LinkReady timeout" "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+   ~DgramTester() {
+      this->Dev_->AsyncDispose("test end");
+      this->Dev_->WaitGetDeviceId();
+      this->Dev_.reset();
+      close(this->Sender_);
+   }
+   void Send(const std::string& dgram) {
+      sendto(this->Sender_, dgram.data(), dgram.size(), 0, reinterpret_cast<sockaddr*>(&this->Addr_), sizeof(this->Addr_));
+   }
+   /// 取得 DeviceInfo 裡面的 "|name=value" 的 value;
+   uint64_t GetInfo(fon9::StrView name) {
+      const std::string info = this->Dev_->WaitGetDeviceInfo();
+      const std::string key = "|" + name.ToString() + "=";
+      const auto        pos = info.find(key);
+      if (pos == std::string::npos)
+         return 0;
+      return fon9::StrTo(fon9::StrView{info.c_str() + pos + key.size(), info.c_str() + info.size()}, uint64_t{0});
+   }
+   void CheckDgrams(const std::vector<std::string>& expected) {
+      const std::vector<std::string> dgrams = this->Ses_->WaitDgrams(expected.size());
+      if (dgrams.size() != expected.size()) {
+         std::cout << "|dgrams=" << dgrams.size() << "|expected=" << expected.size() << "\r[ERROR]" << std::endl;
+         abort();
+      }
+      for (size_t L = 0; L < dgrams.size(); ++L) {
+         if (dgrams[L] != expected[L]) {
+            std::cout << "|index=" << L << "|size=" << dgrams[L].size() << "|expected=" << expected[L].size()
+                      << "|err=datagram content" "\r[ERROR]" << std::endl;
+            abort();
+         }
+      }
+      // 確定沒有多餘的事件.
+      std::this_thread::sleep_for(std::chrono::milliseconds{20});
+      if (!this->Ses_->WaitDgrams(0).empty()) {
+         std::cout << "|err=unexpected datagram" "\r[ERROR]" << std::endl;
+         abort();
+      }
+   }
+};
+
+static std::string MakeDgram(size_t size, unsigned seed) {
+   std::string dgram(size, '\0');
+   for (size_t L = 0; L < size; ++L)
+      dgram[L] = static_cast<char>(seed + L * 7);
+   return dgram;
+}
+//--------------------------------------------------------------------------//
+void TestRecvBatch() {
+   std::cout << "[TEST ] RecvBatch=8" << std::flush;
+   DgramTester tester{"RecvBatch=8"};
+   std::vector<std::string> expected;
+   for (unsigned L = 0; L < 20; ++L)
+      expected.push_back(MakeDgram(100 + L, L));
+   // 第1個 datagram 的事件暫停, 此時送出其餘的 datagrams, 之後應可一次 recvmmsg() 取出多個.
+   tester.Ses_->IsHoldFirstRecv_ = true;
+   tester.Send(expected[0]);
+   while (!tester.Ses_->IsHolding_)
+      std::this_thread::yield();
+   for (unsigned L = 1; L < expected.size(); ++L)
+      tester.Send(expected[L]);
+   std::this_thread::sleep_for(std::chrono::milliseconds{10});
+   tester.Ses_->IsHolding_ = false;
+   tester.CheckDgrams(expected);
+   const uint64_t calls = tester.GetInfo("RecvCalls");
+   const uint64_t dgrams = tester.GetInfo("RecvDgrams");
+   std::cout << "|RecvCalls=" << calls << "|RecvDgrams=" << dgrams;
+   if (dgrams != expected.size() || calls <= 1 || calls > 1 + (expected.size() - 1 + 7) / 8) {
+      std::cout << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+void TestTrunc() {
+   std::cout << "[TEST ] RecvBatch=4|MaxDgram=512" << std::flush;
+   DgramTester tester{"RecvBatch=4|MaxDgram=512"};
+   const std::string d1 = MakeDgram(100, 1), d2 = MakeDgram(1000, 2), d3 = MakeDgram(512, 3), d4 = MakeDgram(513, 4);
+   tester.Send(d1);
+   tester.Send(d2); // 超過 MaxDgram: 拋棄, 不可送出部分資料.
+   tester.Send(d3); // 剛好 MaxDgram: 正常收到.
+   tester.Send(d4);
+   tester.CheckDgrams({d1, d3});
+   const uint64_t truncs = tester.GetInfo("TruncDgrams");
+   std::cout << "|TruncDgrams=" << truncs;
+   if (truncs != 2) {
+      std::cout << "\r[ERROR]" << std::endl;
+      abort();
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+void TestGro() {
+   std::cout << "[TEST ] Gro=Y" << std::flush;
+#if !defined(UDP_GRO) || !defined(UDP_SEGMENT)
+   std::cout << "|UDP_GRO or UDP_SEGMENT not defined." "\r[SKIP ]" << std::endl;
+#else
+   DgramTester tester{"Gro=Y"};
+   if (tester.GetInfo("RecvBatch") == 0) {
+      std::cout << "|UDP_GRO not supported." "\r[SKIP ]" << std::endl;
+      return;
+   }
+   // 使用 UDP_SEGMENT(GSO) 送出, 核心會將多個 segment 合併成一個 GRO 封包交給接收端;
+   // segSize 無法整除資料量, 最後一個 datagram 較小.
+   const uint16_t    segSize = 300;
+   const std::string gsoPayload = MakeDgram(1000, 5);
+   char              cmsgBuf[CMSG_SPACE(sizeof(uint16_t))];
+   struct iovec      iov;
+   struct msghdr     msg;
+   fon9::ZeroStruct(cmsgBuf);
+   fon9::ZeroStruct(msg);
+   iov.iov_base = const_cast<char*>(gsoPayload.data());
+   iov.iov_len = gsoPayload.size();
+   msg.msg_name = &tester.Addr_;
+   msg.msg_namelen = sizeof(tester.Addr_);
+   msg.msg_iov = &iov;
+   msg.msg_iovlen = 1;
+   msg.msg_control = cmsgBuf;
+   msg.msg_controllen = sizeof(cmsgBuf);
+   struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+   cmsg->cmsg_level = SOL_UDP;
+   cmsg->cmsg_type = UDP_SEGMENT;
+   cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+   memcpy(CMSG_DATA(cmsg), &segSize, sizeof(segSize));
+   if (sendmsg(tester.Sender_, &msg, 0) < 0) {
+      std::cout << "|UDP_SEGMENT not supported|errno=" << errno << "\r[SKIP ]" << std::endl;
+      return;
+   }
+   const std::string single = MakeDgram(50, 6);
+   tester.Send(single);
+   std::vector<std::string> expected;
+   for (size_t pos = 0; pos < gsoPayload.size(); pos += segSize)
+      expected.push_back(gsoPayload.substr(pos, segSize));
+   expected.push_back(single);
+   tester.CheckDgrams(expected);
+   // RecvDgrams 為 recvmmsg() 取出的數量(拆開前), 若等於 dgrams 則表示核心沒有合併, 此時沒有測到拆開的功能.
+   const uint64_t rdgrams = tester.GetInfo("RecvDgrams");
+   std::cout << "|dgrams=" << expected.size() << "|RecvDgrams=" << rdgrams
+             << (rdgrams < expected.size() ? "" : "|not coalesced") << "\r[OK   ]" << std::endl;
+#endif
+}
+
+int main(int argc, char** argv) {
+   (void)argc; (void)argv;
+   fon9::AutoPrintTestInfo utinfo("FdrDgram");
+   fon9::io::IoServiceArgs       iosvArgs;
+   fon9::io::FdrServiceEpoll::MakeResult err;
+   iosvArgs.ThreadCount_ = 1;
+   IoService_ = fon9::io::FdrServiceEpoll::MakeService(iosvArgs, "FdrDgram_UT", err);
+   if (!IoService_) {
+      std::cout << "IoService.MakeService|" << fon9::RevPrintTo<std::string>(err) << "\r[ERROR]" << std::endl;
+      return 3;
+   }
+   TestRecvBatch();
+   TestTrunc();
+   TestGro();
+   IoService_.reset();
+}
+#else
+int main() {
+   fon9::AutoPrintTestInfo utinfo("FdrDgram");
+   std::cout << "recvmmsg() not supported.\r[SKIP ]" << std::endl;
+}
+#endif
@@ -8,16 +8,126 @@
 namespace fon9 { namespace io {
 
 FdrService::FdrService(FdrThreads thrs, const IoServiceArgs& ioArgs, const std::string& thrName)
-   : FdrThreads_{std::move(thrs)} {
+   : FdrThreads_{std::move(thrs)}
+   , AllocPolicy_{ioArgs.FdrAllocPolicy_}
+   , Pins_{ioArgs.FdrPins_} {
    assert(!this->FdrThreads_.empty());
+   EvRates::Locker{this->EvRates_}->resize(this->FdrThreads_.size());
    size_t L = 0;
    for (auto& thr : this->FdrThreads_)
       thr->Thread_ = std::thread(&FdrThread::ThrRun, thr.get(), ServiceThreadArgs{ioArgs, thrName, L++});
 }
 FdrService::~FdrService() {
 }
-FdrThreadSP FdrService::AllocFdrThread(Fdr::fdr_t fd) {
-   return this->FdrThreads_[static_cast<size_t>(fd) % this->FdrThreads_.size()];
+const IoServiceArgs::FdrPin* FdrService::FindPin(StrView devName) const {
+   if (!devName.empty()) {
+      for (const IoServiceArgs::FdrPin& pin : this->Pins_) {
+         if (devName == ToStrView(pin.DeviceName_))
+            return &pin;
+      }
+   }
+   return nullptr;
+}
+FdrThreadSP FdrService::AllocFdrThread(Fdr::fdr_t fd, StrView devName) {
+   const size_t thrCount = this->FdrThreads_.size();
+   if (const IoServiceArgs::FdrPin* pin = this->FindPin(devName))
+      return this->FdrThreads_[pin->ThreadIndex_ % thrCount];
+   if (thrCount > 1 && this->AllocPolicy_ != FdrAllocPolicy::FdMod)
+      return this->FdrThreads_[this->FindLeastLoaded(this->AllocPolicy_)];
+   return this->FdrThreads_[static_cast<size_t>(fd) % thrCount];
+}
+size_t FdrService::FindLeastLoaded(FdrAllocPolicy policy) {
+   const size_t thrCount = this->FdrThreads_.size();
+   size_t       retval = 0;
+   if (policy == FdrAllocPolicy::LeastEvents) {
+      EvRates::Locker   rates{this->EvRates_};
+      const uint64_t    now = LatencyHistogram::NowNS();
+      for (size_t L = 0; L < thrCount; ++L) {
+         EvRate&        r = (*rates)[L];
+         const uint64_t cnt = this->FdrThreads_[L]->GetEventCount();
+         const uint64_t ms = (now - r.LastNS_) / 1000000;
+         if (ms >= 1000) {
+            if (r.LastNS_)
+               r.PerSec_ = (cnt - r.LastCount_) * 1000 / ms;
+            r.LastCount_ = cnt;
+            r.LastNS_ = now;
+         }
+         if (L > 0) {
+            const EvRate& rmin = (*rates)[retval];
+            if (r.PerSec_ < rmin.PerSec_
+                || (r.PerSec_ == rmin.PerSec_
+                    && this->FdrThreads_[L]->GetHandlerCount() < this->FdrThreads_[retval]->GetHandlerCount()))
+               retval = L;
+         }
+      }
+      return retval;
+   }
+   for (size_t L = 1; L < thrCount; ++L) {
+      if (this->FdrThreads_[L]->GetHandlerCount() < this->FdrThreads_[retval]->GetHandlerCount())
+         retval = L;
+   }
+   return retval;
+}
+bool FdrService::MigrateFdrEventHandler(FdrEventHandler& handler, size_t toIndex) {
+   if (toIndex >= this->FdrThreads_.size() || &handler.GetFdrService() != this || handler.IsFdrRemoved())
+      return false;
+   FdrThread* from = handler.GetFdrThread();
+   const FdrThreadSP& to = this->FdrThreads_[toIndex];
+   if (from == to.get())
+      return false;
+   from->MigrateFdrEvent(&handler, to);
+   return true;
+}
+bool FdrService::MigrateToLeastLoaded(FdrEventHandler& handler) {
+   if (&handler.GetFdrService() != this)
+      return false;
+   const FdrAllocPolicy policy = (this->AllocPolicy_ == FdrAllocPolicy::FdMod ? FdrAllocPolicy::LeastConn : this->AllocPolicy_);
+   const size_t   toIndex = this->FindLeastLoaded(policy);
+   FdrThread*     from = handler.GetFdrThread();
+   FdrThread*     to = this->FdrThreads_[toIndex].get();
+   if (from == to || from->GetHandlerCount() <= 1)
+      return false;
+   if (policy == FdrAllocPolicy::LeastConn) {
+      // 轉移後, 目的 thread 的 handler 數量, 必須仍比原本的少, 否則只是互換.
+      if (to->GetHandlerCount() + 1 >= from->GetHandlerCount())
+         return false;
+   }
+   else {
+      // 目的 thread 的每秒事件數量, 必須明顯低於原本的, 否則可能在 thread 之間來回轉移.
+      EvRates::Locker   rates{this->EvRates_};
+      size_t            fromIndex = 0;
+      while (this->FdrThreads_[fromIndex].get() != from)
+         ++fromIndex;
+      if ((*rates)[toIndex].PerSec_ * 2 >= (*rates)[fromIndex].PerSec_)
+         return false;
+   }
+   return this->MigrateFdrEventHandler(handler, toIndex);
+}
+void FdrService::AppendLatencyInfo(std::string& info) const {
+   RevBufferList rbuf{256};
+   for (size_t L = this->FdrThreads_.size(); L > 0;) {
+      const FdrThread& thr = *this->FdrThreads_[--L];
+      RevPrint(rbuf, "|thr=", L + 1,
+               "|Wakeup:", thr.GetWakeupLatency(),
+               "|Dispatch:", thr.GetDispatchLatency());
+   }
+   BufferAppendTo(rbuf.MoveOut(), info);
+}
+void FdrService::AppendThreadsInfo(std::string& info) {
+   this->FindLeastLoaded(FdrAllocPolicy::LeastEvents); // 更新 EvRates_;
+   EvRates::Locker   rates{this->EvRates_};
+   RevBufferList     rbuf{256};
+   for (size_t L = this->FdrThreads_.size(); L > 0;) {
+      const FdrThread& thr = *this->FdrThreads_[--L];
+      RevPrint(rbuf, "|thr=", L + 1,
+               ":Handlers=", thr.GetHandlerCount(),
+               "|Events=", thr.GetEventCount(),
+               "|EvPerSec=", (*rates)[L].PerSec_,
+               "|WakeupLatency:", thr.GetWakeupLatency(),
+               "|DispatchLatency:", thr.GetDispatchLatency());
+   }
+   RevPrint(rbuf, "|Alloc=", FdrAllocPolicyToStr(this->AllocPolicy_));
+   BufferAppendTo(rbuf.MoveOut(), info);
 }
 
 //--------------------------------------------------------------------------//
@@ -29,7 +139,34 @@ void intrusive_ptr_deleter(const FdrThread* p) {
       delete p;
 }
 
+FdrThread::FdrThread()
+   : PendingUpdates_{&FdrEventHandler::PendingUpdateNode_}
+   , PendingSends_{&FdrEventHandler::PendingSendNode_}
+   , PendingRemoves_{&FdrEventHandler::PendingRemoveNode_} {
+}
 FdrThread::~FdrThread() {
+   // 釋放仍在佇列裡面的 handler 參考計數.
+   MoveOutPendingImpl(this->PendingSends_);
+   MoveOutPendingImpl(this->PendingUpdates_);
+   MoveOutPendingImpl(this->PendingRemoves_);
+}
+bool FdrThread::PendingReqs::Push(FdrEventHandlerSP&& handler) {
+   FdrPendingNode& node = handler.get()->*this->NodeMember_;
+   if (node.IsQueued_.exchange(true, std::memory_order_acq_rel))
+      return false;
+   // 由佇列擁有 handler 的參考計數, 在 MoveOut() 時交給 out.
+   this->Queue_.push(&node);
+   handler.detach();
+   return true;
+}
+void FdrThread::PendingReqs::MoveOut(PendingReqsImpl& out) {
+   while (MpscNode* node = this->Queue_.pop()) {
+      FdrPendingNode* pnode = static_cast<FdrPendingNode*>(node);
+      // 必須在處理之前清除 IsQueued_, 處理期間若有新的要求, 才能再次放入佇列.
+      // 使用 exchange(acq_rel): 確保可以看到「因 IsQueued_ 而合併」的 producer 在要求之前的異動.
+      pnode->IsQueued_.exchange(false, std::memory_order_acq_rel);
+      out.emplace_back(pnode->Owner_, false);
+   }
 }
 void FdrThread::CancelReqs(PendingReqsImpl reqs) {
    for (FdrEventHandlerSP& r : reqs)
@@ -38,6 +175,8 @@ void FdrThread::CancelReqs(PendingReqsImpl reqs) {
 void FdrThread::ThrRun(ServiceThreadArgs args) {
    args.OnThrRunBegin("FdrThread");
    this->ThreadId_ = ThisThread_.ThreadId_;
+   this->RebalanceNS_ = args.RebalanceSecs_ * uint64_t{1000000000};
+   this->LastRebalanceNS_ = LatencyHistogram::NowNS();
    this->ThrRunImpl(args);
    if (this->use_count() != 0) {
       // select(), poll(), epoll_wait()... error.
@@ -47,34 +186,104 @@ void FdrThread::ThrRun(ServiceThreadArgs args) {
          this->CancelReqs(MoveOutPendingImpl(this->PendingSends_));
          this->CancelReqs(MoveOutPendingImpl(this->PendingUpdates_));
          MoveOutPendingImpl(this->PendingRemoves_);
+         PendingMigrates::Locker{this->PendingMigrates_}->clear();
          std::this_thread::yield();
       }
    }
    this->Thread_.detach();
-   fon9_LOG_ThrRun("FdrThread.ThrRun.End|name=", args.Name_);
+   fon9_LOG_ThrRun("FdrThread.ThrRun.End|name=", args.Name_,
+                   "|index=", args.ThreadPoolIndex_ + 1,
+                   "|WakeupLatency:", this->WakeupLatency_,
+                   "|DispatchLatency:", this->DispatchLatency_);
    delete this;
 }
 void FdrThread::ProcessPendingSends() {
    PendingReqsImpl reqs = this->MoveOutPendingImpl(this->PendingSends_);
-   for (FdrEventHandlerSP& sender : reqs)
-      sender->OnFdrEvent_StartSend();
+   for (FdrEventHandlerSP& sender : reqs) {
+      if (fon9_UNLIKELY(this->IsMigratedFrom(sender.get())))
+         sender->StartSendInFdrThread();
+      else
+         sender->OnFdrEvent_StartSend();
+   }
 }
-void FdrThread::PushToPendingReqs(PendingReqs& reqs, FdrEventHandlerSP&& handler) {
+void FdrThread::RebalanceCandidate::Check(FdrEventHandler* hdr) {
+   const uint32_t evCount = hdr->FdrEventCount_;
+   hdr->FdrEventCount_ = 0;
+   if (hdr->IsFdrPinned_ || (this->Handler_ && this->EventCount_ <= evCount) || !hdr->IsFdrEventIdle())
+      return;
+   this->Handler_ = hdr;
+   this->EventCount_ = evCount;
+}
+void FdrThread::RebalanceCandidate::Migrate() {
+   if (this->Handler_)
+      this->Handler_->GetFdrService().MigrateToLeastLoaded(*this->Handler_);
+}
+void FdrThread::MigrateFdrEvent(FdrEventHandlerSP handler, intrusive_ptr<FdrThread> to) {
    {
-      PendingReqs::Locker lk{reqs};
-      lk->emplace_back(std::move(handler));
+      PendingMigrates::Locker lk{this->PendingMigrates_};
+      lk->emplace_back(MigrateReq{std::move(handler), std::move(to)});
    }
    this->WakeupThread();
 }
+bool FdrThread::CheckMigrate(MigrateReq& req) {
+   FdrEventHandler* hdr = req.Handler_.get();
+   if (this->IsMigratedFrom(hdr)) {
+      // 在此要求之前, 已轉移到其他 thread, 所以改由 hdr 目前的 FdrThread 處理.
+      if (hdr->GetFdrThread() != req.To_.get())
+         hdr->GetFdrThread()->MigrateFdrEvent(std::move(req.Handler_), std::move(req.To_));
+      return false;
+   }
+   if (req.To_.get() == this)
+      return false;
+   // 已移除: 若仍轉移, 則新的 FdrThread 會重新註冊已移除的 handler.
+   if (hdr->IsFdrRemoved())
+      return false;
+   if (!hdr->IsFdrEventIdle()) {
+      fon9_LOG_WARN("FdrThread.Migrate|fd=", hdr->GetFD(), "|hdr=", ToPtr{hdr}, "|err=Not idle");
+      return false;
+   }
+   return true;
+}
+void FdrThread::MigrateTo(MigrateReq& req) {
+   FdrEventHandler* hdr = req.Handler_.get();
+   assert(hdr->GetFdrEventHandlerBookmark() == 0);
+   this->HandlerCount_.fetch_sub(1, std::memory_order_relaxed);
+   req.To_->HandlerCount_.fetch_add(1, std::memory_order_relaxed);
+   hdr->FdrThread_.store(req.To_.get(), std::memory_order_release);
+   fon9_LOG_INFO("FdrThread.Migrate|fd=", hdr->GetFD(), "|hdr=", ToPtr{hdr}, "|from=", ToPtr{this}, "|to=", ToPtr{req.To_.get()});
+   req.To_->UpdateFdrEvent(std::move(req.Handler_));
+}
+void FdrThread::PushToPendingReqs(PendingReqs& reqs, FdrEventHandlerSP&& handler) {
+   // 若與之前的要求合併, 則之前的要求已(或即將)喚醒 FdrThread, 不用再 wakeup.
+   if (reqs.Push(std::move(handler)))
+      this->WakeupThread();
+}
 void FdrThread::WakeupThread() {
+   if (this->IsThisThread()) {
+      this->WakeupRequests_.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   // 只保留最早的要求時間, 在 ClearWakeup() 時計算延遲.
+   uint64_t reqns = 0;
+   this->WakeupRequestNS_.compare_exchange_strong(reqns, LatencyHistogram::NowNS(), std::memory_order_relaxed);
    if (this->WakeupRequests_.fetch_add(1, std::memory_order_relaxed) == 0)
-      if (!this->IsThisThread())
-         this->WakeupFdr_.Wakeup();
+      this->WakeupFdr_.Wakeup();
 }
 
 //--------------------------------------------------------------------------//
 
+FdrEventHandler::FdrEventHandler(FdrService& iosv, FdrAuto&& fd, StrView devName)
+   : FdrService_{&iosv}
+   , FdrThread_{iosv.AllocFdrThread(fd.GetFD(), devName).get()}
+   , Fdr_{std::move(fd)}
+   , IsFdrPinned_{iosv.IsPinnedDevice(devName)} {
+   this->GetFdrThread()->HandlerCount_.fetch_add(1, std::memory_order_relaxed);
+}
 FdrEventHandler::~FdrEventHandler() {
+   this->GetFdrThread()->HandlerCount_.fetch_sub(1, std::memory_order_relaxed);
+}
+bool FdrEventHandler::IsFdrEventIdle() const {
+   return true;
 }
 
 } } // namespaces
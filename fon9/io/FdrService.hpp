@@ -7,6 +7,8 @@
 #include "fon9/FdrNotify.hpp"
 #include "fon9/MustLock.hpp"
 #include "fon9/ThreadId.hpp"
+#include "fon9/LatencyHistogram.hpp"
+#include "fon9/MpscQueue.hpp"
 
 #include <thread>
 #include <vector>
@@ -27,6 +29,10 @@ enum class FdrEventFlag {
    /// 當有錯誤發生, 一定會通知,
    /// 註冊事件時不用提供此旗標.
    Error = 0x0100,
+   /// 註冊事件時提供此旗標, 表示 handler 會自行處理 socket error queue (e.g. MSG_ZEROCOPY 完成通知);
+   /// 此時若只有 POLLERR(沒有 POLLHUP), FdrThread 不會自動移除 handler, 而是用此旗標通知,
+   /// 由 handler 取出 error queue 的內容, 並自行判斷是否為真正的錯誤.
+   ErrQueue = 0x0200,
 
    /// 當無法提供服務時, 透過此旗標告知.
    OperationCanceled = 0x1000,
@@ -35,45 +41,163 @@ fon9_ENABLE_ENUM_BITWISE_OP(FdrEventFlag);
 
 //--------------------------------------------------------------------------//
 
+/// \ingroup io
+/// 嵌入在 FdrEventHandler 裡面的 FdrThread 要求節點, 每種要求(Update, Send, Remove)各一個.
+/// - 放入 FdrThread 的等候佇列時, 由佇列擁有一個 handler 的參考計數, 取出時釋放.
+/// - 若同一種要求已在佇列裡面(尚未被 FdrThread 取出), 則不會重複放入:
+///   FdrThread 取出後才會處理 handler 當時的狀態, 所以合併後的結果與分開處理相同.
+struct FdrPendingNode : public MpscNode {
+   fon9_NON_COPY_NON_MOVE(FdrPendingNode);
+   FdrEventHandler* const  Owner_;
+   std::atomic<bool>       IsQueued_{false};
+   explicit FdrPendingNode(FdrEventHandler* owner) : Owner_{owner} {
+   }
+};
+
 /// \ingroup io
 /// 處理事件通知的 thread.
 /// - 實際作法可能使用 select(), poll(), epoll(linux), kqueue(FreeBSD)...
 /// - 每個 FdrThread 負責服務一批 FdrEventHandler
 /// - 在 FdrEventHandler 建構時, 由 FdrService 決定該 handler 由哪個 FdrThread 服務
+///   - 之後可透過 FdrService::MigrateFdrEventHandler() 轉移到同一個 FdrService 的其他 FdrThread.
 /// - 只有在全部的 FdrEventHandler 死亡後, 才會結束 thread.
 class FdrThread : public intrusive_ref_counter<FdrThread> {
 protected:
    using PendingReqsImpl = std::vector<FdrEventHandlerSP>;
-   using PendingReqs = MustLock<PendingReqsImpl>;
+   /// 等候 FdrThread 處理的要求: 使用 lock-free MPSC 佇列(MpscQueue), 節點嵌入在 FdrEventHandler.
+   /// - 任意 thread 可放入(Push), 只有 FdrThread 會取出(MoveOutPendingImpl).
+   class PendingReqs {
+      fon9_NON_COPY_NON_MOVE(PendingReqs);
+      MpscQueue   Queue_;
+   public:
+      FdrPendingNode FdrEventHandler::* const NodeMember_;
+      explicit PendingReqs(FdrPendingNode FdrEventHandler::* nodeMember) : NodeMember_{nodeMember} {
+      }
+      /// \retval false 已在佇列裡面, 與之前的要求合併.
+      bool Push(FdrEventHandlerSP&& handler);
+      /// 只能在 FdrThread 呼叫.
+      void MoveOut(PendingReqsImpl& out);
+   };
    PendingReqs       PendingUpdates_;
    PendingReqs       PendingSends_;
    PendingReqs       PendingRemoves_;
+   struct MigrateReq {
+      FdrEventHandlerSP Handler_;
+      intrusive_ptr<FdrThread> To_;
+   };
+   using PendingMigratesImpl = std::vector<MigrateReq>;
+   using PendingMigrates = MustLock<PendingMigratesImpl>;
+   PendingMigrates   PendingMigrates_;
    FdrNotify         WakeupFdr_;
    ThreadId::IdType  ThreadId_;
    std::atomic_uint_fast32_t  WakeupRequests_{0};
-
+   /// 其他 thread 第一次要求 wakeup 的時間(LatencyHistogram::NowNS()), 0 表示沒有等候中的要求.
+   std::atomic<uint64_t>      WakeupRequestNS_{0};
+   /// 從其他 thread 要求 wakeup, 到 FdrThread 開始處理 pendings 的延遲.
+   LatencyHistogram           WakeupLatency_;
+   /// 從 FdrThread 醒來(例: epoll_wait() 返回), 到 handler 處理完該事件的延遲.
+   /// 包含同一批事件中, 排在前面的 handler 處理時間.
+   LatencyHistogram           DispatchLatency_;
+   /// 由此 thread 服務的 handler 數量.
+   std::atomic<uint32_t>      HandlerCount_{0};
+   /// 已觸發的事件數量(OnFdrEvent_Emit() 的次數), 只有 this thread 會寫入.
+   std::atomic<uint64_t>      EventCount_{0};
+   /// IoServiceArgs::RebalanceSecs_ 換算成 ns, 0 = 不自動轉移.
+   uint64_t                   RebalanceNS_{0};
+   uint64_t                   LastRebalanceNS_{0};
+
+   /// 在處理 pendings 之前呼叫, 同時記錄 wakeup 的延遲.
    void ClearWakeup() {
       assert(this->IsThisThread());
+      if (const uint64_t reqns = this->WakeupRequestNS_.exchange(0, std::memory_order_relaxed))
+         this->WakeupLatency_.AddSince(reqns);
       this->WakeupFdr_.ClearWakeup();
       this->WakeupRequests_.store(0, std::memory_order_relaxed);
    }
 
-   static void OnFdrEvent_Emit(FdrEventFlag evs, FdrEventHandler* handler);
+   void OnFdrEvent_Emit(FdrEventFlag evs, FdrEventHandler* handler);
    static void SetFdrEventHandlerBookmark(FdrEventHandler* handler, uint64_t bookmark);
 
-   static PendingReqsImpl MoveOutPendingImpl(PendingReqs& impl) {
-      PendingReqs::Locker lk{impl};
-      return std::move(*lk);
+   static PendingReqsImpl MoveOutPendingImpl(PendingReqs& reqs) {
+      PendingReqsImpl impl;
+      reqs.MoveOut(impl);
+      return impl;
    }
 
    void ProcessPendingSends();
 
+   /// handler 已轉移到其他 FdrThread? 若是, 則 this thread 不可再處理它的 Bookmark.
+   /// 此時應將要求轉給 handler 目前的 FdrThread, 例: handler->UpdateFdrEvent();
+   bool IsMigratedFrom(const FdrEventHandler* handler) const;
+
+   /// 在衍生者的 ProcessPendings() 裡面呼叫.
+   /// 取出轉移要求, 若 handler 閒置中, 則呼叫 fnRemove(handler) 從 this thread 移除,
+   /// 然後交給新的 FdrThread 註冊事件.
+   template <class FnRemove>
+   void ProcessPendingMigrates(FnRemove&& fnRemove) {
+      PendingMigratesImpl reqs;
+      {
+         PendingMigrates::Locker lk{this->PendingMigrates_};
+         if (fon9_LIKELY(lk->empty()))
+            return;
+         reqs.swap(*lk);
+      }
+      for (MigrateReq& req : reqs) {
+         if (this->CheckMigrate(req)) {
+            fnRemove(req.Handler_.get());
+            this->MigrateTo(req);
+         }
+      }
+   }
+
+   /// 在衍生者的事件迴圈裡面呼叫, 若 RebalanceNS_ == 0 則直接傳回 false.
+   /// 每隔 RebalanceNS_ 傳回一次 true, 此時衍生者應:
+   /// \code
+   ///   RebalanceCandidate cand;
+   ///   for (each handler served by this thread)
+   ///      cand.Check(handler);
+   ///   cand.Migrate();
+   /// \endcode
+   bool IsRebalanceTime() {
+      if (fon9_LIKELY(this->RebalanceNS_ == 0))
+         return false;
+      const uint64_t now = LatencyHistogram::NowNS();
+      if (now - this->LastRebalanceNS_ < this->RebalanceNS_)
+         return false;
+      this->LastRebalanceNS_ = now;
+      return this->GetHandlerCount() > 1;
+   }
+   /// 選出「上次檢查後事件最少, 閒置中, 沒有 Pin」的 handler,
+   /// 透過 FdrService::MigrateToLeastLoaded() 轉移; 是否真的轉移, 由 MigrateToLeastLoaded() 依負載決定.
+   class RebalanceCandidate {
+      FdrEventHandler*  Handler_{nullptr};
+      uint32_t          EventCount_{0};
+   public:
+      /// 同時清除 hdr 的事件計數.
+      void Check(FdrEventHandler* hdr);
+      void Migrate();
+   };
+
+   FdrThread();
+
 public:
    virtual ~FdrThread();
 
    bool IsThisThread() const {
       return this->ThreadId_ == ThisThread_.ThreadId_;
    }
+   const LatencyHistogram& GetWakeupLatency() const {
+      return this->WakeupLatency_;
+   }
+   const LatencyHistogram& GetDispatchLatency() const {
+      return this->DispatchLatency_;
+   }
+   uint32_t GetHandlerCount() const {
+      return this->HandlerCount_.load(std::memory_order_relaxed);
+   }
+   uint64_t GetEventCount() const {
+      return this->EventCount_.load(std::memory_order_relaxed);
+   }
 
 private:
    std::thread Thread_;
@@ -90,6 +214,11 @@ private:
    virtual void ThrRunImpl(const ServiceThreadArgs& args) = 0;
    void ThrRun(ServiceThreadArgs args);
    void CancelReqs(PendingReqsImpl);
+   /// \retval true  可以轉移: req.Handler_ 仍屬於 this thread, 且閒置中, 且目的與 this 不同.
+   /// \retval false 不可轉移: 若 req.Handler_ 已不屬於 this thread, 則會轉給 handler 目前的 FdrThread 處理.
+   bool CheckMigrate(MigrateReq& req);
+   /// 若 CheckMigrate(req) 成功, 則在 fnRemove() 之後呼叫: 設定 handler 的新 FdrThread, 並要求新的 FdrThread 註冊事件.
+   void MigrateTo(MigrateReq& req);
 
    friend class FdrEventHandler;
    void WakeupThread();
@@ -103,6 +232,7 @@ private:
    void StartSendInFdrThread(FdrEventHandlerSP handler) {
       this->PushToPendingReqs(this->PendingSends_, std::move(handler));
    }
+   void MigrateFdrEvent(FdrEventHandlerSP handler, intrusive_ptr<FdrThread> to);
 };
 using FdrThreadSP = intrusive_ptr<FdrThread>;
 extern void intrusive_ptr_deleter(const FdrThread* p);
@@ -111,6 +241,11 @@ extern void intrusive_ptr_deleter(const FdrThread* p);
 
 /// \ingroup io
 /// 負責管理 FdrThread, 決定 FdrEventHandler 要使用哪個 FdrThread.
+/// - 生命週期: FdrEventHandler 擁有 FdrServiceSP(轉移期間需要), 已註冊的 handler 則由 FdrThread 擁有,
+///   所以在 handler 呼叫 RemoveFdrEvent() 之前, 會形成 service => thread => handler => service 的循環參考;
+///   - 這與 FdrEventHandler 直接擁有 FdrThreadSP 時相同: 由 RemoveFdrEvent()(例: Device 關閉) 解開循環.
+///   - 因此結束時, 釋放 FdrServiceSP 之前(或之後), 必須關閉(Dispose)全部的 Device;
+///     最後一個 handler 解構後, FdrService 才會解構, 然後 FdrThread 才會結束.
 class FdrService : public intrusive_ref_counter<FdrService> {
 public:
    using FdrThreads = std::vector<FdrThreadSP>;
@@ -120,16 +255,60 @@ public:
 
    virtual ~FdrService();
 
-   /// 預設使用 [fd % thrCount] 決定使用哪個 fdr thread.
-   virtual FdrThreadSP AllocFdrThread(Fdr::fdr_t fd);
+   /// 決定 handler 要使用哪個 fdr thread:
+   /// - 若 devName 有在 IoServiceArgs::FdrPins_ 裡面, 則使用指定的 thread.
+   /// - 否則依照 IoServiceArgs::FdrAllocPolicy_ 決定, 預設使用 [fd % thrCount].
+   virtual FdrThreadSP AllocFdrThread(Fdr::fdr_t fd, StrView devName);
+   /// devName 是否有在 IoServiceArgs::FdrPins_ 裡面.
+   bool IsPinnedDevice(StrView devName) const {
+      return this->FindPin(devName) != nullptr;
+   }
+
+   size_t GetThreadCount() const {
+      return this->FdrThreads_.size();
+   }
+   /// 將閒置中的 handler 轉移到 FdrThreads_[toIndex], 不用重新連線.
+   /// - 實際的轉移在 handler 目前所在的 FdrThread 處理, 若當時 handler 並非閒置(FdrEventHandler::IsFdrEventIdle()),
+   ///   則放棄轉移(記錄 log).
+   /// \retval false toIndex 超過範圍, 或 handler 已在該 thread.
+   bool MigrateFdrEventHandler(FdrEventHandler& handler, size_t toIndex);
+   /// 使用 FdrAllocPolicy_(若為 FdMod 則使用 LeastConn) 找出負載最低的 thread, 若與 handler 目前的不同, 則轉移.
+   /// 可用來將忙碌 thread 上的閒置 handler 移走, 讓忙碌的連線獨占該 thread.
+   /// - 原本的 thread 只有 1 個 handler 時不轉移.
+   /// - LeastConn: 轉移後, 目的 thread 的 handler 數量必須仍比原本的少.
+   /// - LeastEvents: 目的 thread 的每秒事件數量必須低於原本的一半, 避免來回轉移.
+   /// - 若有設定 IoServiceArgs::RebalanceSecs_, 則 FdrThread 會定時自動呼叫.
+   bool MigrateToLeastLoaded(FdrEventHandler& handler);
+
+   /// 每個 FdrThread 的延遲統計(wakeup 及 dispatch), 用來調整 IoServiceArgs::SpinUS_, BackoffMS_...
+   /// 格式: "|thr=1|Wakeup:" LatencyHistogram "|Dispatch:" LatencyHistogram "|thr=2|Wakeup:" ...
+   void AppendLatencyInfo(std::string& info) const;
+   /// 每個 FdrThread 的負載及延遲統計, 用來調整 IoServiceArgs::SpinUS_, BackoffMS_, FdrAllocPolicy_...
+   /// 格式: "|Alloc=policy|thr=1:Handlers=n|Events=n|EvPerSec=n|WakeupLatency:" LatencyHistogram "|DispatchLatency:" ... "|thr=2:..."
+   void AppendThreadsInfo(std::string& info);
 
 private:
-   const FdrThreads  FdrThreads_;
+   const FdrThreads        FdrThreads_;
+   const FdrAllocPolicy    AllocPolicy_;
+   const IoServiceArgs::FdrPins  Pins_;
+   struct EvRate {
+      uint64_t LastCount_{0};
+      uint64_t LastNS_{0};
+      uint64_t PerSec_{0};
+   };
+   using EvRates = MustLock<std::vector<EvRate>>;
+   EvRates  EvRates_;
+   /// 更新每秒事件數量(距離上次更新超過 1 秒才會重算), 然後選出負載最低的 thread index.
+   size_t FindLeastLoaded(FdrAllocPolicy policy);
+   const IoServiceArgs::FdrPin* FindPin(StrView devName) const;
 };
 using FdrServiceSP = intrusive_ptr<FdrService>;
 
 /// \ingroup io
 /// 各個 OS 有它自己的預設 FdrService: 例如 Linux = FdrServiceEpoll.
+/// - 目前不提供 io_uring 版本: FdrEventHandler 是 readiness 介面(收到事件後由 handler 自行 read/writev),
+///   若只用 io_uring 取代 epoll_wait(), 每個事件反而需要更多 syscall(重新 arm poll);
+///   要使用 registered buffers 及批次 recv/send, 必須先改成 completion-based 的 device 介面.
 fon9_API FdrServiceSP MakeDefaultFdrService(const IoServiceArgs& ioArgs, const std::string& thrName, Result2& err);
 
 //--------------------------------------------------------------------------//
@@ -141,10 +320,8 @@ class fon9_API FdrEventHandler {
 
 public:
    /// 建構時由 iosv 分配 FdrThread.
-   FdrEventHandler(FdrService& iosv, FdrAuto&& fd)
-      : FdrThread_{iosv.AllocFdrThread(fd.GetFD())}
-      , Fdr_{std::move(fd)} {
-   }
+   /// devName 用於 IoServiceArgs::FdrPins_, 通常為 IoManager 設定的 device Id.
+   FdrEventHandler(FdrService& iosv, FdrAuto&& fd, StrView devName = StrView{});
 
    virtual ~FdrEventHandler();
 
@@ -155,7 +332,7 @@ public:
    ///   - 當不再需要事件時, 應呼叫 RemoveFdrEvent() 移除事件通知,
    ///   - 無法在解構時處理 (因為尚未移除前, fdr service 會擁有 this SP, 不可能造成解構).
    void UpdateFdrEvent() {
-      this->FdrThread_->UpdateFdrEvent(this);
+      this->GetFdrThread()->UpdateFdrEvent(this);
    }
 
    /// 從 fdr thread 移除事件處理者.
@@ -164,18 +341,31 @@ public:
    ///   - 僅把 this 加入等候移除的 qu 就返回:
    ///      - 所以返回後仍有可能收到 FdrEvent() 事件.
    /// - 一旦移除, 就不會再收到任何事件, 即使再呼叫 UpdateFdrEvent() 也不會有任何作用.
+   ///   - 也不會再轉移: 避免與轉移同時進行時, 新的 FdrThread 又重新註冊.
    void RemoveFdrEvent() {
-      this->FdrThread_->RemoveFdrEvent(this);
+      this->IsFdrRemoved_.store(true, std::memory_order_release);
+      this->GetFdrThread()->RemoveFdrEvent(this);
+   }
+   /// 是否已呼叫過 RemoveFdrEvent();
+   bool IsFdrRemoved() const {
+      return this->IsFdrRemoved_.load(std::memory_order_acquire);
    }
 
    /// 通常在 SendBuffered() 時使用:
    /// 到 fdr thread 送出: 透過 this->OnFdrEvent_StartSend();
    void StartSendInFdrThread() {
-      this->FdrThread_->StartSendInFdrThread(this);
+      this->GetFdrThread()->StartSendInFdrThread(this);
    }
 
    bool InFdrThread() const {
-      return this->FdrThread_->IsThisThread();
+      return this->GetFdrThread()->IsThisThread();
+   }
+   /// 傳回目前服務此 handler 的 FdrThread, 轉移之後會改變.
+   FdrThread* GetFdrThread() const {
+      return this->FdrThread_.load(std::memory_order_acquire);
+   }
+   FdrService& GetFdrService() const {
+      return *this->FdrService_;
    }
    uint64_t GetFdrEventHandlerBookmark() const {
       return this->FdrThreadBookmark_;
@@ -189,12 +379,30 @@ public:
    ///   但是沒有從 fdr thread 移除, 若要移除, 應使用 RemoveFdrEvent();
    virtual FdrEventFlag GetRequiredFdrEventFlag() const = 0;
 
+   /// 在 FdrThread 處理轉移要求時呼叫, 傳回 false 則放棄轉移.
+   /// 預設傳回 true; 例: FdrSocket 在 SendBuffer 有資料, 或 op thread 正在處理 Recv 事件時, 傳回 false.
+   virtual bool IsFdrEventIdle() const;
+   /// 建構時的 devName 是否有在 IoServiceArgs::FdrPins_ 裡面, 若有, 則不會自動轉移.
+   bool IsFdrPinned() const {
+      return this->IsFdrPinned_;
+   }
+
 private:
    friend class FdrThread;
-   // 在建構時就決定了要使用哪個 FdrThread & 處理哪個 fd 的事件.
-   const FdrThreadSP FdrThread_;
-   const FdrAuto     Fdr_;
-   uint64_t          FdrThreadBookmark_{0};
+   // 在建構時決定要使用哪個 FdrThread & 處理哪個 fd 的事件.
+   // FdrService_ 確保: 轉移期間, 其他 thread 取得的 FdrThread* 仍有效.
+   // 此處與 FdrThread 形成的循環參考, 參閱 FdrService 的說明.
+   const FdrServiceSP      FdrService_;
+   std::atomic<FdrThread*> FdrThread_;
+   const FdrAuto           Fdr_;
+   uint64_t                FdrThreadBookmark_{0};
+   /// 上次 FdrThread::CheckRebalance() 之後的事件數量, 只有 FdrThread 會使用.
+   uint32_t                FdrEventCount_{0};
+   const bool              IsFdrPinned_;
+   std::atomic<bool>       IsFdrRemoved_{false};
+   FdrPendingNode          PendingUpdateNode_{this};
+   FdrPendingNode          PendingSendNode_{this};
+   FdrPendingNode          PendingRemoveNode_{this};
 
    /// 可能同時有多種事件通知.
    /// 只會在 fdr thread 裡面呼叫.
@@ -217,8 +425,13 @@ private:
 //--------------------------------------------------------------------------//
 
 inline void FdrThread::OnFdrEvent_Emit(FdrEventFlag evs, FdrEventHandler* handler) {
+   this->EventCount_.store(this->EventCount_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+   ++handler->FdrEventCount_;
    handler->OnFdrEvent_Handling(evs);
 }
+inline bool FdrThread::IsMigratedFrom(const FdrEventHandler* handler) const {
+   return handler->GetFdrThread() != this;
+}
 inline void FdrThread::SetFdrEventHandlerBookmark(FdrEventHandler* handler, uint64_t bookmark) {
    handler->FdrThreadBookmark_ = bookmark;
 }
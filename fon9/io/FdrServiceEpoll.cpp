@@ -4,6 +4,7 @@
 #include "fon9/io/FdrServiceEpoll.hpp"
 #include "fon9/Log.hpp"
 #include <sys/epoll.h>
+#include <sys/socket.h>
 
 namespace fon9 { namespace io {
 
@@ -59,12 +60,19 @@ void FdrThreadEpoll::ThrRunImpl(const ServiceThreadArgs& args) {
    EvHandlers  evHandlers{args.Capacity_};
    Fdr::fdr_t  epFdr = this->FdrEpoll_.GetFD();
    const int   kEpollWaitMS = (IsBlockWait(args.HowWait_) ? -1 : 0);
+   // Block 模式下的 Spin: 沒有事件時, 下次 epoll_wait() 的 timeout 由 idleWaitMS 決定;
+   // 0 = spinning; >0 = backoff 中; -1 = 進入 block.
+   const uint64_t kSpinNS = (kEpollWaitMS < 0 ? args.SpinUS_ * uint64_t{1000} : 0);
+   const int      kBackoffMS = static_cast<int>(args.BackoffMS_);
+   int            idleWaitMS = (kSpinNS ? 0 : kEpollWaitMS);
+   uint64_t       lastEventNS = LatencyHistogram::NowNS();
+   this->BusyPollUS_ = args.BusyPollUS_;
    while (this->use_count() > 0) {
       // 再次進入 epoll_wait() 之前, 必須先將 Pending Removes, Updates 處理完,
       // 因為: 在 OnFdrEvent_Emit() 裡面關閉 readable, writable 偵測, 必須確實執行.
       // 避免: 當 Device 必須回到 op thread 觸發 OnDevice_Recv() 或 執行 send,
       //       如果沒有確實禁止 readable, writable, 則可能會發生非預期的結果.
-      int msWait = kEpollWaitMS;
+      int msWait = idleWaitMS;
       if (fon9_UNLIKELY(this->WakeupRequests_.load(std::memory_order_relaxed) != 0)) {
          this->ClearWakeup();
          this->ProcessPendings(epFdr, evHandlers);
@@ -76,6 +84,7 @@ void FdrThreadEpoll::ThrRunImpl(const ServiceThreadArgs& args) {
       struct epoll_event* pEvBeg = &*epEvents.begin();
       int epRes = epoll_wait(epFdr, pEvBeg, static_cast<int>(epEvents.size()), msWait);
       if (fon9_LIKELY(epRes > 0)) {
+         const uint64_t wakeNS = LatencyHistogram::NowNS();
          for (int L = 0; L < epRes; ++L, ++pEvBeg) {
             if (FdrEventHandler* hdr = static_cast<FdrEventHandler*>(pEvBeg->data.ptr)) {
                if (fon9_LIKELY(hdr->GetFdrEventHandlerBookmark() > 0)) {
@@ -84,11 +93,16 @@ void FdrThreadEpoll::ThrRunImpl(const ServiceThreadArgs& args) {
                   if (eflags & (EPOLLIN | EPOLLPRI | EPOLLRDHUP))
                      evs |= FdrEventFlag::Readable;
                   if (fon9_UNLIKELY(eflags & (EPOLLHUP | EPOLLERR))) {
-                     evs |= FdrEventFlag::Error;
-                     // 避免 hdr 處理 error 期間, 這裡會一直觸發 error, 所以一旦 error, 就移除 handler.
-                     hdr->RemoveFdrEvent();
+                     if ((eflags & EPOLLHUP) == 0 && IsEnumContains(hdr->GetRequiredFdrEventFlag(), FdrEventFlag::ErrQueue))
+                        evs |= FdrEventFlag::ErrQueue;
+                     else {
+                        evs |= FdrEventFlag::Error;
+                        // 避免 hdr 處理 error 期間, 這裡會一直觸發 error, 所以一旦 error, 就移除 handler.
+                        hdr->RemoveFdrEvent();
+                     }
                   }
                   this->OnFdrEvent_Emit(evs, hdr);
+                  this->DispatchLatency_.AddSince(wakeNS);
                }
             }
             else
@@ -100,18 +114,73 @@ void FdrThreadEpoll::ThrRunImpl(const ServiceThreadArgs& args) {
             epEvents.resize(epRes * 2);
             epEvents.resize(epEvents.capacity());
          }
+         if (kSpinNS) {
+            idleWaitMS = 0;
+            lastEventNS = LatencyHistogram::NowNS();
+         }
       }
       else if (fon9_LIKELY(epRes == 0)) { // 如果 !Block, 則 epRes==0 是常態!
          if (args.HowWait_ == HowWait::Yield)
             std::this_thread::yield();
+         else if (kSpinNS && idleWaitMS >= 0) {
+            if (idleWaitMS == 0) {
+               if (LatencyHistogram::NowNS() - lastEventNS >= kSpinNS)
+                  idleWaitMS = (kBackoffMS > 0 ? 1 : -1);
+            }
+            else if ((idleWaitMS *= 2) > kBackoffMS)
+               idleWaitMS = -1;
+         }
       }
       else if (epRes < 0) {
          if (int eno = ErrorCannotRetry(errno))
             fon9_LOG_FATAL("FdrThreadEpoll.ThrRun|fn=epoll_wait|err=", GetSysErrC(eno));
       }
+      if (fon9_UNLIKELY(this->IsRebalanceTime())) {
+         RebalanceCandidate cand;
+         evHandlers.ForEach([&cand](EvHandler& evh) {
+            if (FdrEventHandler* hdr = evh.get())
+               cand.Check(hdr);
+         });
+         cand.Migrate();
+      }
    }
 }
 
+void FdrThreadEpoll::SetBusyPoll(FdrEventHandler* hdr) {
+#ifdef SO_BUSY_POLL
+   int val = static_cast<int>(this->BusyPollUS_);
+   if (fon9_LIKELY(setsockopt(hdr->GetFD(), SOL_SOCKET, SO_BUSY_POLL, &val, sizeof(val)) == 0)) {
+   #ifdef SO_PREFER_BUSY_POLL
+      val = 1;
+      setsockopt(hdr->GetFD(), SOL_SOCKET, SO_PREFER_BUSY_POLL, &val, sizeof(val));
+   #endif
+      return;
+   }
+   int eno = errno;
+   // 不是 socket(例: FileIO, eventfd) 則不用設定.
+   // 若因權限不足(EPERM: 超過 net.core.busy_read 需要 CAP_NET_ADMIN)而失敗, 則只記錄一次.
+   if (eno == ENOTSOCK || this->IsBusyPollWarned_)
+      return;
+   this->IsBusyPollWarned_ = true;
+   fon9_LOG_WARN("FdrServiceEpoll.SO_BUSY_POLL|fd=", hdr->GetFD(), "|us=", this->BusyPollUS_, "|err=", GetSysErrC(eno));
+#else
+   (void)hdr;
+#endif
+}
+void FdrThreadEpoll::RemoveHandler(Fdr::fdr_t epFdr, EvHandlers& evHandlers, FdrEventHandler* hdr) {
+   auto idx1 = hdr->GetFdrEventHandlerBookmark();
+   if (fon9_UNLIKELY(idx1 <= 0))
+      return;
+   if (!evHandlers.RemoveObj(idx1 - 1, hdr))
+      fon9_LOG_ERROR("FdrServiceEpoll.Remove|fd=", hdr->GetFD(), "|idx=", idx1, "|hdr=", ToPtr{hdr}, "|err=Not found");
+   struct epoll_event evc;
+   if (fon9_UNLIKELY(epoll_ctl(epFdr, EPOLL_CTL_DEL, hdr->GetFD(), &evc) < 0)) {
+      int eno = errno; // 必須先將 errno 取出, 否則進入 fon9_LOG_ERROR() 可能會破壞 errno 的值.
+      fon9_LOG_ERROR("FdrServiceEpoll.DEL|fd=", hdr->GetFD(), "|err=", GetSysErrC(eno));
+   }
+   // fon9_LOG_TRACE("FdrServiceEpoll.Remove|fd=", hdr->GetFD(), "|idx=", idx1, "|hdr=", ToPtr{hdr});
+   this->SetFdrEventHandlerBookmark(hdr, 0);
+}
 void FdrThreadEpoll::ProcessPendings(Fdr::fdr_t epFdr, EvHandlers& evHandlers) {
    this->ProcessPendingSends();
 
@@ -119,21 +188,24 @@ void FdrThreadEpoll::ProcessPendings(Fdr::fdr_t epFdr, EvHandlers& evHandlers) {
    PendingReqsImpl reqs = this->MoveOutPendingImpl(this->PendingRemoves_);
    for (FdrEventHandlerSP& spRemove : reqs) {
       FdrEventHandler* hdr = spRemove.get();
-      auto idx1 = hdr->GetFdrEventHandlerBookmark();
-      if (fon9_UNLIKELY(idx1 <= 0))
-         continue;
-      if (!evHandlers.RemoveObj(idx1 - 1, hdr))
-         fon9_LOG_ERROR("FdrServiceEpoll.Remove|fd=", hdr->GetFD(), "|idx=", idx1, "|hdr=", ToPtr{hdr}, "|err=Not found");
-      if (fon9_UNLIKELY(epoll_ctl(epFdr, EPOLL_CTL_DEL, hdr->GetFD(), &evc) < 0)) {
-         int eno = errno; // 必須先將 errno 取出, 否則進入 fon9_LOG_ERROR() 可能會破壞 errno 的值.
-         fon9_LOG_ERROR("FdrServiceEpoll.DEL|fd=", hdr->GetFD(), "|err=", GetSysErrC(eno));
-      }
-      // fon9_LOG_TRACE("FdrServiceEpoll.Remove|fd=", hdr->GetFD(), "|idx=", idx1, "|hdr=", ToPtr{hdr});
-      this->SetFdrEventHandlerBookmark(hdr, 0);
+      if (fon9_UNLIKELY(this->IsMigratedFrom(hdr)))
+         hdr->RemoveFdrEvent();
+      else
+         this->RemoveHandler(epFdr, evHandlers, hdr);
    }
+   this->ProcessPendingMigrates([this, epFdr, &evHandlers](FdrEventHandler* hdr) {
+      this->RemoveHandler(epFdr, evHandlers, hdr);
+   });
    reqs = this->MoveOutPendingImpl(this->PendingUpdates_);
    for (FdrEventHandlerSP& sp : reqs) {
       FdrEventHandler* hdr = sp.get();
+      // 已移除(可能與轉移同時發生, 此時 Remove 已先處理), 不可再註冊.
+      if (fon9_UNLIKELY(hdr->IsFdrRemoved()))
+         continue;
+      if (fon9_UNLIKELY(this->IsMigratedFrom(hdr))) {
+         hdr->UpdateFdrEvent();
+         continue;
+      }
       auto idx1 = hdr->GetFdrEventHandlerBookmark();
       int  op;
       FdrEventFlag evs = hdr->GetRequiredFdrEventFlag();
@@ -153,6 +225,8 @@ void FdrThreadEpoll::ProcessPendings(Fdr::fdr_t epFdr, EvHandlers& evHandlers) {
          evh.Events_ = evs;
          this->SetFdrEventHandlerBookmark(hdr, idx1 = evHandlers.Add(evh) + 1);
          op = EPOLL_CTL_ADD;
+         if (this->BusyPollUS_ > 0)
+            this->SetBusyPoll(hdr);
       }
       // EPOLLET 有其他問題? 莫名的斷線: 收到 events=0x2019? 0x19 = EPOLLHUP(0x10) + EPOLLERR(0x08) + EPOLLIN(0x01)
       evc.events = IsEnumContains(evs, FdrEventFlag::Readable)
@@ -15,6 +15,9 @@ struct FdrServiceEpoll {
 
 /// \ingroup io
 /// 提供使用 epoll 處理 non-blocking fd 讀寫事件服務.
+/// - 若 HowWait::Block 且有設定 SpinUS_: 最後一次事件後的 SpinUS_ 期間, 使用 epoll_wait(timeout=0) 持續檢查;
+///   之後依序使用 1ms, 2ms, 4ms... 的 timeout(不超過 BackoffMS_), 最後才進入 epoll_wait(timeout=-1);
+///   任何事件(包含 wakeup)都會回到 Spin 狀態.
 class FdrThreadEpoll : public FdrThread {
    const FdrAuto  FdrEpoll_;
    struct EvHandler : public FdrEventHandlerSP {
@@ -23,6 +26,12 @@ class FdrThreadEpoll : public FdrThread {
    };
    using EvHandlers = ObjPool<EvHandler>;
 
+   /// 若 ServiceThreadArgs::BusyPollUS_ > 0, 則在 EPOLL_CTL_ADD 時, 設定 socket 的 SO_BUSY_POLL.
+   uint32_t BusyPollUS_{0};
+   bool     IsBusyPollWarned_{false};
+   void SetBusyPoll(FdrEventHandler* hdr);
+
+   void RemoveHandler(Fdr::fdr_t epFdr, EvHandlers& evHandlers, FdrEventHandler* hdr);
    void ProcessPendings(Fdr::fdr_t epFdr, EvHandlers& evHandlers);
    virtual void ThrRunImpl(const ServiceThreadArgs& args) override;
 
@@ -0,0 +1,274 @@
+﻿/// \file fon9/io/FdrService_UT.cpp
+/// \author fonwinz@gmail.com
+#include "fon9/TestTools.hpp"
+#include "fon9/sys/Config.h"
+#ifdef __linux__
+#include "fon9/io/FdrServiceEpoll.hpp"
+#include "fon9/Log.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace fon9::io;
+
+static void CheckResult(bool isOK, fon9::StrView msg) {
+   if (isOK)
+      return;
+   std::cout << "|err=" << msg.ToString() << "\r[ERROR]" << std::endl;
+   abort();
+}
+template <class FnCond>
+static bool WaitFor(FnCond&& fnCond, unsigned ms = 2000) {
+   for (unsigned L = 0; L < ms; ++L) {
+      if (fnCond())
+         return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+   }
+   return fnCond();
+}
+//--------------------------------------------------------------------------//
+fon9_WARN_DISABLE_PADDING;
+/// 使用 pipe 的讀端, 測試者寫入 pipe 觸發 Readable 事件.
+/// GetRequiredFdrEventFlag() 一律傳回 Readable: 模擬最壞的情況, 移除之後仍要求事件.
+class TestHandler : public FdrEventHandler {
+   fon9_NON_COPY_NON_MOVE(TestHandler);
+   using base = FdrEventHandler;
+   std::atomic<unsigned>   RefCount_{0};
+   const int               WriteFd_;
+
+   void OnFdrEvent_AddRef() override {
+      this->RefCount_.fetch_add(1, std::memory_order_relaxed);
+   }
+   void OnFdrEvent_ReleaseRef() override {
+      if (this->RefCount_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+         delete this;
+   }
+   void OnFdrEvent_Handling(FdrEventFlag evs) override {
+      if (!IsEnumContains(evs, FdrEventFlag::Readable))
+         return;
+      char buf[64];
+      while (read(this->GetFD(), buf, sizeof(buf)) > 0) {
+      }
+      if (!this->InFdrThread())
+         ++this->WrongThreadCount_;
+      this->LastEventThread_ = this->GetFdrThread();
+      ++this->EventCount_;
+   }
+   void OnFdrEvent_StartSend() override {
+      if (!this->InFdrThread())
+         ++this->WrongThreadCount_;
+      ++this->StartSendCount_;
+   }
+   struct Pipe {
+      int Fds_[2];
+      Pipe() {
+         if (pipe2(this->Fds_, O_NONBLOCK | O_CLOEXEC) != 0)
+            this->Fds_[0] = this->Fds_[1] = -1;
+      }
+   };
+   TestHandler(FdrService& iosv, Pipe pipe)
+      : base(iosv, fon9::FdrAuto{pipe.Fds_[0]})
+      , WriteFd_{pipe.Fds_[1]} {
+   }
+public:
+   std::atomic<bool>       IsIdle_{true};
+   std::atomic<unsigned>   EventCount_{0};
+   std::atomic<unsigned>   StartSendCount_{0};
+   std::atomic<unsigned>   WrongThreadCount_{0};
+   std::atomic<FdrThread*> LastEventThread_{nullptr};
+
+   TestHandler(FdrService& iosv) : TestHandler(iosv, Pipe{}) {
+   }
+   ~TestHandler() {
+      close(this->WriteFd_);
+   }
+   unsigned use_count() const {
+      return this->RefCount_.load(std::memory_order_acquire);
+   }
+   FdrEventFlag GetRequiredFdrEventFlag() const override {
+      return FdrEventFlag::Readable;
+   }
+   bool IsFdrEventIdle() const override {
+      return this->IsIdle_;
+   }
+   /// 寫入 pipe, 並等候 Readable 事件.
+   bool Ping(unsigned ms = 2000) {
+      const unsigned count = this->EventCount_;
+      if (write(this->WriteFd_, "x", 1) != 1)
+         return false;
+      return WaitFor([this, count]() { return this->EventCount_ != count; }, ms);
+   }
+};
+using TestHandlerSP = fon9::intrusive_ptr<TestHandler>;
+fon9_WARN_POP;
+
+class TestService : public FdrService {
+   fon9_NON_COPY_NON_MOVE(TestService);
+   std::atomic<bool>& IsDestroyed_;
+public:
+   TestService(FdrThreads thrs, std::atomic<bool>& isDestroyed)
+      : FdrService(std::move(thrs), IoServiceArgs{}, "FdrService_UT")
+      , IsDestroyed_(isDestroyed) {
+   }
+   ~TestService() {
+      this->IsDestroyed_ = true;
+   }
+};
+static FdrServiceSP MakeTestService(std::atomic<bool>& isDestroyed) {
+   fon9::Result2           err;
+   FdrService::FdrThreads  thrs;
+   for (unsigned L = 0; L < 2; ++L) {
+      thrs.emplace_back(new FdrThreadEpoll{err});
+      CheckResult(!err.IsError(), "FdrThreadEpoll");
+   }
+   return FdrServiceSP{new TestService{std::move(thrs), isDestroyed}};
+}
+/// 將 hdr 轉移到另一個 thread, 傳回目的 thread index.
+static size_t MigrateToOther(FdrService& iosv, TestHandler& hdr) {
+   if (iosv.MigrateFdrEventHandler(hdr, 0))
+      return 0;
+   CheckResult(iosv.MigrateFdrEventHandler(hdr, 1), "MigrateFdrEventHandler(1)");
+   return 1;
+}
+/// 等候 hdr 不再被 FdrThread 擁有(只剩 hdr 本身), 且 pipe 寫入後, 不會再有事件.
+static void CheckRemoved(TestHandlerSP& hdr) {
+   CheckResult(WaitFor([&hdr]() { return hdr->use_count() == 1; }), "Handler still registered");
+   const unsigned count = hdr->EventCount_;
+   CheckResult(!hdr->Ping(5), "Event after remove");
+   CheckResult(count == hdr->EventCount_, "Event after remove");
+}
+//--------------------------------------------------------------------------//
+void TestMigrateIdle(FdrService& iosv) {
+   std::cout << "[TEST ] Migrate idle handler" << std::flush;
+   TestHandlerSP hdr{new TestHandler{iosv}};
+   hdr->UpdateFdrEvent();
+   CheckResult(hdr->Ping(), "Ping before migrate");
+   FdrThread* const from = hdr->GetFdrThread();
+   CheckResult(hdr->LastEventThread_ == from, "Event thread before migrate");
+   const uint32_t fromCount = from->GetHandlerCount();
+   CheckResult(!iosv.MigrateFdrEventHandler(*hdr, 2), "Migrate to out of range thread");
+   const size_t toIndex = MigrateToOther(iosv, *hdr);
+   CheckResult(WaitFor([&hdr, from]() { return hdr->GetFdrThread() != from; }), "Migrate timeout");
+   FdrThread* const to = hdr->GetFdrThread();
+   CheckResult(hdr->Ping(), "Ping after migrate");
+   CheckResult(hdr->LastEventThread_ == to, "Event thread after migrate");
+   CheckResult(from->GetHandlerCount() + 1 == fromCount, "HandlerCount(from)");
+   // 已在目的 thread, 再次要求轉移到同一個 thread: 傳回 false.
+   CheckResult(!iosv.MigrateFdrEventHandler(*hdr, toIndex), "Migrate to same thread");
+   CheckResult(iosv.MigrateFdrEventHandler(*hdr, 1 - toIndex), "Migrate back");
+   CheckResult(WaitFor([&hdr, to]() { return hdr->GetFdrThread() != to; }), "Migrate back timeout");
+   CheckResult(hdr->Ping(), "Ping after migrate back");
+   CheckResult(hdr->LastEventThread_ == from, "Event thread after migrate back");
+   CheckResult(hdr->WrongThreadCount_ == 0, "Event in wrong thread");
+   hdr->RemoveFdrEvent();
+   CheckRemoved(hdr);
+   std::cout << "\r[OK   ]" << std::endl;
+}
+void TestMigrateNotIdle(FdrService& iosv) {
+   std::cout << "[TEST ] Migrate not idle handler" << std::flush;
+   TestHandlerSP hdr{new TestHandler{iosv}};
+   hdr->UpdateFdrEvent();
+   CheckResult(hdr->Ping(), "Ping before migrate");
+   FdrThread* const from = hdr->GetFdrThread();
+   hdr->IsIdle_ = false;
+   MigrateToOther(iosv, *hdr); // 要求成功送出, 但 FdrThread 處理時因為不是閒置而放棄.
+   std::this_thread::sleep_for(std::chrono::milliseconds{50});
+   CheckResult(hdr->GetFdrThread() == from, "Migrated while not idle");
+   CheckResult(hdr->Ping(), "Ping after rejected migrate");
+   CheckResult(hdr->LastEventThread_ == from, "Event thread after rejected migrate");
+   hdr->IsIdle_ = true;
+   hdr->RemoveFdrEvent();
+   CheckRemoved(hdr);
+   std::cout << "\r[OK   ]" << std::endl;
+}
+void TestMigrateWithSend(FdrService& iosv) {
+   std::cout << "[TEST ] Migrate with pending StartSend" << std::flush;
+   for (unsigned L = 0; L < 100; ++L) {
+      TestHandlerSP hdr{new TestHandler{iosv}};
+      hdr->UpdateFdrEvent();
+      CheckResult(hdr->Ping(), "Ping before migrate");
+      MigrateToOther(iosv, *hdr);
+      // 在舊的 thread 排隊的 StartSend, 若 handler 已轉移, 則必須轉給新的 thread 處理.
+      hdr->StartSendInFdrThread();
+      CheckResult(WaitFor([&hdr]() { return hdr->StartSendCount_ != 0; }), "StartSend lost");
+      CheckResult(hdr->Ping(), "Ping after migrate");
+      CheckResult(hdr->WrongThreadCount_ == 0, "StartSend or event in wrong thread");
+      hdr->RemoveFdrEvent();
+      CheckRemoved(hdr);
+   }
+   std::cout << "\r[OK   ]" << std::endl;
+}
+/// 移除(例: 關閉連線)與轉移同時發生: 不論先後, 移除之後都不可再被任何 FdrThread 註冊.
+void TestRemoveRaceMigrate(FdrService& iosv) {
+   static const char* const kCaseNames[] = {
+      "migrate then remove",
+      "remove then migrate",
+      "remove after migrated", // 此時新的 thread 可能還沒處理 UpdateFdrEvent();
+   };
+   for (unsigned caseIdx = 0; caseIdx < 3; ++caseIdx) {
+      std::cout << "[TEST ] Remove race migrate: " << kCaseNames[caseIdx] << std::flush;
+      for (unsigned L = 0; L < 200; ++L) {
+         TestHandlerSP hdr{new TestHandler{iosv}};
+         hdr->UpdateFdrEvent();
+         CheckResult(hdr->Ping(), "Ping before migrate");
+         FdrThread* const from = hdr->GetFdrThread();
+         switch (caseIdx) {
+         case 0:
+            MigrateToOther(iosv, *hdr);
+            hdr->RemoveFdrEvent();
+            break;
+         case 1:
+            hdr->RemoveFdrEvent();
+            CheckResult(!iosv.MigrateFdrEventHandler(*hdr, 0) && !iosv.MigrateFdrEventHandler(*hdr, 1),
+                        "Migrate removed handler");
+            break;
+         case 2:
+            MigrateToOther(iosv, *hdr);
+            while (hdr->GetFdrThread() == from)
+               std::this_thread::yield();
+            hdr->RemoveFdrEvent();
+            break;
+         }
+         CheckRemoved(hdr);
+      }
+      std::cout << "\r[OK   ]" << std::endl;
+   }
+}
+/// service => thread => handler => service 的循環參考, 由 RemoveFdrEvent() 解開.
+void TestServiceLifetime() {
+   std::cout << "[TEST ] Service lifetime" << std::flush;
+   std::atomic<bool> isDestroyed{false};
+   FdrServiceSP      iosv = MakeTestService(isDestroyed);
+   TestHandler*      hdr = new TestHandler{*iosv};
+   hdr->UpdateFdrEvent();
+   CheckResult(hdr->Ping(), "Ping");
+   iosv.reset();
+   std::this_thread::sleep_for(std::chrono::milliseconds{20});
+   // handler 仍在 FdrThread 裡面, 所以 service 仍然存在.
+   CheckResult(!isDestroyed, "Service destroyed while handler registered");
+   CheckResult(hdr->Ping(), "Ping after service released");
+   hdr->RemoveFdrEvent();
+   CheckResult(WaitFor([&isDestroyed]() { return isDestroyed.load(); }), "Service not destroyed after remove");
+   std::cout << "\r[OK   ]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+   (void)argc; (void)argv;
+   fon9::AutoPrintTestInfo utinfo("FdrService");
+   fon9::LogLevel_ = fon9::LogLevel::Error; // 不顯示每次轉移的 log.
+   std::atomic<bool> isDestroyed{false};
+   {
+      FdrServiceSP iosv = MakeTestService(isDestroyed);
+      TestMigrateIdle(*iosv);
+      TestMigrateNotIdle(*iosv);
+      TestMigrateWithSend(*iosv);
+      TestRemoveRaceMigrate(*iosv);
+   }
+   CheckResult(WaitFor([&isDestroyed]() { return isDestroyed.load(); }), "Service not destroyed");
+   TestServiceLifetime();
+}
+#else
+int main() {
+   fon9::AutoPrintTestInfo utinfo("FdrService");
+   std::cout << "FdrServiceEpoll not supported.\r[SKIP ]" << std::endl;
+}
+#endif
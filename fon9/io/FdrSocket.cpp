@@ -3,11 +3,27 @@
 #include "fon9/sys/Config.h"
 #ifdef fon9_POSIX
 #include "fon9/io/FdrSocket.hpp"
+#include "fon9/Log.hpp"
+#ifdef __linux__
+#include <linux/errqueue.h>
+#endif
 
 namespace fon9 { namespace io {
 
 FdrEventFlag FdrSocket::GetRequiredFdrEventFlag() const {
-   return static_cast<FdrEventFlag>(this->EnabledEvents_.load(std::memory_order_relaxed));
+   const FdrEventFlag evs = static_cast<FdrEventFlag>(this->EnabledEvents_.load(std::memory_order_relaxed));
+   // 使用 MSG_ZEROCOPY 時, 完成通知會觸發 POLLERR, 必須自行處理, 不能讓 FdrThread 視為錯誤而移除.
+   return this->ZeroCopyThreshold_ ? (evs | FdrEventFlag::ErrQueue) : evs;
+}
+
+bool FdrSocket::IsFdrEventIdle() const {
+   // Recv 事件可能正在 op thread 處理中(RecvBufferState::WaitingEventInvoke),
+   // 處理完畢後會在 op thread 呼叫 ContinueRecv(), 此時不可轉移.
+   if (this->RecvBuffer_.IsReceiving() || this->RecvBuffer_.IsInvokingEvent())
+      return false;
+   if (IsEnumContains(static_cast<FdrEventFlag>(this->EnabledEvents_.load(std::memory_order_relaxed)), FdrEventFlag::Writable))
+      return false;
+   return this->ZeroCopyThreshold_ == 0 || ZeroCopyInflight::ConstLocker{this->ZeroCopyInflight_}->empty();
 }
 
 void FdrSocket::SocketError(StrView fnName, int eno) {
@@ -25,6 +41,8 @@ void FdrSocket::SocketError(StrView fnName, int eno) {
 int FdrSocket::Sendv(DeviceOpLocker& sc, DcQueueList& toSend) {
    struct iovec   bufv[IOV_MAX];
    size_t         bufCount = toSend.PeekBlockVector(bufv);
+   if (fon9_UNLIKELY(this->ZeroCopyThreshold_ > 0))
+      return this->SendvZeroCopy(sc, toSend, bufv, bufCount);
 __RETRY_WRITEV:
    ssize_t        wrsz = (bufCount ? writev(this->GetFD(), bufv, static_cast<int>(bufCount)) : 0);
    if (fon9_LIKELY(wrsz >= 0)) {
@@ -54,6 +72,134 @@ __RETRY_WRITEV:
    return 0;
 }
 
+//--------------------------------------------------------------------------//
+
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define fon9_HAVE_MSG_ZEROCOPY
+#endif
+
+void FdrSocket::SetZeroCopyThreshold(uint32_t threshold) {
+   if (threshold <= 0)
+      return;
+#ifdef fon9_HAVE_MSG_ZEROCOPY
+   int val = 1;
+   if (setsockopt(this->GetFD(), SOL_SOCKET, SO_ZEROCOPY, &val, sizeof(val)) == 0) {
+      this->ZeroCopyThreshold_ = threshold;
+      return;
+   }
+   int eno = errno;
+#else
+   int eno = ENOTSUP;
+#endif
+   fon9_LOG_WARN("FdrSocket.SO_ZEROCOPY|fd=", this->GetFD(), "|err=", GetSocketErrC(eno));
+}
+
+FdrSocket::ZeroCopyInflightImpl::~ZeroCopyInflightImpl() {
+   BufferList nodes;
+   for (ZeroCopyItem& i : *this)
+      nodes.push_back(std::move(i.Nodes_));
+   BufferListConsumeErr(std::move(nodes), std::errc::operation_canceled);
+}
+
+int FdrSocket::SendvZeroCopy(DeviceOpLocker& sc, DcQueueList& toSend, struct iovec* bufv, size_t bufCount) {
+   size_t totsz = 0;
+   for (size_t L = 0; L < bufCount; ++L)
+      totsz += bufv[L].iov_len;
+   struct msghdr msg;
+   ZeroStruct(msg);
+   msg.msg_iov = bufv;
+   msg.msg_iovlen = bufCount;
+#ifdef fon9_HAVE_MSG_ZEROCOPY
+   int flags = (totsz >= this->ZeroCopyThreshold_ ? MSG_ZEROCOPY : 0);
+#else
+   int flags = 0;
+#endif
+__RETRY_SENDMSG:
+   ssize_t wrsz = (bufCount ? sendmsg(this->GetFD(), &msg, flags) : 0);
+   if (fon9_LIKELY(wrsz >= 0)) {
+      {
+         ZeroCopyInflight::Locker zcs{this->ZeroCopyInflight_};
+         if (flags && wrsz > 0)
+            zcs->emplace_back(zcs->NextSeq_++);
+         if (zcs->empty())
+            toSend.PopConsumed(static_cast<size_t>(wrsz));
+         else {
+            // 只要還有 MSG_ZEROCOPY 尚未完成, 用完的節點(包含一般傳送的)都要等到最後一個 MSG_ZEROCOPY 完成才歸還;
+            // 因為: 部分傳送的節點, 其前段可能已用 MSG_ZEROCOPY 送出.
+            toSend.PopConsumedTo(static_cast<size_t>(wrsz), zcs->back().Nodes_);
+         }
+      }
+      if (fon9_LIKELY(toSend.empty()))
+         this->CheckSendQueueEmpty(sc);
+      else
+         this->EnableEventBit(FdrEventFlag::Writable);
+      return 0;
+   }
+   if (int eno = ErrorCannotRetry(errno)) {
+      if (eno == ENOBUFS && flags) {
+         // 超過 optmem 限制, 無法再 pin 住更多的記憶體, 此次改用一般傳送.
+         flags = 0;
+         goto __RETRY_SENDMSG;
+      }
+      this->SocketError("Sendv", eno);
+      return eno;
+   }
+   this->EnableEventBit(FdrEventFlag::Writable);
+   return 0;
+}
+
+void FdrSocket::CheckZeroCopyCompleted() {
+#ifdef fon9_HAVE_MSG_ZEROCOPY
+   BufferList completed;
+   for (;;) {
+      char           ctrlbuf[CMSG_SPACE(sizeof(struct sock_extended_err)) * 4];
+      struct msghdr  msg;
+      ZeroStruct(msg);
+      msg.msg_control = ctrlbuf;
+      msg.msg_controllen = sizeof(ctrlbuf);
+      if (recvmsg(this->GetFD(), &msg, MSG_ERRQUEUE) < 0) {
+         int eno = errno;
+         if (eno == EINTR)
+            continue;
+         if (eno == EAGAIN || eno == EWOULDBLOCK)
+            break;
+         BufferListConsumeErr(std::move(completed), GetSocketErrC(eno));
+         this->SocketError("ErrQueue", eno);
+         return;
+      }
+      for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+         if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR)
+               || (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+            continue;
+         const struct sock_extended_err* serr = reinterpret_cast<const struct sock_extended_err*>(CMSG_DATA(cm));
+         if (fon9_UNLIKELY(serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+            if (serr->ee_errno == 0)
+               continue;
+            BufferListConsumeErr(std::move(completed), GetSocketErrC(static_cast<int>(serr->ee_errno)));
+            this->SocketError("ErrQueue", static_cast<int>(serr->ee_errno));
+            return;
+         }
+         // [ee_info..ee_data] 為此次完成的 MSG_ZEROCOPY 序號範圍;
+         // 若 ee_code 有 SO_EE_CODE_ZEROCOPY_COPIED, 表示核心改用複製(例: loopback), 但節點一樣可以歸還.
+         const uint32_t seqTo = serr->ee_data;
+         ZeroCopyInflight::Locker zcs{this->ZeroCopyInflight_};
+         while (!zcs->empty() && static_cast<int32_t>(zcs->front().Seq_ - seqTo) <= 0) {
+            completed.push_back(std::move(zcs->front().Nodes_));
+            zcs->pop_front();
+         }
+      }
+   }
+   if (!completed.empty()) {
+      // 在 lock 之外歸還, 避免在 OnBufferConsumed() 裡面再次傳送造成死結.
+      DcQueueList dcq{std::move(completed)};
+      dcq.PopConsumed(dcq.CalcSize());
+   }
+#endif
+   // POLLERR 可能是 socket 發生錯誤, 而不是 error queue 有通知.
+   if (int eno = Socket::LoadSocketErrno(this->GetFD()))
+      this->SocketError("Event", eno);
+}
+
 void FdrSocket::CheckSendQueueEmpty(DeviceOpLocker& sc) {
    auto& alocker = sc.GetALocker();
    alocker.Relock();
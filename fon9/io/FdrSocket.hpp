@@ -7,6 +7,10 @@
 #include "fon9/io/DeviceRecvEvent.hpp"
 #include "fon9/io/Socket.hpp"
 
+fon9_BEFORE_INCLUDE_STD;
+#include <deque>
+fon9_AFTER_INCLUDE_STD;
+
 namespace fon9 { namespace io {
 
 class FdrSocket : public FdrEventHandler {
@@ -17,12 +21,41 @@ protected:
    RecvBuffer                 RecvBuffer_;
    SendBuffer                 SendBuffer_;
 
+   /// MSG_ZEROCOPY: 每次傳送資料量 >= ZeroCopyThreshold_ 時使用; 0 = 不使用.
+   /// 只有在 SetZeroCopyThreshold() 成功設定 SO_ZEROCOPY 之後, 才會 > 0.
+   uint32_t ZeroCopyThreshold_{0};
+   struct ZeroCopyItem {
+      /// 對應核心的 MSG_ZEROCOPY 計數.
+      uint32_t    Seq_;
+      /// 已交給核心, 但尚未收到完成通知的節點, 收到通知之前不能歸還.
+      BufferList  Nodes_;
+      ZeroCopyItem(uint32_t seq) : Seq_{seq} {
+      }
+   };
+   struct ZeroCopyInflightImpl : public std::deque<ZeroCopyItem> {
+      /// 下一次 sendmsg(MSG_ZEROCOPY) 成功時, 核心給的計數.
+      uint32_t NextSeq_{0};
+      /// 剩餘的節點, 使用 ConsumeErr(std::errc::operation_canceled) 歸還.
+      ~ZeroCopyInflightImpl();
+   };
+   using ZeroCopyInflight = MustLock<ZeroCopyInflightImpl>;
+   /// 在 Sendv() 加入; 在 CheckZeroCopyCompleted() 收到核心的完成通知後移除.
+   /// TCP 的完成通知必定依序, 所以只要檢查序號即可.
+   ZeroCopyInflight  ZeroCopyInflight_;
+
+   int SendvZeroCopy(DeviceOpLocker& sc, DcQueueList& toSend, struct iovec* bufv, size_t bufCount);
+   /// 收到 FdrEventFlag::ErrQueue 事件時, 從 error queue 取出 MSG_ZEROCOPY 完成通知, 歸還已完成的節點.
+   /// 若 error queue 有其他錯誤, 或 socket 有錯誤, 則呼叫 this->SocketError();
+   void CheckZeroCopyCompleted();
+
    /// 建立錯誤訊息字串, 觸發事件:
    /// `this->OnFdrSocket_Error("fnName:" + GetSocketErrC(eno));`
    virtual void SocketError(StrView fnName, int eno);
    virtual void OnFdrSocket_Error(std::string errmsg) = 0;
 
    virtual FdrEventFlag GetRequiredFdrEventFlag() const override;
+   /// 沒有在等候 writable(沒有待送資料), 沒有尚未完成的 MSG_ZEROCOPY, 且沒有正在處理的 Recv 事件, 則視為閒置.
+   virtual bool IsFdrEventIdle() const override;
 
    void CheckSocketErrorOrCanceled(FdrEventFlag evs) {
       if (IsEnumContains(evs, FdrEventFlag::Error)) {
@@ -31,8 +64,13 @@ protected:
       else if (IsEnumContains(evs, FdrEventFlag::OperationCanceled)) {
          this->SocketError("Cancel", ECANCELED);
       }
+      else if (fon9_UNLIKELY(IsEnumContains(evs, FdrEventFlag::ErrQueue))) {
+         this->CheckZeroCopyCompleted();
+      }
    }
 
+   /// - 若有設定 ZeroCopyThreshold_, 且資料量 >= ZeroCopyThreshold_, 則使用 sendmsg(MSG_ZEROCOPY);
+   ///   已送出的節點, 會保留到收到核心的完成通知後, 才會歸還(觸發 BufferNodeVirtual 的通知).
    /// \retval 0     success;  返回前, 若已無資料則: CheckSendQueueEmpty(); 若仍有資料則: 啟動 writable 偵測.
    /// \retval else  errno;    返回前, 已先呼叫 this->OnFdrSocket_Error("fn=Sendv|err=", retval);
    int Sendv(DeviceOpLocker& sc, DcQueueList& toSend);
@@ -43,9 +81,16 @@ protected:
    }
 
 public:
-   FdrSocket(FdrService& iosv, Socket&& so) : FdrEventHandler{iosv, so.MoveOut()} {
+   /// devName: 用來對照 IoServiceArgs::FdrPins_, 決定使用哪個 FdrThread.
+   FdrSocket(FdrService& iosv, Socket&& so, StrView devName = StrView{})
+      : FdrEventHandler{iosv, so.MoveOut(), devName} {
    }
 
+   /// 設定 SO_ZEROCOPY, 成功後, 若 Sendv() 的資料量 >= threshold 則使用 MSG_ZEROCOPY 傳送.
+   /// - 必須在啟用事件(UpdateFdrEvent)之前呼叫, 通常在建構時呼叫.
+   /// - 若 OS 不支援, 則記錄 log 之後, 使用一般的 writev().
+   void SetZeroCopyThreshold(uint32_t threshold);
+
    void EnableEventBit(FdrEventFlag ev) {
       if ((this->EnabledEvents_.fetch_or(static_cast<FdrEventFlagU>(ev), std::memory_order_relaxed)
            & static_cast<FdrEventFlagU>(ev)) == 0)
@@ -55,8 +55,8 @@ protected:
    }
 
 public:
-   FdrSocketClientImpl(FdrService& iosv, Socket&& so)
-      : FdrSocket{iosv, std::move(so)} {
+   FdrSocketClientImpl(FdrService& iosv, Socket&& so, StrView devName = StrView{})
+      : FdrSocket{iosv, std::move(so), devName} {
    }
    bool IsClosing() const {
       return this->State_ == State::Closing;
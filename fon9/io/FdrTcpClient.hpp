@@ -20,8 +20,9 @@ public:
    const OwnerDeviceSP  Owner_;
 
    FdrTcpClientImpl(OwnerDevice* owner, Socket&& so, SocketResult&)
-      : base{*owner->IoService_, std::move(so)}
+      : base{*owner->IoService_, std::move(so), owner->GetManagerDeviceName()}
       , Owner_{owner} {
+      this->SetZeroCopyThreshold(owner->Config_.Options_.ZeroCopyThreshold_);
    }
    bool OpImpl_ConnectTo(const SocketAddress& addr, SocketResult& soRes);
 };
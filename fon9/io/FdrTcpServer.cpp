@@ -54,7 +54,8 @@ class FdrTcpListener::AcceptedClient : public DeviceAcceptedClient, public FdrSo
 public:
    AcceptedClient(FdrTcpListener& owner, Socket soAccepted, SessionSP ses, ManagerSP mgr, const DeviceOptions& optsDefault)
       : base(&owner, std::move(ses), std::move(mgr), &optsDefault)
-      , FdrSocket(*owner.IoServiceSP_, std::move(soAccepted)) {
+      , FdrSocket(*owner.IoServiceSP_, std::move(soAccepted), owner.Server_->GetManagerDeviceName()) {
+      this->SetZeroCopyThreshold(owner.Server_->Config_.AcceptedSocketOptions_.ZeroCopyThreshold_);
    }
 
    using Impl = DeviceImpl_DeviceStartSend<DeviceAcceptedClientWithSend<AcceptedClient>, FdrSocket>;
@@ -2,6 +2,8 @@
 /// \author fonwinz@gmail.com
 #include "fon9/io/SimpleManager.hpp"
 #include "fon9/TestTools.hpp"
+#include "fon9/MpscQueue.hpp"
+#include "fon9/MustLock.hpp"
 
 #ifdef fon9_WINDOWS
 #include "fon9/io/win/IocpTcpClient.hpp"
@@ -155,9 +157,99 @@ public:
 using PingpongSP = fon9::intrusive_ptr<PingpongSession>;
 fon9_WARN_POP;
 
+//--------------------------------------------------------------------------//
+// FdrThread 的 pending 佇列(PendingUpdates_, PendingSends_, PendingRemoves_) 效率比較:
+// - Locked: 舊的作法 MustLock<std::vector<>>, consumer 用 swap 一次取出.
+// - Mpsc:   目前的作法 MpscQueue, 節點嵌入在物件裡面.
+// 多個 producer threads 各自 push countPerProducer 次, 一個 consumer thread 全部取出.
+struct PendingItem : public fon9::MpscNode {
+   uint64_t Value_{0};
+};
+struct PendingLocked {
+   using Impl = std::vector<PendingItem*>;
+   fon9::MustLock<Impl> Reqs_;
+   Impl                 Out_;
+   void Push(PendingItem* item) {
+      fon9::MustLock<Impl>::Locker lk{this->Reqs_};
+      lk->push_back(item);
+   }
+   template <class FnConsume>
+   void Drain(FnConsume&& fn) {
+      this->Out_.clear();
+      this->Reqs_.Lock()->swap(this->Out_);
+      for (PendingItem* item : this->Out_)
+         fn(item);
+   }
+};
+struct PendingMpsc {
+   fon9::MpscQueue   Reqs_;
+   void Push(PendingItem* item) {
+      this->Reqs_.push(item);
+   }
+   template <class FnConsume>
+   void Drain(FnConsume&& fn) {
+      while (fon9::MpscNode* node = this->Reqs_.pop())
+         fn(static_cast<PendingItem*>(node));
+   }
+};
+template <class Pendings>
+void BenchPendings(const char* name, unsigned producerCount, uint64_t countPerProducer) {
+   Pendings                   pendings;
+   std::vector<PendingItem>   items(producerCount * countPerProducer);
+   std::vector<std::thread>   producers;
+   std::atomic<unsigned>      readyCount{0};
+   std::atomic<bool>          isStart{false};
+   for (unsigned L = 0; L < producerCount; ++L) {
+      producers.emplace_back([&, L]() {
+         PendingItem* beg = &items[L * countPerProducer];
+         PendingItem* end = beg + countPerProducer;
+         readyCount.fetch_add(1);
+         while (!isStart.load(std::memory_order_acquire))
+            std::this_thread::yield();
+         for (; beg != end; ++beg)
+            pendings.Push(beg);
+      });
+   }
+   while (readyCount.load() < producerCount)
+      std::this_thread::yield();
+
+   const uint64_t    expCount = items.size();
+   uint64_t          popCount = 0, drainCount = 0, sum = 0;
+   fon9::StopWatch   stopWatch;
+   isStart.store(true, std::memory_order_release);
+   while (popCount < expCount) {
+      ++drainCount;
+      pendings.Drain([&popCount, &sum](PendingItem* item) {
+         sum += ++item->Value_;
+         ++popCount;
+      });
+   }
+   stopWatch.PrintResultNoEOL(name, expCount) << "|drains=" << drainCount << std::endl;
+   for (std::thread& thr : producers)
+      thr.join();
+   if (sum != expCount) {
+      std::cout << "[ERROR] " << name << "|sum=" << sum << "|expected=" << expCount << std::endl;
+      abort();
+   }
+}
+int BenchPendings(int argc, const char** argv) {
+   const unsigned producerCount = (argc >= 3 ? fon9::StrTo(fon9::StrView_cstr(argv[2]), 0u) : 0u);
+   const uint64_t countPerProducer = (argc >= 4 ? fon9::StrTo(fon9::StrView_cstr(argv[3]), uint64_t{}) : uint64_t{});
+   fon9::AutoPrintTestInfo utinfo("IoDev.Pendings");
+   for (unsigned thrs = 1; thrs <= (producerCount ? producerCount : 4u); thrs *= 2) {
+      const uint64_t count = (countPerProducer ? countPerProducer : 1000000u);
+      std::cout << "producers=" << thrs << "|countPerProducer=" << count << std::endl;
+      BenchPendings<PendingLocked>("Locked", thrs, count);
+      BenchPendings<PendingMpsc>  ("Mpsc  ", thrs, count);
+   }
+   return 0;
+}
+
 //--------------------------------------------------------------------------//
 
 int main(int argc, const char** argv) {
+   if (argc >= 2 && argv[1][0] == 'q')
+      return BenchPendings(argc, argv);
    if (argc < 3) {
 __USAGE:
       std::cout << R"**(
@@ -165,10 +257,13 @@ Usage:
     c "TcpClientConfigs" "IoServiceConfigs"
     s "TcpServerConfigs"
     u "DgramConfigs(UDP or Multicast)" "IoServiceConfigs"
+    q [producers] [countPerProducer]
+      FdrThread pending queue benchmark: Locked(MustLock<vector>) vs Mpsc(MpscQueue).
 
 e.g.
     c "127.0.0.1:9000|Timeout=30" "ThreadCount=2|Wait=Block|Cpus="
     s "9000|ThreadCount=2|Wait=Block|Cpus="
+    c "127.0.0.1:9000" "ThreadCount=1|SpinUS=200|BackoffMS=8|BusyPollUS=50"
 )**"
          << std::endl;
       return 3;
@@ -248,6 +343,8 @@ Commands:
    ? or help      this menu.
    quit           quit program.
    log N          N=LogLevel, 4=WARN, 5=ERROR
+   lat            IoServiceConfigs wakeup & dispatch latency (POSIX: c, u mode only).
+   thrs           IoServiceConfigs threads load & wakeup latency (POSIX: c, u mode only).
 
    ses e          pingpong echo on/off
    ses a size     dev.SendASAP(data, size);
@@ -278,6 +375,22 @@ Commands:
          std::cout << "LogLevel=" << fon9::GetLevelStr(fon9::LogLevel_) << std::endl;
          continue;
       }
+#ifndef fon9_WINDOWS
+      if (c1 == "lat") {
+         std::string info;
+         if (iosv)
+            iosv->AppendLatencyInfo(info);
+         std::cout << "Latency" << info << std::endl;
+         continue;
+      }
+      if (c1 == "thrs") {
+         std::string info;
+         if (iosv)
+            iosv->AppendThreadsInfo(info);
+         std::cout << "Threads" << info << std::endl;
+         continue;
+      }
+#endif
       auto dres = dev->DeviceCommand(cmd);
       if (!dres.empty())
          std::cout << dres << std::endl;
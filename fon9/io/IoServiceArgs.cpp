@@ -7,6 +7,29 @@
 
 namespace fon9 { namespace io {
 
+static const StrView fdrAllocPolicyStrMap[]{
+   fon9_MAKE_ENUM_CLASS_StrView_NoSeq(0, FdrAllocPolicy, FdMod),
+   fon9_MAKE_ENUM_CLASS_StrView_NoSeq(1, FdrAllocPolicy, LeastConn),
+   fon9_MAKE_ENUM_CLASS_StrView_NoSeq(2, FdrAllocPolicy, LeastEvents),
+};
+
+fon9_API FdrAllocPolicy StrToFdrAllocPolicy(StrView value, FdrAllocPolicy defaultValue) {
+   for (size_t idx = 0; idx < numofele(fdrAllocPolicyStrMap); ++idx) {
+      if (fdrAllocPolicyStrMap[idx] == value)
+         return static_cast<FdrAllocPolicy>(idx);
+   }
+   return defaultValue;
+}
+
+fon9_API StrView FdrAllocPolicyToStr(FdrAllocPolicy value) {
+   size_t idx = static_cast<size_t>(value);
+   if (idx >= numofele(fdrAllocPolicyStrMap))
+      return StrView("Unknown");
+   return fdrAllocPolicyStrMap[idx];
+}
+
+//--------------------------------------------------------------------------//
+
 ConfigParser::Result IoServiceArgs::OnTagValue(StrView tag, StrView& value) {
    const char* pvalbeg = value.begin();
    if (tag == "ThreadCount") {
@@ -18,12 +41,42 @@ ConfigParser::Result IoServiceArgs::OnTagValue(StrView tag, StrView& value) {
    }
    else if (tag == "Capacity")
       this->Capacity_ = StrTo(value, 0u);
+   else if (tag == "SpinUS")
+      this->SpinUS_ = StrTo(value, 0u);
+   else if (tag == "BackoffMS")
+      this->BackoffMS_ = StrTo(value, 0u);
+   else if (tag == "BusyPollUS")
+      this->BusyPollUS_ = StrTo(value, 0u);
+   else if (tag == "Rebalance")
+      this->RebalanceSecs_ = StrTo(value, 0u);
    else if (tag == "Wait") {
       if ((this->HowWait_ = StrToHowWait(value)) == HowWait::Unknown) {
          this->HowWait_ = HowWait::Block;
          return ConfigParser::Result::EInvalidValue;
       }
    }
+   else if (tag == "Alloc") {
+      const FdrAllocPolicy kUnknown = static_cast<FdrAllocPolicy>(0xff);
+      FdrAllocPolicy policy = StrToFdrAllocPolicy(value, kUnknown);
+      if (policy == kUnknown)
+         return ConfigParser::Result::EInvalidValue;
+      this->FdrAllocPolicy_ = policy;
+   }
+   else if (tag == "Pin") {
+      while (!value.empty()) {
+         StrView v1 = StrFetchTrim(value, ',');
+         if (v1.empty())
+            continue;
+         StrView name = StrFetchTrim(v1, ':');
+         const char* pend;
+         int n = StrTo(v1, -1, &pend);
+         if (name.empty() || n < 0 || pend != v1.end()) {
+            value.SetBegin(name.begin());
+            return ConfigParser::Result::EInvalidValue;
+         }
+         this->FdrPins_.push_back(FdrPin{name.ToString(), static_cast<uint32_t>(n)});
+      }
+   }
    else if (tag == "Cpus") {
       while (!value.empty()) {
          StrView v1 = StrFetchTrim(value, ',');
@@ -56,7 +109,11 @@ void ServiceThreadArgs::OnThrRunBegin(StrView msgHead) const {
       "|index=", this->ThreadPoolIndex_ + 1,
       "|Cpu=", this->CpuAffinity_, ':', cpuAffinityResult,
       "|Wait=", HowWaitToStr(this->HowWait_),
-      "|Capacity=", this->Capacity_);
+      "|Capacity=", this->Capacity_,
+      "|SpinUS=", this->SpinUS_,
+      "|BackoffMS=", this->BackoffMS_,
+      "|BusyPollUS=", this->BusyPollUS_,
+      "|Rebalance=", this->RebalanceSecs_);
    fon9_LOG_ThrRun(thrName);
    SetCurrentThreadName(thrName.c_str());
 }
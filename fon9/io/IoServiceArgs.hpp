@@ -13,7 +13,20 @@ fon9_AFTER_INCLUDE_STD;
 namespace fon9 { namespace io {
 
 /// \ingroup io
-/// args: "ThreadCount=n|Wait=Policy|Cpus=List|Capacity=0"
+/// FdrService 建立 FdrEventHandler 時, 如何選擇 FdrThread.
+enum class FdrAllocPolicy : uint8_t {
+   /// fd % ThreadCount.
+   FdMod,
+   /// 選擇 handler 數量最少的 FdrThread.
+   LeastConn,
+   /// 選擇最近每秒事件數量最少的 FdrThread, 若相同則選 handler 數量最少的.
+   LeastEvents,
+};
+fon9_API FdrAllocPolicy StrToFdrAllocPolicy(StrView value, FdrAllocPolicy defaultValue);
+fon9_API StrView FdrAllocPolicyToStr(FdrAllocPolicy value);
+
+/// \ingroup io
+/// args: "ThreadCount=n|Wait=Policy|Cpus=List|Capacity=0|SpinUS=0|BackoffMS=0|BusyPollUS=0|Alloc=FdMod|Pin=List|Rebalance=0"
 /// Policy: Block(default)
 struct fon9_API IoServiceArgs {
    /// 若有設定 CpuAffinity, 則每個 io service thread 會綁定一個固定的 cpu, 而不是所有的 thread 共用這裡設定的 cpu.
@@ -30,6 +43,34 @@ struct fon9_API IoServiceArgs {
    /// 0 = 由 io service 自行決定最佳值.
    size_t   Capacity_{0};
 
+   /// 目前僅 FdrThreadEpoll 支援 SpinUS_, BackoffMS_, BusyPollUS_.
+   /// 僅在 HowWait_ == Block 時有效(Busy, Yield 本來就不會進入等候):
+   /// 最後一次有事件之後, 持續檢查事件(不等候)的時間(microseconds).
+   /// 超過此時間仍沒有事件, 則逐步退讓(BackoffMS_), 最後才進入 Block.
+   /// 0 = 不使用, 直接 Block.
+   uint32_t SpinUS_{0};
+   /// Spin 結束後, 等候時間依序為 1ms, 2ms, 4ms... 直到超過 BackoffMS_ 才進入 Block.
+   /// 0 = Spin 結束後直接 Block.
+   uint32_t BackoffMS_{0};
+   /// 若 > 0, 則在 socket 加入 FdrThread 時設定 SO_BUSY_POLL(及 SO_PREFER_BUSY_POLL, 若 OS 支援).
+   /// 通常需要搭配 SpinUS_ 或 HowWait::Busy 才有意義.
+   uint32_t BusyPollUS_{0};
+
+   /// 僅在 POSIX 環境下有效.
+   FdrAllocPolicy FdrAllocPolicy_{FdrAllocPolicy::FdMod};
+   /// 指定名稱的 device(e.g. IoManager 設定的 Id) 固定使用 FdrThreads[ThreadIndex_ % ThreadCount];
+   /// 優先於 FdrAllocPolicy_.
+   struct FdrPin {
+      std::string DeviceName_;
+      uint32_t    ThreadIndex_;
+   };
+   using FdrPins = std::vector<FdrPin>;
+   FdrPins  FdrPins_;
+   /// 僅在 POSIX 環境下有效: 若 > 0, 則每個 FdrThread 每隔 RebalanceSecs_ 秒檢查一次負載,
+   /// 若負載明顯高於其他 thread, 則將「最近事件最少的閒置 handler(沒有 Pin)」轉移到負載最低的 thread.
+   /// 0 = 不自動轉移.
+   uint32_t RebalanceSecs_{0};
+
    IoServiceArgs() = default;
 
    int GetCpuAffinity(size_t threadPoolIndex) const {
@@ -45,6 +86,12 @@ struct fon9_API IoServiceArgs {
    /// Capacity    | >= 0
    /// Wait        | "Block" or "Busy" or "Yield"
    /// Cpus        | c0, c1, c2 ... 根據 thread pool index 依序選擇 c0 或 c1 或 c2...
+   /// SpinUS      | >= 0
+   /// BackoffMS   | >= 0
+   /// BusyPollUS  | >= 0
+   /// Alloc       | "FdMod"(default) or "LeastConn" or "LeastEvents"
+   /// Pin         | name0:i0, name1:i1 ... 名稱為 name0 的 device 使用 thread pool index=i0(從 0 開始).
+   /// Rebalance   | >= 0 秒.
    ConfigParser::Result OnTagValue(StrView tag, StrView& value);
 };
 
@@ -56,6 +103,10 @@ struct fon9_API ServiceThreadArgs {
    int         CpuAffinity_;
    HowWait     HowWait_;
    size_t      Capacity_;
+   uint32_t    SpinUS_;
+   uint32_t    BackoffMS_;
+   uint32_t    BusyPollUS_;
+   uint32_t    RebalanceSecs_;
 
    ServiceThreadArgs() = default;
    ServiceThreadArgs(const IoServiceArgs& ioArgs, const std::string& name, size_t index)
@@ -63,7 +114,11 @@ struct fon9_API ServiceThreadArgs {
       , ThreadPoolIndex_{index}
       , CpuAffinity_{ioArgs.GetCpuAffinity(index)}
       , HowWait_{ioArgs.HowWait_}
-      , Capacity_{ioArgs.Capacity_} {
+      , Capacity_{ioArgs.Capacity_}
+      , SpinUS_{ioArgs.SpinUS_}
+      , BackoffMS_{ioArgs.BackoffMS_}
+      , BusyPollUS_{ioArgs.BusyPollUS_}
+      , RebalanceSecs_{ioArgs.RebalanceSecs_} {
    }
 
    /// - 透過 fon9_LOG_ThrRun(msgHead, ".ThrRun|name=", this->Name_...) 記錄 log.
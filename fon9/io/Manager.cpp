@@ -6,6 +6,9 @@ namespace fon9 { namespace io {
 
 Manager::~Manager() {
 }
+StrView Manager::GetDeviceName(Device&) {
+   return StrView{};
+}
 
 unsigned ManagerC::IoManagerAddRef() {
    return intrusive_ptr_add_ref(static_cast<baseCounter*>(this));
@@ -36,6 +36,11 @@ public:
 
    virtual void OnSession_StateUpdated(Device& dev, StrView stmsg, LogLevel lv) = 0;
 
+   /// 取得 dev 在管理員裡面的名稱(例: IoManager 的設定 Id), 用來對照 IoServiceArgs::FdrPins_ 之類的設定.
+   /// - 若 dev 為 accepted client, 則應傳回 server 的名稱.
+   /// - 預設傳回 StrView{}.
+   virtual StrView GetDeviceName(Device& dev);
+
 private:
    virtual unsigned IoManagerAddRef() = 0;
    virtual unsigned IoManagerRelease() = 0;
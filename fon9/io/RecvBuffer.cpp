@@ -55,5 +55,11 @@ DcQueueList& RecvBuffer::SetDataReceived(size_t rxsz) {
    }
    return this->Queue_;
 }
+DcQueueList& RecvBuffer::SetDataReceived(FwdBufferNode* node) {
+   assert(this->State_ == RecvBufferState::NotInUse);
+   this->State_ = RecvBufferState::InvokingEvent;
+   this->Queue_.push_back(node);
+   return this->Queue_;
+}
 
 } } // namespace
@@ -89,6 +89,12 @@ public:
    /// \return 存放接收資料的 DcQueueList.
    DcQueueList& SetDataReceived(size_t rxsz);
 
+   /// 不透過 GetRecvBlockVector() 取得緩衝區, 而是直接提供已收到資料的 node,
+   /// 加入接收緩衝之後, 進入 RecvBufferState::InvokingEvent 狀態.
+   /// - 例: 使用 recvmmsg() 一次收到多個 datagram, 每個 datagram 各自使用一個 node, 各自觸發一次事件.
+   /// - node 的所有權轉移到 this.
+   DcQueueList& SetDataReceived(FwdBufferNode* node);
+
    /// 僅能在 OnDevice_Recv() 事件之後呼叫一次.
    void SetContinueRecv() {
       assert(this->IsInvokingEvent());
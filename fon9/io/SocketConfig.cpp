@@ -55,6 +55,8 @@ ConfigParser::Result SocketOptions::OnTagValue(StrView tag, StrView& value) {
    }
    else if (tag == "KeepAlive")
       this->KeepAliveInterval_ = StrTo(value, int{});
+   else if (tag == "ZeroCopy")
+      this->ZeroCopyThreshold_ = StrTo(value, 0u);
    else
       return ConfigParser::Result::EUnknownTag;
    return ConfigParser::Result::Success;
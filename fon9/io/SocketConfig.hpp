@@ -40,6 +40,13 @@ struct fon9_API SocketOptions {
    /// - >1:  TCP_KEEPIDLE,TCP_KEEPINTVL 的間隔秒數, 此時 TCP_KEEPCNT 一律設為 3.
    int KeepAliveInterval_;
 
+   /// 使用 "ZeroCopy=size" 設定(僅 Linux TCP 有效).
+   /// - 0: 不使用(預設).
+   /// - >0: 設定 SO_ZEROCOPY, 每次傳送的資料量 >= size 時, 使用 sendmsg(MSG_ZEROCOPY) 傳送;
+   ///   較小的資料仍使用一般的 writev().
+   /// - 由於 MSG_ZEROCOPY 需要額外的 page pinning 及完成通知, 通常只有在 size >= 10K 時才有效益.
+   uint32_t ZeroCopyThreshold_;
+
    void SetDefaults();
 
    ConfigParser::Result OnTagValue(StrView tag, StrView& value);
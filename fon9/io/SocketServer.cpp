@@ -21,6 +21,12 @@ void SocketServerConfig::SetDefaults() {
    this->ServiceArgs_.Capacity_ = 0;
    this->ServiceArgs_.CpuAffinity_.clear();
    this->ServiceArgs_.HowWait_ = HowWait::Block;
+   this->ServiceArgs_.SpinUS_ = 0;
+   this->ServiceArgs_.BackoffMS_ = 0;
+   this->ServiceArgs_.BusyPollUS_ = 0;
+   this->ServiceArgs_.FdrAllocPolicy_ = FdrAllocPolicy::FdMod;
+   this->ServiceArgs_.FdrPins_.clear();
+   this->ServiceArgs_.RebalanceSecs_ = 0;
 }
 
 SocketServerConfig::Parser::~Parser() {
@@ -71,7 +71,7 @@ int main() {
       }
    };
    fon9::StrView cfgstr{"192.168.1.3:5555|Timeout=99|DN=" cstrDN
-      "|TcpNoDelay=N|SNDBUF=1234|RCVBUF=5678|ReuseAddr=Y|ReusePort=Y|Linger=N|KeepAlive=8"
+      "|TcpNoDelay=N|SNDBUF=1234|RCVBUF=5678|ReuseAddr=Y|ReusePort=Y|Linger=N|KeepAlive=8|ZeroCopy=16384"
       "|MyTag=MyValue|Bind=192.168.1.4:29999"
       "|ERR-TEST"};
    if (CliParser{clicfg}.Parse(cfgstr) != fon9::ConfigParser::Result::EUnknownTag
@@ -98,6 +98,7 @@ int main() {
    CHECK_VALUE(clicfg, Options_.Linger_.l_onoff,    1);
    CHECK_VALUE(clicfg, Options_.Linger_.l_linger,   0);
    CHECK_VALUE(clicfg, Options_.KeepAliveInterval_, 8);
+   CHECK_VALUE(clicfg, Options_.ZeroCopyThreshold_, 16384);
 
    if (clicfg.AddrRemote_.Addr_.sa_family != AF_INET
        || clicfg.AddrRemote_.Addr4_.sin_addr.s_addr != 0x0301a8c0
@@ -136,9 +137,10 @@ __ERROR_cstrErrFieldName:
       }
    };
    cfgstr = "[::1]9999|Remote=[2406:2000:ec:815::3]:8888|ListenBacklog=100"
-      "|Capacity=10240|ThreadCount=99|Wait=Busy|Cpus=1,2,3"
+      "|Capacity=10240|ThreadCount=99|Wait=Busy|Cpus=1,2,3|SpinUS=50|BackoffMS=8|BusyPollUS=20"
+      "|Alloc=LeastConn|Pin=OrdLine:1,MdFeed:0|Rebalance=5"
       "|ClientOptions="
-         "{TcpNoDelay=N|SNDBUF=1234|RCVBUF=5678|ReuseAddr=Y|ReusePort=Y|Linger=N|KeepAlive=8"
+         "{TcpNoDelay=N|SNDBUF=1234|RCVBUF=5678|ReuseAddr=Y|ReusePort=Y|Linger=N|KeepAlive=8|ZeroCopy=16384"
          "|MyClientTag=MyClientValue}"
       "|MyServerTag=MyServerValue|ERR-TEST";
    if (SerParser{sercfg}.Parse(cfgstr) != fon9::ConfigParser::Result::EUnknownTag
@@ -152,6 +154,16 @@ __ERROR_cstrErrFieldName:
    CHECK_VALUE(sercfg, ServiceArgs_.ThreadCount_, 99);
    CHECK_VALUE(sercfg, ServiceArgs_.HowWait_,     fon9::HowWait::Busy);
    CHECK_VALUE(sercfg, ServiceArgs_.Capacity_,    10240);
+   CHECK_VALUE(sercfg, ServiceArgs_.SpinUS_,      50);
+   CHECK_VALUE(sercfg, ServiceArgs_.BackoffMS_,   8);
+   CHECK_VALUE(sercfg, ServiceArgs_.BusyPollUS_,  20);
+   CHECK_VALUE(sercfg, ServiceArgs_.FdrAllocPolicy_, fon9::io::FdrAllocPolicy::LeastConn);
+   CHECK_VALUE(sercfg, ServiceArgs_.FdrPins_.size(), 2u);
+   CHECK_VALUE(sercfg, ServiceArgs_.FdrPins_[0].DeviceName_, "OrdLine");
+   CHECK_VALUE(sercfg, ServiceArgs_.FdrPins_[0].ThreadIndex_, 1u);
+   CHECK_VALUE(sercfg, ServiceArgs_.FdrPins_[1].DeviceName_, "MdFeed");
+   CHECK_VALUE(sercfg, ServiceArgs_.FdrPins_[1].ThreadIndex_, 0u);
+   CHECK_VALUE(sercfg, ServiceArgs_.RebalanceSecs_, 5u);
    CHECK_VALUE(sercfg, ListenBacklog_, 100);
 
    struct in6_addr sin6_addr;
@@ -547,7 +547,12 @@ struct RcSvStreamDecoder_MdRts : public RcSvStreamDecoder, public RcSvStreamDeco
                return;
             }
             assert(!flds->empty());
-            unsigned count = static_cast<unsigned>(first & 0x0f) + 1;
+            unsigned count = static_cast<unsigned>(first & fmkt::kRtBSSnapshotCountMask) + 1;
+            if (first & fmkt::kRtBSSnapshotCountExt)
+               count = static_cast<unsigned>(ReadOrRaise<uint8_t>(rxbuf)) + 1;
+            // 來源提供的檔數超過本地欄位數量: 拋棄較深的檔位.
+            for (; count > flds->size(); --count)
+               SkipPQ(rxbuf);
             auto     ibeg = flds->cbegin() + count;
             this->ClearFieldValues(dec.RawWr_, ibeg, flds->cend());
             do {
@@ -623,6 +628,12 @@ struct RcSvStreamDecoder_MdRts : public RcSvStreamDecoder, public RcSvStreamDeco
       while (--iend != ibeg)
          CopyPQ(wr, *iend, *(iend - 1));
    }
+   static void SkipPQ(DcQueue& rxbuf) {
+      fmkt::Pri pri;
+      fmkt::Qty qty;
+      BitvTo(rxbuf, pri);
+      BitvTo(rxbuf, qty);
+   }
    void DecodeUpdateBS(svc::RxSubrData& rx, f9sv_ClientReport& rpt, DcQueue& rxbuf) {
       InfoAux  dec(rx, rpt, rxbuf, this->TabIdxBS_);
       dec.PutDecField(*this->FldBSInfoTime_, *dec.InfoTime_);
@@ -643,13 +654,35 @@ struct RcSvStreamDecoder_MdRts : public RcSvStreamDecoder, public RcSvStreamDeco
             assert(!"Unknown RtBSType.");
             return;
          }
-         assert((bsType & 0x0fu) < flds->size());
-         if ((bsType & 0x0fu) >= flds->size()) {
-            fon9_LOG_ERROR("DecodeUpdateBS|err=Bad level|rtBS=", ToHex(bsType));
-            return;
+         unsigned lv = (bsType & fmkt::kRtBSLevelMask);
+         if (lv == fmkt::kRtBSLevelExt)
+            lv = ReadOrRaise<uint8_t>(rxbuf);
+         const auto bsAction = static_cast<fmkt::RtBSAction>(bsType & cast_to_underlying(fmkt::RtBSAction::Mask));
+         if (fon9_UNLIKELY(lv >= flds->size())) {
+            // 來源的檔數超過本地欄位數量: 此檔位的異動, 不影響本地可見的檔位, 取出 Pri,Qty 後拋棄.
+            fon9_WARN_DISABLE_SWITCH;
+            switch (bsAction) {
+            case fmkt::RtBSAction::New:
+            case fmkt::RtBSAction::ChangePQ:
+               SkipPQ(rxbuf);
+               break;
+            case fmkt::RtBSAction::ChangeQty:
+            {
+               fmkt::Qty qty;
+               BitvTo(rxbuf, qty);
+               break;
+            }
+            }
+            fon9_WARN_POP;
+            if (fon9_UNLIKELY(rx.IsNeedsLog_))
+               RevPrint(rx.LogBuf_, "|rtBS.", ToHex(bsType), ".lv=", lv, "(skip)");
+            if (count <= 0)
+               break;
+            --count;
+            continue;
          }
-         const auto ibeg = flds->cbegin() + (bsType & 0x0f);
-         switch (static_cast<fmkt::RtBSAction>(bsType & cast_to_underlying(fmkt::RtBSAction::Mask))) {
+         const auto ibeg = flds->cbegin() + lv;
+         switch (bsAction) {
          case fmkt::RtBSAction::New:
             InsertPQ(dec.RawWr_, ibeg, flds->cend());
             // 不用 break; 取出 rxbuf 裡面的 Pri,Qty; 填入 ibeg;
@@ -672,8 +705,12 @@ struct RcSvStreamDecoder_MdRts : public RcSvStreamDecoder, public RcSvStreamDeco
             fon9_LOG_ERROR("DecodeUpdateBS|err=Unknown RtBSAction|rtBS=", ToHex(bsType));
             return;
          }
-         if (fon9_UNLIKELY(rx.IsNeedsLog_))
-            RevPrint(rx.LogBuf_, "|rtBS.", ToHex(bsType), '=');
+         if (fon9_UNLIKELY(rx.IsNeedsLog_)) {
+            if ((bsType & fmkt::kRtBSLevelMask) == fmkt::kRtBSLevelExt)
+               RevPrint(rx.LogBuf_, "|rtBS.", ToHex(bsType), ".lv=", lv, '=');
+            else
+               RevPrint(rx.LogBuf_, "|rtBS.", ToHex(bsType), '=');
+         }
          if (count <= 0)
             break;
          --count;
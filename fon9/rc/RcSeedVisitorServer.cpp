@@ -27,7 +27,7 @@ void RcSeedVisitorServerAgent::OnRecvFunctionCall(RcSession& ses, RcFunctionPara
          RevPrint(rbuf, fon9_kCSTR_LEAD_TABLE fon9_kCSTR_PolicyAclAgent_Name fon9_kCSTR_ROWSPL);
          PutBigEndian(rbuf.AllocPacket<SvFunc>(), SvFuncCode::Acl);
          ses.Send(this->FunctionCode_, std::move(rbuf));
-         ses.ResetNote(this->FunctionCode_, RcFunctionNoteSP{new RcSeedVisitorServerNote(ses, authr, std::move(aclcfg))});
+         ses.ResetNote(this->FunctionCode_, RcFunctionNoteSP{new RcSeedVisitorServerNote(ses, authr, std::move(aclcfg), this->IsSharedGv_)});
       }
       else
          ses.ForceLogout("Auth PolicyAclAgent not found.");
@@ -66,13 +66,15 @@ struct RcSeedVisitorServerNote::SeedVisitor : public seed::SeedVisitor {
 //--------------------------------------------------------------------------//
 RcSeedVisitorServerNote::RcSeedVisitorServerNote(RcSession& ses,
                                                  const auth::AuthResult& authr,
-                                                 seed::AclConfig&& aclcfg)
+                                                 seed::AclConfig&& aclcfg,
+                                                 bool isSharedGv)
    : Visitor_{new SeedVisitor(ses.GetDevice(), authr, std::move(aclcfg))}
    , FcQry_(static_cast<unsigned>(aclcfg.FcQuery_.FcCount_ * 2), // *2: for 緩衝.
             TimeInterval_Millisecond(aclcfg.FcQuery_.FcTimeMS_))
    , FcRecover_(aclcfg.FcRecover_.FcCount_ * 1000u,
                 TimeInterval_Millisecond(aclcfg.FcRecover_.FcTimeMS_),
-                aclcfg.FcRecover_.FcTimeMS_ /* 讓時間分割單位=1ms */) {
+                aclcfg.FcRecover_.FcTimeMS_ /* 讓時間分割單位=1ms */)
+   , IsSharedGv_{isSharedGv} {
 }
 RcSeedVisitorServerNote::~RcSeedVisitorServerNote() {
 }
@@ -449,7 +451,7 @@ void RcSeedVisitorServerNote::OnRecvFunctionCall(RcSession& ses, RcFunctionParam
                }
             }
          }
-         ppSubr->reset(new SubrReg(reqKey.SubrIndex_, ToStrView(reqKey.SeedKey_), ses.GetDevice()));
+         ppSubr->reset(new SubrReg(reqKey.SubrIndex_, ToStrView(reqKey.SeedKey_), ses.GetDevice(), this->IsSharedGv_));
          TicketRunnerSubscribe* req = new TicketRunnerSubscribe{*this->Visitor_, std::move(reqKey)};
          runner.reset(req);
          svTicket = req;
@@ -552,6 +554,16 @@ void RcSeedVisitorServerNote::OnSubscribeNotify(SubrRegSP preg, const seed::Seed
       // 不用 break; 繼續處理 gv 及 key 填入 ackbuf;
    case seed::SeedNotifyKind::SeedChanged:
    case seed::SeedNotifyKind::StreamData:
+      if (fon9_UNLIKELY(preg->IsSharedGv_)) {
+         // 若發行者有提供共用的內容(例: MdRts), 則直接串到 ackbuf, 不用每個訂閱者都複製一次.
+         BufferList gvbuf{e.GetGridViewShared()};
+         if (const BufferNode* gvfront = gvbuf.cfront()) {
+            const size_t gvsz = CalcSendDataSize(gvfront);
+            ackbuf = RevBufferList{128, std::move(gvbuf)};
+            ByteArraySizeToBitvT(ackbuf, gvsz);
+            goto __CHECK_PUT_KEY_FOR_SUBR_TREE;
+         }
+      }
       ToBitv(ackbuf, e.GetGridView());
       goto __CHECK_PUT_KEY_FOR_SUBR_TREE;
    case seed::SeedNotifyKind::PodRemoved:
@@ -580,11 +592,15 @@ void RcSeedVisitorServerNote::OnSubscribeNotify(SubrRegSP preg, const seed::Seed
 #include "fon9/framework/IoManager.hpp"
 
 static bool RcSvServerAgent_Start(fon9::seed::PluginsHolder& holder, fon9::StrView args) {
+   // args = "SharedGv=Y|AddTo=..."; SharedGv 必須在 AddTo 之前設定.
    fon9::StrView tag, value;
+   bool          isSharedGv = false;
    while (fon9::SbrFetchTagValue(args, tag, value)) {
-      if (tag == "AddTo") {
+      if (tag == "SharedGv")
+         isSharedGv = (toupper(static_cast<unsigned char>(value.Get1st())) == 'Y');
+      else if (tag == "AddTo") {
          if (fon9::rc::RcFunctionMgr* rcFuncMgr = fon9::rc::FindRcFunctionMgr(holder, value))
-            rcFuncMgr->Add(fon9::rc::RcFunctionAgentSP{new fon9::rc::RcSeedVisitorServerAgent{}});
+            rcFuncMgr->Add(fon9::rc::RcFunctionAgentSP{new fon9::rc::RcSeedVisitorServerAgent{isSharedGv}});
          else
             return false;
       }
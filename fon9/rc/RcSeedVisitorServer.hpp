@@ -17,7 +17,16 @@ class RcSeedVisitorServerAgent : public RcFunctionAgent {
    fon9_NON_COPY_NON_MOVE(RcSeedVisitorServerAgent);
    using base = RcFunctionAgent;
 public:
-   RcSeedVisitorServerAgent() : base{f9rc_FunctionCode_SeedVisitor} {
+   /// 訂閱通知時, 是否使用發行者提供的共用內容(SeedNotifyArgs::GetGridViewShared()).
+   /// - 預設為 false: 每個訂閱者各自複製 GetGridView();
+   /// - 共用內容可避免每個訂閱者複製一次, 但需額外分配 BufferNodeShared 及 atomic 參考計數,
+   ///   實測在訂閱者多、封包小的情況下, 反而比複製更耗 CPU, 所以僅在需要降低傳送緩衝的記憶體用量時才啟用.
+   const bool  IsSharedGv_;
+   char        Padding___[7];
+
+   RcSeedVisitorServerAgent(bool isSharedGv = false)
+      : base{f9rc_FunctionCode_SeedVisitor}
+      , IsSharedGv_{isSharedGv} {
    }
    ~RcSeedVisitorServerAgent();
 
@@ -40,8 +49,9 @@ class RcSeedVisitorServerNote : public RcFunctionNote {
    TicketRunnerSubscribe* Runner_{};
    struct SubrReg : public intrusive_ref_counter<SubrReg> {
       fon9_NON_COPY_NON_MOVE(SubrReg);
-      SubrReg(f9sv_SubrIndex subrIndex, StrView seedKey, io::DeviceSP dev)
+      SubrReg(f9sv_SubrIndex subrIndex, StrView seedKey, io::DeviceSP dev, bool isSharedGv)
          : SubrIndex_{subrIndex}
+         , IsSharedGv_{isSharedGv}
          , SeedKey_{seedKey}
          , Device_{std::move(dev)} {
       }
@@ -59,7 +69,8 @@ class RcSeedVisitorServerNote : public RcFunctionNote {
       bool                 IsStream_{false};
       /// 當收到 NotifyKind = ParentSeedClear, 或 訂閱 seed 收到 PodRemoved, SeedRemoved 時;
       bool                 IsSubjectClosed_{false};
-      char                 Padding___[1];
+      /// 複製 RcSeedVisitorServerAgent::IsSharedGv_;
+      const bool           IsSharedGv_;
       seed::TreeSP         Tree_;
       SubConn              SubConn_{};
       const CharVector     SeedKey_;
@@ -69,6 +80,8 @@ class RcSeedVisitorServerNote : public RcFunctionNote {
    using SubrListImpl = std::vector<SubrRegSP>; // 索引值為 Client 端的 SubrIndex;
    using SubrList = MustLock<SubrListImpl>;
    SubrList SubrList_;
+   const bool  IsSharedGv_;
+   char        Padding___[7];
 
    static void OnSubscribeNotify(SubrRegSP preg, const seed::SeedNotifyArgs& e);
    void OnRecvUnsubscribe(RcSession& ses, f9sv_SubrIndex usidx);
@@ -76,7 +89,8 @@ class RcSeedVisitorServerNote : public RcFunctionNote {
 public:
    RcSeedVisitorServerNote(RcSession& ses,
                            const auth::AuthResult& authr,
-                           seed::AclConfig&& aclcfg);
+                           seed::AclConfig&& aclcfg,
+                           bool isSharedGv);
    ~RcSeedVisitorServerNote();
    void OnRecvFunctionCall(RcSession& ses, RcFunctionParam& param) override;
    void OnSessionLinkBroken();
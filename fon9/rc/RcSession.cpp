@@ -29,10 +29,12 @@ static inline ChecksumT FeedCalcCheckSum(ChecksumT cksum, const byte* ptr, size_
    return cksum;
 }
 static ChecksumT BufferList_CalcRcChecksum(const BufferNode* node) {
-   ChecksumT cksum = 0;
+   ChecksumT   cksum = 0;
+   const byte* beg;
    while (node) {
-      if (auto sz = node->GetDataSize())
-         cksum = FeedCalcCheckSum(cksum, node->GetDataBegin(), sz);
+      // 送出的 BufferList 可能包含 BufferNodeShared(例: MdRts 訂閱通知), 所以使用 GetSendData();
+      if (auto sz = GetSendData(node, &beg))
+         cksum = FeedCalcCheckSum(cksum, beg, sz);
       node = node->GetNext();
    }
    return cksum;
@@ -114,7 +116,7 @@ io::RecvBufferSize RcSession::OnDevice_LinkReady(io::Device& dev) {
    return kRcSession_RecvBufferSize;
 }
 void RcSession::Send(f9rc_FunctionCode fnCode, RevBufferList&& rbuf) {
-   ByteArraySizeToBitvT(rbuf, CalcDataSize(rbuf.cfront()));
+   ByteArraySizeToBitvT(rbuf, CalcSendDataSize(rbuf.cfront()));
    char* pout = rbuf.AllocPrefix(sizeof(fnCode));
    PutBigEndian(pout -= sizeof(fnCode), fnCode);
    rbuf.SetPrefixUsed(pout);
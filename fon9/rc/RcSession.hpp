@@ -42,6 +42,7 @@ public:
    /// 在透過 Device 送出前, 這裡會加上:
    /// - checksum(如果需要) + fnCode + ByteArraySizeToBitvT(rbuf的資料量)
    /// - 若 if (!this->LocalParam_.IsNoChecksum()) 則加上 checksum.
+   /// - rbuf 可以包含 BufferNodeShared(例: SeedNotifyArgs::GetGridViewShared()).
    void Send(f9rc_FunctionCode fnCode, RevBufferList&& rbuf);
 
    /// 發生嚴重錯誤, 強制結束 Session.
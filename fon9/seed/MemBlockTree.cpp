@@ -0,0 +1,128 @@
+﻿/// \file fon9/seed/MemBlockTree.cpp
+/// \author fonwinz@gmail.com
+#include "fon9/seed/MemBlockTree.hpp"
+#include "fon9/seed/FieldMaker.hpp"
+#include "fon9/seed/TreeOp.hpp"
+#include "fon9/seed/PodOp.hpp"
+#include "fon9/seed/RawRd.hpp"
+#include "fon9/buffer/MemBlockImpl.hpp"
+#include "fon9/CharVector.hpp"
+
+namespace fon9 { namespace seed {
+
+fon9_WARN_DISABLE_PADDING;
+struct MemBlockStatRow {
+   CharVector  Key_;
+   char        IsArena_;
+   uint32_t    BlockSize_;
+   uint64_t    Hits_;
+   uint64_t    Misses_;
+   uint64_t    Refills_;
+   uint64_t    EmptyCount_;
+   uint64_t    ReservedLists_;
+   uint64_t    TrimmedLists_;
+   uint64_t    Threads_;
+
+   MemBlockStatRow(const impl::MemBlockLevelStat& st)
+      : IsArena_{st.IsArena_ ? 'Y' : 'N'}
+      , BlockSize_{st.BlockSize_}
+      , Hits_{st.HitCount_}
+      , Misses_{st.MissCount_}
+      , Refills_{st.RefillCount_}
+      , EmptyCount_{st.EmptyCount_}
+      , ReservedLists_{st.ReservedListCount_}
+      , TrimmedLists_{st.TrimmedListCount_}
+      , Threads_{st.ThreadCount_} {
+      char  buf[32];
+      char* pend = buf + sizeof(buf);
+      char* pbeg = UIntToStrRev(pend, st.LevelIndex_);
+      *--pbeg = '.';
+      if (st.NodeId_ >= kMemBlockMaxNumaNodes)
+         *--pbeg = '*';
+      else
+         pbeg = UIntToStrRev(pbeg, st.NodeId_);
+      this->Key_.assign(pbeg, pend);
+   }
+};
+fon9_WARN_POP;
+using MemBlockStatRows = std::vector<MemBlockStatRow>;
+
+// key 的格式為 "node.level", node 與 level 都只有 1 碼(或 node="*"),
+// 且 MemBlockGetStats() 依序傳回, 所以 Rows 已依照 key 排序.
+static MemBlockStatRows::iterator ContainerLowerBound(MemBlockStatRows& rows, StrView strKeyText) {
+   return std::lower_bound(rows.begin(), rows.end(), strKeyText,
+                           [](const MemBlockStatRow& row, const StrView& key) {
+      return ToStrView(row.Key_) < key;
+   });
+}
+static MemBlockStatRows::iterator ContainerFind(MemBlockStatRows& rows, StrView strKeyText) {
+   auto ifind = ContainerLowerBound(rows, strKeyText);
+   return (ifind != rows.end() && ToStrView(ifind->Key_) == strKeyText) ? ifind : rows.end();
+}
+
+LayoutSP MemBlockTree::MakeLayout() {
+   Fields fields;
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, IsArena));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, BlockSize));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, Hits));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, Misses));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, Refills));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, EmptyCount));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, ReservedLists));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, TrimmedLists));
+   fields.Add(fon9_MakeField2_const(MemBlockStatRow, Threads));
+   return new Layout1(fon9_MakeField2_const(MemBlockStatRow, Key),
+                      new Tab{Named{"MemBlock"}, std::move(fields), TabFlag::NoSapling | TabFlag::NoSeedCommand});
+}
+
+struct MemBlockTree::TreeOp : public seed::TreeOp {
+   fon9_NON_COPY_NON_MOVE(TreeOp);
+   using base = seed::TreeOp;
+   MemBlockStatRows  Rows_;
+   TreeOp(MemBlockTree& tree) : base{tree} {
+      impl::MemBlockLevelStats stats;
+      impl::MemBlockGetStats(stats);
+      this->Rows_.reserve(stats.size());
+      for (const impl::MemBlockLevelStat& st : stats)
+         this->Rows_.emplace_back(st);
+   }
+   static void MakeRowView(MemBlockStatRows::iterator ivalue, Tab* tab, RevBuffer& rbuf) {
+      if (tab)
+         FieldsCellRevPrint(tab->Fields_, SimpleRawRd{*ivalue}, rbuf, GridViewResult::kCellSplitter);
+      RevPrint(rbuf, ivalue->Key_);
+   }
+   void GridView(const GridViewRequest& req, FnGridViewOp fnCallback) override {
+      GridViewResult res{this->Tree_, req.Tab_};
+      MakeGridView(this->Rows_, GetIteratorForGv(this->Rows_, req.OrigKey_),
+                   req, res, &MakeRowView);
+      fnCallback(res);
+   }
+   struct PodOp : public PodOpDefault {
+      fon9_NON_COPY_NON_MOVE(PodOp);
+      using base = PodOpDefault;
+      MemBlockStatRow& Row_;
+      PodOp(MemBlockStatRow& row, Tree& sender)
+         : base(sender, OpResult::no_error, ToStrView(row.Key_))
+         , Row_(row) {
+      }
+      void BeginRead(Tab& tab, FnReadOp fnCallback) override {
+         this->BeginRW(tab, std::move(fnCallback), SimpleRawRd{this->Row_});
+      }
+   };
+   void Get(StrView strKeyText, FnPodOp fnCallback) override {
+      auto ifind = GetIteratorForPod(this->Rows_, strKeyText);
+      if (ifind == this->Rows_.end())
+         fnCallback(PodOpResult{this->Tree_, OpResult::not_found_key, strKeyText}, nullptr);
+      else {
+         PodOp op{*ifind, this->Tree_};
+         fnCallback(op, &op);
+      }
+   }
+};
+
+void MemBlockTree::OnTreeOp(FnTreeOp fnCallback) {
+   TreeOp op{*this};
+   fnCallback(TreeOpResult{this, OpResult::no_error}, &op);
+}
+
+} } // namespaces
@@ -0,0 +1,25 @@
+﻿/// \file fon9/seed/MemBlockTree.hpp
+/// \author fonwinz@gmail.com
+#ifndef __fon9_seed_MemBlockTree_hpp__
+#define __fon9_seed_MemBlockTree_hpp__
+#include "fon9/seed/Tree.hpp"
+
+namespace fon9 { namespace seed {
+
+/// \ingroup seed
+/// 提供 MemBlock 各 center(NUMA node) 各 level 的使用統計, 僅供查看.
+/// - key = "node.level": node 為 "*" 表示 default center(使用 malloc, 不分 node).
+/// - 每次 OnTreeOp() 都會透過 impl::MemBlockGetStats() 取得當時的快照.
+class fon9_API MemBlockTree : public Tree {
+   fon9_NON_COPY_NON_MOVE(MemBlockTree);
+   using base = Tree;
+   struct TreeOp;
+   static LayoutSP MakeLayout();
+public:
+   MemBlockTree() : base{MakeLayout()} {
+   }
+   void OnTreeOp(FnTreeOp fnCallback) override;
+};
+
+} } // namespaces
+#endif//__fon9_seed_MemBlockTree_hpp__
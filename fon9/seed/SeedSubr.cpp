@@ -29,6 +29,9 @@ void SeedNotifyArgs::MakeGridView() const {
    FieldsCellRevPrint0NoSpl(this->Tab_->Fields_, *this->Rd_, rbuf, *fon9_kCSTR_CELLSPL);
    this->CacheGV_ = BufferTo<std::string>(rbuf.MoveOut());
 }
+BufferList SeedNotifyArgs::GetGridViewShared() const {
+   return BufferList{};
+}
 //--------------------------------------------------------------------------//
 SeedNotifySubscribeOK::SeedNotifySubscribeOK(TreeOp& opTree, Tab& tab)
    : base(opTree.Tree_, &tab, TextBegin(), nullptr, SeedNotifyKind::SubscribeOK)
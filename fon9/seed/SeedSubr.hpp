@@ -97,6 +97,11 @@ public:
          this->MakeGridView();
       return this->CacheGV_;
    }
+   /// 發行者可提供「打包一次, 全部訂閱者共用」的內容(GetGridView() 的內容), 例: BufferShared;
+   /// - 每次呼叫都會返回一個新的 BufferList(BufferNodeShared), 但不會複製資料,
+   ///   訂閱者只能直接串到自己的傳送緩衝, 例: io::Device::Send(); rc::RcSession::Send();
+   /// - 預設返回 BufferList{}; 此時訂閱者應使用 GetGridView();
+   virtual BufferList GetGridViewShared() const;
 };
 fon9_WARN_POP;
 //--------------------------------------------------------------------------//
@@ -65,8 +65,10 @@ inline static File::Result SetFileSize(int fd, File::PosType newFileSize) {
       return File::Result{newFileSize};
    return File::Result{GetSysErrC()};
 }
-inline static void FlushFileBuffers(int fd) {
-   fdatasync(fd);
+inline static File::Result SyncFile(int fd) {
+   if (fdatasync(fd) == 0)
+      return File::Result{0};
+   return File::Result{GetSysErrC()};
 }
 //------------------------------------------------
 static File::Result OpenFileFD(FdrAuto& fd, const std::string& fname, FileMode fmode) {
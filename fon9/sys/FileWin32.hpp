@@ -113,6 +113,11 @@ inline static File::Result GetFileSize(HANDLE fd) {
       return File::Result{static_cast<File::PosType>(fsz.QuadPart)};
    return File::Result{GetSysErrC()};
 }
+inline static File::Result SyncFile(HANDLE fd) {
+   if (::FlushFileBuffers(fd))
+      return File::Result{0};
+   return File::Result{GetSysErrC()};
+}
 inline static File::Result SetFileSize(HANDLE fd, File::PosType newFileSize) {
    FILE_END_OF_FILE_INFO fpos;
    fpos.EndOfFile.QuadPart = static_cast<LONGLONG>(newFileSize);
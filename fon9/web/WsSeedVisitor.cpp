@@ -87,6 +87,8 @@ struct WsSeedVisitor::SeedVisitor : public seed::SeedVisitor {
          case fon9::seed::SeedNotifyKind::StreamRecoverEnd:
          case fon9::seed::SeedNotifyKind::StreamEnd:
          case fon9::seed::SeedNotifyKind::ParentSeedClear:
+            // Stream(例: MdRts) 為二進位內容, 這裡(TextFrame)不轉送;
+            // 所以也不需要使用 SeedNotifyArgs::GetGridViewShared(): 目前只有 MdRtsNotifyArgs 有提供.
             return;
          case fon9::seed::SeedNotifyKind::PodRemoved:
             RevPrint(rbuf, '\n');